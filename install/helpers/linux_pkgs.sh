@@ -18,6 +18,7 @@ apt install -y \
     build-essential \
     libx264-dev \
     libopencv-dev \
+    libjpeg-dev \
 
 apt upgrade -y
 
@@ -130,6 +130,57 @@ ReturnCodes CLI_Parser::addFlags() {
         ->check(::CLI::Range(1024, 65535))
         ;
 
+    net_group->add_option("--pkt-encoding", cli_res[CLI::Results::ParseKeys::PKT_ENCODING])
+        ->description("How the client serializes packets (the server answers in the same encoding)")
+        ->required(false)
+        ->default_val("binary")
+        ->check(::CLI::IsMember({"binary", "bson"}))
+        ;
+
+    const std::vector<std::string> channel_list {"control", "camera", "srv-data"};
+    net_group->add_option("--no-checksum", cli_res[CLI::Results::ParseKeys::NO_CHECKSUM])
+        ->description("Channels to skip checksums on (comma-seperated). Only for links that cannot corrupt data (i.e. loopback)")
+        ->required(false)
+        ->default_val("")
+        ->expected(0, channel_list.size())
+        ->allow_extra_args()
+        ->delimiter(delim)
+        ->check(::CLI::IsMember(channel_list))
+        ->join(delim)
+        ;
+
+    net_group->add_option("--transport", cli_res[CLI::Results::ParseKeys::TRANSPORT])
+        ->description("How the server & client talk (both ends must match). "
+                      "tcp, udp (control & server data as datagrams, camera on tcp), "
+                      "local (same machine: unix sockets + camera frames in shared memory) "
+                      "or mux (every channel over one tcp connection on the control port)")
+        ->required(false)
+        ->default_val("tcp")
+        ->check(::CLI::IsMember({"tcp", "udp", "local", "mux"}))
+        ;
+
+    net_group->add_option("--sim-loss", cli_res[CLI::Results::ParseKeys::SIM_LOSS])
+        ->description("Percent of udp datagrams to drop/duplicate/reorder on send (for testing --transport udp over loopback)")
+        ->required(false)
+        ->default_val("0")
+        ->check(::CLI::Range(0.0, 100.0))
+        ;
+
+    net_group->add_option("--io-engine", cli_res[CLI::Results::ParseKeys::IO_ENGINE])
+        ->description("How the client reads its tcp sockets. posix (a recv() per chunk) "
+                      "or uring (multishot io_uring recv, needs linux 6.0+, falls back to posix)")
+        ->required(false)
+        ->default_val("posix")
+        ->check(::CLI::IsMember({"posix", "uring"}))
+        ;
+
+    net_group->add_option("--capture", cli_res[CLI::Results::ParseKeys::CAPTURE])
+        ->description("Record every control pkt, camera frame & server data pkt sent/received to this file "
+                      "(replay it with ./bin/capture_replay)")
+        ->required(false)
+        ->default_val("")
+        ;
+
     /**************************************** I2C Address Flags ***************************************/
 
     auto hardware_group = add_option_group("Hardware");
@@ -171,6 +222,40 @@ ReturnCodes CLI_Parser::addFlags() {
         ->check(::CLI::ExistingFile)
         ;
 
+    cam_group->add_option("--lbp-xml", cli_res[CLI::Results::ParseKeys::LBPXML])
+        ->description("The absolute path to the opencv `lbpcascade_frontalface_improved.xml` for the lbp face detector")
+        ->required(false)
+        ->check(::CLI::ExistingFile)
+        ;
+
+    cam_group->add_option("--dnn-model", cli_res[CLI::Results::ParseKeys::DNN_MODEL])
+        ->description("The absolute path to the opencv dnn face model's weights "
+                      "(`res10_300x300_ssd_iter_140000_fp16.caffemodel`) for the dnn face detector")
+        ->required(false)
+        ->check(::CLI::ExistingFile)
+        ;
+
+    cam_group->add_option("--dnn-config", cli_res[CLI::Results::ParseKeys::DNN_CONFIG])
+        ->description("The absolute path to the opencv dnn face model's network (`deploy.prototxt`)")
+        ->required(false)
+        ->check(::CLI::ExistingFile)
+        ;
+
+    cam_group->add_option("--detector", cli_res[CLI::Results::ParseKeys::DETECTOR])
+        ->description("How faces are detected. lbp, haar, dnn (opencv's ssd face model on the cpu) "
+                      "or auto (the most accurate one whose files exist & that fits --detect-budget)")
+        ->required(false)
+        ->default_val("auto")
+        ->check(::CLI::IsMember({"auto", "lbp", "haar", "dnn"}))
+        ;
+
+    cam_group->add_option("--detect-budget", cli_res[CLI::Results::ParseKeys::DETECT_BUDGET])
+        ->description("The ms of cpu time face detection can take per frame")
+        ->required(false)
+        ->default_val("12")
+        ->check(::CLI::Range(1.0, 1000.0))
+        ;
+
     /*********************************** Miscellaneous/Main/Required Flags *********************************/
 
     auto misc_group = add_option_group("Miscellaneous");
@@ -16,6 +16,10 @@ const fs::path      FRONTEND_DIR         {CURR_DIR / "frontend"};
 const fs::path      HTML_DIR             {FRONTEND_DIR / "html"};
 const fs::path      STATIC_DIR           {FRONTEND_DIR / "static"};
 
+// mjpeg stream
+const std::string   MJPEG_BOUNDARY       {"rpi-frame"};    // separates the frames (parts) of the multipart response
+constexpr int       STREAM_WAIT_MS       {100};            // longest the stream thread waits for a frame (new/caught up streams & exit)
+
 /********************************************** Constructors **********************************************/
 
 WebApp::WebApp(const std::shared_ptr<RPI::Network::TcpBase> tcp_client, const int port)
@@ -24,6 +28,10 @@ WebApp::WebApp(const std::shared_ptr<RPI::Network::TcpBase> tcp_client, const in
     , web_url_root{std::string(URL_BASE_IP) + ":" + std::to_string(web_port)}
     , web_app{Pistache::Address{Pistache::Ipv4::any(), Pistache::Port(web_port)}}
     , is_running{false}
+    , stream_mutex{}
+    , pending_streams{}
+    , stream_thread{}
+    , stop_streams{false}
 {
     if(setupSites() != ReturnCodes::Success) {
         cerr << "ERROR: Failed to setup web app" << endl;
@@ -35,6 +43,14 @@ WebApp::~WebApp() {
     stopWebApp();
 }
 
+WebApp::VidStream::VidStream(Pistache::Http::ResponseWriter& res)
+    : stream{res.stream(Pistache::Http::Code::Ok)}  // a prvalue, so it is built in place
+    , peer{res.peer()}                              // throws if the browser is already gone
+    , generation{0}                                 // no frame sent yet
+{
+    // stub
+}
+
 /********************************************* Getters/Setters *********************************************/
 
 
@@ -49,6 +65,8 @@ void WebApp::startWebApp(const bool print_urls) {
 
     // start running the web app
     is_running = true;
+    stop_streams.store(false);
+    stream_thread = std::thread{&WebApp::runVidStreams, this};
     web_app.serveThreaded();
 }
 
@@ -56,6 +74,10 @@ ReturnCodes WebApp::stopWebApp() {
     // causes issues trying to close web app if it is not open
     if (is_running) {
         is_running = false;
+
+        // end the streams while the server can still send the end of them
+        stop_streams.store(true);
+        if (stream_thread.joinable()) stream_thread.join();
         web_app.shutdown();
     }
     return ReturnCodes::Success;
@@ -91,11 +113,21 @@ ReturnCodes WebApp::setupSites() {
         WebAppUrls.at(WebAppUrlsNames::CAM_PAGE),
         Pistache::Rest::Routes::bind(&WebApp::handleVidReq, this)
     );
+    Pistache::Rest::Routes::Get(
+        web_app_router,
+        WebAppUrls.at(WebAppUrlsNames::CAM_STREAM),
+        Pistache::Rest::Routes::bind(&WebApp::handleVidStreamReq, this)
+    );
     Pistache::Rest::Routes::Get(
         web_app_router,
         WebAppUrls.at(WebAppUrlsNames::CAM_SETTINGS),
         Pistache::Rest::Routes::bind(&WebApp::handleCamSettingReq, this)
     );
+    Pistache::Rest::Routes::Get(
+        web_app_router,
+        WebAppUrls.at(WebAppUrlsNames::CAM_LATENCY),
+        Pistache::Rest::Routes::bind(&WebApp::handleCamLatencyReq, this)
+    );
     Pistache::Rest::Routes::Get(
         web_app_router,
         WebAppUrls.at(WebAppUrlsNames::SERVER_DATA),
@@ -250,10 +282,11 @@ void WebApp::handleVidReq(
     Pistache::Http::ResponseWriter res
 ) {
     try {
-        // stores pixel data
-        const std::vector<unsigned char>& frame   { client_ptr->getLatestCamFrame() };
-        const std::size_t img_size                { frame.size() };
-        const char* frame_buf                     { img_size > 0 ? (char*)frame.data() : "" };
+        // stores pixel data (handle keeps the frame alive even if a new one arrives mid-send)
+        const RPI::Network::CamFrameSnapshot snapshot { client_ptr->getLatestCamFrameSnapshot() };
+        const RPI::Network::CamFrame& frame       { snapshot.frame };
+        const std::size_t img_size                { frame->size() };
+        const char* frame_buf                     { img_size > 0 ? (char*)frame->data() : "" };
 
         // actually send the pixel data back to GET request
         res.send(
@@ -265,6 +298,9 @@ void WebApp::handleVidReq(
             )
         );
 
+        // last hop of the frame's trip from the camera
+        client_ptr->recordFrameServed(snapshot.stamp);
+
     } catch (std::exception& err) {
         constexpr auto err_str {"ERROR: Handling web app video data"};
         cout << err_str << ": " << err.what() << endl;
@@ -272,6 +308,30 @@ void WebApp::handleVidReq(
     }
 }
 
+void WebApp::handleVidStreamReq(
+    __attribute__((unused)) const Pistache::Rest::Request& req,
+    Pistache::Http::ResponseWriter res
+) {
+    // the browser replaces the image w/ every part it gets
+    res.headers()
+        .add<Pistache::Http::Header::CacheControl>(Pistache::Http::CacheDirective::NoCache)
+        .addRaw(Pistache::Http::Header::Raw{"Content-Type", "multipart/x-mixed-replace; boundary=" + MJPEG_BOUNDARY});
+
+    // send the headers now, the response stays open & from here on only stream_thread writes to it
+    std::list<VidStream> new_stream {};
+    try {
+        new_stream.emplace_back(res);
+        new_stream.back().stream.flush();
+    } catch (std::exception& err) {
+        // the browser is already gone
+        return;
+    }
+
+    // only held to hand the stream over (this worker is free for other requests right away)
+    std::lock_guard<std::mutex> lock {stream_mutex};
+    pending_streams.splice(pending_streams.end(), new_stream);
+}
+
 void WebApp::handleCamSettingReq(
     __attribute__((unused)) const Pistache::Rest::Request& req,
     Pistache::Http::ResponseWriter res
@@ -303,6 +363,30 @@ void WebApp::handleCamSettingReq(
     }
 }
 
+void WebApp::handleCamLatencyReq(
+    __attribute__((unused)) const Pistache::Rest::Request& req,
+    Pistache::Http::ResponseWriter res
+) {
+    try {
+        // see FrameTimings::toJson() for what it looks like (+ how well the clocks are synced, see ClockSync::toJson())
+        json latency {client_ptr->getFrameTimings().toJson()};
+        latency["clock"] = client_ptr->getClockSync().toJson();
+
+        res.send(
+            Pistache::Http::Code::Ok,
+            latency.dump(),
+            Pistache::Http::Mime::MediaType(
+                Pistache::Http::Mime::Type::Application, // main type
+                Pistache::Http::Mime::Subtype::Json // sub type
+            )
+        );
+
+    } catch (std::exception& err) {
+        constexpr auto err_str {"ERROR: Sending camera latency"};
+        cout << err_str << ": " << err.what() << endl;
+        res.send(Pistache::Http::Code::Bad_Request, err_str);
+    }
+}
 
 void WebApp::handleServerDataReq(
     __attribute__((unused)) const Pistache::Rest::Request& req,
@@ -349,6 +433,94 @@ void WebApp::handleShutdown(
 
 /********************************************* Helper Functions ********************************************/
 
+void WebApp::runVidStreams() {
+    // only this thread writes to the streams, so no lock is held while it does
+    std::list<VidStream> vid_streams {};
+    std::uint64_t last_generation {0};
+    std::string part {};                // latest frame's part (built once, written to every stream)
+    std::uint64_t part_generation {0};
+    std::uint64_t served_generation {0};
+    while (!stop_streams.load()) {
+        const RPI::Network::CamFrameSnapshot snapshot {client_ptr->waitForNewCamFrame(last_generation, STREAM_WAIT_MS)};
+        last_generation = snapshot.generation;
+        {
+            std::lock_guard<std::mutex> lock {stream_mutex};
+            vid_streams.splice(vid_streams.end(), pending_streams);
+        }
+        if (vid_streams.empty() || !snapshot.frame || snapshot.frame->empty()) continue;
+
+        if (part_generation != snapshot.generation) {
+            part = makeStreamPart(*snapshot.frame);
+            part_generation = snapshot.generation;
+        }
+
+        bool was_served {false};
+        for (auto vid = vid_streams.begin(); vid != vid_streams.end();) {
+            // has this frame already or is still sending an older one (gets the newest once it caught up)
+            if (vid->generation == snapshot.generation || isStreamBusy(*vid)) {
+                ++vid;
+                continue;
+            }
+            if (!writeStreamPart(*vid, part)) {
+                vid = vid_streams.erase(vid);
+                continue;
+            }
+            vid->generation = snapshot.generation;
+            was_served = true;
+            ++vid;
+        }
+
+        // last hop of the frame's trip from the camera (once, however many streams got it)
+        if (was_served && served_generation != snapshot.generation) {
+            client_ptr->recordFrameServed(snapshot.stamp);
+            served_generation = snapshot.generation;
+        }
+    }
+
+    // close the streams properly (the browsers keep the last frame up)
+    {
+        std::lock_guard<std::mutex> lock {stream_mutex};
+        vid_streams.splice(vid_streams.end(), pending_streams);
+    }
+    for (auto& vid : vid_streams) {
+        try {
+            vid.stream.ends();
+        } catch (std::exception& err) {
+            // already gone
+        }
+    }
+}
+
+bool WebApp::isStreamBusy(const VidStream& vid) {
+    // a part pistache could not hand to the kernel yet keeps the socket's queue full too
+    const std::shared_ptr<Pistache::Tcp::Peer> peer {vid.peer.lock()};
+    return peer && RPI::Network::SockTuning::getNotSentSize(peer->fd()) > 0;
+}
+
+bool WebApp::writeStreamPart(VidStream& vid, const std::string& part) {
+    // the connection is gone (i.e. the tab was closed)
+    if (vid.peer.expired()) return false;
+
+    try {
+        // queued behind the headers & older parts by the same stream, so they go out in order
+        vid.stream.write(part.data(), static_cast<std::streamsize>(part.size()));
+        vid.stream.flush();
+    } catch (std::exception& err) {
+        return false;
+    }
+    return true;
+}
+
+std::string WebApp::makeStreamPart(const std::vector<unsigned char>& frame) {
+    std::string part {
+        "--" + MJPEG_BOUNDARY + "\r\n"
+        "Content-Type: image/jpeg\r\n"
+        "Content-Length: " + std::to_string(frame.size()) + "\r\n\r\n"
+    };
+    part.append(frame.begin(), frame.end());
+    part.append("\r\n");
+    return part;
+}
 
 void WebApp::printUrls() const {
     cout << "Web App's Urls: " << endl;
@@ -4,7 +4,7 @@
  */
 
 import { DataIfPageExists } from "./request_handler.js"
-import { sendCamPkt, getCamSettings } from "./pkt.js"
+import { sendCamPkt } from "./pkt.js"
 
 
 /**
@@ -66,14 +66,12 @@ const CheckImage = async (url) => {
 $("document").ready( async () => {
     /**
      * Image representing the camera's most recent frame.
-     * If refreshed often, forms video
+     * Its src is set to the mjpeg stream, which the backend pushes every new frame over (forms video)
      */
     const cam_vid = document.getElementById("Cam-Stream")
-    const cam_original_src = cam_vid.src
-
-    // get the camera's settings
-    const cam_settings = await getCamSettings()
-    const fps = cam_settings.fps // TODO: get this from get request
+    const cam_original_src = cam_vid.src // single (latest) frame, used to check if the backend is up
+    const cam_stream_src = "/Camera/stream.mjpg"
+    const cam_settings_src = "/Camera/settings.json" // small page polled to notice the backend going down
 
     // track/manage camera's recording status
     // contains all elements which when clicked toggle recording
@@ -176,33 +174,22 @@ $("document").ready( async () => {
         CreateWakeupInterval()
     }
 
-    // creates the interval which continously grabs frames to generate the "video"
-    // wrap in function so interval can be recreated when/if stopped
-    // keep reloading JUST the image at the correct fps to mimic a video
+    // opens the mjpeg stream which generates the "video" (the backend pushes each new frame over it)
+    // wrap in function so it can be reopened when/if stopped
     const CreateVidStream = () => {
         // trigger toggle for starting condition to show pause button while removing blue box
         playpause_click(true)
 
+        // attach random string so a restart opens a new stream instead of reusing the dead one
+        cam_vid.src = `${cam_stream_src}?v=${new Date().getTime()}`
+
+        // if connection dies, stop everything (the last frame stays up)
+        // the stream itself cannot tell "no new frames" from "backend down", so check a small page now and then
         stop_dict.intervals.push(setInterval(
             async () => {
-                // attach random string to force reload of JUST the image
-                const cache_refresh = `?v=${new Date().getTime()}`
-                const new_img_url = cam_original_src + cache_refresh
-
-                // if connection dies, dont try to reload image (keep last)
-                // only refresh image if backend is still up
-                // -- prevents issue with reloading to blank image and erroring
-                const img_data = await CheckImage(new_img_url)
-                const img_exists = img_data != null
-                if (!img_exists) {
-                    StopCamActivites()
-                    return // prevent latest frame from reloading
-                }
-
-                // actually reload page
-                cam_vid.src = img_data.src
-
-            }, 1000 / fps // need ms per frame
+                const settings_data = await DataIfPageExists(cam_settings_src, "GET")
+                if (settings_data == null) StopCamActivites()
+            }, 3000 // check every 3 seconds
         ))
     }
 
@@ -0,0 +1,116 @@
+#ifndef BENCH_HELPERS_HPP
+#define BENCH_HELPERS_HPP
+
+// Standard Includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib> // for strtod/strtoull & EXIT_*
+#include <cmath>   // for std::isfinite
+#include <limits>
+#include <cerrno>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// helpers shared by the network benchmarks (& capture_replay)
+namespace Bench {
+
+/**
+ * @brief Connects a loopback tcp socket pair
+ * @param send_fd Set to the accepted end
+ * @param recv_fd Set to the connecting end
+ * @param recv_buf_size The receiver's SO_RCVBUF (i.e. kept small to act like a link's queue, 0 = kernel default)
+ * @return false if any step failed
+ */
+inline bool connectPair(int& send_fd, int& recv_fd, const int recv_buf_size=0) {
+    const int listen_fd {::socket(AF_INET, SOCK_STREAM, 0)};
+    sockaddr_in addr        {};
+    addr.sin_family         = AF_INET;
+    addr.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len      {sizeof(addr)};
+    if (listen_fd < 0
+        || ::bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0
+        || ::listen(listen_fd, 1) < 0
+        || ::getsockname(listen_fd, (sockaddr*)&addr, &addr_len) < 0
+    ) {
+        if (listen_fd >= 0) ::close(listen_fd);
+        return false;
+    }
+
+    recv_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (recv_fd >= 0 && recv_buf_size > 0) {
+        ::setsockopt(recv_fd, SOL_SOCKET, SO_RCVBUF, &recv_buf_size, sizeof(recv_buf_size));
+    }
+    const bool connected {recv_fd >= 0 && ::connect(recv_fd, (sockaddr*)&addr, sizeof(addr)) == 0};
+    send_fd = connected ? ::accept(listen_fd, nullptr, nullptr) : -1;
+    ::close(listen_fd);
+    return send_fd >= 0;
+}
+
+/**
+ * @brief Get a percentile of sorted samples (nearest rank below, 0 if there are none)
+ * @param sorted The samples (ascending)
+ * @param pct The percentile (0-100)
+ */
+inline double percentile(const std::vector<double>& sorted, const double pct) {
+    if (sorted.empty()) return 0;
+    const std::size_t idx {static_cast<std::size_t>(pct / 100.0 * (sorted.size() - 1))};
+    return sorted[idx];
+}
+
+/**
+ * @brief Parse a numeric command line argument
+ * @param arg The argument (all of it has to be the number)
+ * @param value Set to the number if it is valid (left as is otherwise)
+ * @param min_val, max_val The range it has to be in (inclusive)
+ * @return false if it is not a number or out of range
+ */
+inline bool parseArg(const char* arg, double& value, const double min_val,
+                     const double max_val=std::numeric_limits<double>::max()) {
+    char* end {nullptr};
+    const double parsed {std::strtod(arg, &end)};
+    if (end == arg || *end != '\0' || !std::isfinite(parsed) || parsed < min_val || parsed > max_val) return false;
+    value = parsed;
+    return true;
+}
+
+inline bool parseArg(const char* arg, std::size_t& value, const std::size_t min_val,
+                     const std::size_t max_val=std::numeric_limits<std::size_t>::max()) {
+    // strtoull() would wrap a negative number around
+    if (arg[0] < '0' || arg[0] > '9') return false;
+    char* end {nullptr};
+    errno = 0;
+    const unsigned long long parsed {std::strtoull(arg, &end, 10)};
+    if (*end != '\0' || errno == ERANGE || parsed < min_val || parsed > max_val) return false;
+    value = static_cast<std::size_t>(parsed);
+    return true;
+}
+
+/**
+ * @brief Determine if any argument asks for help (-h/--help)
+ */
+inline bool wantsHelp(const int argc, char* argv[]) {
+    for (int idx = 1; idx < argc; ++idx) {
+        const std::string arg {argv[idx]};
+        if (arg == "-h" || arg == "--help") return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Print how to call the program (stdout if it was asked for w/ -h/--help, stderr otherwise)
+ * @param args The program's arguments, as listed after its name
+ * @return The exit code: success if help was asked for, failure if the arguments were bad
+ */
+inline int usage(const int argc, char* argv[], const std::string& args) {
+    const bool asked {wantsHelp(argc, argv)};
+    (asked ? std::cout : std::cerr) << "Usage: " << argv[0] << " " << args << std::endl;
+    return asked ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}; // end of Bench namespace
+
+#endif
@@ -0,0 +1,242 @@
+/**
+ * @file capture_replay.cpp
+ * @brief Replays a capture file (recorded w/ --capture, see TcpBase::startCapture()) through a TcpServer and/or
+ * TcpClient, so a recorded session drives the network stack the same way every time (no pi, camera or gpio needed):
+ * recorded camera frames & server data pkts are handed to the server's setLatestCamFrame()/updatePkt() & recorded
+ * control pkts to the client's updatePkt(), at the times they were recorded (sped up or as fast as possible)
+ * @note Usage: ./bin/capture_replay <capture file> [speed (default=1, 0=as fast as possible)]
+ * [target: loopback|server|client (default=loopback)] [server ip (client target, default=127.0.0.1)]
+ * [transport: tcp|udp|local|mux (default=tcp)]
+ * loopback: runs both ends in this process & reports what made it across (frame hop & control pkt latencies).
+ * server: a server on the default ports fed w/ the recorded frames & server data (a real client connects to it).
+ * client: a client connected to a real server, fed w/ the recorded control pkts
+ */
+
+// Standard Includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm> // for std::find_if & std::max
+
+// Our Includes
+#include "tcp_server.h"
+#include "tcp_client.h"
+#include "capture_file.h"
+#include "bench_helpers.hpp"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+namespace Net = RPI::Network;
+using RPI::ReturnCodes;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int                       CTRL_PORT       {55555};    // same defaults as the driver's --ctrl-port etc
+constexpr int                       CAM_PORT        {55556};
+constexpr int                       SRV_DATA_PORT   {55557};
+constexpr std::chrono::seconds      CONNECT_TIMEOUT {5};        // client has to sync its clock by then
+constexpr std::chrono::milliseconds DRAIN_TIME      {500};      // what is still in flight when the replay ends
+
+struct ChannelCount {
+    std::uint64_t   num_msgs    {0};
+    std::uint64_t   bytes       {0};
+};
+
+const std::vector<std::pair<std::string, Net::Transport>> TRANSPORTS {
+    {"tcp",     Net::Transport::Tcp},
+    {"udp",     Net::Transport::Udp},
+    {"local",   Net::Transport::Local},
+    {"mux",     Net::Transport::Mux},
+};
+
+std::string channelName(const Net::Channel channel) {
+    switch (channel) {
+        case Net::Channel::Control: return "control";
+        case Net::Channel::Camera:  return "camera";
+        case Net::Channel::SrvData:
+        default:                    return "srv data";
+    }
+}
+
+/**
+ * @brief Prints a latency histogram's count & percentiles (ms)
+ */
+void printLatency(const std::string& name, const Net::LatencyHistogram& hist) {
+    cout << "  " << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(3)
+         << std::setw(8) << hist.getCount()
+         << std::setw(10) << hist.getPercentileUs(0.50) / 1000.0
+         << std::setw(10) << hist.getPercentileUs(0.99) / 1000.0
+         << std::setw(10) << hist.getMaxUs() / 1000.0 << endl;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+    double speed {1.0};
+    if (Bench::wantsHelp(argc, argv) || argc < 2 || argc > 6
+        || (argc > 2 && !Bench::parseArg(argv[2], speed, 0))
+    ) {
+        return Bench::usage(argc, argv,
+            "<capture file> [speed (default=1, 0=as fast as possible)] "
+            "[loopback|server|client (default=loopback)] [server ip (default=127.0.0.1)] "
+            "[tcp|udp|local|mux (default=tcp)]");
+    }
+    const std::string path {argv[1]};
+    const std::string target {argc > 3 ? argv[3] : "loopback"};
+    const std::string ip {argc > 4 ? argv[4] : "127.0.0.1"};
+    const std::string transport_name {argc > 5 ? argv[5] : "tcp"};
+
+    const auto transport {std::find_if(TRANSPORTS.begin(), TRANSPORTS.end(), [&](const auto& entry) {
+        return entry.first == transport_name;
+    })};
+    if (transport == TRANSPORTS.end() || (target != "loopback" && target != "server" && target != "client")) {
+        cerr << "ERROR: Unknown target/transport (see usage)" << endl;
+        return EXIT_FAILURE;
+    }
+
+    Net::CaptureReader capture {};
+    if (capture.open(path) != ReturnCodes::Success) return EXIT_FAILURE;
+    if (capture.size() == 0) {
+        cerr << "ERROR: " << path << " has no records" << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "Replaying " << capture.size() << " records (" << capture.getDurationUs() / 1e6 << "s recorded) @"
+         << (speed > 0 ? std::to_string(speed) + "x" : std::string{"max speed"}) << endl;
+
+    // control pkts are re-encoded by the client, in the encoding they were recorded in
+    Net::PktEncoding ctrl_encoding {Net::PktEncoding::Binary};
+    for (std::size_t idx = 0; idx < capture.size(); ++idx) {
+        const Net::CaptureRecord record {capture.at(idx)};
+        if (record.channel != Net::Channel::Control) continue;
+        ctrl_encoding = static_cast<Net::PktEncoding>(record.header.protocol);
+        break;
+    }
+
+    const bool use_server {target != "client"};
+    const bool use_client {target != "server"};
+    std::unique_ptr<Net::TcpServer> server {};
+    std::unique_ptr<Net::TcpClient> client {};
+    std::atomic<std::uint64_t> ctrl_recv {0};
+    if (use_server) {
+        server = std::make_unique<Net::TcpServer>(CTRL_PORT, CAM_PORT, SRV_DATA_PORT, true, false, transport->second);
+        server->setRecvCallback([&](const Net::CommonPkt&) {
+            ctrl_recv.fetch_add(1, std::memory_order_relaxed);
+            return ReturnCodes::Success;
+        });
+    }
+    if (use_client) {
+        client = std::make_unique<Net::TcpClient>(
+            ip, CTRL_PORT, CAM_PORT, SRV_DATA_PORT, true, false, ctrl_encoding, transport->second
+        );
+    }
+    if ((server && !server->getIsInit()) || (client && !client->getIsInit())) {
+        cerr << "ERROR: Failed to init the server/client" << endl;
+        return EXIT_FAILURE;
+    }
+    if (server) server->runNetAgent(false);
+    if (client) client->runNetAgent(false);
+
+    // a synced clock means the control connection is up (frames recorded before then would just be dropped)
+    if (client) {
+        const auto connect_by {clock_type::now() + CONNECT_TIMEOUT};
+        while (!client->getClockSync().isSynced() && clock_type::now() < connect_by) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (!client->getClockSync().isSynced()) cerr << "Warning: Client did not connect in time, replaying anyway" << endl;
+    }
+
+    /************************************************ Replay ************************************************/
+
+    std::array<ChannelCount, Net::NUM_CHANNELS> injected {};
+    std::uint64_t max_late_us {0};  // how far behind the recorded timing the replay fell
+    const std::uint64_t first_generation {client ? client->getLatestCamFrameSnapshot().generation : 0};
+    const std::uint64_t first_us {capture.at(0).time_us};
+    const auto start {clock_type::now()};
+    for (std::size_t idx = 0; idx < capture.size(); ++idx) {
+        const Net::CaptureRecord record {capture.at(idx)};
+        if (speed > 0) {
+            const auto due {start + std::chrono::microseconds(
+                static_cast<std::int64_t>(static_cast<double>(record.time_us - first_us) / speed)
+            )};
+            std::this_thread::sleep_until(due);
+            const auto late {std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - due).count()};
+            max_late_us = std::max<std::uint64_t>(max_late_us, static_cast<std::uint64_t>(std::max<std::int64_t>(late, 0)));
+        }
+
+        const char* data {reinterpret_cast<const char*>(record.data)};
+        const Net::PktEncoding encoding {static_cast<Net::PktEncoding>(record.header.protocol)};
+        try {
+            switch (record.channel) {
+                case Net::Channel::Control:
+                    if (!client) continue;
+                    client->updatePkt(client->readCmnPkt(data, record.size, encoding));
+                    break;
+                case Net::Channel::Camera: {
+                    if (!server) continue;
+                    // stamped as if it was just captured, so the frame timings measure this replay's hops
+                    RPI::Camera::FrameStamp stamp {};
+                    stamp.seq           = record.header.getStamp().seq;
+                    stamp.capture_us    = RPI::Camera::FrameStamp::now();
+                    stamp.encoded_us    = stamp.capture_us;
+                    server->setLatestCamFrame(
+                        std::make_shared<const std::vector<unsigned char>>(record.data, record.data + record.size), stamp
+                    );
+                    break;
+                }
+                case Net::Channel::SrvData:
+                default:
+                    if (!server) continue;
+                    server->updatePkt(server->readSrvPkt(data, record.size, encoding));
+                    break;
+            }
+        } catch (std::exception& err) {
+            cerr << "Warning: Skipping record " << idx << " (" << channelName(record.channel) << "): " << err.what() << endl;
+            continue;
+        }
+        ChannelCount& count {injected[static_cast<std::size_t>(record.channel)]};
+        ++count.num_msgs;
+        count.bytes += record.size;
+    }
+    const double replay_secs {std::chrono::duration<double>(clock_type::now() - start).count()};
+
+    std::this_thread::sleep_for(DRAIN_TIME);
+    if (client) client->setExitCode(true);
+    if (server) server->setExitCode(true);
+    if (client) client->cleanup();
+    if (server) server->cleanup();
+
+    /************************************************ Results ***********************************************/
+
+    cout << endl << "Replayed in " << std::fixed << std::setprecision(3) << replay_secs << "s (fell behind the "
+         << "recorded timing by up to " << max_late_us / 1000.0 << "ms)" << endl;
+    for (std::size_t idx = 0; idx < Net::NUM_CHANNELS; ++idx) {
+        const ChannelCount& count {injected[idx]};
+        cout << "  " << std::left << std::setw(10) << channelName(static_cast<Net::Channel>(idx)) << std::right
+             << std::setw(8) << count.num_msgs << " msgs " << std::setw(10) << std::setprecision(2)
+             << static_cast<double>(count.bytes) / 1e6 << " MB" << endl;
+    }
+
+    if (target == "loopback") {
+        // the client only sends its latest control pkt & the server only its latest frame, so fewer can arrive
+        // (frames over mux or shared memory are not stamped, so only their count is known)
+        cout << endl << "Received: " << ctrl_recv.load() << " control pkts (server), "
+             << client->getLatestCamFrameSnapshot().generation - first_generation << " frames (client)" << endl;
+        cout << "  " << std::left << std::setw(18) << "latency (ms)" << std::right
+             << std::setw(8) << "count" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << endl;
+        for (const Net::FrameStage stage : {Net::FrameStage::Send, Net::FrameStage::Recv}) {
+            printLatency(Net::getFrameStageName(stage), client->getFrameTimings().getStage(stage));
+        }
+        printLatency("control", server->getCtrlLatency());
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file checksum_bench.cpp
+ * @brief Measures the throughput of each CRC32C implementation for typical message sizes
+ * @note Usage: ./bin/checksum_bench [total MB checksummed per row (default=256)]
+ */
+
+// Standard Includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm> // for std::max
+
+// Our Includes
+#include "checksum.h"
+#include "bench_helpers.hpp"
+
+using std::cout;
+using std::endl;
+namespace Checksum = RPI::Network::Checksum;
+
+namespace {
+
+using CrcFn = std::uint32_t (*)(const void*, const std::size_t, const std::uint32_t);
+
+/**
+ * @brief Checksums buf enough times to cover `total_bytes` & returns the throughput in MB/s
+ * @param sink Result of every call is folded in so the calls cannot be discarded
+ */
+double timeMBps(const CrcFn fn, const std::vector<std::uint8_t>& buf, const std::size_t total_bytes,
+                std::uint32_t& sink) {
+    const std::size_t iters {std::max<std::size_t>(1, total_bytes / buf.size())};
+    const auto start {std::chrono::steady_clock::now()};
+    for (std::size_t idx = 0; idx < iters; ++idx) {
+        sink ^= fn(buf.data(), buf.size(), sink);
+    }
+    const double secs {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    return (static_cast<double>(iters * buf.size()) / (1024.0 * 1024.0)) / secs;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t total_mb {256};
+    if (Bench::wantsHelp(argc, argv) || argc > 2 || (argc > 1 && !Bench::parseArg(argv[1], total_mb, 1, 1024 * 1024))) {
+        return Bench::usage(argc, argv, "[total MB checksummed per row (default=256)]");
+    }
+    const std::size_t total_bytes {total_mb * 1024 * 1024};
+
+    // sizes: control pkt, recv chunk, camera frame, large frame
+    const std::vector<std::size_t> sizes {64, 4096, 100 * 1024, 1024 * 1024};
+
+    std::vector<std::pair<std::string, CrcFn>> impls {
+        {"bytewise",        &Checksum::crc32cBytewise},
+        {"slicing-by-8",    &Checksum::crc32cSlicing8},
+    };
+    if (Checksum::hasHardwareCrc()) {
+        impls.emplace_back("hardware", &Checksum::crc32cHardware);
+    }
+
+    std::uint32_t sink {0};
+    cout << "CRC32C benchmark (crc32c() dispatches to: " << Checksum::getImplName() << ")" << endl;
+    cout << std::left  << std::setw(16) << "impl";
+    for (const std::size_t size : sizes) {
+        cout << std::right << std::setw(14) << (std::to_string(size) + "B MB/s");
+    }
+    cout << endl;
+
+    for (const auto& impl : impls) {
+        cout << std::left << std::setw(16) << impl.first;
+        for (const std::size_t size : sizes) {
+            std::vector<std::uint8_t> buf(size);
+            for (std::size_t idx = 0; idx < size; ++idx) {
+                buf[idx] = static_cast<std::uint8_t>(idx * 131 + 7);
+            }
+            cout << std::right << std::setw(14) << std::fixed << std::setprecision(0)
+                 << timeMBps(impl.second, buf, total_bytes, sink);
+        }
+        cout << endl;
+    }
+
+    // print so the checksums are used
+    cout << "(sink: " << std::hex << sink << std::dec << ")" << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file io_engine_bench.cpp
+ * @brief Compares reading camera sized frames over loopback tcp w/ recv() vs io_uring (see UringEngine)
+ * @note Usage: ./bin/io_engine_bench [frames per run (default=2000)] [frame KB (default=100)]
+ * Reports the receiver's syscalls per frame & cpu time (user + sys) per MB received
+ */
+
+// Standard Includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <sys/resource.h> // for getrusage()
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Our Includes
+#include "tcp_base.h"
+#include "uring_engine.h"
+#include "bench_helpers.hpp"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+namespace Net = RPI::Network;
+using RPI::ReturnCodes;
+
+namespace {
+
+/**
+ * @brief Just enough of a net agent to get at recvData()/sendData() on a socket pair
+ */
+class BenchAgent : public Net::TcpBase {
+    public:
+        BenchAgent() : TcpBase{false} {
+            setChecksumEnabled(Net::Channel::Camera, false); // only measure the i/o
+        }
+
+        using TcpBase::recvData;
+        using TcpBase::sendData;
+        using TcpBase::CloseOpenSock;
+
+        ReturnCodes sendResetPkt() override { return ReturnCodes::Success; }
+
+    protected:
+        ReturnCodes initSock() override { return ReturnCodes::Success; }
+        void ControlLoopFn(const bool) override {}
+        void VideoStreamHandler() override {}
+        void ServerDataHandler(const bool) override {}
+        void quit() override {}
+};
+
+struct RunResult {
+    bool            ok          {false};
+    double          secs        {0};    // wall time of the run
+    double          cpu_secs    {0};    // receiver thread's user + sys time
+    std::uint64_t   syscalls    {0};    // receiver's recv()/io_uring_enter() calls
+};
+
+double threadCpuSecs() {
+    rusage usage {};
+    ::getrusage(RUSAGE_THREAD, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/**
+ * @brief Streams `num_frames` frames from one thread & receives them w/ the chosen engine on this one
+ */
+RunResult runEngine(const Net::IoEngine engine, const std::size_t num_frames, const std::size_t frame_size) {
+    RunResult result {};
+    int send_fd {-1};
+    int recv_fd {-1};
+    if (!Bench::connectPair(send_fd, recv_fd)) {
+        cerr << "ERROR: Failed to connect over loopback" << endl;
+        return result;
+    }
+
+    // same receive timeout the client's sockets use
+    timeval timeout {RPI::Constants::Network::ACPT_TIMEOUT, 0};
+    ::setsockopt(recv_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    BenchAgent receiver {};
+    if (receiver.setIoEngine(engine) != ReturnCodes::Success) return result;
+
+    std::thread sender_thread {[send_fd, num_frames, frame_size]() mutable {
+        BenchAgent sender {};
+        const std::vector<std::uint8_t> frame(frame_size, 0xA5);
+        for (std::size_t idx = 0; idx < num_frames; ++idx) {
+            const Net::SendRtn sent {sender.sendData(
+                send_fd, Net::Channel::Camera, frame.data(), static_cast<std::uint32_t>(frame.size())
+            )};
+            if (sent.RtnCode != Net::RecvSendRtnCodes::Success) break;
+        }
+        sender.CloseOpenSock(send_fd);
+    }};
+
+    Net::BufferPool pool {RPI::Constants::Network::MAX_FRAME_MSG_SIZE};
+    std::size_t num_rx {0};
+    const double cpu_start {threadCpuSecs()};
+    const auto start {std::chrono::steady_clock::now()};
+    while (num_rx < num_frames) {
+        const Net::RecvRtn frame {receiver.recvData(recv_fd, pool, Net::Channel::Camera)};
+        if (frame.RtnCode == Net::RecvSendRtnCodes::WouldBlock) continue;
+        if (frame.RtnCode != Net::RecvSendRtnCodes::Success || frame.buf->size() != frame_size) break;
+        ++num_rx;
+    }
+    result.secs     = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.cpu_secs = threadCpuSecs() - cpu_start;
+    result.syscalls = receiver.getNumRecvSyscalls();
+    result.ok       = num_rx == num_frames;
+
+    receiver.CloseOpenSock(recv_fd);
+    sender_thread.join();
+    return result;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+    constexpr std::size_t max_frame_kb {RPI::Constants::Network::MAX_FRAME_MSG_SIZE / 1024};
+    std::size_t num_frames {2000};
+    std::size_t frame_kb {100};
+    if (Bench::wantsHelp(argc, argv) || argc > 3
+        || (argc > 1 && !Bench::parseArg(argv[1], num_frames, 1))
+        || (argc > 2 && !Bench::parseArg(argv[2], frame_kb, 1, max_frame_kb))
+    ) {
+        return Bench::usage(argc, argv, "[frames per run (default=2000)] [frame KB (default=100)]");
+    }
+    const std::size_t frame_size {frame_kb * 1024};
+    const double total_mb {static_cast<double>(num_frames * frame_size) / (1024.0 * 1024.0)};
+
+    std::vector<std::pair<std::string, Net::IoEngine>> engines {{"posix", Net::IoEngine::Posix}};
+    if (Net::UringEngine::isSupported()) {
+        engines.emplace_back("uring", Net::IoEngine::Uring);
+    } else {
+        cout << "(io_uring is not available on this kernel, only running posix)" << endl;
+    }
+
+    cout << "Loopback receive benchmark: " << num_frames << " frames of " << frame_size / 1024 << "KB" << endl;
+    cout << std::left  << std::setw(10) << "engine"
+         << std::right << std::setw(12) << "MB/s"
+         << std::setw(18) << "syscalls/frame"
+         << std::setw(16) << "cpu ms/MB" << endl;
+
+    for (const auto& engine : engines) {
+        const RunResult result {runEngine(engine.second, num_frames, frame_size)};
+        cout << std::left << std::setw(10) << engine.first;
+        if (!result.ok) {
+            cout << "  failed" << endl;
+            continue;
+        }
+        cout << std::right << std::fixed
+             << std::setw(12) << std::setprecision(0) << total_mb / result.secs
+             << std::setw(18) << std::setprecision(2) << static_cast<double>(result.syscalls) / num_frames
+             << std::setw(16) << std::setprecision(3) << result.cpu_secs * 1000.0 / total_mb << endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,356 @@
+/**
+ * @file loopback_bench.cpp
+ * @brief Runs a TcpServer & TcpClient in one process over loopback (no pi, camera or gpio needed) & measures the
+ * whole network stack: synthetic camera frames are fed to the server's setLatestCamFrame() & control pkts to the
+ * client's updatePkt() at fixed rates, for every transport
+ * @note Usage: ./bin/loopback_bench [seconds per run (default=5)] [frame KB (default=100)] [frames/s (default=25)]
+ * [control pkts/s (default=50)] [transport: tcp|udp|local|mux|all (default=all)]
+ * Reports per channel throughput & latency (p50/p99/p999/max, from handing it to the net agent until the other
+ * side has it) plus the net threads' cpu time (the process' minus the feeder's & poller's) & heap allocations
+ * (whole process) per message received. Frames carry when they were set in their first bytes & are picked up by
+ * polling the client's latest frame (adds up to POLL_PERIOD); control pkts carry their seq in the servo field &
+ * are timed by the server's receive callback
+ */
+
+// Standard Includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>   // for malloc/free
+#include <cstring>   // for memcpy
+#include <new>       // for std::bad_alloc
+#include <algorithm> // for std::sort & std::find_if
+#include <sys/resource.h> // for getrusage()
+
+// Our Includes
+#include "tcp_server.h"
+#include "tcp_client.h"
+#include "bench_helpers.hpp"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+namespace Net = RPI::Network;
+using RPI::ReturnCodes;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int                       BASE_PORT       {55500};    // each run uses the next 3 ports after the last
+constexpr std::chrono::microseconds POLL_PERIOD     {50};       // how often the client's latest frame is checked
+constexpr std::chrono::milliseconds DRAIN_TIME      {200};      // what is still in flight when feeding stops
+constexpr std::chrono::seconds      CONNECT_TIMEOUT {5};        // first frame has to arrive by then
+constexpr std::size_t               FRAME_BUFS      {8};        // frame buffers reused by the feeder
+constexpr std::size_t               MAX_CTRL_SEQS   {1 << 16};  // control pkts in flight the send times are kept for
+
+std::atomic<std::uint64_t> num_allocs {0}; // every operator new since the program started
+
+struct ChannelResult {
+    std::uint64_t       num_sent    {0};
+    std::uint64_t       num_recv    {0};
+    std::uint64_t       bytes_recv  {0};
+    std::vector<double> latency_ms  {};     // sorted once the run is done
+};
+
+struct RunResult {
+    bool            ok          {false};
+    double          secs        {0};    // how long messages were fed for
+    ChannelResult   frames      {};
+    ChannelResult   ctrl        {};
+    double          cpu_secs    {0};    // server & client threads (user + sys), w/o the feeder & poller
+    std::uint64_t   allocs      {0};    // heap allocations during the run (whole process)
+};
+
+/**
+ * @brief Get the cpu time (user + sys) of the whole process (RUSAGE_SELF) or the calling thread (RUSAGE_THREAD)
+ */
+double cpuSecs(const int who) {
+    rusage usage {};
+    ::getrusage(who, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+std::int64_t nowTicks() {
+    return clock_type::now().time_since_epoch().count();
+}
+
+double ticksToMs(const std::int64_t ticks) {
+    return std::chrono::duration<double, std::milli>(clock_type::duration(ticks)).count();
+}
+
+/**
+ * @brief Get a frame buffer no one else holds anymore (the server may still be sending an older one),
+ * a new one if they are all in use
+ */
+std::shared_ptr<std::vector<unsigned char>> getFreeFrame(
+    std::array<std::shared_ptr<std::vector<unsigned char>>, FRAME_BUFS>& frames,
+    const std::size_t frame_size
+) {
+    const auto free_frame {std::find_if(frames.begin(), frames.end(), [](const auto& frame) {
+        return frame.use_count() == 1;
+    })};
+    if (free_frame != frames.end()) return *free_frame;
+    return std::make_shared<std::vector<unsigned char>>(frame_size, 0xA5);
+}
+
+RunResult runTransport(
+    const Net::Transport transport,
+    const int base_port,
+    const double secs,
+    const std::size_t frame_size,
+    const double frame_rate,
+    const double ctrl_rate
+) {
+    RunResult result {};
+    Net::TcpServer server {base_port, base_port + 1, base_port + 2, true, false, transport};
+    Net::TcpClient client {
+        "127.0.0.1", base_port, base_port + 1, base_port + 2, true, false, Net::PktEncoding::Binary, transport
+    };
+    if (!server.getIsInit() || !client.getIsInit()) {
+        cerr << "ERROR: Failed to init the server/client" << endl;
+        return result;
+    }
+
+    // control pkts are timed from when the client was handed them until the server's callback sees them
+    std::mutex ctrl_mutex {};
+    std::vector<std::int64_t> ctrl_sent_at(MAX_CTRL_SEQS, 0);
+    bool is_measuring {false};
+    server.setRecvCallback([&](const Net::CommonPkt& pkt) {
+        const std::int64_t recv_at {nowTicks()};
+        std::lock_guard<std::mutex> lock{ctrl_mutex};
+        const std::size_t seq {static_cast<std::size_t>(pkt.cntrl.servo.horiz) % MAX_CTRL_SEQS};
+        if (!is_measuring || pkt.cntrl.servo.horiz <= 0 || ctrl_sent_at[seq] == 0) return ReturnCodes::Success;
+        result.ctrl.latency_ms.push_back(ticksToMs(recv_at - ctrl_sent_at[seq]));
+        ctrl_sent_at[seq] = 0; // a resent (heartbeat) pkt is not a new sample
+        return ReturnCodes::Success;
+    });
+
+    server.runNetAgent(false);
+    client.runNetAgent(false);
+
+    // frames carry when they were set, the poller times each new one the client has
+    // (its own cpu time is taken out of the result, it is measured while is_polling_measured)
+    std::atomic<bool> stop_polling {false};
+    std::atomic<bool> is_polling_measured {false};
+    std::atomic<std::uint64_t> first_frames {0};
+    std::atomic<bool> poller_cpu_done {false};
+    double poller_cpu_secs {0};
+    std::thread poller {[&]() {
+        std::uint64_t last_generation {client.getLatestCamFrameSnapshot().generation};
+        bool was_measured {false};
+        while (!stop_polling.load()) {
+            const bool is_measured {is_polling_measured.load()};
+            if (is_measured != was_measured) {
+                poller_cpu_secs = cpuSecs(RUSAGE_THREAD) - poller_cpu_secs;
+                if (was_measured) poller_cpu_done.store(true);
+                was_measured = is_measured;
+            }
+
+            const Net::CamFrameSnapshot snapshot {client.getLatestCamFrameSnapshot()};
+            if (snapshot.generation != last_generation && snapshot.frame && snapshot.frame->size() == frame_size) {
+                last_generation = snapshot.generation;
+                std::int64_t set_at {0};
+                std::memcpy(&set_at, snapshot.frame->data(), sizeof(set_at));
+                if (is_measured) {
+                    result.frames.latency_ms.push_back(ticksToMs(nowTicks() - set_at));
+                    result.frames.bytes_recv += snapshot.frame->size();
+                } else {
+                    first_frames.fetch_add(1);
+                }
+            }
+            std::this_thread::sleep_for(POLL_PERIOD);
+        }
+    }};
+
+    std::array<std::shared_ptr<std::vector<unsigned char>>, FRAME_BUFS> frame_bufs {};
+    for (auto& frame_buf : frame_bufs) frame_buf = std::make_shared<std::vector<unsigned char>>(frame_size, 0xA5);
+    const auto feedFrame {[&]() {
+        const auto frame {getFreeFrame(frame_bufs, frame_size)};
+        const std::int64_t set_at {nowTicks()};
+        std::memcpy(frame->data(), &set_at, sizeof(set_at));
+        server.setLatestCamFrame(Net::CamFrame{frame});
+    }};
+
+    // wait for the first frame to make it through (everything is connected by then)
+    const auto connect_deadline {clock_type::now() + CONNECT_TIMEOUT};
+    while (first_frames.load() == 0 && clock_type::now() < connect_deadline) {
+        feedFrame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    if (first_frames.load() > 0) {
+        // feed both channels at their rates
+        const auto frame_period {std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(1.0 / frame_rate))};
+        const auto ctrl_period {std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(1.0 / ctrl_rate))};
+        {
+            std::lock_guard<std::mutex> lock{ctrl_mutex};
+            is_measuring = true;
+        }
+        is_polling_measured.store(true);
+        const std::uint64_t allocs_start {num_allocs.load()};
+        const double cpu_start {cpuSecs(RUSAGE_SELF)};
+        const double feeder_cpu_start {cpuSecs(RUSAGE_THREAD)};
+        const auto start {clock_type::now()};
+        const auto stop_at {start + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(secs))};
+        auto next_frame {start};
+        auto next_ctrl {start};
+        int ctrl_seq {0};
+        while (clock_type::now() < stop_at) {
+            const auto now {clock_type::now()};
+            if (now >= next_frame) {
+                next_frame += frame_period;
+                feedFrame();
+                ++result.frames.num_sent;
+            }
+            if (now >= next_ctrl) {
+                next_ctrl += ctrl_period;
+                Net::CommonPkt pkt {};
+                pkt.cntrl.servo.horiz = ++ctrl_seq;
+                {
+                    std::lock_guard<std::mutex> lock{ctrl_mutex};
+                    ctrl_sent_at[static_cast<std::size_t>(ctrl_seq) % MAX_CTRL_SEQS] = nowTicks();
+                }
+                client.updatePkt(pkt);
+                ++result.ctrl.num_sent;
+            }
+            std::this_thread::sleep_until(std::min(next_frame, next_ctrl));
+        }
+        result.secs = std::chrono::duration<double>(clock_type::now() - start).count();
+        std::this_thread::sleep_for(DRAIN_TIME);
+
+        is_polling_measured.store(false);
+        while (!poller_cpu_done.load()) std::this_thread::sleep_for(POLL_PERIOD);
+        const double feeder_cpu_secs {cpuSecs(RUSAGE_THREAD) - feeder_cpu_start};
+        result.cpu_secs = cpuSecs(RUSAGE_SELF) - cpu_start - feeder_cpu_secs - poller_cpu_secs;
+        result.allocs   = num_allocs.load() - allocs_start;
+        result.ok       = true;
+    } else {
+        cerr << "ERROR: No frame made it to the client" << endl;
+    }
+
+    stop_polling.store(true);
+    poller.join();
+    client.setExitCode(true);
+    server.setExitCode(true);
+    client.cleanup();
+    server.cleanup();
+
+    std::lock_guard<std::mutex> lock{ctrl_mutex};
+    result.frames.num_recv  = result.frames.latency_ms.size();
+    result.ctrl.num_recv    = result.ctrl.latency_ms.size();
+    std::sort(result.frames.latency_ms.begin(), result.frames.latency_ms.end());
+    std::sort(result.ctrl.latency_ms.begin(), result.ctrl.latency_ms.end());
+    return result;
+}
+
+void printChannel(const std::string& name, const ChannelResult& channel, const double secs) {
+    cout << std::left << std::setw(10) << ("  " + name)
+         << std::right << std::fixed
+         << std::setw(8) << channel.num_sent
+         << std::setw(8) << channel.num_recv
+         << std::setw(10) << std::setprecision(1) << static_cast<double>(channel.num_recv) / secs
+         << std::setw(10) << std::setprecision(2) << static_cast<double>(channel.bytes_recv) / secs / 1e6
+         << std::setw(10) << std::setprecision(3) << Bench::percentile(channel.latency_ms, 50)
+         << std::setw(10) << Bench::percentile(channel.latency_ms, 99)
+         << std::setw(10) << Bench::percentile(channel.latency_ms, 99.9)
+         << std::setw(10) << (channel.latency_ms.empty() ? 0 : channel.latency_ms.back()) << endl;
+}
+
+} // end of anonymous namespace
+
+/**
+ * @brief Counts every heap allocation (the rest of the stack is untouched, it is just malloc underneath)
+ */
+void* operator new(std::size_t size) {
+    num_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+int main(int argc, char* argv[]) {
+    constexpr std::size_t max_frame_kb {RPI::Constants::Network::MAX_FRAME_MSG_SIZE / 1024};
+    double secs {5.0};
+    std::size_t frame_kb {100};
+    double frame_rate {25.0};
+    double ctrl_rate {50.0};
+    if (Bench::wantsHelp(argc, argv) || argc > 6
+        || (argc > 1 && !Bench::parseArg(argv[1], secs, 0.1))
+        || (argc > 2 && !Bench::parseArg(argv[2], frame_kb, 1, max_frame_kb))
+        || (argc > 3 && !Bench::parseArg(argv[3], frame_rate, 0.1))
+        || (argc > 4 && !Bench::parseArg(argv[4], ctrl_rate, 0.1))
+    ) {
+        return Bench::usage(argc, argv,
+            "[seconds per run (default=5)] [frame KB (default=100)] [frames/s (default=25)] "
+            "[control pkts/s (default=50)] [transport: tcp|udp|local|mux|all (default=all)]");
+    }
+    const std::size_t frame_size {frame_kb * 1024};
+    const std::string which {argc > 5 ? argv[5] : "all"};
+
+    const std::vector<std::pair<std::string, Net::Transport>> all_transports {
+        {"tcp",     Net::Transport::Tcp},
+        {"udp",     Net::Transport::Udp},
+        {"local",   Net::Transport::Local},
+        {"mux",     Net::Transport::Mux},
+    };
+    std::vector<std::pair<std::string, Net::Transport>> transports {};
+    for (const auto& transport : all_transports) {
+        if (which == "all" || which == transport.first) transports.push_back(transport);
+    }
+    if (transports.empty()) {
+        cerr << "ERROR: Unknown transport '" << which << "' (tcp|udp|local|mux|all)" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // the server & client print as they connect, so the results are printed once every run is done
+    std::vector<RunResult> results {};
+    for (std::size_t idx = 0; idx < transports.size(); ++idx) {
+        const int base_port {BASE_PORT + static_cast<int>(idx) * 3};
+        results.push_back(runTransport(transports[idx].second, base_port, secs, frame_size, frame_rate, ctrl_rate));
+    }
+
+    cout << endl << "Loopback benchmark: " << frame_size / 1024 << "KB frames @" << frame_rate << "/s, control pkts @"
+         << ctrl_rate << "/s, " << secs << "s per run (latency in ms)" << endl;
+    cout << std::left  << std::setw(10) << "transport"
+         << std::right << std::setw(8) << "sent"
+         << std::setw(8) << "recv"
+         << std::setw(10) << "msgs/s"
+         << std::setw(10) << "MB/s"
+         << std::setw(10) << "p50"
+         << std::setw(10) << "p99"
+         << std::setw(10) << "p999"
+         << std::setw(10) << "max" << endl;
+
+    for (std::size_t idx = 0; idx < transports.size(); ++idx) {
+        const RunResult& result {results[idx]};
+        cout << std::left << std::setw(10) << transports[idx].first;
+        if (!result.ok) {
+            cout << "  failed" << endl;
+            continue;
+        }
+
+        const double num_msgs {static_cast<double>(result.frames.num_recv + result.ctrl.num_recv)};
+        cout << std::fixed << std::setprecision(1) << "  net cpu " << result.cpu_secs * 1000.0 / result.secs << "ms/s, "
+             << std::setprecision(1) << (num_msgs > 0 ? result.cpu_secs * 1e6 / num_msgs : 0) << "us/msg, "
+             << (num_msgs > 0 ? static_cast<double>(result.allocs) / num_msgs : 0) << " allocs/msg" << endl;
+        printChannel("frames", result.frames, result.secs);
+        printChannel("control", result.ctrl, result.secs);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file pkt_codec_bench.cpp
+ * @brief Measures the per-packet encode/decode cost & size of each packet wire encoding
+ * @note Usage: ./bin/pkt_codec_bench [iterations (default=200000)]
+ */
+
+// Standard Includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <functional>
+
+// Our Includes
+#include "packet.h"
+#include "bench_helpers.hpp"
+
+using std::cout;
+using std::endl;
+using RPI::Network::Packet;
+using RPI::Network::CommonPkt;
+using RPI::Network::SrvDataPkt;
+using RPI::Network::PktEncoding;
+
+namespace {
+
+/**
+ * @brief Build a packet that changes every iteration (so nothing can be hoisted out of the timed loop)
+ * @param idx The iteration number
+ */
+CommonPkt makeCmnPkt(const std::size_t idx) {
+    CommonPkt pkt;
+    pkt.cntrl.led.red           = idx & 0x1;
+    pkt.cntrl.led.blue          = idx & 0x2;
+    pkt.cntrl.motor.forward     = idx & 0x4;
+    pkt.cntrl.motor.left        = idx & 0x8;
+    pkt.cntrl.servo.horiz       = static_cast<int>(idx % 7) - 3;
+    pkt.cntrl.servo.vert        = static_cast<int>(idx % 5) - 2;
+    pkt.ACK                     = true;
+    return pkt;
+}
+
+SrvDataPkt makeSrvPkt(const std::size_t idx) {
+    SrvDataPkt pkt;
+    pkt.ultrasonic.dist = static_cast<float>(idx % 400) + 0.25F;
+    pkt.ACK = false;
+    return pkt;
+}
+
+/**
+ * @brief Runs fn `iters` times and returns the average time per call in nanoseconds
+ */
+double timeNsPerOp(const std::size_t iters, const std::function<void(std::size_t)>& fn) {
+    const auto start {std::chrono::steady_clock::now()};
+    for (std::size_t idx = 0; idx < iters; ++idx) {
+        fn(idx);
+    }
+    const auto elapsed {std::chrono::steady_clock::now() - start};
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iters;
+}
+
+void printRow(const std::string& name, const std::size_t bytes, const double enc_ns, const double dec_ns) {
+    cout << std::left  << std::setw(22) << name
+         << std::right << std::setw(8)  << bytes
+         << std::setw(14) << std::fixed << std::setprecision(1) << enc_ns
+         << std::setw(14) << dec_ns << endl;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t iters {200000};
+    if (Bench::wantsHelp(argc, argv) || argc > 2 || (argc > 1 && !Bench::parseArg(argv[1], iters, 1))) {
+        return Bench::usage(argc, argv, "[iterations (default=200000)]");
+    }
+    const Packet pkt_handler;
+
+    // accumulate decoded values so the compiler cannot discard the decode calls
+    volatile std::size_t sink {0};
+
+    cout << "Packet codec benchmark (" << iters << " iterations)" << endl;
+    cout << std::left  << std::setw(22) << "codec"
+         << std::right << std::setw(8)  << "bytes"
+         << std::setw(14) << "encode ns/pkt"
+         << std::setw(14) << "decode ns/pkt" << endl;
+
+    for (const PktEncoding encoding : {PktEncoding::Bson, PktEncoding::Binary}) {
+        const std::string enc_name {encoding == PktEncoding::Bson ? "bson" : "binary"};
+
+        // common (control) packets
+        const std::string cmn_sample {pkt_handler.writePkt(makeCmnPkt(1), encoding)};
+        const double cmn_enc_ns {timeNsPerOp(iters, [&](std::size_t idx) {
+            sink = sink + pkt_handler.writePkt(makeCmnPkt(idx), encoding).size();
+        })};
+        const double cmn_dec_ns {timeNsPerOp(iters, [&](std::size_t) {
+            const CommonPkt pkt {pkt_handler.readCmnPkt(cmn_sample.data(), cmn_sample.size(), encoding)};
+            sink = sink + static_cast<std::size_t>(pkt.cntrl.servo.horiz);
+        })};
+        printRow("control (" + enc_name + ")", cmn_sample.size(), cmn_enc_ns, cmn_dec_ns);
+
+        // server data (sensor) packets
+        const std::string srv_sample {pkt_handler.writePkt(makeSrvPkt(1), encoding)};
+        const double srv_enc_ns {timeNsPerOp(iters, [&](std::size_t idx) {
+            sink = sink + pkt_handler.writePkt(makeSrvPkt(idx), encoding).size();
+        })};
+        const double srv_dec_ns {timeNsPerOp(iters, [&](std::size_t) {
+            const SrvDataPkt pkt {pkt_handler.readSrvPkt(srv_sample.data(), srv_sample.size(), encoding)};
+            sink = sink + static_cast<std::size_t>(pkt.ultrasonic.dist);
+        })};
+        printRow("server data (" + enc_name + ")", srv_sample.size(), srv_enc_ns, srv_dec_ns);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file sched_bench.cpp
+ * @brief Measures how long control pkts take to arrive while camera frames saturate a slow link, for a single
+ * connection sending in fifo order vs the mux transport's priority scheduler (MuxWriter) w/o & w/ its socket tuning
+ * (SO_PRIORITY, dscp & TCP_NOTSENT_LOWAT, see SockTuning)
+ * @note Usage: ./bin/sched_bench [seconds per run (default=5)] [link Mbit/s (default=20)] [frame KB (default=100)]
+ * A relay thread forwards the loopback connection at the link rate (token bucket), so the sender's queues fill up
+ * the same way they would on a slow wifi link. The sender always has a frame queued (full video load) & queues a
+ * 64 byte control pkt every 20ms; each one's latency is from when it was queued until it was fully received
+ */
+
+// Standard Includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>   // for memcpy
+#include <algorithm> // for std::sort & std::min
+#include <poll.h>
+#include <fcntl.h> // for O_NONBLOCK
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Our Includes
+#include "net_conn.h"
+#include "sock_tuning.h"
+#include "bench_helpers.hpp"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+namespace Net = RPI::Network;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+constexpr std::size_t               CTRL_SIZE       {64};
+constexpr std::chrono::milliseconds CTRL_PERIOD     {20};
+constexpr int                       LINK_RCVBUF     {32 * 1024}; // how much the "link" buffers (receiver's socket)
+
+enum class Mode {
+    Fifo,       // one connection, messages go out in the order they were queued (MsgWriter)
+    Mux,        // MuxWriter on an untuned socket (it stops handing the kernel fragments at MUX_NOTSENT_LOWAT itself)
+    MuxTuned,   // MuxWriter + SockTuning::tune() (the socket also only polls writable below that mark)
+};
+
+struct RunResult {
+    bool                ok          {false};
+    std::vector<double> ctrl_ms;            // latency of every control pkt received
+    double              video_mbps  {0};    // frame bytes received per second (Mbit/s)
+    double              unsent_kb   {0};    // avg bytes sitting unsent in the sender's kernel queue
+};
+
+Net::OutMsg makeMsg(const Net::Channel channel, std::shared_ptr<const std::vector<std::uint8_t>> data) {
+    Net::OutMsg msg {};
+    msg.header.total_length = static_cast<std::uint32_t>(data->size());
+    msg.header.channel      = static_cast<std::uint8_t>(channel);
+    msg.header.tos          = Net::channelPriority(channel);
+    msg.header.flags_fo     = Net::HeaderPkt_t::FLAG_NO_CHECKSUM;
+    msg.data                = data->data();
+    msg.size                = msg.header.total_length;
+    msg.keepalive           = std::move(data);
+    return msg;
+}
+
+/**
+ * @brief Queues a frame whenever the last one is handed off & a control pkt every CTRL_PERIOD until `stop_at`
+ * @param unsent_samples Filled w/ the kernel's unsent bytes (sampled every CTRL_PERIOD)
+ */
+void runSender(const int send_fd, const Mode mode, const std::size_t frame_size, const clock_type::time_point stop_at,
+               std::vector<std::size_t>& unsent_samples) {
+    const auto frame {std::make_shared<const std::vector<std::uint8_t>>(frame_size, 0xA5)};
+    Net::MsgWriter fifo_writer {};
+    std::deque<Net::OutMsg> fifo_queue {};
+    Net::MuxWriter mux_writer {};
+
+    auto next_ctrl {clock_type::now()};
+    while (clock_type::now() < stop_at) {
+        const auto now {clock_type::now()};
+        if (now >= next_ctrl) {
+            next_ctrl += CTRL_PERIOD;
+            unsent_samples.push_back(Net::SockTuning::getNotSentSize(send_fd));
+
+            // stamped w/ when it was queued (receiver is in the same process, so shares the clock)
+            auto ctrl_data {std::make_shared<std::vector<std::uint8_t>>(CTRL_SIZE, 0)};
+            const std::int64_t stamp {now.time_since_epoch().count()};
+            std::memcpy(ctrl_data->data(), &stamp, sizeof(stamp));
+            const Net::OutMsg ctrl {makeMsg(Net::Channel::Control, std::move(ctrl_data))};
+            if (mode == Mode::Fifo) {
+                fifo_queue.push_back(ctrl);
+            } else if (!mux_writer.isBusy(Net::Channel::Control)) {
+                mux_writer.start(ctrl);
+            }
+        }
+
+        Net::SendRtn sent {};
+        if (mode == Mode::Fifo) {
+            if (fifo_queue.empty()) fifo_queue.push_back(makeMsg(Net::Channel::Camera, frame));
+            if (!fifo_writer.isBusy()) {
+                fifo_writer.start(fifo_queue.front());
+                fifo_queue.pop_front();
+            }
+            sent = fifo_writer.writeSome(send_fd, nullptr);
+        } else {
+            if (!mux_writer.isBusy(Net::Channel::Camera)) mux_writer.start(makeMsg(Net::Channel::Camera, frame));
+            sent = mux_writer.writeSome(send_fd);
+        }
+
+        if (sent.RtnCode == Net::RecvSendRtnCodes::WouldBlock) {
+            // an untuned socket polls writable while MuxWriter waits for the kernel to drain, so just nap
+            if (mode == Mode::Mux
+                && Net::SockTuning::getNotSentSize(send_fd) >= RPI::Constants::Network::MUX_NOTSENT_LOWAT
+            ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            // wait for room, but wake up in time to queue the next control pkt
+            const auto wait {std::chrono::duration_cast<std::chrono::milliseconds>(next_ctrl - clock_type::now())};
+            pollfd pfd {send_fd, POLLOUT, 0};
+            ::poll(&pfd, 1, static_cast<int>(std::max<std::int64_t>(0, wait.count())) + 1);
+        } else if (sent.RtnCode != Net::RecvSendRtnCodes::Success) {
+            break;
+        }
+    }
+    ::shutdown(send_fd, SHUT_WR);
+}
+
+/**
+ * @brief Forwards everything from `in_fd` to `out_fd` at `bytes_per_sec` until `in_fd` closes
+ */
+void runLink(const int in_fd, const int out_fd, const double bytes_per_sec) {
+    constexpr std::size_t max_burst {16 * 1024};
+    std::vector<std::uint8_t> buf(max_burst);
+    double tokens {0};
+    auto last {clock_type::now()};
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto now {clock_type::now()};
+        tokens = std::min<double>(max_burst, tokens + bytes_per_sec * std::chrono::duration<double>(now - last).count());
+        last = now;
+        if (tokens < 1) continue;
+
+        const ssize_t rx_size {::recv(in_fd, buf.data(), static_cast<std::size_t>(tokens), MSG_DONTWAIT)};
+        if (rx_size == 0 || (rx_size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) break;
+        if (rx_size < 0) continue;
+        tokens -= static_cast<double>(rx_size);
+
+        for (ssize_t tx_total = 0; tx_total < rx_size;) {
+            const ssize_t tx_size {::send(out_fd, buf.data() + tx_total, static_cast<std::size_t>(rx_size - tx_total), 0)};
+            if (tx_size <= 0) return;
+            tx_total += tx_size;
+        }
+    }
+    ::shutdown(out_fd, SHUT_WR);
+}
+
+RunResult runMode(const Mode mode, const double secs, const double link_mbps, const std::size_t frame_size) {
+    RunResult result {};
+    int send_fd {-1};
+    int link_fd {-1};
+    int relay_fds[2] {-1, -1}; // link -> receiver
+    if (!Bench::connectPair(send_fd, link_fd, LINK_RCVBUF) || ::socketpair(AF_UNIX, SOCK_STREAM, 0, relay_fds) < 0) {
+        cerr << "ERROR: Failed to connect over loopback" << endl;
+        return result;
+    }
+    if (mode == Mode::MuxTuned && Net::SockTuning::tune(send_fd, Net::Channel::Control, true) != RPI::ReturnCodes::Success) {
+        cerr << "ERROR: Failed to tune the sender's socket" << endl;
+    }
+    ::fcntl(send_fd, F_SETFL, ::fcntl(send_fd, F_GETFL) | O_NONBLOCK);
+
+    const auto stop_at {clock_type::now() + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(secs))};
+    std::vector<std::size_t> unsent_samples {};
+    std::thread sender_thread {[&]() { runSender(send_fd, mode, frame_size, stop_at, unsent_samples); }};
+    std::thread link_thread {[&]() { runLink(link_fd, relay_fds[0], link_mbps * 1e6 / 8); }};
+
+    // receive on this thread (blocking, the relay closes its end once the sender is done)
+    Net::BufferPool ctrl_pool {RPI::Constants::Network::MAX_CTRL_MSG_SIZE};
+    Net::BufferPool cam_pool {RPI::Constants::Network::MAX_FRAME_MSG_SIZE};
+    const Net::MuxPools pools {&ctrl_pool, &cam_pool, nullptr};
+    Net::MsgReader fifo_reader {};
+    Net::MuxReader mux_reader {};
+    std::size_t frame_bytes {0};
+    const auto start {clock_type::now()};
+    while (true) {
+        const Net::RecvRtn msg {mode == Mode::Fifo ?
+            fifo_reader.readSome(relay_fds[1], cam_pool) :
+            mux_reader.readSome(relay_fds[1], pools)
+        };
+        if (msg.RtnCode != Net::RecvSendRtnCodes::Success) break;
+
+        // fifo framing has no channel on the wire, but control pkts are the only small ones
+        const bool is_ctrl {mode == Mode::Fifo ? msg.buf->size() == CTRL_SIZE :
+                            static_cast<Net::Channel>(msg.header.channel) == Net::Channel::Control};
+        if (is_ctrl) {
+            std::int64_t stamp {0};
+            std::memcpy(&stamp, msg.buf->data(), sizeof(stamp));
+            const clock_type::time_point queued_at {clock_type::duration(stamp)};
+            result.ctrl_ms.push_back(std::chrono::duration<double, std::milli>(clock_type::now() - queued_at).count());
+        } else {
+            frame_bytes += msg.buf->size();
+        }
+    }
+    const double elapsed {std::chrono::duration<double>(clock_type::now() - start).count()};
+
+    sender_thread.join();
+    link_thread.join();
+    for (const int fd : {send_fd, link_fd, relay_fds[0], relay_fds[1]}) ::close(fd);
+
+    std::size_t unsent_total {0};
+    for (const std::size_t unsent : unsent_samples) unsent_total += unsent;
+    result.unsent_kb    = unsent_samples.empty() ? 0 : static_cast<double>(unsent_total) / unsent_samples.size() / 1024.0;
+    result.video_mbps   = static_cast<double>(frame_bytes) * 8 / 1e6 / elapsed;
+    result.ok           = !result.ctrl_ms.empty();
+    std::sort(result.ctrl_ms.begin(), result.ctrl_ms.end());
+    return result;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+    constexpr std::size_t max_frame_kb {RPI::Constants::Network::MAX_FRAME_MSG_SIZE / 1024};
+    double secs {5.0};
+    double link_mbps {20.0};
+    std::size_t frame_kb {100};
+    if (Bench::wantsHelp(argc, argv) || argc > 4
+        || (argc > 1 && !Bench::parseArg(argv[1], secs, 0.1))
+        || (argc > 2 && !Bench::parseArg(argv[2], link_mbps, 0.1))
+        || (argc > 3 && !Bench::parseArg(argv[3], frame_kb, 1, max_frame_kb))
+    ) {
+        return Bench::usage(argc, argv,
+            "[seconds per run (default=5)] [link Mbit/s (default=20)] [frame KB (default=100)]");
+    }
+    const std::size_t frame_size {frame_kb * 1024};
+
+    const std::vector<std::pair<std::string, Mode>> modes {
+        {"fifo",        Mode::Fifo},
+        {"mux",         Mode::Mux},
+        {"mux+tuned",   Mode::MuxTuned},
+    };
+
+    cout << "Control latency under full video load: " << link_mbps << " Mbit/s link, "
+         << frame_size / 1024 << "KB frames, " << secs << "s per run" << endl;
+    cout << std::left  << std::setw(12) << "sender"
+         << std::right << std::setw(10) << "ctrl p50"
+         << std::setw(10) << "p99"
+         << std::setw(10) << "max"
+         << std::setw(14) << "video Mbit/s"
+         << std::setw(16) << "kernel unsent" << endl;
+
+    for (const auto& mode : modes) {
+        const RunResult result {runMode(mode.second, secs, link_mbps, frame_size)};
+        cout << std::left << std::setw(12) << mode.first;
+        if (!result.ok) {
+            cout << "  failed" << endl;
+            continue;
+        }
+        cout << std::right << std::fixed << std::setprecision(1)
+             << std::setw(8) << Bench::percentile(result.ctrl_ms, 50) << "ms"
+             << std::setw(8) << Bench::percentile(result.ctrl_ms, 99) << "ms"
+             << std::setw(8) << result.ctrl_ms.back() << "ms"
+             << std::setw(14) << result.video_mbps
+             << std::setw(14) << std::setprecision(0) << result.unsent_kb << "KB" << endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+#include "face_detector.h"
+
+#include <iostream>
+#include <chrono>
+#include <algorithm> // for std::min & std::max
+
+namespace RPI {
+
+namespace Camera {
+
+// for convenience
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+
+constexpr double    COST_ALPHA          {0.2};      // weight of the newest cost in the moving avg
+
+// files the detectors load when the config has no path for them (in the classifiers dir)
+const fs::path      HAAR_XML            {"haarcascade_frontalface.xml"};
+const fs::path      LBP_XML             {"lbpcascade_frontalface_improved.xml"};
+const fs::path      DNN_MODEL           {"res10_300x300_ssd_iter_140000_fp16.caffemodel"};
+const fs::path      DNN_CONFIG          {"deploy.prototxt"};
+
+// what the res10 ssd model was trained on
+const cv::Size      DNN_INPUT_SIZE      {300, 300};
+const cv::Scalar    DNN_MEAN            {104.0, 177.0, 123.0};
+
+fs::path pathOr(const fs::path& path, const fs::path& default_dir, const fs::path& default_file) {
+    return path.empty() ? default_dir / default_file : path;
+}
+
+} // end of anonymous namespace
+
+std::string getDetectorBackendName(const DetectorBackend backend) {
+    switch (backend) {
+        case DetectorBackend::Lbp:  return "lbp";
+        case DetectorBackend::Haar: return "haar";
+        case DetectorBackend::Dnn:
+        default:                    return "dnn";
+    }
+}
+
+/****************************************************** FaceDetector *****************************************************/
+
+FaceDetector::FaceDetector(const DetectorBackend backend, const fs::path& model_path)
+    : backend{backend}
+    , model_path{model_path}
+    , cost_ms{0}
+{
+    // stub
+}
+
+FaceDetector::~FaceDetector() {
+    // stub
+}
+
+DetectorBackend FaceDetector::getBackend() const {
+    return backend;
+}
+
+const fs::path& FaceDetector::getModelPath() const {
+    return model_path;
+}
+
+double FaceDetector::getCostMs() const {
+    return cost_ms.load(std::memory_order_relaxed);
+}
+
+void FaceDetector::resetCost() {
+    cost_ms.store(0, std::memory_order_relaxed);
+}
+
+void FaceDetector::detect(const cv::Mat& img, const cv::Mat& gray_img, std::vector<cv::Rect>& faces) {
+    const auto start {std::chrono::steady_clock::now()};
+    runDetect(img, gray_img, faces);
+    const double elapsed_ms {
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+    };
+
+    const double prev {getCostMs()};
+    cost_ms.store(prev <= 0 ? elapsed_ms : prev + COST_ALPHA * (elapsed_ms - prev), std::memory_order_relaxed);
+}
+
+/**************************************************** CascadeDetector ****************************************************/
+
+CascadeDetector::CascadeDetector(const DetectorBackend backend, const fs::path& xml_path)
+    : FaceDetector{backend, xml_path}
+    , classifier{}
+{
+    // stub
+}
+
+CascadeDetector::~CascadeDetector() {
+    // stub
+}
+
+ReturnCodes CascadeDetector::load() {
+    return classifier.load(getModelPath().string()) ? ReturnCodes::Success : ReturnCodes::Error;
+}
+
+void CascadeDetector::runDetect(const cv::Mat&, const cv::Mat& gray_img, std::vector<cv::Rect>& faces) {
+    // detect faces of different sizes using cascade classifier
+    classifier.detectMultiScale(gray_img, faces, 1.3, 5);
+}
+
+/****************************************************** DnnDetector ******************************************************/
+
+DnnDetector::DnnDetector(const fs::path& model_path, const fs::path& config_path)
+    : FaceDetector{DetectorBackend::Dnn, model_path}
+    , config_path{config_path}
+    , net{}
+{
+    // stub
+}
+
+DnnDetector::~DnnDetector() {
+    // stub
+}
+
+ReturnCodes DnnDetector::load() {
+    try {
+        net = cv::dnn::readNet(getModelPath().string(), config_path.string());
+    } catch (const cv::Exception& err) {
+        cerr << "Error: Failed to read dnn face model: " << err.what() << endl;
+        return ReturnCodes::Error;
+    }
+    if (net.empty()) return ReturnCodes::Error;
+    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+
+    // the first forward pass sets the net up (much slower than the rest), keep it out of the measured cost
+    net.setInput(cv::dnn::blobFromImage(cv::Mat{DNN_INPUT_SIZE, CV_8UC3, cv::Scalar{}}, 1.0, DNN_INPUT_SIZE, DNN_MEAN));
+    net.forward();
+    return ReturnCodes::Success;
+}
+
+void DnnDetector::runDetect(const cv::Mat& img, const cv::Mat&, std::vector<cv::Rect>& faces) {
+    net.setInput(cv::dnn::blobFromImage(img, 1.0, DNN_INPUT_SIZE, DNN_MEAN));
+    cv::Mat out {net.forward()};
+
+    // [1, 1, detections, 7]: each is (img id, label, confidence, left, top, right, bottom) w/ the corners
+    // as fractions of the frame
+    const cv::Mat detections {out.size[2], out.size[3], CV_32F, out.ptr<float>()};
+    faces.clear();
+    for (int row = 0; row < detections.rows; ++row) {
+        const float* detection {detections.ptr<float>(row)};
+        if (detection[2] < Constants::Camera::DNN_MIN_CONFIDENCE) continue;
+
+        // the corners can land outside the frame, keep the part inside
+        const int left      {std::max(static_cast<int>(detection[3] * img.cols), 0)};
+        const int top       {std::max(static_cast<int>(detection[4] * img.rows), 0)};
+        const int right     {std::min(static_cast<int>(detection[5] * img.cols), img.cols)};
+        const int bottom    {std::min(static_cast<int>(detection[6] * img.rows), img.rows)};
+        if (right <= left || bottom <= top) continue;
+        faces.emplace_back(left, top, right - left, bottom - top);
+    }
+}
+
+/***************************************************** FaceDetectors *****************************************************/
+
+FaceDetectors::FaceDetectors()
+    : detectors{}
+    , active{0}
+{
+    // stub
+}
+
+FaceDetectors::~FaceDetectors() {
+    // stub
+}
+
+bool FaceDetectors::empty() const {
+    return detectors.empty();
+}
+
+FaceDetector& FaceDetectors::getActive() {
+    return *detectors[active.load(std::memory_order_relaxed)];
+}
+
+const FaceDetector& FaceDetectors::getActive() const {
+    return *detectors[active.load(std::memory_order_relaxed)];
+}
+
+bool FaceDetectors::isActiveCheapest() const {
+    return active.load(std::memory_order_relaxed) == 0;
+}
+
+void FaceDetectors::resetCosts() {
+    for (auto& detector : detectors) {
+        detector->resetCost();
+    }
+}
+
+ReturnCodes FaceDetectors::load(const DetectorConfig& config, const fs::path& default_dir, const bool is_verbose) {
+    const bool is_auto {config.backend == "auto"};
+    detectors.clear();
+    for (std::size_t idx = 0; idx < NUM_DETECTOR_BACKENDS; ++idx) {
+        const DetectorBackend backend {static_cast<DetectorBackend>(idx)};
+        const std::string name {getDetectorBackendName(backend)};
+        if (!is_auto && config.backend != name) continue;
+
+        std::unique_ptr<FaceDetector> detector {};
+        switch (backend) {
+            case DetectorBackend::Lbp:
+                detector = std::make_unique<CascadeDetector>(backend, pathOr(config.lbp_xml, default_dir, LBP_XML));
+                break;
+            case DetectorBackend::Haar:
+                detector = std::make_unique<CascadeDetector>(backend, pathOr(config.haar_xml, default_dir, HAAR_XML));
+                break;
+            case DetectorBackend::Dnn:
+            default:
+                detector = std::make_unique<DnnDetector>(
+                    pathOr(config.dnn_model, default_dir, DNN_MODEL),
+                    pathOr(config.dnn_config, default_dir, DNN_CONFIG)
+                );
+                break;
+        }
+
+        // w/ auto, backends whose files are not there are just not used (only haar's ships w/ the repo)
+        if (is_auto && !fs::exists(detector->getModelPath())) {
+            if (is_verbose) cout << "face detector " << name << ": " << detector->getModelPath() << " not found, skipping" << endl;
+            continue;
+        }
+        if (detector->load() != ReturnCodes::Success) {
+            cerr << "Error: Failed to load " << name << " face detector: " << detector->getModelPath() << endl;
+            continue;
+        }
+        if (is_verbose) cout << "face detector " << name << ": " << detector->getModelPath() << " (loaded)" << endl;
+        detectors.push_back(std::move(detector));
+    }
+
+    if (detectors.empty()) {
+        cerr << "Error: No face detector could be loaded (--detector " << config.backend << ")" << endl;
+        return ReturnCodes::Error;
+    }
+
+    // the most accurate one goes first, pick() drops it once it is measured over budget
+    active.store(detectors.size() - 1, std::memory_order_relaxed);
+    return ReturnCodes::Success;
+}
+
+bool FaceDetectors::pick(const double budget_ms) {
+    std::size_t best {0};
+    for (std::size_t idx = 0; idx < detectors.size(); ++idx) {
+        const double cost_ms {detectors[idx]->getCostMs()};
+        if (cost_ms <= 0 || cost_ms <= budget_ms) best = idx;
+    }
+    if (best == active.load(std::memory_order_relaxed)) return false;
+    active.store(best, std::memory_order_relaxed);
+    return true;
+}
+
+}; // end of Camera namespace
+
+}; // end of RPI namespace
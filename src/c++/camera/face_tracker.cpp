@@ -0,0 +1,212 @@
+#include "face_tracker.h"
+
+#include <algorithm> // for std::clamp & std::max
+#include <chrono>
+#include <cmath> // for std::ceil
+#include <utility> // for std::swap
+
+namespace RPI {
+
+namespace Camera {
+
+namespace {
+
+const cv::Size      MOTION_SIZE         {80, 60};   // frames are compared for motion at this size
+constexpr double    COST_ALPHA          {0.2};      // weight of the newest cost in the moving averages
+constexpr double    SCALE_STEP          {0.75};     // scale is lowered/raised by this factor at a time
+constexpr std::size_t SCALE_SETTLE      {8};        // detections at a scale before it can change again
+
+double elapsedMs(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Moving average of a cost (the first sample is taken as is)
+ */
+void addCost(std::atomic<double>& avg, const double cost_ms) {
+    const double prev {avg.load(std::memory_order_relaxed)};
+    avg.store(prev <= 0 ? cost_ms : prev + COST_ALPHA * (cost_ms - prev), std::memory_order_relaxed);
+}
+
+} // end of anonymous namespace
+
+/********************************************** Constructors **********************************************/
+
+FaceTracker::FaceTracker(const double budget_ms)
+    : budget_ms{budget_ms}
+    , tracks{}
+    , since_detect{0}
+    , small_img{}
+    , gray_img{}
+    , motion_img{}
+    , motion_ref{}
+    , match_result{}
+    , detects_at_scale{0}
+    , interval{1}                                       // detect every frame until the costs are known
+    , scale{Constants::Camera::DETECT_MAX_SCALE}
+    , detect_cost_ms{0}
+    , track_cost_ms{0}
+{
+    // stub
+}
+
+FaceTracker::~FaceTracker() {
+    // stub
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+std::size_t FaceTracker::getInterval() const {
+    return interval.load(std::memory_order_relaxed);
+}
+
+double FaceTracker::getScale() const {
+    return scale.load(std::memory_order_relaxed);
+}
+
+double FaceTracker::getDetectCostMs() const {
+    return detect_cost_ms.load(std::memory_order_relaxed);
+}
+
+double FaceTracker::getTrackCostMs() const {
+    return track_cost_ms.load(std::memory_order_relaxed);
+}
+
+/******************************************** Tracking Functions *******************************************/
+
+bool FaceTracker::update(const cv::Mat& img, FaceDetectors& detectors, std::vector<cv::Rect>& faces) {
+    const auto start {std::chrono::steady_clock::now()};
+    const double curr_scale {getScale()};
+
+    // everything below works on the scaled down frame (tracking on its gray version)
+    if (curr_scale < 1.0) {
+        cv::resize(img, small_img, cv::Size{}, curr_scale, curr_scale, cv::INTER_AREA);
+    } else {
+        small_img = img;
+    }
+    cv::cvtColor(small_img, gray_img, cv::COLOR_BGR2GRAY);
+
+    // the detector runs when it is due, when the scene jumped (tracks would not follow it) or when a track was lost
+    ++since_detect;
+    const bool moved {hasMotion()}; // every frame, it is compared to the one before
+    const bool run_detector {moved || since_detect >= getInterval() || !track()};
+    if (run_detector) {
+        detect(detectors.getActive());
+        since_detect = 0;
+        addCost(detect_cost_ms, elapsedMs(start));
+    } else {
+        addCost(track_cost_ms, elapsedMs(start));
+    }
+
+    // back to the frame's coordinates
+    faces.clear();
+    for (const Track& face : tracks) {
+        faces.emplace_back(
+            static_cast<int>(face.box.x / curr_scale),
+            static_cast<int>(face.box.y / curr_scale),
+            static_cast<int>(face.box.width / curr_scale),
+            static_cast<int>(face.box.height / curr_scale)
+        );
+    }
+
+    // may change the scale (& drop the tracks), so only after they were handed out
+    if (run_detector) adapt(detectors);
+    return run_detector;
+}
+
+/********************************************* Helper Functions ********************************************/
+
+bool FaceTracker::hasMotion() {
+    // compared to the previous frame: a face moving is for the tracker, a cut/pan moves everything at once
+    std::swap(motion_img, motion_ref);
+    cv::resize(gray_img, motion_img, MOTION_SIZE, 0, 0, cv::INTER_AREA);
+    if (motion_ref.empty()) return true;
+    const double mean_diff {cv::norm(motion_img, motion_ref, cv::NORM_L1) / MOTION_SIZE.area()};
+    return mean_diff > Constants::Camera::DETECT_MOTION_DIFF;
+}
+
+void FaceTracker::detect(FaceDetector& detector) {
+    std::vector<cv::Rect> found {};
+    detector.detect(small_img, gray_img, found);
+
+    tracks.clear();
+    for (const cv::Rect& box : found) {
+        tracks.push_back(Track{box, gray_img(box).clone()});
+    }
+}
+
+bool FaceTracker::track() {
+    const cv::Rect frame_rect {0, 0, gray_img.cols, gray_img.rows};
+    for (Track& face : tracks) {
+        // search around where it was, by half its size each way
+        const cv::Rect search {
+            cv::Rect{
+                face.box.x - face.box.width / 2,
+                face.box.y - face.box.height / 2,
+                face.box.width * 2,
+                face.box.height * 2
+            } & frame_rect
+        };
+        if (search.width < face.templ.cols || search.height < face.templ.rows) return false;
+
+        cv::matchTemplate(gray_img(search), face.templ, match_result, cv::TM_CCOEFF_NORMED);
+        double best_score {0};
+        cv::Point best_loc {};
+        cv::minMaxLoc(match_result, nullptr, &best_score, nullptr, &best_loc);
+        if (best_score < Constants::Camera::TRACK_MIN_SCORE) return false;
+
+        face.box.x = search.x + best_loc.x;
+        face.box.y = search.y + best_loc.y;
+    }
+    return true;
+}
+
+void FaceTracker::adapt(FaceDetectors& detectors) {
+    using Constants::Camera::DETECT_MAX_INTERVAL;
+    using Constants::Camera::DETECT_MAX_SCALE;
+    using Constants::Camera::DETECT_MIN_SCALE;
+
+    // the most accurate detector that fits comes first, the interval & scale only make up for the rest
+    // (the stage's detection cost was the old detector's)
+    if (detectors.pick(budget_ms)) {
+        detect_cost_ms.store(0, std::memory_order_relaxed);
+        return;
+    }
+
+    // a detection & (interval - 1) tracked frames should average under the budget:
+    // (detect + (n - 1) * track) / n <= budget  ->  n >= (detect - track) / (budget - track)
+    const double detect_ms {getDetectCostMs()};
+    const double track_ms {getTrackCostMs()};
+    std::size_t new_interval {DETECT_MAX_INTERVAL};
+    if (detect_ms <= budget_ms) {
+        new_interval = 1;
+    } else if (track_ms < budget_ms) {
+        const double needed {std::ceil((detect_ms - track_ms) / (budget_ms - track_ms))};
+        new_interval = static_cast<std::size_t>(std::clamp<double>(needed, 1, DETECT_MAX_INTERVAL));
+    }
+    interval.store(new_interval, std::memory_order_relaxed);
+
+    // the scale only changes once the costs at the current one have settled
+    if (++detects_at_scale < SCALE_SETTLE) return;
+    const double curr_scale {getScale()};
+    const double avg_ms {(detect_ms + (new_interval - 1) * track_ms) / new_interval};
+    double new_scale {curr_scale};
+    if (new_interval >= DETECT_MAX_INTERVAL && avg_ms > budget_ms && detectors.isActiveCheapest()) {
+        new_scale = std::max(curr_scale * SCALE_STEP, DETECT_MIN_SCALE);
+    } else if (new_interval == 1 && detect_ms < budget_ms / 2) {
+        new_scale = std::min(curr_scale / SCALE_STEP, DETECT_MAX_SCALE);
+    }
+    if (new_scale == curr_scale) return;
+
+    // the tracks are in the old scale's coordinates & the detectors' costs were for its frame size, start over
+    scale.store(new_scale, std::memory_order_relaxed);
+    detects_at_scale = 0;
+    tracks.clear();
+    detectors.resetCosts();
+    detect_cost_ms.store(0, std::memory_order_relaxed);
+    track_cost_ms.store(0, std::memory_order_relaxed);
+}
+
+}; // end of Camera namespace
+
+}; // end of RPI namespace
@@ -0,0 +1,333 @@
+#include "jpeg_encoder.h"
+
+#include <iostream>
+#include <algorithm> // for std::min & std::max
+#include <cstdio> // jpeglib.h needs FILE & size_t declared first
+#include <csetjmp> // libjpeg reports errors by longjmp-ing out of it
+
+#include <jpeglib.h>
+
+namespace RPI {
+
+namespace Camera {
+
+// for convenience
+using std::cerr;
+using std::endl;
+
+namespace {
+
+// jpeg_set_defaults() subsamples the chroma 2x2, so a MCU covers 16x16 pixels (strips are whole MCU rows)
+constexpr int           MCU_SIZE            {16};
+constexpr unsigned int  MAX_RESTART         {65535};    // the DRI marker's field is 16 bits
+constexpr std::size_t   MIN_STRIP_BUF       {64 * 1024};
+constexpr int           ROWS_PER_WRITE      {MCU_SIZE};  // scanlines handed to libjpeg at a time
+
+// jpeg markers (the byte after 0xFF)
+constexpr std::uint8_t  MARKER_SOI          {0xD8};
+constexpr std::uint8_t  MARKER_EOI          {0xD9};
+constexpr std::uint8_t  MARKER_SOF0         {0xC0};
+constexpr std::uint8_t  MARKER_SOS          {0xDA};
+constexpr std::uint8_t  MARKER_RST0         {0xD0};
+
+// where a strip's jpeg splits into headers & entropy coded data
+struct StripLayout {
+    std::size_t     sof_pos     {0};    // the SOF0 marker (its height is patched to the frame's)
+    std::size_t     data_pos    {0};    // first byte after the SOS header
+    std::size_t     data_end    {0};    // the EOI marker
+};
+
+/**
+ * @brief Find the SOF0 & SOS markers & EOI of a jpeg written by libjpeg
+ * @return false if it does not look like one
+ */
+bool parseStrip(const unsigned char* jpeg, const std::size_t size, StripLayout& layout) {
+    if (size < 4 || jpeg[0] != 0xFF || jpeg[1] != MARKER_SOI) return false;
+    if (jpeg[size - 2] != 0xFF || jpeg[size - 1] != MARKER_EOI) return false;
+
+    // every marker segment before the scan is 0xFF, marker, 16 bit length (which counts itself)
+    std::size_t pos {2};
+    bool found_sof {false};
+    while (pos + 4 <= size && jpeg[pos] == 0xFF) {
+        const std::uint8_t marker {jpeg[pos + 1]};
+        const std::size_t length {static_cast<std::size_t>(jpeg[pos + 2]) << 8 | jpeg[pos + 3]};
+        if (marker == MARKER_SOF0) {
+            layout.sof_pos = pos;
+            found_sof = true;
+        }
+        pos += 2 + length;
+        if (marker == MARKER_SOS) {
+            layout.data_pos = pos;
+            layout.data_end = size - 2;
+            return found_sof && layout.data_pos <= layout.data_end;
+        }
+    }
+    return false;
+}
+
+} // end of anonymous namespace
+
+/********************************************** Strip **********************************************/
+
+struct JpegEncoder::Strip {
+    // libjpeg calls error_exit() on any error (& would exit() by default), this longjmps back to Encode()
+    struct ErrorMgr {
+        jpeg_error_mgr      pub;
+        std::jmp_buf        jump;
+    };
+
+    jpeg_compress_struct        cinfo;
+    ErrorMgr                    err;
+    jpeg_destination_mgr        dest;
+    std::vector<unsigned char>  buf;        // the strip's jpeg (grows as needed, kept between frames)
+    std::size_t                 size;       // bytes of buf used by the last frame
+    int                         first_row;  // of the frame
+    int                         num_rows;
+    bool                        is_ok;      // the last frame's strip was encoded
+
+    Strip()
+        : cinfo{}
+        , err{}
+        , dest{}
+        , buf(MIN_STRIP_BUF)
+        , size{0}
+        , first_row{0}
+        , num_rows{0}
+        , is_ok{false}
+    {
+        cinfo.err = jpeg_std_error(&err.pub);
+        err.pub.error_exit = [](j_common_ptr info) {
+            std::longjmp(reinterpret_cast<ErrorMgr*>(info->err)->jump, 1);
+        };
+        jpeg_create_compress(&cinfo);
+        cinfo.client_data = this;
+
+        // compressed data goes straight into buf, which doubles when libjpeg fills it
+        dest.init_destination = [](j_compress_ptr info) {
+            Strip& strip {*static_cast<Strip*>(info->client_data)};
+            info->dest->next_output_byte    = strip.buf.data();
+            info->dest->free_in_buffer      = strip.buf.size();
+        };
+        dest.empty_output_buffer = [](j_compress_ptr info) -> boolean {
+            // called w/ the whole buffer full (free_in_buffer is not to be trusted here)
+            Strip& strip {*static_cast<Strip*>(info->client_data)};
+            const std::size_t used {strip.buf.size()};
+            strip.buf.resize(used * 2);
+            info->dest->next_output_byte    = strip.buf.data() + used;
+            info->dest->free_in_buffer      = strip.buf.size() - used;
+            return TRUE;
+        };
+        dest.term_destination = [](j_compress_ptr info) {
+            Strip& strip {*static_cast<Strip*>(info->client_data)};
+            strip.size = strip.buf.size() - info->dest->free_in_buffer;
+        };
+        cinfo.dest = &dest;
+    }
+
+    ~Strip() {
+        jpeg_destroy_compress(&cinfo);
+    }
+
+    Strip(const Strip&) = delete;
+    Strip& operator=(const Strip&) = delete;
+
+    /**
+     * @brief Encode rows [first_row, first_row + num_rows) of the frame as a jpeg of their own
+     * @note Only trivially destructible locals between the setjmp & libjpeg (it may longjmp over them)
+     */
+    bool Encode(const cv::Mat& img, const int quality, const unsigned int restart_interval) {
+        if (setjmp(err.jump)) {
+            jpeg_abort_compress(&cinfo);
+            return false;
+        }
+
+        cinfo.image_width       = static_cast<JDIMENSION>(img.cols);
+        cinfo.image_height      = static_cast<JDIMENSION>(num_rows);
+        cinfo.input_components  = 3;
+        cinfo.in_color_space    = JCS_EXT_BGR;      // opencv's order, no conversion pass
+        jpeg_set_defaults(&cinfo);
+        jpeg_set_quality(&cinfo, quality, TRUE);
+        cinfo.optimize_coding   = FALSE;            // every strip has to use the same (standard) huffman tables
+        cinfo.restart_interval  = restart_interval; // the whole strip is one interval, so the DRI marker matches
+        cinfo.dct_method        = JDCT_ISLOW;
+
+        jpeg_start_compress(&cinfo, TRUE);
+        JSAMPROW rows[ROWS_PER_WRITE];
+        while (cinfo.next_scanline < cinfo.image_height) {
+            const int batch {std::min<int>(ROWS_PER_WRITE, num_rows - static_cast<int>(cinfo.next_scanline))};
+            for (int row = 0; row < batch; ++row) {
+                // libjpeg only reads the rows (its api is just not const)
+                rows[row] = const_cast<JSAMPROW>(img.ptr<unsigned char>(first_row + static_cast<int>(cinfo.next_scanline) + row));
+            }
+            jpeg_write_scanlines(&cinfo, rows, static_cast<JDIMENSION>(batch));
+        }
+        jpeg_finish_compress(&cinfo);
+        return true;
+    }
+};
+
+/********************************************** Constructors **********************************************/
+
+JpegEncoder::JpegEncoder(const std::size_t num_strips)
+    : strips{}
+    , workers{}
+    , job_mutex{}
+    , job_cv{}
+    , done_cv{}
+    , job_gen{0}
+    , num_active{0}
+    , num_pending{0}
+    , job_img{nullptr}
+    , job_quality{0}
+    , job_restart{0}
+    , should_exit{false}
+{
+    for (std::size_t idx = 0; idx < std::max<std::size_t>(num_strips, 1); ++idx) {
+        strips.push_back(std::make_unique<Strip>());
+    }
+    for (std::size_t idx = 1; idx < strips.size(); ++idx) {
+        workers.emplace_back(&JpegEncoder::RunWorker, this, idx);
+    }
+}
+
+JpegEncoder::~JpegEncoder() {
+    {
+        std::lock_guard<std::mutex> lock {job_mutex};
+        should_exit = true;
+    }
+    job_cv.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+std::size_t JpegEncoder::getNumStrips() const {
+    return strips.size();
+}
+
+/******************************************** Encoding Functions *******************************************/
+
+ReturnCodes JpegEncoder::encode(const cv::Mat& img, const int quality, std::vector<unsigned char>& out) {
+    if (img.type() != CV_8UC3 || img.empty()) {
+        cerr << "Error: Jpeg encoder only takes 8 bit BGR frames" << endl;
+        return ReturnCodes::Error;
+    }
+
+    // as many strips as there are threads, in whole MCU rows (a small frame gets fewer)
+    const int mcu_rows              {(img.rows + MCU_SIZE - 1) / MCU_SIZE};
+    const int mcu_cols              {(img.cols + MCU_SIZE - 1) / MCU_SIZE};
+    int mcu_rows_per_strip          {(mcu_rows + static_cast<int>(strips.size()) - 1) / static_cast<int>(strips.size())};
+    if (static_cast<unsigned int>(mcu_rows_per_strip * mcu_cols) > MAX_RESTART) {
+        mcu_rows_per_strip = mcu_rows; // too wide for a restart interval per strip, encode it whole
+    }
+    const int rows_per_strip        {mcu_rows_per_strip * MCU_SIZE};
+    const std::size_t active        {static_cast<std::size_t>((img.rows + rows_per_strip - 1) / rows_per_strip)};
+
+    for (std::size_t idx = 0; idx < active; ++idx) {
+        Strip& strip {*strips[idx]};
+        strip.first_row = static_cast<int>(idx) * rows_per_strip;
+        strip.num_rows  = std::min(rows_per_strip, img.rows - strip.first_row);
+        strip.is_ok     = false;
+    }
+    const unsigned int restart {active > 1 ? static_cast<unsigned int>(mcu_rows_per_strip * mcu_cols) : 0};
+
+    // hand the other strips to the workers & encode the first one here
+    {
+        std::lock_guard<std::mutex> lock {job_mutex};
+        job_img         = &img;
+        job_quality     = std::clamp(quality, 1, 100);
+        job_restart     = restart;
+        num_active      = active;
+        num_pending     = active - 1;
+        ++job_gen;
+    }
+    if (active > 1) job_cv.notify_all();
+    strips[0]->is_ok = strips[0]->Encode(img, std::clamp(quality, 1, 100), restart);
+
+    {
+        std::unique_lock<std::mutex> lock {job_mutex};
+        done_cv.wait(lock, [this]() { return num_pending == 0; });
+        job_img = nullptr;
+    }
+
+    for (std::size_t idx = 0; idx < active; ++idx) {
+        if (!strips[idx]->is_ok) {
+            cerr << "Error: Failed to jpeg encode strip " << idx << " of the frame" << endl;
+            return ReturnCodes::Error;
+        }
+    }
+    return Stitch(out, img.rows);
+}
+
+/********************************************* Helper Functions ********************************************/
+
+void JpegEncoder::RunWorker(const std::size_t strip_idx) {
+    std::uint64_t seen_gen {0};
+    while (true) {
+        std::unique_lock<std::mutex> lock {job_mutex};
+        job_cv.wait(lock, [&]() { return should_exit || job_gen != seen_gen; });
+        if (should_exit) return;
+        seen_gen = job_gen;
+        if (strip_idx >= num_active) continue; // the frame has fewer strips than threads
+
+        const cv::Mat& img {*job_img};
+        const int quality {job_quality};
+        const unsigned int restart {job_restart};
+        lock.unlock();
+
+        Strip& strip {*strips[strip_idx]};
+        strip.is_ok = strip.Encode(img, quality, restart);
+
+        lock.lock();
+        if (--num_pending == 0) {
+            lock.unlock();
+            done_cv.notify_one();
+        }
+    }
+}
+
+ReturnCodes JpegEncoder::Stitch(std::vector<unsigned char>& out, const int height) const {
+    // the first strip's headers (w/ the frame's height) + every strip's data, a restart marker between each
+    std::size_t total {2};
+    StripLayout first {};
+    for (std::size_t idx = 0; idx < num_active; ++idx) {
+        const Strip& strip {*strips[idx]};
+        StripLayout layout {};
+        if (!parseStrip(strip.buf.data(), strip.size, layout)) {
+            cerr << "Error: Failed to parse the jpeg of strip " << idx << " of the frame" << endl;
+            return ReturnCodes::Error;
+        }
+        if (idx == 0) {
+            first = layout;
+            total += layout.data_pos;
+        }
+        total += layout.data_end - layout.data_pos + 2;
+    }
+
+    out.clear();
+    out.reserve(total);
+    const Strip& first_strip {*strips[0]};
+    out.insert(out.end(), first_strip.buf.data(), first_strip.buf.data() + first.data_end);
+
+    // SOF0 is 0xFF 0xC0, length (2), precision (1), height (2), ...
+    out[first.sof_pos + 5] = static_cast<unsigned char>((height >> 8) & 0xFF);
+    out[first.sof_pos + 6] = static_cast<unsigned char>(height & 0xFF);
+
+    for (std::size_t idx = 1; idx < num_active; ++idx) {
+        const Strip& strip {*strips[idx]};
+        StripLayout layout {};
+        parseStrip(strip.buf.data(), strip.size, layout);
+        out.push_back(0xFF);
+        out.push_back(static_cast<unsigned char>(MARKER_RST0 + ((idx - 1) & 0x7)));
+        out.insert(out.end(), strip.buf.data() + layout.data_pos, strip.buf.data() + layout.data_end);
+    }
+    out.push_back(0xFF);
+    out.push_back(MARKER_EOI);
+    return ReturnCodes::Success;
+}
+
+}; // end of Camera namespace
+
+}; // end of RPI namespace
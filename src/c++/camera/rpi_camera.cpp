@@ -1,5 +1,8 @@
 #include "rpi_camera.h"
 
+#include <sstream> // for the pipeline stats line
+#include <iomanip> // for std::setprecision
+
 namespace RPI {
 
 namespace Camera {
@@ -14,6 +17,32 @@ using std::endl;
 const fs::path CURR_DIR                 {fs::path{__FILE__}.parent_path()};
 const fs::path classifiers_dir          {CURR_DIR / "classifiers"};
 
+namespace {
+
+/**
+ * @brief Get an image no later stage holds anymore to retrieve the next frame into
+ * (retrieving into one still in the pipeline would overwrite it), a new one if they are all in use
+ */
+cv::Mat& getFreeImage(std::vector<cv::Mat>& images) {
+    for (cv::Mat& image : images) {
+        if (image.empty() || (image.u != nullptr && image.u->refcount == 1)) return image;
+    }
+    images.emplace_back();
+    return images.back();
+}
+
+} // end of anonymous namespace
+
+std::string getPipelineStageName(const PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Capture:    return "capture";
+        case PipelineStage::Detect:     return "detect";
+        case PipelineStage::Overlay:    return "overlay";
+        case PipelineStage::Encode:
+        default:                        return "encode";
+    }
+}
+
 /********************************************** Constructors **********************************************/
 
 CamHandler::CamHandler(
@@ -21,7 +50,8 @@ CamHandler::CamHandler(
     const int max_frame_count,
     const bool should_init,
     const std::string face_xml,
-    const std::string eye_xml
+    const std::string eye_xml,
+    const DetectorConfig& detector_config
 )
     : raspicam::RaspiCam_Cv{}
     , is_init{false}
@@ -30,15 +60,22 @@ CamHandler::CamHandler(
     , max_frames{max_frame_count}       // defaults to infinite = -1
     , stop_thread{false}
     , should_record{false}
-    , facial_classifier{std::pair{
-        face_xml != ""  ? fs::path{face_xml} : fs::path{classifiers_dir / "haarcascade_frontalface.xml"},
-        cv::CascadeClassifier{}
-    }}
     , eye_classifier{std::pair{
         eye_xml != "" ?  fs::path{eye_xml} : fs::path{classifiers_dir / "haarcascade_eye_tree_eyeglasses.xml"},
         cv::CascadeClassifier{}
     }}
+    , detector_config{detector_config}
+    , face_detectors{}
+    , face_tracker{detector_config.budget_ms}
+    , detect_queue{Constants::Camera::STAGE_QUEUE_DEPTH}
+    , overlay_queue{Constants::Camera::STAGE_QUEUE_DEPTH}
+    , encode_queue{Constants::Camera::STAGE_QUEUE_DEPTH}
+    , stage_counters{}
 {
+    if (!face_xml.empty()) {
+        this->detector_config.haar_xml = fs::path{face_xml};
+    }
+
     if (should_init) {
         if(SetupCam() != ReturnCodes::Success) {
             cerr << "Error: Failed to setup raspicam" << endl;
@@ -87,6 +124,28 @@ ReturnCodes CamHandler::setGrabCallback(GrabFrameCb _grab_cb) {
     return ReturnCodes::Success;
 }
 
+ReturnCodes CamHandler::setVideoSettingsCallback(VideoSettingsCb _settings_cb) {
+    settings_cb = _settings_cb;
+    return ReturnCodes::Success;
+}
+
+std::array<StageStats, NUM_PIPELINE_STAGES> CamHandler::getPipelineStats() const {
+    const std::array<const StageQueue<PipelineFrame>*, NUM_PIPELINE_STAGES> in_queues {
+        nullptr, &detect_queue, &overlay_queue, &encode_queue
+    };
+
+    std::array<StageStats, NUM_PIPELINE_STAGES> stats {};
+    for (std::size_t stage = 0; stage < NUM_PIPELINE_STAGES; ++stage) {
+        stats[stage].frames     = stage_counters[stage].frames.load(std::memory_order_relaxed);
+        stats[stage].busy_us    = stage_counters[stage].busy_us.load(std::memory_order_relaxed);
+        if (in_queues[stage] != nullptr) {
+            stats[stage].queue_depth    = in_queues[stage]->size();
+            stats[stage].dropped        = in_queues[stage]->getNumDropped();
+        }
+    }
+    return stats;
+}
+
 
 /********************************************* Camera Functions ********************************************/
 
@@ -125,12 +184,73 @@ void CamHandler::RunFrameGrabber(const bool record_immed, const bool should_save
          + (max_frames == -1 ? "infinite" : std::to_string(max_frames))
          + " frames" << endl;
 
-    // place to store the grabbed frame
-    cv::Mat image;
+    // every other stage gets a thread, each one closes the next one's queue once it is done
+    cv::Mat last_image; // last frame through the overlay (only touched by the encode thread until it is joined)
+    std::vector<std::thread> stage_threads {};
+    stage_threads.emplace_back([this]() {
+        RunStage(PipelineStage::Detect, detect_queue, &overlay_queue, [this](PipelineFrame& frame) {
+            // perform facial recognition (should be done PRIOR to any other modifications)
+            if(DetectFaces(frame.image, frame.faces) != ReturnCodes::Success) {
+                cerr << "Error: Failed to perform facial recogniition on image" << endl;
+            }
+        });
+    });
+    stage_threads.emplace_back([this]() {
+        RunStage(PipelineStage::Overlay, overlay_queue, &encode_queue, [this](PipelineFrame& frame) {
+            DrawFaces(frame.image, frame.faces);
+
+            // add timestamp to frame (after detection)
+            std::string timecode    { Helpers::Timing::GetTimecode() };
+            const int fontFace      { cv::FONT_HERSHEY_SIMPLEX };
+            const double fontScale  { 1.0 };
+            const int thickness     { 2 };
+            cv::putText(
+                frame.image,                                    // target frames
+                timecode,                                       // timecode/stamp text to write
+                cv::Point(50, 50),                              // top-left position (otherwise out of screen)
+                fontFace,                                       // font style
+                fontScale,                                      
+                CV_RGB(255, 255, 255),                          // font color (white)
+                thickness,
+                false                                           // relative to top-left
+            );
+        });
+    });
+    stage_threads.emplace_back([this, &last_image]() {
+        // reused for every frame (the grab callback copies what it needs out of img_buf)
+        cv::Mat scaled_image;
+        std::vector<unsigned char> img_buf;
+        JpegEncoder jpeg_encoder {};
+        RunStage(PipelineStage::Encode, encode_queue, nullptr, [&](PipelineFrame& frame) {
+            last_image = frame.image;
+            if (!grab_cb) return;
+
+            // scale down if the link cannot keep up w/ full size frames
+            const VideoSettings& settings {frame.settings};
+            const bool should_scale {settings.width != frame.image.cols || settings.height != frame.image.rows};
+            if (should_scale) {
+                cv::resize(frame.image, scaled_image, cv::Size(settings.width, settings.height), 0, 0, cv::INTER_AREA);
+            }
+
+            // encoded in strips on every core (img_buf keeps its capacity between frames)
+            if (jpeg_encoder.encode(should_scale ? scaled_image : frame.image, settings.jpeg_quality, img_buf) != ReturnCodes::Success) {
+                cerr << "Error: Failed to encode frame " + std::to_string(frame.stamp.seq) + "\n";
+                return;
+            }
+            frame.stamp.encoded_us = FrameStamp::now();
+            grab_cb(img_buf, frame.stamp);
+        });
+    });
+
+    // images frames are retrieved into (reused once no stage holds them anymore)
+    std::vector<cv::Mat> images {};
+    time_point last_sent {};
 
     // start capture
     // loop until max frame count or told to stop
     start_time      = std::chrono::system_clock::now(); // updates in loop
+    auto last_stats {std::chrono::steady_clock::now()};
+    std::array<StageStats, NUM_PIPELINE_STAGES> prev_stats {};
 
     cout << "Camera Ready: " + Helpers::Timing::GetTimecode(start_time) + '\n';
     bool was_recording {false};
@@ -154,61 +274,110 @@ void CamHandler::RunFrameGrabber(const bool record_immed, const bool should_save
             cout << "Starting Camera Capture: " + Helpers::Timing::GetTimecode(start_time) + '\n';
         }
 
+        PipelineFrame frame {};
+        cv::Mat& image {getFreeImage(images)};
         RaspiCam_Cv::grab();
+        frame.stamp.capture_us = FrameStamp::now();
         RaspiCam_Cv::retrieve(image);
+        frame.image = image; // shares the pixels (the pool's handle tells when the pipeline is done w/ them)
 
         // make sure valid frame
-        if(image.empty()) {
+        if(frame.image.empty()) {
             cerr << "Error: Bad video frame" << endl;
             continue;
         }
 
-        // perform facial recognition (should be done PRIOR to any other modifications)
-        if(DetectAndDraw(image) != ReturnCodes::Success) {
-            cerr << "Error: Failed to perform facial recogniition on image" << endl;
+        // drop frames the link has no room for (before spending any time on them)
+        // (half a frame of slack, otherwise jitter would drop every other frame at full rate)
+        frame.settings = settings_cb ? settings_cb() : getVideoSettings(0);
+        const auto now {std::chrono::system_clock::now()};
+        const auto frame_interval {std::chrono::milliseconds(1000 / std::max(frame.settings.fps, 1))};
+        if (grab_cb && now - last_sent < frame_interval - std::chrono::milliseconds(Constants::Camera::VID_FRAMEPER_MS / 2)) {
+            continue;
         }
+        last_sent = now;
 
-        // add timestamp to frame (after detection)
-        std::string timecode    { Helpers::Timing::GetTimecode() };
-        const int fontFace      { cv::FONT_HERSHEY_SIMPLEX };
-        const double fontScale  { 1.0 };
-        const int thickness     { 2 };
-        auto timecode_size      { cv::getTextSize(timecode, fontFace, fontScale, thickness, 0) };
-        cv::putText(
-            image,                                          // target frames
-            timecode,                                       // timecode/stamp text to write
-            cv::Point(50, 50),                              // top-left position (otherwise out of screen)
-            fontFace,                                       // font style
-            fontScale,                                      
-            CV_RGB(255, 255, 255),                          // font color (white)
-            thickness,
-            false                                           // relative to top-left
-        );
-
-
-        // increment frame count
+        // increment frame count & hand off to detection (never waits, the oldest waiting frame is dropped instead)
         ++frame_count;
-
-        // use grab callback if provided
-        if (grab_cb) {
-            // cv::Mat stored as std::vector<uchar (aka unsigned char)> but needed as std::vector<unsigned char>
-            std::vector<unsigned char> img_buf;
-            cv::imencode(".jpg", image, img_buf);
-            grab_cb(img_buf);
+        frame.stamp.seq = static_cast<std::uint16_t>(frame_count);
+        RecordStage(PipelineStage::Capture, frame.stamp.capture_us);
+        detect_queue.push(std::move(frame));
+
+        if (is_verbose) {
+            const auto stats_now {std::chrono::steady_clock::now()};
+            if (stats_now - last_stats >= std::chrono::milliseconds(Constants::Camera::PIPELINE_STATS_MS)) {
+                PrintPipelineStats(prev_stats, std::chrono::duration<double>(stats_now - last_stats).count());
+                last_stats = stats_now;
+            }
         }
     }
 
-    // stop
+    // let the frames in flight through, then stop
+    detect_queue.close();
+    for (auto& stage_thread : stage_threads) {
+        stage_thread.join();
+    }
     RaspiCam_Cv::release();
 
 
     if (should_save) {
         constexpr auto filepath {"raspicam_cv_image.jpg"};
-        cv::imwrite(filepath, image);
+        cv::imwrite(filepath, last_image);
         cout << "Image saved at " + std::string(filepath) << endl;
     }
 }
 
+/*************************************** Pipeline Functions **************************************/
+
+void CamHandler::RunStage(
+    const PipelineStage stage,
+    StageQueue<PipelineFrame>& in_queue,
+    StageQueue<PipelineFrame>* out_queue,
+    const std::function<void(PipelineFrame&)>& work
+) {
+    PipelineFrame frame {};
+    while (true) {
+        if (!in_queue.waitPop(frame, Constants::Camera::STAGE_WAIT_MS)) {
+            if (in_queue.isClosed()) break;
+            continue;
+        }
+
+        const std::uint64_t start_us {FrameStamp::now()};
+        work(frame);
+        RecordStage(stage, start_us);
+        if (out_queue != nullptr) out_queue->push(std::move(frame));
+    }
+    if (out_queue != nullptr) out_queue->close();
+}
+
+void CamHandler::RecordStage(const PipelineStage stage, const std::uint64_t start_us) {
+    StageCounters& counters {stage_counters[static_cast<std::size_t>(stage)]};
+    counters.frames.fetch_add(1, std::memory_order_relaxed);
+    counters.busy_us.fetch_add(FrameStamp::now() - start_us, std::memory_order_relaxed);
+}
+
+void CamHandler::PrintPipelineStats(std::array<StageStats, NUM_PIPELINE_STAGES>& prev, const double secs) const {
+    const std::array<StageStats, NUM_PIPELINE_STAGES> curr {getPipelineStats()};
+    std::ostringstream stats_str {};
+    stats_str << std::fixed << std::setprecision(1) << "Camera pipeline:";
+    for (std::size_t stage = 0; stage < NUM_PIPELINE_STAGES; ++stage) {
+        const std::uint64_t frames {curr[stage].frames - prev[stage].frames};
+        const std::uint64_t busy_us {curr[stage].busy_us - prev[stage].busy_us};
+        stats_str << (stage > 0 ? " |" : "") << " " << getPipelineStageName(static_cast<PipelineStage>(stage))
+                  << " " << frames / secs << "fps " << (frames > 0 ? busy_us / 1000.0 / frames : 0) << "ms/frame";
+        if (stage > 0) {
+            stats_str << " (queue " << curr[stage].queue_depth << ", dropped " << curr[stage].dropped - prev[stage].dropped << ")";
+        }
+    }
+    const std::string detector_name {
+        face_detectors.empty() ? "none" : getDetectorBackendName(face_detectors.getActive().getBackend())
+    };
+    stats_str << " | faces detected (" << detector_name << ") every " << face_tracker.getInterval() << " frames @" << face_tracker.getScale()
+              << "x (" << face_tracker.getDetectCostMs() << "ms, tracked " << face_tracker.getTrackCostMs() << "ms)";
+    cout << stats_str.str() + "\n";
+    prev = curr;
+}
+
 /********************************************* Helper Functions ********************************************/
 
 ReturnCodes CamHandler::SetupCam() {
@@ -259,21 +428,18 @@ ReturnCodes CamHandler::LoadClassifiers(Classifier& classifiers_pair) {
 
 ReturnCodes CamHandler::LoadClassifiers() {
     // TODO: use cli to path these files
-    const bool face_rtn         {LoadClassifiers(facial_classifier) == ReturnCodes::Success};
+    const bool face_rtn         {face_detectors.load(detector_config, classifiers_dir, is_verbose) == ReturnCodes::Success};
     const bool eye_rtn          {LoadClassifiers(eye_classifier) == ReturnCodes::Success};
 
     // print some debug info
     if (is_verbose) {
-        cout << std::boolalpha << "face classifier: " << facial_classifier.first 
-             << " (loaded " << !facial_classifier.second.empty() << ")" << endl;
-
         cout << std::boolalpha << "eye classifier: " << eye_classifier.first
              << " (loaded " << !eye_classifier.second.empty() << ")" << endl;
     }
 
     // check rtn codes
     if(!face_rtn) {
-        cerr << "Error: Failed to load facial recognition classifier: " << facial_classifier.first << endl;
+        cerr << "Error: Failed to load facial recognition detectors" << endl;
     }
 
     if (!eye_rtn) {
@@ -284,18 +450,15 @@ ReturnCodes CamHandler::LoadClassifiers() {
 
 }
 
-ReturnCodes CamHandler::DetectAndDraw(cv::Mat& img) {
-    // define some needed in between step vars
-    std::vector<cv::Rect> faces;
-    cv::Mat gray_img;
-
-    // convert img to grayscale
-    cv::cvtColor(img, gray_img, cv::COLOR_BGR2GRAY);
-    // cv::equalizeHist(gray_img, gray_img);
+ReturnCodes CamHandler::DetectFaces(const cv::Mat& img, std::vector<cv::Rect>& faces) {
+    if (face_detectors.empty()) return ReturnCodes::Error;
 
-    // detect faces of different sizes using cascade classifier
-    facial_classifier.second.detectMultiScale(gray_img, faces, 1.3, 5);
+    // detect faces of different sizes using the detector that fits the budget (or follow the ones it last found)
+    face_tracker.update(img, face_detectors, faces);
+    return ReturnCodes::Success;
+}
 
+void CamHandler::DrawFaces(cv::Mat& img, const std::vector<cv::Rect>& faces) const {
     // draw circles around the faces
     for (auto& face : faces) {
         // center a point/circle in the middle of the object
@@ -340,8 +503,6 @@ ReturnCodes CamHandler::DetectAndDraw(cv::Mat& img) {
         */
 
     } // end of iteration over faces
-
-    return ReturnCodes::Success;
 }
 
 
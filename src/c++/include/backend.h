@@ -4,6 +4,13 @@
 // Standard Includes
 #include <iostream>
 #include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <atomic>
 #include <experimental/filesystem> // to get path to html file
 
 // Our Includes
@@ -16,6 +23,7 @@
 #include <json.hpp>
 #include "pistache/endpoint.h" // for actually web app server
 #include "pistache/router.h" // to be able to make routes
+#include "pistache/peer.h" // to check a stream's connection (is it still open & how much is left to send)
 
 namespace RPI {
 
@@ -31,9 +39,11 @@ enum class WebAppUrlsNames {
     // LANDING_PAGE, //TODO: get redirect to work
     MAIN_PAGE,
     CAM_PAGE,
+    CAM_STREAM,
     SHUTDOWN_PAGE,
     STATIC,
     CAM_SETTINGS,
+    CAM_LATENCY,
     SERVER_DATA,
 };
 
@@ -42,7 +52,9 @@ const std::unordered_map<WebAppUrlsNames, std::string> WebAppUrls {
     // {WebAppUrlsNames::LANDING_PAGE, "/"}, //TODO: get redirect to work
     {WebAppUrlsNames::MAIN_PAGE, "/RPI-Client"},
     {WebAppUrlsNames::CAM_PAGE, "/Camera"},
+    {WebAppUrlsNames::CAM_STREAM, "/Camera/stream.mjpg"}, // every new frame pushed over one response (see handleVidStreamReq())
     {WebAppUrlsNames::CAM_SETTINGS, "/Camera/settings.json"}, // see camera_settings.json for what it looks like
+    {WebAppUrlsNames::CAM_LATENCY, "/Camera/latency.json"}, // per stage latency histograms & clock sync (see FrameTimings::toJson())
     {WebAppUrlsNames::SERVER_DATA, "/Server/data.json"}, // see c++/network/pkt_sample.json for what it looks like
     {WebAppUrlsNames::SHUTDOWN_PAGE, "/Shutdown"},
     {WebAppUrlsNames::STATIC, "../static"}, // from perspective of html file, static is one back
@@ -91,6 +103,25 @@ class WebApp {
         Pistache::Rest::Router      web_app_router;     // default route handler for creation & routing of multi sites
         bool                        is_running;         // true when web app is running
 
+        // a browser's open mjpeg stream (see handleVidStreamReq())
+        struct VidStream {
+            /**
+             * @brief Opens the response's stream in place (the stream is never moved/copied, lists only relink it)
+             * @param res The request's response (its headers must already be set)
+             */
+            explicit VidStream(Pistache::Http::ResponseWriter& res);
+
+            Pistache::Http::ResponseStream      stream;     // the open response (pistache frames & queues every write)
+            std::weak_ptr<Pistache::Tcp::Peer>  peer;       // the stream's connection (expires once the browser is gone)
+            std::uint64_t                       generation; // generation of the last frame sent (0 = none)
+        };
+
+        // mjpeg streams
+        std::mutex                  stream_mutex;       // guards pending_streams (only held to add/take streams)
+        std::list<VidStream>        pending_streams;    // opened by handleVidStreamReq(), taken over by stream_thread
+        std::thread                 stream_thread;      // writes new frames to the streams (runVidStreams())
+        std::atomic_bool            stop_streams;       // true when stream_thread should end the streams & exit
+
         /******************************************** Web/Route Functions *******************************************/
 
         /**
@@ -122,11 +153,23 @@ class WebApp {
          */
         void handleVidReq(const Pistache::Rest::Request& req, Pistache::Http::ResponseWriter res);
 
+        /**
+         * @brief Opens a multipart/x-mixed-replace (mjpeg) stream of the camera's frames: the response stays open
+         * & every new frame is pushed over it once, as it arrives (by stream_thread, so this returns right away)
+         * @note Use it as an <img>'s src
+         */
+        void handleVidStreamReq(const Pistache::Rest::Request& req, Pistache::Http::ResponseWriter res);
+
         /**
          * @brief Responsible for sending the camera settings
          */
         void handleCamSettingReq(const Pistache::Rest::Request& req, Pistache::Http::ResponseWriter res);
 
+        /**
+         * @brief Responsible for GET request on how long camera frames take through each hop (capture->serve)
+         */
+        void handleCamLatencyReq(const Pistache::Rest::Request& req, Pistache::Http::ResponseWriter res);
+
         /**
          * @brief Responsible for GET request on server data (i.e. sensor data)
          */
@@ -162,6 +205,35 @@ class WebApp {
          */
         void printUrls() const;
 
+        /**
+         * @brief stream_thread's loop: takes over new streams & writes each new frame to every stream that is not
+         * still sending an older one (it gets the newest frame once it caught up), drops streams whose browser went
+         * away & ends them all when told to stop
+         * @note It is the only thread writing to a stream once handleVidStreamReq() flushed its headers
+         */
+        void runVidStreams();
+
+        /**
+         * @brief Check if a stream's connection still has unsent bytes of an older part (the browser is slower
+         * than the camera, so it should skip frames)
+         * @param vid The stream
+         * @return true if it is still sending
+         */
+        static bool isStreamBusy(const VidStream& vid);
+
+        /**
+         * @brief Write a frame's part to a stream & flush it (does not wait for it to be sent)
+         * @param vid The stream
+         * @param part The part (see makeStreamPart(), pistache frames it as the response's next http chunk)
+         * @return false if the stream's connection is gone
+         */
+        static bool writeStreamPart(VidStream& vid, const std::string& part);
+
+        /**
+         * @brief Frame a jpeg as the next part of a multipart stream
+         */
+        static std::string makeStreamPart(const std::vector<unsigned char>& frame);
+
 }; // end of WebApp class
 
 }; // end of UI namespace
@@ -0,0 +1,113 @@
+#ifndef RPI_BROADCAST_RING_H
+#define RPI_BROADCAST_RING_H
+
+// Standard Includes
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Our Includes
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Fixed size ring of the most recent messages that any number of subscribers read from at their own pace
+ * @tparam Msg The message type stored (should be cheap to copy, i.e. hold ref-counted handles to the data)
+ * @note Each subscriber keeps its own cursor (sequence number of the next message it wants).
+ * Pushing never waits for subscribers: a subscriber that falls so far behind that its next message was
+ * overwritten skips straight to the newest message instead of stalling everyone else.
+ * Not thread safe (meant to be driven by a single reactor thread)
+ */
+template <typename Msg>
+class BroadcastRing {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        /**
+         * @param capacity How many of the most recent messages are kept (at least 1)
+         */
+        explicit BroadcastRing(const std::size_t capacity)
+            : slots(capacity > 0 ? capacity : 1)
+            , next_seq{1}                           // 0 is never a valid sequence number
+        {
+            // stub
+        }
+
+        /********************************************* Getters/Setters *********************************************/
+
+        bool empty() const {
+            return next_seq == 1;
+        }
+
+        /**
+         * @brief Sequence number the next pushed message will get
+         */
+        std::uint64_t getNextSeq() const {
+            return next_seq;
+        }
+
+        /**
+         * @brief Sequence number of the most recently pushed message (0 if empty)
+         */
+        std::uint64_t getNewestSeq() const {
+            return next_seq - 1;
+        }
+
+        /**
+         * @brief Sequence number of the oldest message still held
+         */
+        std::uint64_t getOldestSeq() const {
+            return next_seq > slots.size() ? next_seq - slots.size() : 1;
+        }
+
+        /**
+         * @brief Get the cursor a new subscriber should start from
+         * @return The newest message's sequence number (so it is sent right away) or the next one if empty
+         */
+        std::uint64_t subscribe() const {
+            return empty() ? next_seq : getNewestSeq();
+        }
+
+        /****************************************** Ring Functions ****************************************/
+
+        /**
+         * @brief Add a message (overwrites the oldest if full)
+         * @return The message's sequence number
+         */
+        std::uint64_t push(Msg msg) {
+            slots[next_seq % slots.size()] = std::move(msg);
+            return next_seq++;
+        }
+
+        /**
+         * @brief Get the next message for a subscriber & advance its cursor
+         * @param cursor The subscriber's cursor (jumps to the newest message if its next one was overwritten)
+         * @param skipped (optional) Set to the number of messages the subscriber missed
+         * @return The message (valid until the next push()) or nullptr if the subscriber is caught up
+         */
+        const Msg* next(std::uint64_t& cursor, std::uint64_t* skipped=nullptr) {
+            if (skipped) *skipped = 0;
+            if (cursor >= next_seq) return nullptr;
+
+            // lapped -> skip to the newest
+            if (cursor < getOldestSeq()) {
+                if (skipped) *skipped = getNewestSeq() - cursor;
+                cursor = getNewestSeq();
+            }
+            return &slots[cursor++ % slots.size()];
+        }
+
+    private:
+        std::vector<Msg>    slots;      // the most recent messages (indexed by seq % capacity)
+        std::uint64_t       next_seq;   // sequence number of the next message pushed
+
+}; // end of BroadcastRing class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
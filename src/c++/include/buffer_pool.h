@@ -0,0 +1,83 @@
+#ifndef RPI_BUFFER_POOL_H
+#define RPI_BUFFER_POOL_H
+
+// Standard Includes
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <sys/types.h> // for u_char
+
+// Our Includes
+#include "constants.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Ref-counted handle to a pooled buffer.
+ * The buffer goes back to the pool it came from once the last handle is dropped
+ * (if the pool no longer exists, the buffer is just freed)
+ */
+using PooledBuf = std::shared_ptr<std::vector<u_char>>;
+
+/**
+ * @brief Pool of reusable receive buffers with a bounded maximum message size
+ * @note Thread safe. Buffers keep their capacity when recycled so steady-state receives never allocate
+ */
+class BufferPool {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        /**
+         * @brief Construct a new buffer pool
+         * @param max_msg_size The largest buffer that can be acquired (larger requests are refused)
+         * @param max_idle_bufs How many released buffers to keep around for reuse (the rest are freed)
+         */
+        BufferPool(
+            const std::size_t max_msg_size=Constants::Network::MAX_CTRL_MSG_SIZE,
+            const std::size_t max_idle_bufs=Constants::Network::POOL_IDLE_BUFS
+        );
+        virtual ~BufferPool();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        std::size_t getMaxMsgSize() const;
+        void setMaxMsgSize(const std::size_t new_max);
+
+        /**
+         * @brief Get the number of released buffers waiting to be reused
+         */
+        std::size_t getNumIdle() const;
+
+        /********************************************** Pool Functions *********************************************/
+
+        /**
+         * @brief Get a buffer of exactly `size` bytes (contents are unspecified)
+         * @param size The number of bytes needed
+         * @return The buffer handle (nullptr if size is larger than the max message size)
+         */
+        PooledBuf acquire(const std::size_t size);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        // shared with every outstanding buffer's deleter so buffers can outlive the pool
+        struct PoolState {
+            std::mutex                                          mutex;          // controls access to idle_bufs
+            std::vector<std::unique_ptr<std::vector<u_char>>>   idle_bufs;      // released buffers ready for reuse
+            std::size_t                                         max_idle_bufs;  // max size of idle_bufs
+        };
+
+        std::shared_ptr<PoolState>  state;              // the idle buffers (see PoolState)
+        std::atomic<std::size_t>    max_msg_size;       // largest buffer that can be acquired
+
+}; // end of BufferPool class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef RPI_CAPTURE_FILE_H
+#define RPI_CAPTURE_FILE_H
+
+// Standard Includes
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Our Includes
+#include "constants.h"
+#include "packet.h"
+#include "net_conn.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Which way a captured message went
+ */
+enum class CaptureDir : std::uint8_t {
+    Sent,
+    Recv,
+};
+
+/**
+ * @brief A message read back out of a capture file
+ * @note `data` points into the reader's mapping (only valid until the reader is closed)
+ */
+struct CaptureRecord {
+    CaptureDir              dir;
+    Channel                 channel;
+    std::uint64_t           time_us;    // when it was sent/received (ClockSync::now() of the capturing host)
+    HeaderPkt_t             header;     // the header it had on the wire (header.channel filled in)
+    const std::uint8_t*     data;
+    std::uint32_t           size;
+};
+
+/**
+ * @brief Appends every message a net agent sends/receives to a capture file (to replay it later, see CaptureReader)
+ * @note The file is memory mapped & grown in large steps, so an append is a memcpy (no syscall most of the time).
+ * The record count in the file's header is kept current, so a capture cut short by a crash can still be read
+ * (w/o the index, which close() writes after the last record). Thread safe
+ */
+class CaptureWriter {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        CaptureWriter();
+        virtual ~CaptureWriter();
+
+        CaptureWriter(const CaptureWriter&) = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        bool isOpen() const;
+        std::uint64_t getNumRecords() const;
+
+        /******************************************** Capture Functions ********************************************/
+
+        /**
+         * @brief Create (or overwrite) a capture file & map it
+         * @param path Where to create it
+         * @return Error if it could not be created/mapped
+         */
+        ReturnCodes open(const std::string& path);
+
+        /**
+         * @brief Append a message
+         * @param dir Whether it was sent or received
+         * @param channel The channel it went over
+         * @param header Its header (as sent/received)
+         * @param data The message's data
+         * @param size The number of bytes of data
+         * @param time_us When it was sent/received (ClockSync::now())
+         * @return Error if the file is not open or could not grow
+         */
+        ReturnCodes append(
+            const CaptureDir dir,
+            const Channel channel,
+            const HeaderPkt_t& header,
+            const void* data,
+            const std::uint32_t size,
+            const std::uint64_t time_us
+        );
+
+        /**
+         * @brief Write the index after the last record, trim the file to its contents & unmap it
+         */
+        void close();
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        mutable std::mutex          file_mutex;     // controls access to everything below
+        int                         fd;             // the capture file (-1 if not open)
+        std::uint8_t*               mapping;        // the whole file
+        std::size_t                 mapping_size;   // bytes mapped (the file's size while open)
+        std::uint64_t               data_end;       // offset the next record goes at
+        std::vector<std::uint64_t>  offsets;        // every record's offset (the index)
+
+        /**
+         * @brief Grow the file & mapping until `size` more bytes fit past data_end (file_mutex must be held)
+         */
+        ReturnCodes reserve(const std::size_t size);
+
+        /**
+         * @brief Unmap & close the file w/o writing the index (file_mutex must be held)
+         */
+        void unmap();
+
+}; // end of CaptureWriter class
+
+/**
+ * @brief Reads a capture file written by CaptureWriter (whole file mapped read-only)
+ * @note Uses the file's index if it has one, otherwise finds the records by walking them (capture cut short)
+ */
+class CaptureReader {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        CaptureReader();
+        virtual ~CaptureReader();
+
+        CaptureReader(const CaptureReader&) = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        bool isOpen() const;
+
+        /**
+         * @brief Get the number of records in the capture
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Get a record (idx < size(), records are in the order they were captured)
+         */
+        CaptureRecord at(const std::size_t idx) const;
+
+        /**
+         * @brief Get the time between the first & last record (µs)
+         */
+        std::uint64_t getDurationUs() const;
+
+        /******************************************** Capture Functions ********************************************/
+
+        /**
+         * @brief Map a capture file
+         * @param path The capture file
+         * @return Error if it could not be read or is not a capture file
+         */
+        ReturnCodes open(const std::string& path);
+
+        void close();
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        const std::uint8_t*         mapping;        // the whole file
+        std::size_t                 mapping_size;   // bytes mapped
+        std::vector<std::uint64_t>  offsets;        // every record's offset
+
+}; // end of CaptureReader class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef RPI_CHECKSUM_H
+#define RPI_CHECKSUM_H
+
+// Standard Includes
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Our Includes
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+namespace Checksum {
+
+/**
+ * @brief Computes the CRC32C (Castagnoli) of a buffer using the fastest implementation the cpu supports
+ * @param data The buffer to checksum
+ * @param size The number of bytes in data
+ * @param crc (optional) A previous result to continue from (to checksum a message in pieces)
+ * @return The CRC32C
+ * @note Uses the SSE4.2 (x86) or ARMv8 CRC32 instructions if available (checked once at runtime),
+ * otherwise falls back to crc32cSlicing8()
+ */
+std::uint32_t crc32c(const void* data, const std::size_t size, const std::uint32_t crc=0);
+
+/**
+ * @brief Portable table-driven CRC32C that processes 8 bytes per step ("slicing-by-8")
+ */
+std::uint32_t crc32cSlicing8(const void* data, const std::size_t size, const std::uint32_t crc=0);
+
+/**
+ * @brief Reference bytewise (single table) CRC32C
+ * @note Only meant for testing/benchmarking the faster implementations
+ */
+std::uint32_t crc32cBytewise(const void* data, const std::size_t size, const std::uint32_t crc=0);
+
+/**
+ * @brief CRC32C using the cpu's crc instructions
+ * @note Only valid to call if hasHardwareCrc() is true
+ */
+std::uint32_t crc32cHardware(const void* data, const std::size_t size, const std::uint32_t crc=0);
+
+/**
+ * @brief Determine if the cpu has CRC32C instructions (so crc32c() uses them)
+ */
+bool hasHardwareCrc();
+
+/**
+ * @brief Get the name of the implementation crc32c() dispatches to (i.e. for logging/benchmarks)
+ */
+std::string getImplName();
+
+} // end of Checksum namespace
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef RPI_CLOCK_SYNC_H
+#define RPI_CLOCK_SYNC_H
+
+// Standard Includes
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Our Includes
+
+// 3rd Party Includes
+#include <json.hpp>
+
+namespace RPI {
+namespace Network {
+
+using json = nlohmann::json;
+
+/**
+ * @brief A clock ping (client -> server) or pong (the same message sent back w/ the server's times filled in)
+ * @note Sent as the data of a control msg w/ HeaderPkt_t::FLAG_CLOCK (MuxHeader::FLAG_CLOCK over mux).
+ * Every time is the sender's monotonic clock (ClockSync::now(), µs)
+ */
+struct ClockPing {
+    std::uint64_t   client_send     {0};    // t1: client sent the ping
+    std::uint64_t   server_recv     {0};    // t2: server received it (0 in a ping)
+    std::uint64_t   server_send     {0};    // t3: server sent the pong (0 in a ping)
+
+    // number of bytes the ping takes up on the wire (network byte order)
+    static constexpr std::size_t WIRE_SIZE {24};
+
+    ClockPing() = default;
+    explicit ClockPing(const std::uint8_t* wire_buf); // reads WIRE_SIZE bytes
+    void pack(std::uint8_t* wire_buf) const; // writes WIRE_SIZE bytes
+};
+
+/**
+ * @brief Estimates a remote host's monotonic clock (offset & drift) from timestamped ping/pongs (NTP style)
+ * @note Every pong is a sample: offset = ((t2-t1) + (t3-t4)) / 2, only off by as much as the path is
+ * asymmetric (at most rtt/2). Samples that waited in a queue are the least trustworthy, so only the lowest rtt
+ * sample of the last few (min-RTT filter) is kept as a point of the skew model, a line fit (least squares)
+ * through the recent points: offset(t) = offset + drift * (t - t_point). Drift is only trusted once the points
+ * span a while & is 0 until then.
+ * Thread safe (the client's reactor adds samples while the web app converts frame times)
+ */
+class ClockSync {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        ClockSync();
+        virtual ~ClockSync();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        /**
+         * @brief Get if there have been enough samples to trust the estimate (remote times can be converted)
+         */
+        bool isSynced() const;
+
+        /**
+         * @brief Get the estimated (remote clock - local clock) right now in µs (nothing until synced)
+         */
+        std::optional<std::int64_t> getOffsetUs() const;
+
+        /**
+         * @brief Get how much faster the remote clock runs than the local one (parts per million)
+         */
+        double getDriftPpm() const;
+
+        /**
+         * @brief Get the lowest rtt of the recent samples (µs, 0 until the first sample)
+         */
+        std::uint64_t getRttUs() const;
+
+        /**
+         * @brief Get how far off the offset may be (half the rtt of the sample it came from, in µs)
+         */
+        std::uint64_t getErrorUs() const;
+
+        /**
+         * @brief Get the state of the estimate (synced, offset, drift, rtt, error & number of samples)
+         */
+        json toJson() const;
+
+        /****************************************** Estimation Functions ****************************************/
+
+        /**
+         * @brief Adds the sample from a pong
+         * @param pong The pong (its client_send & the server's times)
+         * @param local_recv When the pong was received (t4, now())
+         * @note Pongs that make no sense (negative rtt, not from a ping this side sent) are ignored
+         */
+        void addSample(const ClockPing& pong, const std::uint64_t local_recv);
+
+        /**
+         * @brief Converts a remote monotonic time (µs) to the local clock (unchanged if not synced or 0)
+         */
+        std::uint64_t toLocal(const std::uint64_t remote_us) const;
+
+        /**
+         * @brief Converts a local monotonic time (µs) to the remote's clock (unchanged if not synced or 0)
+         */
+        std::uint64_t toRemote(const std::uint64_t local_us) const;
+
+        /**
+         * @brief Forgets every sample (i.e. the remote restarted, so its clock starts over)
+         */
+        void reset();
+
+        /**
+         * @brief Get the local monotonic clock in µs (steady clock, the same as Camera::FrameStamp::now())
+         */
+        static std::uint64_t now();
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        // a sample's offset (remote - local) & rtt, at the local time halfway through its ping/pong
+        struct Sample {
+            std::uint64_t   local_us;
+            std::int64_t    offset_us;
+            std::uint64_t   rtt_us;
+        };
+
+        mutable std::mutex  sync_mutex;
+        std::deque<Sample>  window;         // latest samples (the min-RTT filter picks from these)
+        std::deque<Sample>  points;         // filtered samples the skew model is fit through
+        std::uint64_t       num_samples;    // samples accepted since the last reset()
+        Sample              base;           // model: offset at base.local_us (rtt of the point it came from)
+        double              drift;          // model: µs of offset gained per local µs
+
+        /**
+         * @brief Get the offset the model predicts at a local time (sync_mutex must be held)
+         */
+        std::int64_t offsetAt(const std::uint64_t local_us) const;
+
+        /**
+         * @brief Fits the model through the points (sync_mutex must be held)
+         */
+        void fit();
+
+}; // end of ClockSync class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
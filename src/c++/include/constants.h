@@ -24,6 +24,28 @@ namespace Constants {
 
     namespace Network {
         constexpr std::size_t   MAX_DATA_SIZE   {4096};
+        constexpr std::size_t   MAX_CTRL_MSG_SIZE   {64*1024};      // largest control/server data msg accepted
+        constexpr std::size_t   MAX_FRAME_MSG_SIZE  {4*1024*1024};  // largest camera frame msg accepted
+        constexpr std::size_t   POOL_IDLE_BUFS      {4};            // released recv buffers kept for reuse
+        constexpr std::size_t   ZEROCOPY_MIN_SIZE   {10*1024};      // MSG_ZEROCOPY only pays off for large sends
+        constexpr std::size_t   ZEROCOPY_MAX_PENDING{8};            // zero copy sends allowed in flight per socket
+        constexpr int           MAX_REACTOR_EVENTS  {16};           // ready events handled per epoll_wait() call
+        constexpr int           MAX_SUBSCRIBERS     {8};            // clients the server serves at once (per channel)
+        constexpr std::size_t   BROADCAST_RING_SIZE {4};            // recent frames/pkts kept for slower subscribers
+        constexpr std::size_t   MAX_DGRAM_SIZE      {1400};         // largest udp msg (stays under a typical mtu)
+        constexpr int           UDP_HEARTBEAT_MS    {100};          // latest state is resent this often over udp
+        constexpr std::size_t   URING_BUF_SIZE      {64*1024};      // size of each io_uring provided recv buffer
+        constexpr unsigned      URING_NUM_BUFS      {16};           // provided recv buffers per socket (power of 2)
+        constexpr std::size_t   MUX_FRAG_SIZE       {16*1024};      // largest piece of a message sent at once (mux)
+        constexpr std::size_t   MUX_NOTSENT_LOWAT   {16*1024};      // unsent bytes the kernel holds per mux socket
+        constexpr std::size_t   CAM_NOTSENT_LOWAT   {16*1024};      // unsent frame bytes the kernel holds per camera socket
+        constexpr int           RATE_SAMPLE_MS      {100};          // camera links are measured this often
+        constexpr int           RATE_DOWN_HOLD_MS   {500};          // min time between video quality drops
+        constexpr int           RATE_UP_HOLD_MS     {3000};         // link must keep up this long before quality rises
+        constexpr int           RECONNECT_MIN_MS    {10};           // first reconnect attempt after losing the server
+        constexpr int           RECONNECT_MAX_MS    {2000};         // reconnect backoff stops doubling here
+        constexpr int           CLOCK_SYNC_MS       {1000};         // client pings the server's clock this often
+        constexpr int           CLOCK_SYNC_BURST_MS {50};           // ...& this often until it has an estimate
         constexpr char          PKT_ACK[]       {"Packet ACK\n"};
         constexpr int           RX_TX_TIMEOUT   {1}; // heartbeat (ctrl+c takes this long during runtime)
         constexpr int           ACPT_TIMEOUT    {2}; // ctrl+c takes this long to work pre-connect
@@ -35,6 +57,20 @@ namespace Constants {
         constexpr int           FRAME_SIZE      {FRAME_WIDTH*FRAME_HEIGHT};
         constexpr int           VID_FRAMERATE   {25};
         constexpr int           VID_FRAMEPER_MS {1000/VID_FRAMERATE};
+        constexpr int           TARGET_LATENCY_MS {200};  // max time a sent frame should wait to reach the client
+        constexpr std::size_t   STAGE_QUEUE_DEPTH {2};    // frames waiting between 2 pipeline stages (oldest dropped)
+        constexpr int           STAGE_WAIT_MS   {100};    // how long a stage waits for a frame before checking for exit
+        constexpr int           PIPELINE_STATS_MS {5000}; // how often the pipeline's stats are printed (verbose)
+        constexpr std::size_t   JPEG_ENCODE_STRIPS {4};   // frames are jpeg encoded in this many strips at once (1/core)
+
+        // face detection scheduling (see FaceTracker)
+        constexpr double        DETECT_BUDGET_MS    {12.0};   // detect stage's cpu time per frame to stay under (avg)
+        constexpr std::size_t   DETECT_MAX_INTERVAL {15};     // frames between detections at most (tracked between)
+        constexpr double        DETECT_MAX_SCALE    {1.0};    // size the detector runs at (fraction of the frame)
+        constexpr double        DETECT_MIN_SCALE    {0.25};
+        constexpr double        DETECT_MOTION_DIFF  {6.0};    // mean pixel change (0-255) that counts as motion
+        constexpr double        TRACK_MIN_SCORE     {0.6};    // template match score a tracked face needs to be kept
+        constexpr double        DNN_MIN_CONFIDENCE  {0.5};    // dnn face detector's score a face needs to count
 
     }; //end of camera namespace
 
@@ -53,11 +89,22 @@ namespace CLI::Results {
         CTRL_PORT,
         CAM_PORT,
         SRV_DATA_PORT,
+        PKT_ENCODING,
+        NO_CHECKSUM,
+        TRANSPORT,
+        SIM_LOSS,
+        IO_ENGINE,
+        CAPTURE,
         WEB_PORT,
         I2C_ADDR,
         VID_FRAMES,
         FACEXML,
         EYEXML,
+        LBPXML,
+        DNN_MODEL,
+        DNN_CONFIG,
+        DETECTOR,
+        DETECT_BUDGET,
         VERBOSITY,
         VERSION
     }; // end of ParseResults's keys
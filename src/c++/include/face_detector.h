@@ -0,0 +1,217 @@
+#ifndef RPI_FACE_DETECTOR_H
+#define RPI_FACE_DETECTOR_H
+
+// Standard Includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <experimental/filesystem> // for model paths
+
+// Our Includes
+#include "constants.h"
+
+// 3rd Party Includes
+#include <opencv2/objdetect.hpp> // for CascadeClassifier
+#include <opencv2/dnn.hpp> // for the dnn face model
+
+namespace RPI {
+
+namespace Camera {
+
+namespace fs = std::experimental::filesystem;
+
+/**
+ * @brief The ways faces can be detected (least to most accurate)
+ */
+enum class DetectorBackend : std::uint8_t {
+    Lbp,        // lbp cascade (fastest, most misses)
+    Haar,       // haar cascade
+    Dnn,        // opencv dnn face model (ssd), on the cpu
+};
+
+constexpr std::size_t NUM_DETECTOR_BACKENDS {static_cast<std::size_t>(DetectorBackend::Dnn) + 1};
+
+/**
+ * @brief Get a backend's name (i.e. "haar", same as the --detector cli option)
+ */
+std::string getDetectorBackendName(const DetectorBackend backend);
+
+/**
+ * @brief Which face detectors to load & the cpu budget to pick one by (see FaceDetectors)
+ * @note An empty path uses the file of the same name in the camera's classifiers dir
+ */
+struct DetectorConfig {
+    std::string     backend     {"auto"};   // "auto" = load all & pick by budget, otherwise only this one
+    double          budget_ms   {Constants::Camera::DETECT_BUDGET_MS};  // detect stage's ms/frame
+    fs::path        haar_xml    {};
+    fs::path        lbp_xml     {};
+    fs::path        dnn_model   {};         // weights (i.e. .caffemodel)
+    fs::path        dnn_config  {};         // network (i.e. .prototxt)
+};
+
+/**
+ * @brief A face detection backend, times every detection it runs
+ */
+class FaceDetector {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        /**
+         * @param backend Which backend this is
+         * @param model_path The file it loads its model from
+         */
+        FaceDetector(const DetectorBackend backend, const fs::path& model_path);
+        virtual ~FaceDetector();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        DetectorBackend getBackend() const;
+        const fs::path& getModelPath() const;
+
+        /**
+         * @brief Get the measured cost (ms, moving avg) of a frame it ran on (0 = not run yet)
+         */
+        double getCostMs() const;
+
+        /**
+         * @brief Forget the measured cost (i.e. the frames it runs on changed size)
+         */
+        void resetCost();
+
+        /******************************************** Detection Functions ******************************************/
+
+        /**
+         * @brief Load the model
+         * @return Error if it could not be loaded
+         */
+        virtual ReturnCodes load() = 0;
+
+        /**
+         * @brief Find the faces in a frame (& time it)
+         * @param img The frame (BGR)
+         * @param gray_img The same frame in grayscale
+         * @param faces Set to where the faces are
+         */
+        void detect(const cv::Mat& img, const cv::Mat& gray_img, std::vector<cv::Rect>& faces);
+
+    protected:
+        /**
+         * @brief The backend's detection (each uses whichever of img/gray_img it needs)
+         */
+        virtual void runDetect(const cv::Mat& img, const cv::Mat& gray_img, std::vector<cv::Rect>& faces) = 0;
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        const DetectorBackend   backend;
+        const fs::path          model_path;
+        std::atomic<double>     cost_ms;    // moving avg of a frame it ran on
+
+}; // end of FaceDetector class
+
+/**
+ * @brief Haar & lbp cascades (same opencv api, the xml says which)
+ */
+class CascadeDetector : public FaceDetector {
+    public:
+        CascadeDetector(const DetectorBackend backend, const fs::path& xml_path);
+        virtual ~CascadeDetector();
+
+        ReturnCodes load() override;
+
+    protected:
+        void runDetect(const cv::Mat& img, const cv::Mat& gray_img, std::vector<cv::Rect>& faces) override;
+
+    private:
+        cv::CascadeClassifier   classifier;
+
+}; // end of CascadeDetector class
+
+/**
+ * @brief Opencv's ssd face model (res10 300x300) run by the dnn module on the cpu
+ */
+class DnnDetector : public FaceDetector {
+    public:
+        DnnDetector(const fs::path& model_path, const fs::path& config_path);
+        virtual ~DnnDetector();
+
+        ReturnCodes load() override;
+
+    protected:
+        void runDetect(const cv::Mat& img, const cv::Mat& gray_img, std::vector<cv::Rect>& faces) override;
+
+    private:
+        const fs::path          config_path;
+        cv::dnn::Net            net;
+
+}; // end of DnnDetector class
+
+/**
+ * @brief The loaded face detectors & which one is in use: the most accurate one that fits the budget
+ * @note Backends not run yet count as fitting, so each gets tried (& measured) once.
+ * Loading & picking are done by the detect stage's thread, the getters can be read from any thread
+ */
+class FaceDetectors {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        FaceDetectors();
+        virtual ~FaceDetectors();
+
+        FaceDetectors(const FaceDetectors&) = delete;
+        FaceDetectors& operator=(const FaceDetectors&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        bool empty() const;
+
+        /**
+         * @brief Get the detector in use (!empty())
+         */
+        FaceDetector& getActive();
+        const FaceDetector& getActive() const;
+
+        /**
+         * @brief Get if the detector in use is the least accurate (cheapest) one loaded
+         */
+        bool isActiveCheapest() const;
+
+        /**
+         * @brief Forget every detector's measured cost (i.e. the frames they run on changed size)
+         */
+        void resetCosts();
+
+        /******************************************** Detection Functions ******************************************/
+
+        /**
+         * @brief Load the detectors the config asks for
+         * @param config Which backends & their files ("auto" loads every one whose files exist)
+         * @param default_dir Where files w/o a path in the config are
+         * @param is_verbose Print what was loaded
+         * @return Error if none could be loaded (or the one asked for could not)
+         */
+        ReturnCodes load(const DetectorConfig& config, const fs::path& default_dir, const bool is_verbose);
+
+        /**
+         * @brief Switch to the most accurate detector whose cost fits the budget (the cheapest if none does)
+         * @param budget_ms The ms a frame it runs on can take
+         * @return true if it switched
+         */
+        bool pick(const double budget_ms);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        std::vector<std::unique_ptr<FaceDetector>>  detectors;  // loaded, least to most accurate
+        std::atomic<std::size_t>                    active;     // idx of the one in use
+
+}; // end of FaceDetectors class
+
+}; // end of Camera namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef RPI_FACE_TRACKER_H
+#define RPI_FACE_TRACKER_H
+
+// Standard Includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Our Includes
+#include "constants.h"
+#include "face_detector.h"
+
+// 3rd Party Includes
+#include <opencv2/imgproc.hpp> // for cvtColor(), resize() & matchTemplate()
+
+namespace RPI {
+
+namespace Camera {
+
+/**
+ * @brief Finds the faces in each frame w/o running a detector on every one: the detector runs on a scaled down
+ * frame every `interval` frames (or as soon as the whole scene jumps or a face is lost) & the faces it found are tracked
+ * in between by matching their pixels (template matching around where they were last)
+ * @note Adapts to a cpu budget (ms per frame): after each detection it switches to the most accurate detector
+ * that fits the budget (see FaceDetectors::pick()), then picks the shortest interval that averages under it.
+ * If even the cheapest detector at the longest interval does not, detection runs at a smaller scale; if detecting
+ * every frame leaves plenty of room, at a larger one.
+ * Not thread safe (owned by the detect stage), the getters can be read from any thread
+ */
+class FaceTracker {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        /**
+         * @param budget_ms The cpu time (ms) finding the faces should take per frame, averaged over the interval
+         */
+        explicit FaceTracker(const double budget_ms=Constants::Camera::DETECT_BUDGET_MS);
+        virtual ~FaceTracker();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        /**
+         * @brief Get the number of frames between detections (1 = every frame)
+         */
+        std::size_t getInterval() const;
+
+        /**
+         * @brief Get the size the detector runs at (fraction of the frame's width/height)
+         */
+        double getScale() const;
+
+        /**
+         * @brief Get the measured cost (ms) of a frame the detector ran on & of one the faces were tracked in
+         */
+        double getDetectCostMs() const;
+        double getTrackCostMs() const;
+
+        /******************************************** Tracking Functions *******************************************/
+
+        /**
+         * @brief Find the faces in a frame
+         * @param img The frame (BGR)
+         * @param detectors The face detectors to pick from (!empty())
+         * @param faces Set to where the faces are (in the frame's coordinates)
+         * @return true if the detector ran on this frame, false if the faces were tracked
+         */
+        bool update(const cv::Mat& img, FaceDetectors& detectors, std::vector<cv::Rect>& faces);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        // a face found by the detector & followed since (in the scaled frame's coordinates)
+        struct Track {
+            cv::Rect    box;
+            cv::Mat     templ;      // its pixels when it was detected
+        };
+
+        const double                budget_ms;          // cpu time per frame to stay under
+        std::vector<Track>          tracks;             // faces being followed
+        std::size_t                 since_detect;       // frames since the detector last ran
+        cv::Mat                     small_img;          // the frame at `scale` (reused every frame)
+        cv::Mat                     gray_img;           // small_img in grayscale
+        cv::Mat                     motion_img;         // tiny version of the frame
+        cv::Mat                     motion_ref;         // motion_img of the previous frame
+        cv::Mat                     match_result;       // reused by matchTemplate()
+        std::size_t                 detects_at_scale;   // detections since the scale last changed
+        std::atomic<std::size_t>    interval;           // frames between detections
+        std::atomic<double>         scale;              // size the detector runs at
+        std::atomic<double>         detect_cost_ms;     // moving avg of a frame the detector ran on
+        std::atomic<double>         track_cost_ms;      // moving avg of a frame the faces were tracked in
+
+        /********************************************* Helper Functions ********************************************/
+
+        /**
+         * @brief Get if the frame changed too much since the previous one for the tracks to follow
+         * (also updates motion_img & motion_ref)
+         */
+        bool hasMotion();
+
+        /**
+         * @brief Run the detector on small_img & start tracking what it finds
+         */
+        void detect(FaceDetector& detector);
+
+        /**
+         * @brief Follow each track to where its pixels match best near its last spot
+         * @return false if a track was lost (dropped, the detector should run again)
+         */
+        bool track();
+
+        /**
+         * @brief Picks the detector, interval & scale for the measured costs (after each detection)
+         */
+        void adapt(FaceDetectors& detectors);
+
+}; // end of FaceTracker class
+
+}; // end of Camera namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef RPI_FRAME_STAMP_H
+#define RPI_FRAME_STAMP_H
+
+// Standard Includes
+#include <chrono>
+#include <cstdint>
+
+// Our Includes
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Camera {
+
+/**
+ * @brief When a camera frame passed each hop on its way to the web app (µs on a monotonic clock, 0 = unknown)
+ * @note Filled in as the frame moves along: capture & encoded by the camera, sent by the server (queued for
+ * the subscribers), received by the client. Only capture_us & the seq travel at full precision (see
+ * HeaderPkt_t::setStamp()), the hops after it are rounded to the ms.
+ * Times taken on different machines are only comparable once converted to one clock (see Network::ClockSync)
+ */
+struct FrameStamp {
+    std::uint16_t   seq         {0};    // frame number (wraps), tells which frames were skipped
+    std::uint64_t   capture_us  {0};    // grabbed from the camera (0 = frame is not stamped)
+    std::uint64_t   encoded_us  {0};    // done being processed & jpeg encoded
+    std::uint64_t   sent_us     {0};    // queued for the camera subscribers by the server
+    std::uint64_t   recv_us     {0};    // fully received by the client
+
+    bool isStamped() const {
+        return capture_us != 0;
+    }
+
+    /**
+     * @brief Get the current time the way the hops are stamped (steady clock, so it never jumps w/ the wall clock)
+     */
+    static std::uint64_t now() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count());
+    }
+};
+
+} // end of Camera namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef RPI_FRAME_TIMING_H
+#define RPI_FRAME_TIMING_H
+
+// Standard Includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Our Includes
+#include "frame_stamp.h"
+
+// 3rd Party Includes
+#include <json.hpp>
+
+namespace RPI {
+namespace Network {
+
+using json = nlohmann::json;
+
+/**
+ * @brief Histogram of latencies (µs) w/ log-linear buckets: every power of 2 is split into SUB_BUCKETS
+ * equal buckets, so a bucket is never wider than a quarter of the values in it (0-3µs get a bucket each)
+ * @note Recording is lock-free (relaxed atomics), so one thread can record while another reads.
+ * Percentiles are only as precise as the buckets (reported as the bucket's upper bound)
+ */
+class LatencyHistogram {
+    public:
+        static constexpr std::size_t SUB_BUCKETS {4};
+        static constexpr std::size_t MAX_EXPONENT {32}; // anything >= 2^32 µs (~71 min) goes in the last bucket
+        static constexpr std::size_t NUM_BUCKETS {SUB_BUCKETS * (MAX_EXPONENT - 1)};
+
+        /********************************************** Constructors **********************************************/
+
+        LatencyHistogram();
+        virtual ~LatencyHistogram();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        std::uint64_t getCount() const;
+        std::uint64_t getMaxUs() const;
+        double getMeanUs() const;
+
+        /**
+         * @brief Get the latency a fraction of the samples were at or under
+         * @param fraction i.e. 0.99 for the p99
+         * @return The upper bound of the bucket the percentile falls in (µs, 0 if nothing was recorded)
+         */
+        std::uint64_t getPercentileUs(const double fraction) const;
+
+        /**
+         * @brief Get the number of samples in each bucket
+         */
+        std::array<std::uint64_t, NUM_BUCKETS> getBuckets() const;
+
+        /****************************************** Recording Functions ****************************************/
+
+        void record(const std::uint64_t latency_us);
+        void reset();
+
+        /**
+         * @brief Get the bucket a latency falls in
+         */
+        static std::size_t getBucket(const std::uint64_t latency_us);
+
+        /**
+         * @brief Get the largest latency that falls in a bucket (µs)
+         */
+        static std::uint64_t getBucketMaxUs(const std::size_t bucket);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        std::array<std::atomic<std::uint64_t>, NUM_BUCKETS> buckets;
+        std::atomic<std::uint64_t>  count;          // number of samples recorded
+        std::atomic<std::uint64_t>  sum_us;         // for the mean
+        std::atomic<std::uint64_t>  max_us;         // worst sample
+
+}; // end of LatencyHistogram class
+
+/**
+ * @brief The hops of a camera frame's trip, each one timed from the previous hop (see Camera::FrameStamp)
+ */
+enum class FrameStage : std::uint8_t {
+    Encode,     // capture -> encoded (includes face detection & scaling)
+    Send,       // encoded -> queued for the subscribers by the server
+    Recv,       // queued -> fully received by the client (network & the server's send queue)
+    Serve,      // received -> handed to the web app (how old the frame is by the time it is shown)
+    Total,      // capture -> handed to the web app
+};
+
+constexpr std::size_t NUM_FRAME_STAGES {static_cast<std::size_t>(FrameStage::Total) + 1};
+
+/**
+ * @brief Get a stage's name (i.e. "capture->encode")
+ */
+std::string getFrameStageName(const FrameStage stage);
+
+/**
+ * @brief Per stage latency histograms of the camera frames (where the latency from camera to screen comes from)
+ * @note Safe to record from one thread (i.e. the client's reactor) while another serves/records (the web app)
+ */
+class FrameTimings {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        FrameTimings();
+        virtual ~FrameTimings();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        const LatencyHistogram& getStage(const FrameStage stage) const;
+
+        /**
+         * @brief Get the number of frames that never arrived between two received ones (from gaps in the seq)
+         */
+        std::uint64_t getNumSkipped() const;
+
+        /**
+         * @brief Get every stage's count, mean, percentiles (ms) & non-empty buckets (upper bound in µs -> count)
+         */
+        json toJson() const;
+
+        /****************************************** Recording Functions ****************************************/
+
+        /**
+         * @brief Records the stages up to the client for a frame that was just received
+         * @param stamp The frame's stamp w/ recv_us filled in (unstamped frames are ignored)
+         */
+        void recordReceived(const Camera::FrameStamp& stamp);
+
+        /**
+         * @brief Records the serve & total stages for a frame handed to the web app
+         * @param stamp The frame's stamp (unstamped frames are ignored)
+         * @param served_us When it was served (Camera::FrameStamp::now())
+         * @note Every request is a sample, so a frame served twice is counted twice (w/ how old it was by then)
+         */
+        void recordServed(const Camera::FrameStamp& stamp, const std::uint64_t served_us);
+
+        void reset();
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        std::array<LatencyHistogram, NUM_FRAME_STAGES> stages;
+        std::atomic<std::uint64_t>  num_skipped;    // frames missing between received seqs
+        std::atomic<std::int32_t>   last_seq;       // seq of the last received frame (-1 = none yet)
+
+        void record(const FrameStage stage, const std::uint64_t from_us, const std::uint64_t to_us);
+
+}; // end of FrameTimings class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
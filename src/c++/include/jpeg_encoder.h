@@ -0,0 +1,98 @@
+#ifndef RPI_JPEG_ENCODER_H
+#define RPI_JPEG_ENCODER_H
+
+// Standard Includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Our Includes
+#include "constants.h"
+
+// 3rd Party Includes
+#include <opencv2/core.hpp> // for cv::Mat
+
+namespace RPI {
+
+namespace Camera {
+
+/**
+ * @brief Encodes frames to jpeg on several cores at once (libjpeg-turbo): the frame is cut into horizontal strips,
+ * each strip is encoded by its own thread & the strips are stitched into one baseline jpeg, separated by restart
+ * markers (the restart interval is a strip's worth of MCUs, so every decoder reads it as a single image)
+ * @note Every strip is encoded w/ the same (standard) huffman & quantization tables, so only the first strip's
+ * headers are kept. The threads & their compressors/output buffers live as long as the encoder (nothing is
+ * allocated per frame once the buffers grew to fit). Not thread safe (one frame at a time)
+ */
+class JpegEncoder {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        /**
+         * @param num_strips The most strips (& threads, the calling thread encodes the first) a frame is cut into
+         */
+        explicit JpegEncoder(const std::size_t num_strips=Constants::Camera::JPEG_ENCODE_STRIPS);
+        virtual ~JpegEncoder();
+
+        JpegEncoder(const JpegEncoder&) = delete;
+        JpegEncoder& operator=(const JpegEncoder&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        std::size_t getNumStrips() const;
+
+        /******************************************** Encoding Functions *******************************************/
+
+        /**
+         * @brief Encode a frame
+         * @param img The frame (8 bit BGR)
+         * @param quality The jpeg quality (1-100)
+         * @param out Set to the jpeg (its capacity is reused, so pass the same vector every frame)
+         * @return Error if the frame is not 8 bit BGR or libjpeg failed
+         */
+        ReturnCodes encode(const cv::Mat& img, const int quality, std::vector<unsigned char>& out);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        struct Strip; // a strip's compressor & output buffer (libjpeg types stay in the .cpp)
+
+        std::vector<std::unique_ptr<Strip>> strips;         // strips[0] is encoded by the calling thread
+        std::vector<std::thread>            workers;        // workers[i] encodes strips[i + 1]
+
+        // the frame being encoded (set by encode() under job_mutex)
+        std::mutex                          job_mutex;
+        std::condition_variable             job_cv;         // a new frame or exit
+        std::condition_variable             done_cv;        // a worker finished its strip
+        std::uint64_t                       job_gen;        // bumped every frame
+        std::size_t                         num_active;     // strips the frame is cut into
+        std::size_t                         num_pending;    // workers' strips not done yet
+        const cv::Mat*                      job_img;
+        int                                 job_quality;
+        unsigned int                        job_restart;    // MCUs per strip (the restart interval)
+        bool                                should_exit;
+
+        /********************************************* Helper Functions ********************************************/
+
+        /**
+         * @brief A worker's loop, encodes strips[strip_idx] of every frame it is part of
+         */
+        void RunWorker(const std::size_t strip_idx);
+
+        /**
+         * @brief Stitch the active strips into one jpeg
+         * @return Error if a strip's jpeg could not be parsed
+         */
+        ReturnCodes Stitch(std::vector<unsigned char>& out, const int height) const;
+
+}; // end of JpegEncoder class
+
+}; // end of Camera namespace
+
+}; // end of RPI namespace
+
+#endif
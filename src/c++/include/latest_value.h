@@ -0,0 +1,200 @@
+#ifndef RPI_LATEST_VALUE_H
+#define RPI_LATEST_VALUE_H
+
+// Standard Includes
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread> // for yield
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+// Our Includes
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Mailbox that always holds the most recently published value of T
+ * @tparam T The value type (i.e. a packet struct or a ref-counted frame handle)
+ * @tparam NumSlots The number of buffers values are published into (>= 3, more means writers wait less often)
+ * @note Readers never take a lock or wait for a writer: they pin the current slot & get a stable
+ * snapshot of it (value + generation) without copying the value. Writers publish into a slot no reader
+ * has pinned & then atomically make it the current one, so a reader holding an older snapshot is never
+ * written over. Writers are serialized amongst themselves (only writers can ever wait, and only if every
+ * spare slot is pinned)
+ */
+template <typename T, std::size_t NumSlots=4>
+class LatestValue {
+    static_assert(NumSlots >= 3 && NumSlots <= 256, "need a current slot, a slot to write & a spare (idx is 8 bits)");
+
+    private:
+        struct Slot {
+            T                               value   {};
+            mutable std::atomic<std::uint32_t> readers {0}; // number of snapshots pinning this slot
+        };
+
+    public:
+        /**
+         * @brief A pinned, read-only view of a published value (keep it short lived, it holds the slot)
+         */
+        class Snapshot {
+            public:
+                Snapshot(Snapshot&& other) noexcept
+                    : slot{std::exchange(other.slot, nullptr)}
+                    , generation{other.generation}
+                {
+                    // stub
+                }
+
+                Snapshot& operator=(Snapshot&& other) noexcept {
+                    if (this != &other) {
+                        release();
+                        slot        = std::exchange(other.slot, nullptr);
+                        generation  = other.generation;
+                    }
+                    return *this;
+                }
+
+                Snapshot(const Snapshot&) = delete;
+                Snapshot& operator=(const Snapshot&) = delete;
+
+                ~Snapshot() {
+                    release();
+                }
+
+                const T& get() const { return slot->value; }
+                const T& operator*() const { return slot->value; }
+                const T* operator->() const { return &slot->value; }
+
+                /**
+                 * @brief How many values had been published when this one was (starts at 1 for the initial value)
+                 */
+                std::uint64_t getGeneration() const { return generation; }
+
+            private:
+                friend class LatestValue;
+
+                Snapshot(const Slot* pinned_slot, const std::uint64_t gen)
+                    : slot{pinned_slot}
+                    , generation{gen}
+                {
+                    // stub
+                }
+
+                void release() {
+                    if (slot) slot->readers.fetch_sub(1);
+                    slot = nullptr;
+                }
+
+                const Slot*     slot;       // the pinned slot (nullptr if moved from)
+                std::uint64_t   generation; // generation of the value in the slot
+        }; // end of Snapshot class
+
+        /********************************************** Constructors **********************************************/
+
+        /**
+         * @param initial The value readers get until the first publish() (generation 1)
+         */
+        explicit LatestValue(T initial={})
+            : slots{}
+            , current{pack(1, 0)}
+            , write_mutex{}
+        {
+            slots[0].value = std::move(initial);
+        }
+
+        LatestValue(const LatestValue&) = delete;
+        LatestValue& operator=(const LatestValue&) = delete;
+
+        /********************************************* Reader Functions *********************************************/
+
+        /**
+         * @brief Get a snapshot of the latest value (lock-free, no copy)
+         */
+        Snapshot read() const {
+            while (true) {
+                const std::uint64_t curr {current.load()};
+                const Slot& slot {slots[unpackIdx(curr)]};
+                slot.readers.fetch_add(1);
+
+                // still current after pinning -> no writer can pick this slot until it is released
+                // (generation is part of `current`, so a slot that was reused in between does not match)
+                if (current.load() == curr) {
+                    return Snapshot{&slot, unpackGen(curr)};
+                }
+                slot.readers.fetch_sub(1);
+            }
+        }
+
+        /**
+         * @brief Copy out the latest value
+         * @param generation (optional) Set to the value's generation
+         */
+        T load(std::uint64_t* generation=nullptr) const {
+            const Snapshot snapshot {read()};
+            if (generation) *generation = snapshot.getGeneration();
+            return snapshot.get();
+        }
+
+        /**
+         * @brief Get the generation of the latest value (changes every publish())
+         */
+        std::uint64_t getGeneration() const {
+            return unpackGen(current.load());
+        }
+
+        /********************************************* Writer Functions *********************************************/
+
+        /**
+         * @brief Make a new value the latest one (readers holding older snapshots are unaffected)
+         * @return The new value's generation
+         */
+        std::uint64_t publish(T new_value) {
+            std::unique_lock<std::mutex> lk{write_mutex};
+            const std::uint64_t curr {current.load()};
+
+            // find a slot that is neither current nor pinned by a reader
+            std::size_t free_idx {NumSlots};
+            while (free_idx == NumSlots) {
+                for (std::size_t idx {0}; idx < NumSlots; ++idx) {
+                    if (idx != unpackIdx(curr) && slots[idx].readers.load() == 0) {
+                        free_idx = idx;
+                        break;
+                    }
+                }
+                if (free_idx == NumSlots) std::this_thread::yield();
+            }
+
+            // previous value in the slot is released here (writer side, never while a reader holds it)
+            slots[free_idx].value = std::move(new_value);
+            const std::uint64_t new_gen {unpackGen(curr) + 1};
+            current.store(pack(new_gen, free_idx));
+            return new_gen;
+        }
+
+    private:
+        static constexpr std::uint64_t pack(const std::uint64_t gen, const std::size_t idx) {
+            return (gen << 8) | static_cast<std::uint64_t>(idx);
+        }
+        static constexpr std::size_t unpackIdx(const std::uint64_t packed) {
+            return static_cast<std::size_t>(packed & 0xFF);
+        }
+        static constexpr std::uint64_t unpackGen(const std::uint64_t packed) {
+            return packed >> 8;
+        }
+
+        std::array<Slot, NumSlots>  slots;          // values readers can pin (only 1 is current at a time)
+        std::atomic<std::uint64_t>  current;        // generation (high 56 bits) & index (low 8 bits) of current slot
+        std::mutex                  write_mutex;    // serializes writers (readers never touch it)
+
+}; // end of LatestValue class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
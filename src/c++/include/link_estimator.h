@@ -0,0 +1,138 @@
+#ifndef RPI_LINK_ESTIMATOR_H
+#define RPI_LINK_ESTIMATOR_H
+
+// Standard Includes
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Our Includes
+#include "constants.h"
+#include "video_ladder.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Estimates how fast a connection drains & how long newly sent data waits before reaching the peer
+ * @note Data handed to the connection (addQueued()) is either still in its MsgWriter, in the kernel's send
+ * queue (SIOCOUTQ) or delivered. Throughput is measured from the delivered bytes while the connection is
+ * backlogged; while it is idle the congestion window (TCP_INFO cwnd * mss / rtt) bounds it instead.
+ * Not thread safe (meant to be driven by a single reactor thread)
+ */
+class LinkEstimator {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /********************************************** Constructors **********************************************/
+
+        LinkEstimator();
+        virtual ~LinkEstimator();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        /**
+         * @brief Get the estimated throughput of the connection in bytes/sec (0 until it has been measured)
+         */
+        double getThroughput() const;
+
+        /**
+         * @brief Get the number of bytes not yet delivered as of the last sample()
+         */
+        std::size_t getBacklog() const;
+
+        /**
+         * @brief Get how long data sent now would take to reach the peer (backlog / throughput + rtt/2)
+         * @note As of the last sample()
+         */
+        std::chrono::milliseconds getQueueDelay() const;
+
+        /**
+         * @brief Get how long data sent now would take to reach the peer, w/ a fresh read of the kernel's queue
+         * @param sock_fd The connection's socket
+         * @param writer_unsent The bytes of the current message its MsgWriter has not handed to the kernel yet
+         */
+        std::chrono::milliseconds getQueueDelay(const int sock_fd, const std::size_t writer_unsent) const;
+
+        /****************************************** Estimation Functions ****************************************/
+
+        /**
+         * @brief Record bytes handed to the connection's MsgWriter (header + data)
+         */
+        void addQueued(const std::size_t num_bytes);
+
+        /**
+         * @brief Measure the connection (call about every Constants::Network::RATE_SAMPLE_MS)
+         * @param sock_fd The connection's socket
+         * @param writer_unsent The bytes of the current message its MsgWriter has not handed to the kernel yet
+         * @param now The current time
+         */
+        void sample(const int sock_fd, const std::size_t writer_unsent, const clock::time_point now);
+
+        /**
+         * @brief Get the number of bytes waiting in a socket's send queue (SIOCOUTQ, 0 if unknown)
+         */
+        static std::size_t getSendQueueSize(const int sock_fd);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        std::uint64_t               queued_total;   // bytes ever handed to the connection
+        std::uint64_t               delivered_total;// bytes delivered as of the last sample
+        std::size_t                 backlog;        // bytes not yet delivered as of the last sample
+        double                      throughput;     // smoothed bytes/sec (0 = not measured yet)
+        std::chrono::microseconds   rtt;            // kernel's smoothed round trip time (0 if not tcp)
+        clock::time_point           sampled_at;     // when sample() last ran (epoch = never)
+
+}; // end of LinkEstimator class
+
+/**
+ * @brief Picks the VIDEO_LADDER rung the camera encodes at from the worst queue delay of its subscribers
+ * @note Steps down (faster if the delay is far over the target) as soon as frames wait longer than
+ * Constants::Camera::TARGET_LATENCY_MS, & only steps back up once the delay stayed well under it for
+ * Constants::Network::RATE_UP_HOLD_MS (so it does not flap between two rungs)
+ */
+class VideoRateController {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /********************************************** Constructors **********************************************/
+
+        VideoRateController();
+        virtual ~VideoRateController();
+
+        /********************************************* Getters/Setters *********************************************/
+
+        std::size_t getRung() const;
+
+        /**
+         * @brief Go back to the best rung (i.e. no one is watching)
+         */
+        void reset();
+
+        /****************************************** Control Functions ****************************************/
+
+        /**
+         * @brief Feed the latest queue delay measurement
+         * @param queue_delay The worst queue delay of the camera subscribers
+         * @param now The current time
+         * @return The rung to encode at
+         */
+        std::size_t update(const std::chrono::milliseconds queue_delay, const clock::time_point now);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        std::size_t                 rung;           // current VIDEO_LADDER index (0 = best)
+        clock::time_point           changed_at;     // when the rung last changed
+        clock::time_point           calm_since;     // since when the delay has been well under the target
+
+}; // end of VideoRateController class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,403 @@
+#ifndef RPI_NET_CONN_H
+#define RPI_NET_CONN_H
+
+// Standard Includes
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <cerrno>
+#include <iostream>
+#include <algorithm> // for std::min
+#include <sys/socket.h>
+#include <sys/uio.h> // for iovec
+#include <array>
+
+// Our Includes
+#include "constants.h"
+#include "packet.h"
+#include "buffer_pool.h"
+#include "zero_copy.h"
+#include "link_estimator.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+// the kinds of connections between the server & client (used for per-channel settings)
+enum class Channel : std::uint8_t {
+    Control = 0,    // client -> server control pkts
+    Camera  = 1,    // server -> client camera frames
+    SrvData = 2,    // server -> client server data pkts
+};
+constexpr std::size_t NUM_CHANNELS {3};
+
+/**
+ * @brief Get how urgent a channel's messages are (stored in HeaderPkt_t::tos, lower is more urgent)
+ * @note Decides which channel's fragment goes next when every channel shares one connection (Transport::Mux)
+ */
+constexpr std::uint8_t channelPriority(const Channel channel) {
+    return channel == Channel::Control ? 0 : (channel == Channel::SrvData ? 1 : 2);
+}
+
+// how the server & client reach each other
+enum class Transport : std::uint8_t {
+    Tcp,    // every channel over tcp (reliable & ordered, a lost segment holds up every later pkt)
+    Udp,    // control & server data as datagrams, newest state wins (camera frames stay on tcp)
+    Local,  // same machine: control & server data over unix sockets, camera frames through shared memory
+    Mux,    // every channel over a single tcp connection on the control port (see MuxWriter/MuxReader)
+};
+
+// how the client's stream sockets are read (see UringEngine)
+enum class IoEngine : std::uint8_t {
+    Posix,  // a recv() per header/data chunk
+    Uring,  // multishot io_uring recv into provided buffers (falls back to Posix if the kernel lacks it)
+};
+
+// holds the return of recvData(), check the "RtnCode" attribute to see if any errors occured
+enum class RecvSendRtnCodes {
+    Error,
+    ClosedConn,
+    Success,
+    WouldBlock,     // non-blocking socket has no more data/room right now (try again once epoll says so)
+};
+
+struct RecvRtn {
+    PooledBuf           buf;   // the data received via the socket (buf->size() for size, nullptr unless Success)
+    RecvSendRtnCodes    RtnCode;
+    HeaderPkt_t         header; // the header that preceded the data (i.e. header.protocol = PktEncoding)
+};
+
+struct SendRtn {
+    std::uint32_t       size;   // the size of the  sent data -- pinned to uint32_t bc thats max send size currently
+    RecvSendRtnCodes    RtnCode;
+};
+
+/**
+ * @brief A message ready to be sent (header already filled in) that can be shared by several connections
+ */
+struct OutMsg {
+    HeaderPkt_t                 header      {};         // the header to send before the data
+    const void*                 data        {nullptr};  // the data to send (owned by keepalive)
+    std::uint32_t               size        {0};        // the number of data bytes
+    std::shared_ptr<const void> keepalive   {nullptr};  // keeps `data` alive while any connection sends it
+};
+
+/**
+ * @brief Incrementally reads messages (header + data) from a non-blocking socket
+ * @note Keeps its progress between calls, so a message can arrive over any number of readiness events
+ */
+class MsgReader {
+    public:
+        MsgReader();
+        virtual ~MsgReader();
+
+        /**
+         * @brief Reads as much of the current message as is available
+         * @param sock_fd The non-blocking socket to read from
+         * @param pool The buffer pool to receive the message's data into
+         * @param num_syscalls (optional) Incremented for every recv() it makes
+         * @return Success with the message once it fully arrived, WouldBlock if more data is needed,
+         * ClosedConn/Error if the connection is done. Messages too large for the pool are drained & return Error
+         * (the stream stays in sync, so reading can continue)
+         */
+        RecvRtn readSome(const int sock_fd, BufferPool& pool, std::uint64_t* num_syscalls=nullptr);
+
+        /**
+         * @brief Forget any partially read message (i.e. after reconnecting)
+         */
+        void reset();
+
+    private:
+        std::uint8_t        header_buf[HeaderPkt_t::WIRE_SIZE]; // header bytes received so far
+        std::size_t         header_rx;      // number of header bytes received
+        HeaderPkt_t         header;         // parsed header of the message in progress
+        PooledBuf           data_buf;       // buffer the message's data is received into
+        std::size_t         data_rx;        // number of data bytes received
+        bool                discarding;     // true if the message was too large & is being drained
+};
+
+/**
+ * @brief Incrementally writes a message (header + data) to a non-blocking socket
+ * @note Holds a handle to the data until it has been fully sent (and the kernel is done w/ zero copy sends)
+ */
+class MsgWriter {
+    public:
+        MsgWriter();
+        virtual ~MsgWriter();
+
+        /**
+         * @brief Determine if a message is still being written
+         */
+        bool isBusy() const;
+
+        /**
+         * @brief Get the number of bytes of the current message (header + data) not handed to the kernel yet
+         */
+        std::size_t getUnsentSize() const;
+
+        /**
+         * @brief Queue up a message to be written by writeSome()
+         * @param header The message's header (already filled in)
+         * @param data The data to send after the header
+         * @param size The number of data bytes
+         * @param keepalive Handle that owns data (data must stay valid until the message is sent if null)
+         */
+        void start(const HeaderPkt_t& header, const void* data, const std::uint32_t size,
+                   std::shared_ptr<const void> keepalive);
+        void start(const OutMsg& msg);
+
+        /**
+         * @brief Writes as much of the current message as the socket will take
+         * @param sock_fd The non-blocking socket to write to
+         * @param zc_tracker (optional) If set, large messages are sent with MSG_ZEROCOPY & tracked by it
+         * @return Success once the message is fully sent, WouldBlock if wait for EPOLLOUT, Error if conn is done
+         */
+        SendRtn writeSome(const int sock_fd, ZeroCopyTracker* zc_tracker);
+
+        /**
+         * @brief Drop the message in progress (i.e. after the connection closed)
+         */
+        void reset();
+
+    private:
+        std::uint8_t                header_buf[HeaderPkt_t::WIRE_SIZE]; // packed header of current message
+        const std::uint8_t*         data;           // the current message's data
+        std::uint32_t               data_size;      // number of data bytes in the current message
+        std::shared_ptr<const void> keepalive;      // keeps `data` alive while it is being sent
+        std::size_t                 total_sent;     // bytes sent so far (header + data)
+        bool                        busy;           // true while a message is queued/being sent
+};
+
+/**
+ * @brief Compact header that precedes every fragment when all channels share one connection (Transport::Mux)
+ * @note Carries the parts of HeaderPkt_t the receiver uses (+ channel & priority) in half the bytes:
+ * 1B channel (4 bits) | priority (4 bits), 1B flags (4 bits) | encoding (4 bits), 2B fragment length,
+ * 4B message length, 4B CRC32C of the whole message (network byte order).
+ * A message's first fragment (its channel has no message in progress) has STAMP_SIZE more header bytes: 8B origin
+ * time, 2B seq, 2B send delay (ms), 1B encode time (ms), i.e. HeaderPkt_t's stamp (see HeaderPkt_t::setStamp()).
+ * Messages are split into fragments of at most Constants::Network::MUX_FRAG_SIZE bytes, the last one is flagged FIN.
+ * Fragments of different channels interleave, those of one channel always arrive in order
+ */
+struct MuxHeader {
+    Channel         channel     {Channel::Control};
+    std::uint8_t    priority    {0};    // HeaderPkt_t::tos (lower is more urgent)
+    std::uint8_t    flags       {0};    // FLAG_*
+    std::uint8_t    protocol    {0};    // HeaderPkt_t::protocol (see PktEncoding)
+    std::uint16_t   frag_len    {0};    // number of data bytes in this fragment
+    std::uint32_t   msg_len     {0};    // number of data bytes in the whole message
+    std::uint32_t   checksum    {0};    // HeaderPkt_t::checksum (of the whole message)
+    bool            has_stamp   {false};// first fragment of the message (the fields below are on the wire)
+    std::uint64_t   origin_us   {0};    // HeaderPkt_t::getOriginTime() (frame's capture/control pkt's send time)
+    std::uint16_t   seq         {0};    // HeaderPkt_t::id (frame/server data seq)
+    std::uint16_t   send_ms     {0};    // HeaderPkt_t's fragment-offset (frame's send delay)
+    std::uint8_t    encode_ms   {0};    // HeaderPkt_t::ttl (frame's encode time)
+
+    static constexpr std::size_t    WIRE_SIZE           {12};
+    static constexpr std::size_t    STAMP_SIZE          {13};   // extra bytes of a message's first fragment
+    static constexpr std::size_t    MAX_WIRE_SIZE       {WIRE_SIZE + STAMP_SIZE};
+    static constexpr std::uint8_t   FLAG_FIN            {0x1};  // last fragment of the message
+    static constexpr std::uint8_t   FLAG_NO_CHECKSUM    {0x2};  // sender skipped the checksum
+    static constexpr std::uint8_t   FLAG_SESSION        {0x4};  // message is a session hello (HeaderPkt_t::FLAG_SESSION)
+    static constexpr std::uint8_t   FLAG_CLOCK          {0x8};  // message is a clock ping/pong (HeaderPkt_t::FLAG_CLOCK)
+
+    MuxHeader();
+
+    /**
+     * @brief Build the header for a fragment of a message
+     * @param header The message's header (from TcpBase::makeHeader())
+     * @param offset Where the fragment starts in the message's data
+     */
+    MuxHeader(const HeaderPkt_t& header, const std::uint32_t offset);
+
+    /**
+     * @brief Reads WIRE_SIZE bytes (the stamp follows if it is the message's first fragment, see unpackStamp())
+     */
+    explicit MuxHeader(const std::uint8_t* wire_buf);
+
+    /**
+     * @brief Reads the STAMP_SIZE bytes after the first WIRE_SIZE bytes of a message's first fragment
+     */
+    void unpackStamp(const std::uint8_t* wire_buf);
+
+    /**
+     * @brief Writes getHeaderSize() bytes
+     */
+    void pack(std::uint8_t* wire_buf) const;
+
+    /**
+     * @brief Get the number of bytes the header takes up on the wire (WIRE_SIZE + the stamp if it has one)
+     */
+    std::size_t getHeaderSize() const;
+
+    /**
+     * @brief Get the message's header as if it arrived on its own connection
+     */
+    HeaderPkt_t toHeader() const;
+
+    bool isFin() const;
+
+    /**
+     * @brief Determine if the fields are possible at all (anything else means the stream is out of sync)
+     */
+    bool isValid() const;
+};
+
+// buffer pool each channel's messages are received into (nullptr = channel not expected, its messages are dropped)
+using MuxPools = std::array<BufferPool*, NUM_CHANNELS>;
+
+/**
+ * @brief Incrementally reads the interleaved fragments of every channel from a non-blocking socket & reassembles them
+ * @note Keeps its progress between calls, so fragments can arrive over any number of readiness events
+ */
+class MuxReader {
+    public:
+        MuxReader();
+        virtual ~MuxReader();
+
+        /**
+         * @brief Reads until a whole message (of any channel) has been reassembled or the socket is drained
+         * @param sock_fd The non-blocking socket to read from
+         * @param pools The buffer pool to receive each channel's messages into
+         * @param num_syscalls (optional) Incremented for every recv() it makes
+         * @return Success w/ the message (header.channel says which) once its last fragment arrived,
+         * WouldBlock if more data is needed, ClosedConn/Error if the connection is done (ClosedConn also if a header
+         * is malformed, since the stream is out of sync). Messages too large for their pool (or for a channel w/o one)
+         * are drained & return Error (the stream stays in sync, so reading can continue)
+         */
+        RecvRtn readSome(const int sock_fd, const MuxPools& pools, std::uint64_t* num_syscalls=nullptr);
+
+        /**
+         * @brief Forget any partially read messages (i.e. after reconnecting)
+         */
+        void reset();
+
+    private:
+        // a channel's message being reassembled
+        struct Assembly {
+            PooledBuf       buf         {nullptr};  // buffer the message's data is received into
+            std::uint32_t   msg_len     {0};        // size of the whole message
+            std::uint32_t   rx          {0};        // number of data bytes received (of completed fragments)
+            bool            active      {false};    // true once its first fragment arrived
+            bool            discarding  {false};    // true if the message is refused/malformed & is being drained
+            HeaderPkt_t     header      {};         // from the first fragment's header (w/ the message's stamp)
+        };
+
+        std::uint8_t        header_buf[MuxHeader::MAX_WIRE_SIZE]; // header bytes received so far
+        std::size_t         header_rx;      // number of header bytes received
+        std::size_t         header_len;     // number of header bytes expected (WIRE_SIZE until the stamp is known)
+        MuxHeader           frag;           // parsed header of the fragment in progress
+        std::size_t         frag_rx;        // number of the fragment's data bytes received
+        std::array<Assembly, NUM_CHANNELS> assemblies; // per channel message in progress
+};
+
+/**
+ * @brief Sends a message per channel over one non-blocking socket, a fragment at a time
+ * @note Every fragment goes to the most urgent channel (lowest HeaderPkt_t::tos) that has something queued & a
+ * fragment is only handed to the kernel while less than Constants::Network::MUX_NOTSENT_LOWAT bytes sit unsent in
+ * the socket (SIOCOUTQNSD), so a control pkt only ever waits behind about a fragment instead of a whole camera frame
+ * (or the megabytes of frames an unbounded send buffer would hold). Tune the socket w/ SockTuning::tune(.., true)
+ * so it only polls writable below the same mark & turn the check off w/ setNotSentGate(false) if that failed
+ * (otherwise a reactor waiting for EPOLLOUT spins while the kernel drains).
+ * Each channel holds one message, so callers queue the next once it is done.
+ * Holds a handle to each message's data until it has been fully sent
+ */
+class MuxWriter {
+    public:
+        MuxWriter();
+        virtual ~MuxWriter();
+
+        /**
+         * @brief Determine if any channel still has a message being written
+         */
+        bool isBusy() const;
+
+        /**
+         * @brief Determine if a channel still has a message being written (queue its next one once it does not)
+         */
+        bool isBusy(const Channel channel) const;
+
+        /**
+         * @brief Get the number of bytes (headers + data) of the queued messages not handed to the kernel yet
+         */
+        std::size_t getUnsentSize() const;
+
+        /**
+         * @brief Get the number of bytes a message takes up on the wire (data + a header per fragment + the stamp)
+         */
+        static std::size_t getWireSize(const std::uint32_t size);
+
+        /**
+         * @brief Set whether writeSome() holds fragments back while the kernel has MUX_NOTSENT_LOWAT unsent bytes
+         * @param enabled true (default) if the socket's TCP_NOTSENT_LOWAT is set to match (see TcpBase::tuneSock())
+         * or the caller waits on a timer instead of writability, false if it waits for EPOLLOUT on a socket
+         * w/o the low water mark (the kernel's queue is then unbounded, but the caller does not spin)
+         */
+        void setNotSentGate(const bool enabled);
+
+        /**
+         * @brief Queue up a message to be written by writeSome()
+         * @param msg The message (header.channel says which channel it is for)
+         * @return Error if header.channel is not a channel (nothing is queued)
+         * @note Only call once isBusy(channel) is false (otherwise the receiver would get half of the old message)
+         */
+        ReturnCodes start(const OutMsg& msg);
+
+        /**
+         * @brief Writes fragments (most urgent channel first) until everything is sent or the socket is full
+         * (holds MUX_NOTSENT_LOWAT unsent bytes)
+         * @param sock_fd The non-blocking socket to write to
+         * @return Success once every queued message is sent, WouldBlock if wait for EPOLLOUT, Error if conn is done
+         */
+        SendRtn writeSome(const int sock_fd);
+
+        /**
+         * @brief Drop every message in progress (i.e. after the connection closed)
+         */
+        void reset();
+
+    private:
+        // a channel's message being sent
+        struct Slot {
+            OutMsg          msg         {};         // the message (keepalive holds its data)
+            std::uint32_t   offset      {0};        // data bytes of the message sent (of completed fragments)
+            bool            busy        {false};    // true while the message is queued/being sent
+        };
+
+        std::array<Slot, NUM_CHANNELS> slots;       // per channel message in progress
+        std::uint8_t        header_buf[MuxHeader::MAX_WIRE_SIZE]; // packed header of the fragment being sent
+        std::size_t         header_len;     // number of bytes in header_buf
+        std::size_t         frag_slot;      // index of the slot the fragment being sent belongs to
+        std::size_t         frag_len;       // data bytes in the fragment being sent
+        std::size_t         frag_sent;      // bytes of the fragment sent (header + data)
+        bool                frag_active;    // true while a fragment is partially sent
+        bool                notsent_gate;   // true if fragments wait for the kernel's unsent bytes to drain
+
+        /**
+         * @brief Get the slot whose fragment should go next (nullptr if nothing is queued)
+         */
+        Slot* pickNext();
+};
+
+/**
+ * @brief A non-blocking connection driven by a reactor (socket + its in-progress reads/writes)
+ */
+struct NetConn {
+    int         sock_fd         {-1};       // the connected socket (-1 if not connected)
+    MsgReader   reader          {};         // partially received message
+    MsgWriter   writer          {};         // partially sent message
+    bool        wait_writable   {false};    // true while the reactor is waiting for EPOLLOUT on sock_fd
+    std::uint64_t send_cursor   {0};        // sequence number of the next broadcast msg to send (see BroadcastRing)
+    std::chrono::steady_clock::time_point last_rx {}; // when the last message arrived on this connection
+    LinkEstimator link          {};         // how fast the connection drains (camera subscribers)
+    MuxReader   mux_reader      {};         // every channel's partially received messages (Transport::Mux)
+    MuxWriter   mux_writer      {};         // every channel's partially sent messages (Transport::Mux)
+    std::uint64_t srv_cursor    {0};        // send_cursor of the server data channel (Transport::Mux, camera uses send_cursor)
+    std::uint32_t session       {0};        // token from the client's session hello (0 until it arrived)
+};
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
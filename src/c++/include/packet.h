@@ -12,9 +12,19 @@
 #include <sstream> // for converting packets to strings
 #include <condition_variable> // block with mutex until new data set
 #include <atomic>
+#include <memory>
+#include <cstring> // for memcpy
+#include <stdexcept> // for malformed binary packets
+#include <cstddef> // for offsetof
+#include <type_traits>
+#include <sys/eventfd.h> // to wake up reactors when new data is set
+#include <unistd.h> // for close()
 
 // Our Includes
 #include "constants.h"
+#include "latest_value.h"
+#include "frame_stamp.h"
+#include "checksum.h"
 
 // 3rd Party Includes
 #include <json.hpp>
@@ -112,23 +122,52 @@ struct SrvDataPkt {
 // https://en.wikipedia.org/wiki/IPv4#Header
 // mostly only checking/using total_length & checksum
 struct HeaderPkt_t {
-    std::uint8_t    ver_ihl;        // 4 bits version and 4 bits internet header length (ver=IPv<#>)
-    std::uint8_t    tos;            // type of service
-    std::uint32_t   total_length;   // typically uint16_t but camera frames are very large (>100,000)
-    std::uint16_t   id;             // 
-    std::uint16_t   flags_fo;       // 3 bits flags and 13 bits fragment-offset
-    std::uint8_t    ttl;            // time to live
-    std::uint8_t    protocol;       // 
-    std::uint16_t   checksum;       //
-    std::uint32_t   src_addr;       // 
-    std::uint32_t   dst_addr;       //
+    std::uint8_t    ver_ihl         {0};    // 4 bits version and 4 bits internet header length (ver=IPv<#>)
+    std::uint8_t    tos             {0};    // type of service (message priority, lower is more urgent)
+    std::uint32_t   total_length    {0};    // typically uint16_t but camera frames are very large (>100,000)
+    std::uint16_t   id              {0};    // camera frames: frame seq (see setStamp())
+    std::uint16_t   flags_fo        {0};    // 3 bits flags and 13 bits fragment-offset (camera frames: send delay)
+    std::uint8_t    ttl             {0};    // time to live (camera frames: encode time)
+    std::uint8_t    protocol        {0};    // how the payload is encoded (see PktEncoding)
+    std::uint32_t   checksum        {0};    // CRC32C of the data (see CalcChecksum())
+    std::uint32_t   src_addr        {0};    // origin time (upper 32 bits): camera frames' capture, control pkts' send
+    std::uint32_t   dst_addr        {0};    // origin time (lower 32 bits)
+    std::uint8_t    channel         {0};    // Channel the message is for (only on the wire in mux framing, see MuxHeader)
+
+    // number of bytes the header takes up on the wire (fields are packed w/o padding in network byte order)
+    static constexpr std::size_t WIRE_SIZE {24};
+
+    // flags_fo bit (IPv4's reserved flag) set if the sender skipped the checksum (i.e. on loopback)
+    static constexpr std::uint16_t FLAG_NO_CHECKSUM {0x8000};
+
+    // flags_fo bit (IPv4's don't fragment flag) set if the message is a session hello, not a pkt
+    // (data is the client's session token, see TcpClient::sendSessionHello())
+    static constexpr std::uint16_t FLAG_SESSION {0x4000};
+
+    // flags_fo bit (IPv4's more fragments flag) set if the message is a clock ping/pong, not a pkt
+    // (data is a ClockPing, see TcpClient's clock sync)
+    static constexpr std::uint16_t FLAG_CLOCK {0x2000};
+
+    // flags_fo bits left for the fragment-offset (13 bits)
+    static constexpr std::uint16_t FO_MASK {0x1FFF};
 
     // constructor makes conversion to HeaderPkt_t easy
     HeaderPkt_t     ();
     HeaderPkt_t     (std::istream& stream);
+    explicit HeaderPkt_t(const std::uint8_t* wire_buf); // reads WIRE_SIZE bytes
     // to string makes conversion from HeaderPkt_t easy
-    std::string     toString();
-    std::uint16_t   CalcChecksum(const void* data_buf, std::size_t size);
+    std::string     toString() const;
+    void            pack(std::uint8_t* wire_buf) const; // writes WIRE_SIZE bytes
+    static std::uint32_t CalcChecksum(const void* data_buf, std::size_t size); // CRC32C (hw accelerated if able)
+    bool            hasChecksum() const;
+    bool            isSessionHello() const;
+    bool            isClockPing() const;
+    // sender's monotonic clock (µs, see ClockSync::now()) when the message started out (0 = not set)
+    void            setOriginTime(const std::uint64_t time_us);
+    std::uint64_t   getOriginTime() const;
+    // capture time & frame seq in full, encode time in ttl & send delay in the fragment-offset (ms, saturating)
+    void            setStamp(const Camera::FrameStamp& stamp);
+    Camera::FrameStamp getStamp() const; // unstamped if the sender did not set one
     std::uint8_t    ihl() const;
     std::size_t     size() const;
 };
@@ -138,6 +177,23 @@ enum class PktType {
     Common,
 };
 
+/**
+ * @brief How a message's payload is serialized on the wire
+ * @note Stored in HeaderPkt_t::protocol so the receiver knows how to decode each message.
+ * The client picks the encoding for control packets & the server answers in whatever the client last used.
+ */
+enum class PktEncoding : std::uint8_t {
+    Bson    = 0,    // json -> bson (self describing, kept for the web/debug path)
+    Binary  = 1,    // fixed-layout binary codec (see "Binary Wire Codec" in packet.cpp)
+    Raw     = 2,    // opaque bytes that are not a packet (i.e. camera frames)
+};
+
+namespace BinCodec {
+    constexpr std::uint8_t  VERSION         {1};    // bump whenever the binary layout changes
+    constexpr std::size_t   CMN_MAX_SIZE    {14};   // ver + type + 2 flag bytes + 2 max length varints (5B each)
+    constexpr std::size_t   SRV_SIZE        {7};    // ver + type + flags + float (4B)
+}; // end of BinCodec namespace
+
 
 /**
  * @brief Type for a callback function that accepts a reference to the received pkt
@@ -145,6 +201,25 @@ enum class PktType {
  */
 using RecvPktCallback = std::function<ReturnCodes(const CommonPkt&)>;
 
+/**
+ * @brief Shared, immutable camera frame (jpeg bytes).
+ * Handing these around only bumps a ref count, the frame is freed/recycled once nothing references it
+ */
+using CamFrame = std::shared_ptr<const std::vector<unsigned char>>;
+
+// a camera frame & when it passed each hop so far
+struct StampedFrame {
+    CamFrame            frame;
+    Camera::FrameStamp  stamp;
+};
+
+// a camera frame & the generation it was published as (see Packet::getLatestCamFrameSnapshot())
+struct CamFrameSnapshot {
+    CamFrame            frame;
+    std::uint64_t       generation;
+    Camera::FrameStamp  stamp       {};     // unstamped unless the frame was set w/ one
+};
+
 
 /*************************************************** Packet Class **************************************************/
 
@@ -160,31 +235,73 @@ class Packet {
 
         /********************************************* Getters/Setters *********************************************/
 
-        virtual const CommonPkt& getCurrentCmnPkt() const;
-        virtual const SrvDataPkt& getCurrentSrvPkt() const;
+        /**
+         * @brief Get a copy of the latest common/server data packet
+         * @note Lock-free (never waits for updatePkt())
+         */
+        virtual CommonPkt getCurrentCmnPkt() const;
+        virtual SrvDataPkt getCurrentSrvPkt() const;
 
         /**
-         * @brief 
-         * (notifies cv ``)
-         * @param updated_pkt 
+         * @brief Set the latest common/server data packet
+         * (notifies cv `has_new_cmn_data`/`has_new_srv_data` & the data eventfd)
+         * @param updated_pkt The new packet
          * @return ReturnCodes 
          */
         virtual ReturnCodes updatePkt(const CommonPkt& updated_pkt);
         virtual ReturnCodes updatePkt(const SrvDataPkt& updated_pkt);
 
         /**
-         * @brief Get the latest frame from the camera video stream
-         * @return Reference to the char buffer in the form of a char vector
-         * @note Needs to use a mutex bc of read/write race condition with server
+         * @brief Get a handle to the latest frame from the camera video stream
+         * @return Shared handle to the frame (stays valid even if a new frame is set afterwards)
+         * @note Lock-free (never waits for setLatestCamFrame())
          */
-        virtual const std::vector<unsigned char>& getLatestCamFrame() const;
+        virtual CamFrame getLatestCamFramePtr() const;
+
+        /**
+         * @brief Get a handle to the latest frame along with its generation & stamp (consistent with each other)
+         * @return The frame, its generation (increments every time a frame is set) & stamp
+         */
+        virtual CamFrameSnapshot getLatestCamFrameSnapshot() const;
+
+        /**
+         * @brief Wait until a frame newer than the caller's last one is set (or the timeout passes)
+         * @param last_generation The generation of the last frame the caller got (see getLatestCamFrameSnapshot())
+         * @param timeout_ms The longest to wait
+         * @return The latest frame (its generation is still last_generation if none came in time)
+         * @note Any number of threads can wait, every new frame wakes all of them
+         */
+        virtual CamFrameSnapshot waitForNewCamFrame(const std::uint64_t last_generation, const int timeout_ms) const;
 
         /**
          * @brief Set the latest frame from the camera video stream
+         * @param stamp (optional) When the frame passed each hop so far (sent along w/ it, see HeaderPkt_t::setStamp())
+         * @return Success if no issues
+         * @note Copies the frame (use the CamFrame/rvalue overloads to avoid it)
+         */
+        virtual ReturnCodes setLatestCamFrame(
+            const std::vector<unsigned char>& new_frame,
+            const Camera::FrameStamp& stamp=Camera::FrameStamp{}
+        );
+
+        /**
+         * @brief Set the latest frame from the camera video stream without copying it
+         * @param new_frame The frame to take ownership of
+         * @param stamp (optional) When the frame passed each hop so far
+         * @return Success if no issues
+         */
+        virtual ReturnCodes setLatestCamFrame(
+            std::vector<unsigned char>&& new_frame,
+            const Camera::FrameStamp& stamp=Camera::FrameStamp{}
+        );
+
+        /**
+         * @brief Set the latest frame from the camera video stream without copying it
+         * @param new_frame Shared handle to the new frame (i.e. a pooled receive buffer)
+         * @param stamp (optional) When the frame passed each hop so far
          * @return Success if no issues
-         * @note Needs to use a mutex bc of read/write race condition with server
          */
-        virtual ReturnCodes setLatestCamFrame(const std::vector<unsigned char>& new_frame);
+        virtual ReturnCodes setLatestCamFrame(CamFrame new_frame, const Camera::FrameStamp& stamp=Camera::FrameStamp{});
 
         /*************************************** Packet Read/Write Functions ***************************************/
         // see https://github.com/nlohmann/json#binary-formats-bson-cbor-messagepack-and-ubjson
@@ -193,6 +310,7 @@ class Packet {
          * @brief Final endpoint for readCmnPkt -- can just call this one directly if have correct material
          * @param pkt_json The jsonified packet to parse
          * @return The parsed json packet in struct form
+         * @note Keys missing from the json keep the current packet's values
          */
         CommonPkt readCmnPkt(const json& pkt_json) const;
 
@@ -202,6 +320,8 @@ class Packet {
          * @param size The size of the packet buffer
          * @param is_bson false is just a stringified/charified json. True if is a bson
          * @return The packet translated into the struct
+         * @note Keys missing from the packet keep the current packet's values.
+         * The packet is merged in a single pass straight into the struct (no intermediate json is built)
          */
         CommonPkt readCmnPkt(const char* pkt_buf, const std::size_t size, const bool is_bson) const;
 
@@ -217,6 +337,7 @@ class Packet {
          * @brief Final endpoint for readCmnPkt -- can just call this one directly if have correct material
          * @param pkt_json The jsonified packet to parse
          * @return The parsed json packet in struct form
+         * @note Keys missing from the json keep the current packet's values
          */
         SrvDataPkt readSrvPkt(const json& pkt_json) const;
 
@@ -226,9 +347,22 @@ class Packet {
          * @param size The size of the packet buffer
          * @param is_bson false is just a stringified/charified json. True if is a bson
          * @return The packet translated into the struct
+         * @note Keys missing from the packet keep the current packet's values.
+         * The packet is merged in a single pass straight into the struct (no intermediate json is built)
          */
         SrvDataPkt readSrvPkt(const char* pkt_buf, const std::size_t size, const bool is_bson) const;
 
+        /**
+         * @brief Interprets a received packet based on the encoding it was sent with
+         * @param pkt_buf The received packet buffer
+         * @param size The size of the packet buffer
+         * @param encoding How the packet was serialized (see HeaderPkt_t::protocol)
+         * @return The packet translated into the struct
+         * @note Throws if the packet is malformed
+         */
+        CommonPkt readCmnPkt(const char* pkt_buf, const std::size_t size, const PktEncoding encoding) const;
+        SrvDataPkt readSrvPkt(const char* pkt_buf, const std::size_t size, const PktEncoding encoding) const;
+
         /**
          * @brief Inbetween function that will just convert a buffered bson packet into a regular json
          * @param pkt_buf The bson packet buffer
@@ -255,7 +389,53 @@ class Packet {
         std::string writePkt(const SrvDataPkt& pkt_to_send) const;
         std::string writePkt(const json& pkt_to_send) const;
 
+        /**
+         * @brief Serialize a packet using the requested wire encoding
+         * @param pkt_to_send The packet to send
+         * @param encoding How to serialize the packet (Raw is not valid for packets)
+         * @return The serialized packet to send
+         */
+        std::string writePkt(const CommonPkt& pkt_to_send, const PktEncoding encoding) const;
+        std::string writePkt(const SrvDataPkt& pkt_to_send, const PktEncoding encoding) const;
+
+        /****************************************** Binary Wire Codec *****************************************/
+
+        /**
+         * @brief Encodes a packet into the compact fixed-layout binary format
+         * @param pkt The packet to encode
+         * @return The encoded bytes (little-endian, see packet.cpp for the layout)
+         */
+        static std::string encodeBinPkt(const CommonPkt& pkt);
+        static std::string encodeBinPkt(const SrvDataPkt& pkt);
+
+        /**
+         * @brief Decodes a packet encoded by encodeBinPkt()
+         * @param pkt_buf The encoded bytes
+         * @param size The number of encoded bytes
+         * @return The decoded packet
+         * @note Throws std::runtime_error if the buffer is truncated or has the wrong version/type
+         */
+        static CommonPkt decodeBinCmnPkt(const char* pkt_buf, const std::size_t size);
+        static SrvDataPkt decodeBinSrvPkt(const char* pkt_buf, const std::size_t size);
+
     protected:
+        /**
+         * @brief Get the eventfd that becomes readable whenever new data is set (updatePkt()/setLatestCamFrame())
+         * @note Lets a reactor (epoll) wait for new data to send alongside its sockets instead of polling.
+         * Read it (clearDataEvent()) to reset it, then check the *_pkt_ready flags to see what changed
+         */
+        int getDataEventFd() const;
+
+        /**
+         * @brief Make getDataEventFd() readable (async-signal-safe)
+         */
+        void notifyDataEvent() const;
+
+        /**
+         * @brief Resets getDataEventFd() so it is no longer readable
+         */
+        void clearDataEvent() const;
+
         // vars needed by both client/server for checking whether they are ready/able to send pkts
         std::atomic_bool            cmn_pkt_ready;      // ready to send new common packet
         std::atomic_bool            cam_pkt_ready;      // ready to send new camera data packet
@@ -263,35 +443,25 @@ class Packet {
         std::condition_variable     has_new_cmn_data;   // true if client/server needs to send new common msg
         std::condition_variable     has_new_cam_data;   // true if client/server needs to send new camera data
         std::condition_variable     has_new_srv_data;   // true if client/server needs to send new server data msg
-        mutable std::mutex          cmn_data_pkt_mutex; // controls access to the `latest_ctrl_pkt` data
-        mutable std::mutex          cam_data_pkt_mutex; // controls access to the `latest_frame` data
-        mutable std::mutex          srv_data_pkt_mutex; // controls access to the `latest_srv_data_pkt` data
+        mutable std::mutex          cmn_data_pkt_mutex; // guards `cmn_pkt_ready` for waits on `has_new_cmn_data`
+        mutable std::mutex          cam_data_pkt_mutex; // guards `cam_pkt_ready` for waits on `has_new_cam_data`
+        mutable std::mutex          srv_data_pkt_mutex; // guards `srv_pkt_ready` for waits on `has_new_srv_data`
 
     private:
         /******************************************** Private Variables ********************************************/
 
         // regular data packet variables
-        CommonPkt                       latest_ctrl_pkt;    // holds the most up to date information from client
+        LatestValue<CommonPkt>          latest_ctrl_pkt;    // holds the most up to date information from client
 
         // camera pkt variables
-        std::vector<unsigned char>      latest_frame;       // contains the most up to date camera frame
-        mutable std::mutex              frame_mutex;        // controls access to the `latest_frame` data
+        LatestValue<StampedFrame>       latest_frame;       // contains the most up to date camera frame (& its stamp)
+        mutable std::condition_variable new_frame_set;      // notified on every new frame (w/ cam_data_pkt_mutex)
 
         // server data packet variables
-        SrvDataPkt                      latest_srv_data_pkt;// holds the most up to date information to send to client
+        LatestValue<SrvDataPkt>         latest_srv_data_pkt;// holds the most up to date information to send to client
 
-        /********************************************* Helper Functions ********************************************/
-
-        /**
-         * @brief Helper function that returns the values if the key exists 
-         * (if dne, sets field to current packet's values)
-         * @param json_to_check The json to check if the key exists 
-         * @param keys List of keys needed to access element (in order from root to branch of json)
-         * @return The found element
-         * @tparam rtnType The desired type for the return to be
-         */
-        template<typename rtnType>
-        rtnType findIfExists(const json& json_to_check, const std::vector<std::string>& keys) const;
+        // event notification variables
+        const int                       data_event_fd;      // eventfd signaled whenever new data is set
 
 }; // end of packet class
 
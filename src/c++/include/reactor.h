@@ -0,0 +1,66 @@
+#ifndef RPI_REACTOR_H
+#define RPI_REACTOR_H
+
+// Standard Includes
+#include <vector>
+#include <cstdint>
+#include <sys/epoll.h>
+
+// Our Includes
+#include "constants.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Thin wrapper around an epoll instance used to run all of a net agent's sockets from one thread
+ */
+class Reactor {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        Reactor();
+        virtual ~Reactor();
+
+        bool isValid() const;
+
+        /********************************************* Watch Functions *********************************************/
+
+        /**
+         * @brief Start watching a file descriptor
+         * @param fd The file descriptor to watch
+         * @param events The epoll events to wait for (i.e. EPOLLIN | EPOLLOUT)
+         * @return Success if no issues
+         */
+        ReturnCodes add(const int fd, const std::uint32_t events);
+
+        /**
+         * @brief Change which events a watched file descriptor is waited on for
+         */
+        ReturnCodes modify(const int fd, const std::uint32_t events);
+
+        /**
+         * @brief Stop watching a file descriptor (do this before closing it)
+         */
+        ReturnCodes remove(const int fd);
+
+        /**
+         * @brief Block until at least one watched file descriptor is ready (or timeout)
+         * @param timeout_ms How long to wait (-1 = forever)
+         * @return The ready events (empty on timeout/interrupt)
+         */
+        const std::vector<epoll_event>& wait(const int timeout_ms=-1);
+
+    private:
+        int                         epoll_fd;       // the epoll instance
+        std::vector<epoll_event>    ready_events;   // filled by wait()
+
+}; // end of Reactor class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
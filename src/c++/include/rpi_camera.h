@@ -8,15 +8,25 @@
 #include <chrono> // for time units
 #include <atomic>
 #include <functional>
+#include <algorithm> // for std::max
+#include <array>
+#include <vector>
 #include <experimental/filesystem> // to get path to classifier files
 
 // Our Includes
 #include "constants.h"
 #include "timing.hpp"
+#include "video_ladder.h"
+#include "frame_stamp.h"
+#include "stage_queue.h"
+#include "face_detector.h"
+#include "face_tracker.h"
+#include "jpeg_encoder.h"
 
 // 3rd Party Includes
 #include <raspicam_cv.h>
-#include <opencv2/imgproc.hpp> // for putText()
+#include <opencv2/imgproc.hpp> // for putText() & resize()
+#include <opencv2/imgcodecs.hpp> // for imwrite()
 #include <opencv2/objdetect.hpp> // for object detection
 
 namespace RPI {
@@ -29,10 +39,41 @@ namespace fs = std::experimental::filesystem;
 // for convenience within this namesapce bc super long
 using time_point = std::chrono::_V2::system_clock::time_point;
 
-using GrabFrameCb = std::function<void(const std::vector<unsigned char>& frame)>;
+// frame is the jpeg encoded image, stamp says when it was captured/encoded (passed along to time its later hops)
+using GrabFrameCb = std::function<void(const std::vector<unsigned char>& frame, const FrameStamp& stamp)>;
+
+// tells the grabber how to encode the frames it passes to the grab callback (i.e. to suit the network)
+using VideoSettingsCb = std::function<VideoSettings()>;
 
 using Classifier = std::pair<const fs::path, cv::CascadeClassifier>;
 
+/**
+ * @brief The stages of the frame pipeline, each runs on its own thread (in this order)
+ */
+enum class PipelineStage : std::uint8_t {
+    Capture,    // grab & retrieve from the camera (drops frames the link has no room for)
+    Detect,     // facial detection
+    Overlay,    // circles around the faces & the timecode
+    Encode,     // scale & jpeg encode, then hand to the grab callback
+};
+
+constexpr std::size_t NUM_PIPELINE_STAGES {static_cast<std::size_t>(PipelineStage::Encode) + 1};
+
+/**
+ * @brief Get a stage's name (i.e. "detect")
+ */
+std::string getPipelineStageName(const PipelineStage stage);
+
+/**
+ * @brief What a pipeline stage did so far (see CamHandler::getPipelineStats())
+ */
+struct StageStats {
+    std::uint64_t   frames          {0};    // frames the stage finished
+    std::uint64_t   busy_us         {0};    // time it spent working on them
+    std::size_t     queue_depth     {0};    // frames waiting for it right now (0 for capture, it has no queue)
+    std::uint64_t   dropped         {0};    // frames dropped from its queue (a newer one came in before it got to them)
+};
+
 /**
  * @brief Extends the raspicam opencv camera class
  * @note use `isOpened()` to check open status
@@ -48,7 +89,9 @@ class CamHandler : public raspicam::RaspiCam_Cv {
          * @param verbosity If true, will print more information that is strictly necessary
          * @param max_frame_count (defualts to -1 = infinite) If set, only this number of frames will be taken
          * @param face_xml (default to local version) Absolute path to the opencv face classifier xml file
+         * (the haar detector's, overrides detector_config.haar_xml)
          * @param eye_xml  (default to local version) Absolute path to the opencv eye classifier xml file
+         * @param detector_config Which face detectors to load & the detect stage's budget (ms/frame)
          * @param should_init (default=true) Initialize obj in constructor 
          * (If false, you will have to call SetupCam() manually).
          * Needed if running client code on non-rpi w/o camera to open 
@@ -58,7 +101,8 @@ class CamHandler : public raspicam::RaspiCam_Cv {
             const int max_frame_count=-1,
             const bool should_init=true,
             const std::string face_xml="",
-            const std::string eye_xml=""
+            const std::string eye_xml="",
+            const DetectorConfig& detector_config=DetectorConfig{}
         );
         virtual ~CamHandler();
 
@@ -97,10 +141,26 @@ class CamHandler : public raspicam::RaspiCam_Cv {
          * @param grab_cb The callback to use
          * @param grab_cb Returns: callback should be void return
          * @param grab_cb param: char vector containing the frames pixels (aka const std::vector<unsigned char>& frame)
+         * @param grab_cb param: the frame's seq & when it was captured/encoded (aka const FrameStamp& stamp)
          * @return ReturnCodes Success if set correctly
          */
         ReturnCodes setGrabCallback(GrabFrameCb grab_cb);
 
+        /**
+         * @brief Sets the function asked (once per frame) how to encode the frames passed to the grab callback
+         * @param settings_cb The callback to use (without one, frames are sent at the best VIDEO_LADDER rung)
+         * @note Frames are dropped to meet the fps & scaled down to the size before being jpeg encoded
+         * @return ReturnCodes Success if set correctly
+         */
+        ReturnCodes setVideoSettingsCallback(VideoSettingsCb settings_cb);
+
+        /**
+         * @brief Get every pipeline stage's stats (indexed by PipelineStage)
+         * @note Safe to call from any thread while the grabber runs. A stage's throughput is the change in its frames
+         * over time, its busy_us / frames is how long it takes per frame
+         */
+        std::array<StageStats, NUM_PIPELINE_STAGES> getPipelineStats() const;
+
         /********************************************* Camera Functions ********************************************/
 
         /**
@@ -113,6 +173,9 @@ class CamHandler : public raspicam::RaspiCam_Cv {
          * @brief Main function to start grabbing frames from the camera
          * @param record_immed True if camera should start capturing frames immediately
          * @param should_save (default=true) If true, saves the last grabbed frame to disk
+         * @note Captures on the calling thread & starts a thread for each of the other PipelineStage's. Stages hand
+         * frames on through StageQueue's that drop the oldest frame when full, so a slow stage (i.e. detection) only
+         * lowers the frame rate to what it can do instead of stalling the camera, & the stages run in parallel
          */
         void RunFrameGrabber(const bool record_immed, const bool should_save=true);
 
@@ -127,10 +190,33 @@ class CamHandler : public raspicam::RaspiCam_Cv {
         std::atomic_bool            should_record; // if true, thread keeps going but grabbing will stop
         time_point                  start_time;    // when camera started grabbing
         GrabFrameCb                 grab_cb;       // callback to use when a frame is grabbed
+        VideoSettingsCb             settings_cb;   // says how to encode frames for grab_cb (quality/size/fps)
 
         // PreDefined/Trained Object Detection Classifiers (Facial Recognition)
-        Classifier                  facial_classifier;
         Classifier                  eye_classifier;          // classifier for objects that object face
+        DetectorConfig              detector_config;         // which face detectors to load & their budget
+        FaceDetectors               face_detectors;          // loaded face detectors (picked by face_tracker)
+        FaceTracker                 face_tracker;            // decides when & which face detector runs (tracks between)
+
+        // a frame on its way through the pipeline
+        struct PipelineFrame {
+            cv::Mat                 image       {};     // only the stage working on it touches it
+            FrameStamp              stamp       {};
+            VideoSettings           settings    {};     // how to encode it (asked when it was captured)
+            std::vector<cv::Rect>   faces       {};     // found by the detect stage
+        };
+
+        // counters a stage's thread updates (read by getPipelineStats())
+        struct StageCounters {
+            std::atomic<std::uint64_t>  frames      {0};
+            std::atomic<std::uint64_t>  busy_us     {0};
+        };
+
+        // pipeline vars
+        StageQueue<PipelineFrame>   detect_queue;   // capture -> detect
+        StageQueue<PipelineFrame>   overlay_queue;  // detect -> overlay
+        StageQueue<PipelineFrame>   encode_queue;   // overlay -> encode
+        std::array<StageCounters, NUM_PIPELINE_STAGES> stage_counters;
 
         /********************************************* Helper Functions ********************************************/
 
@@ -141,6 +227,34 @@ class CamHandler : public raspicam::RaspiCam_Cv {
         ReturnCodes SetupCam();
         void setIsInit(const bool new_state);
 
+        /*************************************** Pipeline Functions **************************************/
+
+        /**
+         * @brief Runs a stage's thread: works on each frame from its queue & passes it on, until the queue is closed
+         * @param stage The stage (its counters are updated)
+         * @param in_queue The queue it takes frames from
+         * @param out_queue The queue it passes them on to (nullptr for the last stage), closed once it is done
+         * @param work What the stage does to a frame
+         */
+        void RunStage(
+            const PipelineStage stage,
+            StageQueue<PipelineFrame>& in_queue,
+            StageQueue<PipelineFrame>* out_queue,
+            const std::function<void(PipelineFrame&)>& work
+        );
+
+        /**
+         * @brief Adds the time since `start_us` to a stage's counters (one more frame)
+         */
+        void RecordStage(const PipelineStage stage, const std::uint64_t start_us);
+
+        /**
+         * @brief Prints each stage's throughput, time per frame, queue depth & drops since `prev`
+         * @param prev The stats last printed (updated to the current ones)
+         * @param secs How long it has been since then
+         */
+        void PrintPipelineStats(std::array<StageStats, NUM_PIPELINE_STAGES>& prev, const double secs) const;
+
         /*************************************** Facial Recognition Functions **************************************/
 
         /**
@@ -153,11 +267,20 @@ class CamHandler : public raspicam::RaspiCam_Cv {
         ReturnCodes LoadClassifiers(Classifier& classifiers_pair);
 
         /**
-         * @brief Performs facial recognition on the passed image using preloaded classifiers
-         * @param img The image to detect faces on & modify (hence not const)
+         * @brief Performs facial recognition on the passed image using preloaded detectors
+         * @note A detector only runs every few frames (see FaceTracker), the faces are tracked in between
+         * @param img The image to detect faces on
+         * @param faces Set to where the faces are
          * @return ReturnCodes Success if no issues
          */
-        ReturnCodes DetectAndDraw(cv::Mat& img);
+        ReturnCodes DetectFaces(const cv::Mat& img, std::vector<cv::Rect>& faces);
+
+        /**
+         * @brief Circles the faces found by DetectFaces()
+         * @param img The image to draw on
+         * @param faces Where the faces are
+         */
+        void DrawFaces(cv::Mat& img, const std::vector<cv::Rect>& faces) const;
 
 }; // end of CamHandler class
 
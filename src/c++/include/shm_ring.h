@@ -0,0 +1,121 @@
+#ifndef RPI_SHM_RING_H
+#define RPI_SHM_RING_H
+
+// Standard Includes
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+
+// Our Includes
+#include "constants.h"
+#include "buffer_pool.h"
+#include "net_conn.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Ring of the most recent frames in shared memory, written by one process & read by any number of others
+ * on the same machine (i.e. camera frames for a client running on the server's box)
+ * @note The writer never waits on readers: each slot is guarded by a seqlock, so a reader that is lapped
+ * while copying a frame notices & just moves on to the newest one.
+ * Readers sleep on a futex (the newest frame's seq), which the writer wakes on every publish.
+ * Seqs are 32 bits so they are lock-free (& process-shared) on every pi
+ */
+class ShmFrameRing {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        ShmFrameRing();
+        virtual ~ShmFrameRing();
+
+        ShmFrameRing(const ShmFrameRing&) = delete;
+        ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        bool isOpen() const;
+
+        /**
+         * @brief Get the shared memory object's name for a port (each server's ring is named after its camera port)
+         */
+        static std::string makeName(const int port);
+
+        /********************************************** Ring Functions *********************************************/
+
+        /**
+         * @brief Create (or take over a stale) ring & map it (writer side)
+         * @param name The shared memory object's name (see makeName())
+         * @param num_slots How many recent frames are kept
+         * @param slot_size The largest frame that fits in a slot
+         * @return Error if it could not be created/mapped
+         */
+        ReturnCodes create(
+            const std::string& name,
+            const std::size_t num_slots=Constants::Network::BROADCAST_RING_SIZE,
+            const std::size_t slot_size=Constants::Network::MAX_FRAME_MSG_SIZE
+        );
+
+        /**
+         * @brief Map an existing ring (reader side)
+         * @param name The shared memory object's name (see makeName())
+         * @return Error if there is no such ring (i.e. server not running) or it is not a frame ring
+         */
+        ReturnCodes open(const std::string& name);
+
+        /**
+         * @brief Unmap the ring (the writer also marks it closed, wakes the readers & removes the name)
+         */
+        void close();
+
+        /**
+         * @brief Copy a frame into the next slot & wake the readers (writer side)
+         * @param header The frame's header (from TcpBase::makeHeader(), carries its stamp to the readers)
+         * @param data The frame
+         * @param size The frame's size (frames larger than the slot size are refused)
+         * @return The frame's seq (0 if refused)
+         */
+        std::uint32_t publish(const HeaderPkt_t& header, const void* data, const std::size_t size);
+
+        /**
+         * @brief Wait for a frame newer than `cursor` & copy it into a pooled buffer (reader side)
+         * @param pool The buffer pool to copy the frame into
+         * @param cursor The seq of the last frame read (0 for none), updated to the returned frame's seq
+         * @param timeout_ms Longest to wait for a new frame
+         * @return Success w/ the newest frame & the header it was published with, WouldBlock if none arrived in time,
+         * ClosedConn once the writer closed the ring, Error if not open
+         * @note Frames older than the newest are skipped (only the newest matters)
+         */
+        RecvRtn waitNext(BufferPool& pool, std::uint32_t& cursor, const int timeout_ms);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        struct RingHeader;  // start of the shared memory (defined in shm_ring.cpp)
+        struct SlotHeader;  // start of every slot
+
+        std::string     shm_name;       // name of the shared memory object (empty if closed)
+        void*           mapping;        // start of the mapped shared memory (nullptr if closed)
+        std::size_t     mapping_size;   // number of bytes mapped
+        bool            is_writer;      // true if created (not opened) by this process
+
+        /********************************************* Helper Functions ********************************************/
+
+        RingHeader* getHeader() const;
+        SlotHeader* getSlot(const std::uint32_t seq) const;
+
+        /**
+         * @brief Maps the shared memory object's fd & closes the fd
+         */
+        ReturnCodes mapFd(const int shm_fd, const std::size_t size);
+
+}; // end of ShmFrameRing class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef RPI_SOCK_TUNING_H
+#define RPI_SOCK_TUNING_H
+
+// Standard Includes
+#include <cstddef>
+
+// Our Includes
+#include "constants.h"
+#include "net_conn.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+namespace SockTuning {
+
+/**
+ * @brief How a channel's sockets are set up so urgent pkts are not stuck behind camera frames
+ * @note priority -> SO_PRIORITY, picks the band of the default (pfifo_fast/prio) qdisc the pkts wait in.
+ * dscp -> IP_TOS (<< 2), lets routers/wifi access points do the same (EF -> voice, AF31/CS0 -> best effort).
+ * notsent_lowat -> TCP_NOTSENT_LOWAT, how many not yet sent bytes the kernel holds before the socket stops
+ * being writable (0 = kernel default, so the rest waits in user space where it can still be reordered/dropped)
+ */
+struct ChannelTuning {
+    int             priority;       // SO_PRIORITY (0-6 w/o CAP_NET_ADMIN)
+    int             dscp;           // DiffServ code point (6 bits)
+    std::size_t     notsent_lowat;  // 0 = leave the kernel default
+};
+
+/**
+ * @brief Get how a channel's sockets should be tuned
+ * @param channel The channel the socket carries
+ * @param is_mux Does the socket carry every channel (Transport::Mux)?
+ * A mux connection is marked like its most urgent channel (control) & only polls writable while the kernel holds
+ * less than MuxWriter lets it (about a fragment), so the reactor wakes up right when the next fragment can go
+ */
+constexpr ChannelTuning getChannelTuning(const Channel channel, const bool is_mux=false) {
+    return is_mux                       ? ChannelTuning{6, 46, Constants::Network::MUX_NOTSENT_LOWAT} :
+           channel == Channel::Control  ? ChannelTuning{6, 46, 0} :
+           channel == Channel::SrvData  ? ChannelTuning{4, 26, 0} :
+                                          ChannelTuning{2, 0, Constants::Network::CAM_NOTSENT_LOWAT};
+}
+
+/**
+ * @brief Applies a channel's tuning (& TCP_NODELAY) to a socket
+ * @param sock_fd The socket (before connect() to mark the handshake too, or right after accept())
+ * @param channel The channel the socket carries
+ * @param is_mux Does the socket carry every channel (Transport::Mux)?
+ * @param has_lowat (optional) Set to true if the channel's TCP_NOTSENT_LOWAT is in effect (read back from the
+ * socket), false if the channel has none or it could not be set
+ * @return Error if any option could not be set (the socket still works, just untuned).
+ * Unix sockets only get their SO_PRIORITY set, udp sockets their SO_PRIORITY & dscp
+ */
+ReturnCodes tune(const int sock_fd, const Channel channel, const bool is_mux=false, bool* has_lowat=nullptr);
+
+/**
+ * @brief Get the number of bytes in a socket's send queue the kernel has not sent yet (SIOCOUTQNSD, 0 if unknown)
+ * @note Unlike SIOCOUTQ this leaves out bytes already sent & waiting to be acked
+ */
+std::size_t getNotSentSize(const int sock_fd);
+
+} // end of SockTuning namespace
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
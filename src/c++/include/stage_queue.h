@@ -0,0 +1,197 @@
+#ifndef RPI_STAGE_QUEUE_H
+#define RPI_STAGE_QUEUE_H
+
+// Standard Includes
+#include <atomic>
+#include <memory>
+#include <thread> // for yield
+#include <cstdint>
+#include <cstddef>
+#include <climits> // for INT_MAX
+#include <ctime> // for timespec
+#include <unistd.h> // for syscall()
+#include <sys/syscall.h> // for SYS_futex
+#include <linux/futex.h>
+
+// Our Includes
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Camera {
+
+/**
+ * @brief Bounded queue handing items from one pipeline stage's thread to the next (single producer & consumer)
+ * @tparam T The item type (i.e. a frame & its stamp)
+ * @note Pushing never waits on the consumer: when the queue is full the oldest item is dropped to make room,
+ * so a slow stage only ever works on the freshest items & never holds up the stages before it.
+ * Lock-free (bounded MPMC ring, the producer pops the oldest item itself to drop it), the consumer sleeps on a
+ * futex while the queue is empty
+ */
+template <typename T>
+class StageQueue {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        /**
+         * @param capacity How many items can wait before the oldest is dropped (at least 2, a single slot's
+         * seq would read the same whether it is full or was just emptied)
+         */
+        explicit StageQueue(const std::size_t capacity)
+            : num_slots{capacity > 2 ? capacity : 2}
+            , slots{std::make_unique<Slot[]>(num_slots)}
+            , head{0}
+            , tail{0}
+            , num_pushed{0}
+            , num_dropped{0}
+            , is_closed{false}
+        {
+            for (std::size_t idx = 0; idx < num_slots; ++idx) {
+                slots[idx].seq.store(idx, std::memory_order_relaxed);
+            }
+        }
+
+        StageQueue(const StageQueue&) = delete;
+        StageQueue& operator=(const StageQueue&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        /**
+         * @brief Get the number of items waiting right now
+         */
+        std::size_t size() const {
+            const std::uint64_t curr_tail {tail.load(std::memory_order_acquire)};
+            const std::uint64_t curr_head {head.load(std::memory_order_acquire)};
+            return curr_tail > curr_head ? static_cast<std::size_t>(curr_tail - curr_head) : 0;
+        }
+
+        std::size_t capacity() const {
+            return num_slots;
+        }
+
+        /**
+         * @brief Get the number of items dropped (a newer one was pushed before the consumer got to them)
+         */
+        std::uint64_t getNumDropped() const {
+            return num_dropped.load(std::memory_order_relaxed);
+        }
+
+        bool isClosed() const {
+            return is_closed.load();
+        }
+
+        /********************************************* Queue Functions *********************************************/
+
+        /**
+         * @brief Add an item, dropping the oldest one if the queue is full (producer only)
+         * @return true if an item was dropped to make room
+         */
+        bool push(T item) {
+            bool dropped {false};
+            const std::uint64_t pos {tail.load(std::memory_order_relaxed)};
+            Slot& slot {slots[pos % num_slots]};
+            while (slot.seq.load(std::memory_order_acquire) != pos) {
+                // the slot still holds the item from a lap ago: full -> drop the oldest
+                // (otherwise the consumer is just moving it out, which takes no time)
+                T oldest {};
+                if (pos - head.load(std::memory_order_acquire) >= num_slots && tryPop(oldest)) {
+                    num_dropped.fetch_add(1, std::memory_order_relaxed);
+                    dropped = true;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+
+            slot.value = std::move(item);
+            slot.seq.store(pos + 1, std::memory_order_release);
+            tail.store(pos + 1, std::memory_order_release);
+
+            // wake the consumer if it is waiting for an item
+            num_pushed.fetch_add(1, std::memory_order_release);
+            futexWake(num_pushed);
+            return dropped;
+        }
+
+        /**
+         * @brief Take the oldest item if there is one
+         * @return false if the queue is empty
+         */
+        bool tryPop(T& item) {
+            std::uint64_t pos {head.load(std::memory_order_relaxed)};
+            while (true) {
+                Slot& slot {slots[pos % num_slots]};
+                const std::int64_t diff {
+                    static_cast<std::int64_t>(slot.seq.load(std::memory_order_acquire)) - static_cast<std::int64_t>(pos + 1)
+                };
+                if (diff == 0) {
+                    // claim it first, the producer may be dropping the same item
+                    if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel)) {
+                        item = std::move(slot.value);
+                        slot.value = T{};
+                        slot.seq.store(pos + num_slots, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Take the oldest item, waiting for one if the queue is empty (consumer only)
+         * @param timeout_ms The longest to wait
+         * @return false if nothing came in time or the queue was closed (& is empty)
+         */
+        bool waitPop(T& item, const int timeout_ms) {
+            // the pushed count is read before trying, so a push in between changes it & the futex does not sleep
+            const std::uint32_t seen {num_pushed.load(std::memory_order_acquire)};
+            if (tryPop(item)) return true;
+            if (isClosed()) return tryPop(item); // the last push may have come in right before close()
+            futexWait(num_pushed, seen, timeout_ms);
+            return tryPop(item);
+        }
+
+        /**
+         * @brief Wakes the consumer for good (i.e. the pipeline is stopping), items left can still be popped
+         */
+        void close() {
+            is_closed.store(true);
+            num_pushed.fetch_add(1, std::memory_order_release);
+            futexWake(num_pushed);
+        }
+
+    private:
+        struct Slot {
+            std::atomic<std::uint64_t>  seq     {0};    // pos + 1 once the item at pos is in, pos + capacity once taken
+            T                           value   {};
+        };
+
+        // private futex (the word is only shared by the threads of this process)
+        static void futexWait(std::atomic<std::uint32_t>& word, const std::uint32_t expected, const int timeout_ms) {
+            timespec timeout    {};
+            timeout.tv_sec      = timeout_ms / 1000;
+            timeout.tv_nsec     = static_cast<long>(timeout_ms % 1000) * 1000000L;
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+        }
+
+        static void futexWake(std::atomic<std::uint32_t>& word) {
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        const std::size_t               num_slots;      // capacity
+        std::unique_ptr<Slot[]>         slots;          // indexed by pos % capacity
+        std::atomic<std::uint64_t>      head;           // pos of the oldest item (consumer & dropping producer)
+        std::atomic<std::uint64_t>      tail;           // pos the next item goes at (producer)
+        std::atomic<std::uint32_t>      num_pushed;     // bumped every push (the consumer's futex)
+        std::atomic<std::uint64_t>      num_dropped;    // items dropped to make room
+        std::atomic_bool                is_closed;      // no more items are coming
+
+}; // end of StageQueue class
+
+}; // end of Camera namespace
+
+}; // end of RPI namespace
+
+#endif
@@ -18,33 +18,35 @@
 #include <mutex>
 #include <condition_variable>
 #include <sstream> // for packet stream
+#include <sys/uio.h> // for iovec
+#include <cerrno>
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <array>
+#include <sys/un.h> // for unix socket addresses
+#include <ifaddrs.h> // for getifaddrs()
+#include <net/if.h> // for IFF_UP
 
 // Our Includes
 #include "constants.h"
 #include "packet.h"
+#include "buffer_pool.h"
+#include "zero_copy.h"
+#include "net_conn.h"
+#include "udp_channel.h"
+#include "uring_engine.h"
+#include "video_ladder.h"
+#include "sock_tuning.h"
+#include "frame_timing.h"
+#include "clock_sync.h"
+#include "capture_file.h"
 
 // 3rd Party Includes
 
 namespace RPI {
 namespace Network {
 
-// holds the return of recvData(), check the "RtnCode" attribute to see if any errors occured
-enum class RecvSendRtnCodes {
-    Error,
-    ClosedConn,
-    Success
-};
-struct RecvRtn {
-    std::vector<u_char> buf;   // the data receivied via the socket (data.size() for size)
-    RecvSendRtnCodes    RtnCode;
-};
-
-struct SendRtn {
-    std::uint32_t       size;   // the size of the  sent data -- pinned to uint32_t bc thats max send size currently
-    RecvSendRtnCodes    RtnCode;
-};
-
-
 /**
  * @brief Implements common features shared between server & client
  * 
@@ -56,8 +58,9 @@ class TcpBase : public Packet {
         /**
          * @brief Construct a TcpBase object (should be created via cast from a derived class)
          * @param verbosity If true, will print more information that is strictly necessary
+         * @param transport How control & server data pkts travel (camera frames always use tcp)
          */
-        TcpBase(const bool verbosity=false);
+        TcpBase(const bool verbosity=false, const Transport transport=Transport::Tcp);
         virtual ~TcpBase();
 
         /**
@@ -84,6 +87,7 @@ class TcpBase : public Packet {
          * @param new_exit true TcpServer is should exit
          * @param new_exit false TcpServer should still run and not ready to exit
          * @note Useful for terminating runNetAgent() from main thread
+         * (also wakes up anything blocked on getDataEventFd(), safe to call from a signal handler)
          */
         ReturnCodes setExitCode(const bool new_exit);
 
@@ -105,6 +109,79 @@ class TcpBase : public Packet {
         bool getIsInit() const;
         void setIsInit(const bool new_status);
 
+        /**
+         * @brief Turn checksums for a channel on/off (on by default)
+         * @param channel The channel to change
+         * @param enabled false: messages sent on the channel skip the checksum (flagged in the header)
+         * & received ones are not verified. Only worth it when the link cannot corrupt data (i.e. loopback)
+         */
+        void setChecksumEnabled(const Channel channel, const bool enabled);
+        bool isChecksumEnabled(const Channel channel) const;
+
+        Transport getTransport() const;
+
+        /**
+         * @brief Simulate a lossy network on the udp transport (see LossShim), i.e. to test it over loopback
+         * @note Call before runNetAgent()
+         */
+        void setLossShim(const LossShim& shim);
+
+        /**
+         * @brief Choose how blocking stream sockets are read by recvData()
+         * @param engine Uring: multishot io_uring recv (see UringEngine)
+         * @return Error if the kernel cannot do io_uring (stays Posix)
+         * @note Call before runNetAgent(). The server's reactor sockets are unaffected
+         */
+        ReturnCodes setIoEngine(const IoEngine engine);
+        IoEngine getIoEngine() const;
+
+        /**
+         * @brief Get the number of syscalls recvData()/continueRecv() made so far (recv() or io_uring_enter() calls)
+         */
+        std::uint64_t getNumRecvSyscalls() const;
+
+        /**
+         * @brief Get how the camera should encode the frames it hands to setLatestCamFrame()
+         * @return The VIDEO_LADDER rung the server picked for its slowest camera subscriber
+         * (always the best rung for the client & over Transport::Local)
+         * @note Safe to call from any thread (i.e. the camera's)
+         */
+        Camera::VideoSettings getVideoSettings() const;
+        std::size_t getVideoRung() const;
+
+        /**
+         * @brief Get the per stage latency histograms of the camera frames received (& served) so far
+         * @note Only the client fills these in (from the stamps the server sends along w/ each frame)
+         */
+        const FrameTimings& getFrameTimings() const;
+
+        /**
+         * @brief Records the last hop of a frame: it was just handed to the web app
+         * @param stamp The stamp of the frame being served (see getLatestCamFrameSnapshot())
+         */
+        void recordFrameServed(const Camera::FrameStamp& stamp);
+
+        /**
+         * @brief Get the estimate of the other host's monotonic clock
+         * @note Only the client fills this in (from its clock pings, see Constants::Network::CLOCK_SYNC_MS)
+         */
+        const ClockSync& getClockSync() const;
+
+        /**
+         * @brief Start logging every control pkt, camera frame & server data pkt sent/received to a capture file
+         * (see CaptureWriter, replay it w/ capture_replay)
+         * @param path The file to create (overwritten if it exists)
+         * @return Error if it could not be created
+         * @note Session hellos & clock pings are left out. Stopped by cleanup()
+         */
+        ReturnCodes startCapture(const std::string& path);
+
+        /**
+         * @brief Stop capturing & write the capture's index
+         */
+        void stopCapture();
+        bool isCapturing() const;
+
         /**
          * @brief Sends a reset packet to the other host
          * @return Success if no issues
@@ -115,9 +192,9 @@ class TcpBase : public Packet {
         /****************************************** Shared Common Functions ****************************************/
 
         /**
-         * @brief Get the public ip address of the device
-         * @return A string containing the public ip address
-         * @credit: https://stackoverflow.com/a/3120382/13933174
+         * @brief Get the ip address other devices on the network can reach this one at
+         * @return The first non-loopback ipv4 address of an interface that is up ("127.0.0.1" if there is none)
+         * @note Only reads the local interfaces (nothing is sent, works w/o a route to the internet)
          */
         std::string GetPublicIp() const;
 
@@ -129,38 +206,213 @@ class TcpBase : public Packet {
          */
         std::string formatIpAddr(const std::string& ip, const int port) const;
 
+        /**
+         * @brief Get the unix socket address a port maps to when both ends are on the same machine (Transport::Local)
+         * @param port The port the connection would use over tcp
+         * @param addr Filled in w/ the address (abstract namespace, so nothing is left on the filesystem)
+         * @return The address' length (pass to bind()/connect())
+         */
+        socklen_t makeLocalAddr(const int port, sockaddr_un& addr) const;
+
         /**
          * @brief Receives data from remote host.
          * @param socket_fd The receiving socket's file descriptor
-         * @return string containing the data - check its size/exists for number of bytes received:
-         * (std::nullopt if error occurred)
-         * (0  if closed connection)
+         * @param pool The connection's buffer pool the data is received straight into
+         * (messages larger than the pool's max message size are discarded & reported as an Error)
+         * @param channel Which channel the socket is for (decides if the checksum is verified)
+         * @return Handle to the received data (check RtnCode for errors/closed connection).
+         * Messages that fail their checksum are dropped & reported as an Error.
+         * WouldBlock if the socket's receive timeout passed first (io_uring engine only, the message is kept)
          */
-        virtual RecvRtn recvData(int socket_fd);
+        virtual RecvRtn recvData(int socket_fd, BufferPool& pool, const Channel channel);
 
         /**
          * @brief Send data to remote host.
+         * Blocking version of continueSend(): header & data go out through a MsgWriter (looping until everything is sent)
          * @param socket_fd The receiving socket's file descriptor
+         * @param channel Which channel the socket is for (decides if a checksum is computed)
          * @param buf pointer to the buffer where the data to be sent is stored - can be (un)signed char
          * @param size_to_tx size to transmit
-         * (other host closes conn) & instead returns EPIPE (negative)
-         * @return number of bytes sent (RtnCode == Success if no issues)
+         * @param encoding How the buffer was serialized (stored in the header so receiver can decode it)
+         * @param keepalive (optional) Handle that owns `buf`. If provided & zero copy was enabled on the socket
+         * (see enableZeroCopy()), large buffers are sent with MSG_ZEROCOPY & kept alive until the kernel is done
+         * @return number of bytes of data sent (RtnCode == Success if no issues)
          * - max size is std::uint32_t bc thats the max packet length
-         * @todo Handle packet sizes larger that automatically loop when sending packets
          * @note sends will not result in a broken SIGPIPE signal to prevent program from being killed
+         * (other host closes conn) & instead returns EPIPE (negative)
          */
         virtual SendRtn sendData(
             int& socket_fd,
+            const Channel channel,
             const void* buf,
-            const std::uint32_t size_to_tx
+            const std::uint32_t size_to_tx,
+            const PktEncoding encoding=PktEncoding::Raw,
+            const std::shared_ptr<const void>& keepalive=nullptr
         );
 
+        /**
+         * @brief Builds the header that precedes data sent to the remote host
+         * @param buf The data the header describes
+         * @param size_to_tx The number of bytes in buf
+         * @param encoding How the buffer was serialized
+         * @param channel Which channel it is sent on (checksum is skipped if disabled for it)
+         */
+        HeaderPkt_t makeHeader(
+            const void* buf,
+            const std::uint32_t size_to_tx,
+            const PktEncoding encoding,
+            const Channel channel
+        ) const;
+
+        /**
+         * @brief Checks a received message against its header's checksum
+         * @param recv The fully received message
+         * @param channel The channel it arrived on
+         * @return true if the data is intact (or the sender/channel skips checksums)
+         */
+        bool verifyChecksum(const RecvRtn& recv, const Channel channel) const;
+
+        /**
+         * @brief Builds the session hello a client sends first on every new connection, so the server can tell
+         * a reconnect apart from a new client (see HeaderPkt_t::FLAG_SESSION)
+         * @param session_token The client's session token (random, non-zero & fixed for the life of the process)
+         * @param channel The channel of the connection it is sent on
+         */
+        OutMsg makeSessionHello(const std::uint32_t session_token, const Channel channel) const;
+
+        /**
+         * @brief Get the session token out of a received session hello
+         * @return The token (0 if the message is not a valid session hello)
+         */
+        static std::uint32_t readSessionToken(const RecvRtn& hello);
+
+        /**
+         * @brief Make a clock ping/pong ready to queue (HeaderPkt_t::FLAG_CLOCK, always on the control channel)
+         * @param ping The ping (client) or the ping w/ the server's times filled in (server)
+         */
+        OutMsg makeClockMsg(const ClockPing& ping) const;
+
+        /**
+         * @brief Get the ping/pong out of a received clock message
+         * @return The ping (nothing if the message is not a valid clock message)
+         */
+        static std::optional<ClockPing> readClockMsg(const RecvRtn& msg);
+
+        /**
+         * @brief Log a message to the capture file (does nothing unless startCapture() was called)
+         * @param dir Whether it was sent or received
+         * @param channel The channel it went over
+         * @param header Its header
+         * @param data The message's data
+         * @param size The number of bytes of data
+         */
+        void captureMsg(
+            const CaptureDir dir,
+            const Channel channel,
+            const HeaderPkt_t& header,
+            const void* data,
+            const std::uint32_t size
+        );
+
+        /**
+         * @brief Send a message as a single datagram on `udp_chan` (Transport::Udp)
+         * @param dest Where to send it
+         * @param msg The message to send (header from makeHeader())
+         * @return Success if sent (a datagram lost to a full socket buffer also counts, the next one replaces it)
+         */
+        SendRtn sendDatagram(const sockaddr_in& dest, const OutMsg& msg);
+
+        /**
+         * @brief Receives the next datagram on `udp_chan` (Transport::Udp)
+         * @param pool The buffer pool the data is received straight into
+         * @param channel Which channel the datagram is for (decides if the checksum is verified)
+         * @return The datagram (check msg.RtnCode). Ones that fail their checksum are dropped & reported as an Error
+         * @note Does not filter stale datagrams, that is up to the caller's SeqFilter (one per sender)
+         */
+        DgramRtn recvDatagram(BufferPool& pool, const Channel channel);
+
+        /**
+         * @brief Non-blocking version of sendData(): writes as much of the writer's message as the socket takes
+         * @param socket_fd The non-blocking socket to send on
+         * @param writer The connection's writer (message queued w/ MsgWriter::start())
+         * @return Success once the whole message is sent, WouldBlock if should retry on EPOLLOUT, Error otherwise
+         * @note Uses MSG_ZEROCOPY for large messages if enableZeroCopy() was called for the socket
+         */
+        SendRtn continueSend(const int socket_fd, MsgWriter& writer);
+
+        /**
+         * @brief Non-blocking version of recvData(): reads as much of the next message as has arrived
+         * @param socket_fd The non-blocking socket to read from
+         * @param reader The connection's reader (keeps the progress between calls)
+         * @param pool The connection's buffer pool the data is received into
+         * @param channel Which channel the socket is for (decides if the checksum is verified)
+         * @return Success w/ the message once it fully arrived, WouldBlock if should retry once getRecvWaitFd() is
+         * readable, ClosedConn/Error if the connection is done. Messages that fail their checksum are dropped
+         * & reported as an Error (the stream stays in sync, so reading can continue)
+         * @note Uses the socket's io_uring engine if setIoEngine(IoEngine::Uring) was called
+         */
+        RecvRtn continueRecv(const int socket_fd, MsgReader& reader, BufferPool& pool, const Channel channel);
+
+        /**
+         * @brief Mux version of continueSend(): writes fragments of every channel's queued message (Transport::Mux)
+         * @param socket_fd The non-blocking socket every channel shares
+         * @param writer The connection's writer (messages queued w/ MuxWriter::start())
+         * @return Success once everything queued is sent, WouldBlock if should retry on EPOLLOUT, Error otherwise
+         */
+        SendRtn continueSend(const int socket_fd, MuxWriter& writer);
+
+        /**
+         * @brief Mux version of continueRecv(): reads fragments until a message of any channel is complete
+         * @param socket_fd The non-blocking socket every channel shares
+         * @param reader The connection's reader (keeps every channel's progress between calls)
+         * @param pools The buffer pool each channel's messages are received into
+         * @return Same as continueRecv() (header.channel says which channel the message is for)
+         */
+        RecvRtn continueRecv(const int socket_fd, MuxReader& reader, const MuxPools& pools);
+
+        /**
+         * @brief Get what a reactor should wait on (EPOLLIN) before calling continueRecv() for a socket
+         * @return The socket's io_uring ring if it is read w/ io_uring, otherwise the socket itself
+         * @note Call once the socket is connected & non-blocking (sets up its io_uring engine)
+         */
+        int getRecvWaitFd(const int socket_fd);
+
+        /**
+         * @brief Allow sendData() to use MSG_ZEROCOPY for large buffers sent on this socket
+         * @param socket_fd The socket to enable zero copy sends on
+         * @return Success if enabled, Error if the kernel does not support it (sends will just copy)
+         */
+        ReturnCodes enableZeroCopy(const int socket_fd);
+
+        /**
+         * @brief Marks a socket w/ its channel's priority & send queue limits (see SockTuning::tune())
+         * @param socket_fd The socket (a mux connection is tuned for every channel it carries)
+         * @param channel The channel the socket carries
+         * @return true if the socket's TCP_NOTSENT_LOWAT is in effect (see MuxWriter::setNotSentGate())
+         * @note Failures are only reported in verbose mode (always for a mux connection's low water mark),
+         * the socket still works untuned
+         */
+        bool tuneSock(const int socket_fd, const Channel channel);
+
         /**
          * @brief Creates the socket, bind it & sets options. Override to be called in constructor
          * @return Error as soon as any of the operations it performs fails. Success if no issues
          */
         virtual ReturnCodes initSock() = 0;
 
+        /**
+         * @brief Called by runNetAgent() to start the net agent's threads (w/ startNetThread())
+         * @note Defaults to a thread each for ControlLoopFn(), VideoStreamHandler() & ServerDataHandler().
+         * Override if the derived class drives its sockets differently (i.e. from a single reactor thread)
+         * @param print_data Should received data be printed?
+         */
+        virtual void launchNetThreads(const bool print_data);
+
+        /**
+         * @brief Runs a function in a new thread that is joined by cleanup()
+         */
+        void startNetThread(std::function<void()> thread_fn);
+
         /**
          * @brief The function to run when starting up the TCP server/client
          * (override so that it can be called by runNetAgent() in a thread)
@@ -189,6 +441,9 @@ class TcpBase : public Packet {
         /***************************** Protected Variables (Both Client/Server Can Use) *****************************/
     protected:
         RecvPktCallback             recv_cb;            // callback for when a packet is received
+        UdpChannel                  udp_chan;           // control & server data datagrams (Transport::Udp only)
+        FrameTimings                frame_timings;      // how long camera frames took to get through each hop
+        ClockSync                   clock_sync;         // the other host's clock (converts its timestamps to ours)
 
         /**
          * @brief Helper function that closes and sets a socket file descriptor to -1 if it is open
@@ -197,20 +452,50 @@ class TcpBase : public Packet {
          */
         virtual int CloseOpenSock(int sock_fd);
 
+        /**
+         * @brief Set the VIDEO_LADDER rung returned by getVideoSettings()
+         */
+        void setVideoRung(const std::size_t rung);
+
     private:
         /******************************************** Private Variables ********************************************/
 
         const bool                  is_verbose;         // false if should only print errors/important info
+        const Transport             transport;          // how control & server data pkts travel
         std::atomic_bool            should_exit;        // true if should exit/stop connection
-        std::thread                 control_thread;     // holds the thread proc for ControlLoopFn()
-        std::thread                 cam_vid_thread;     // holds the thread proc for VideoStreamHandler()
-        std::thread                 srv_data_thread;    // holds the thread proc for ServerDataHandler()
+        std::vector<std::thread>    net_threads;        // holds the thread procs started by launchNetThreads()
         std::atomic_bool            started_threads;    // need to send an initization message for first packet
         std::mutex                  thread_mutex;       // mutex controlling access to the classes threads (start/join)
         std::condition_variable     thread_cv;          // true if client needs to tell the server something
         std::atomic_bool            is_init;            // helps determine if needs to cleanup in derived classes
         std::atomic_bool            has_cleaned_up;     // makes sure cleanup doesnt happen twice
 
+        // per channel (indexed by Channel) true if checksums are computed/verified
+        std::array<std::atomic_bool, NUM_CHANNELS> checksum_enabled;
+
+        // zero copy vars
+        std::unordered_map<int, ZeroCopyTracker> zc_trackers; // per socket in-flight MSG_ZEROCOPY sends
+        std::mutex                  zc_mutex;           // controls access to `zc_trackers`
+
+        // io engine vars
+        std::atomic<IoEngine>       io_engine;          // how recvData() reads
+        std::unordered_map<int, std::unique_ptr<UringEngine>> uring_engines; // per socket io_uring state
+        std::mutex                  uring_mutex;        // controls access to `uring_engines`
+        std::atomic<std::uint64_t>  recv_syscalls;      // syscalls made by recvData()/continueRecv()
+        std::atomic<std::size_t>    video_rung;         // VIDEO_LADDER index the camera should encode at
+
+        // capture vars
+        CaptureWriter               capture;            // every message sent/received (see startCapture())
+        std::atomic_bool            is_capturing;       // checked before touching `capture` (off by default)
+
+        /********************************************* Helper Functions ********************************************/
+
+        /**
+         * @brief Get a socket's io_uring engine (setup on first use)
+         * @return nullptr if it could not be setup (socket is read w/ recv() instead)
+         */
+        UringEngine* getUringEngine(const int socket_fd);
+
 }; // end of TcpClient class
 
 
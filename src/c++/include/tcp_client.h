@@ -9,13 +9,21 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h> // for socket close()
+#include <fcntl.h> // for O_NONBLOCK
 #include <cstring> // for memset
 #include <chrono> // send packet every right before server timeout
 #include <mutex>
+#include <memory> // for shared_ptr
+#include <algorithm> // for std::max
+#include <random> // for the session token
+#include <array>
 
 // Our Includes
 #include "constants.h"
 #include "tcp_base.h"
+#include "reactor.h"
+#include "net_conn.h"
+#include "shm_ring.h"
 
 // 3rd Party Includes
 
@@ -34,6 +42,11 @@ class TcpClient : public TcpBase {
          * @param srv_data_port_num The port to recv server data on
          * @param should_init False: do not init (most likely bc should run server)
          * @param verbosity If true, will print more information that is strictly necessary
+         * @param encoding How control packets are serialized (the server answers in the same encoding)
+         * @param transport How control & server data pkts travel. Udp: both go over datagrams to/from the server's
+         * control port (srv_data_port_num is unused), camera frames stay on tcp.
+         * Local: server is on the same machine, control & server data over unix sockets, camera frames through shared memory.
+         * Mux: every channel over a single connection to the control port (cam_port_num & srv_data_port_num are unused)
          */
         TcpClient(
             const std::string& ip_addr,
@@ -41,7 +54,9 @@ class TcpClient : public TcpBase {
             const int cam_port_num,
             const int srv_data_port_num,
             const bool should_init,
-            const bool verbosity=false
+            const bool verbosity=false,
+            const PktEncoding encoding=PktEncoding::Binary,
+            const Transport transport=Transport::Tcp
         );
         virtual ~TcpClient();
 
@@ -59,35 +74,79 @@ class TcpClient : public TcpBase {
     protected:
 
         /**
-         * @brief Starts up a non-blocking function to start sending messages to server
+         * @brief Runs the whole client from a single reactor thread (only starts ControlLoopFn())
+         * @note Camera frames from shared memory (Transport::Local) get a thread of their own (see ShmCamLoopFn())
+         * @param print_data Should received data be printed?
+         */
+        virtual void launchNetThreads(const bool print_data) override;
+
+        /**
+         * @brief The client's reactor loop: connects to the server, then waits (epoll) on the connections,
+         * the new data eventfd & the next control heartbeat and dispatches whichever are ready until told to exit
+         * @note If a connection closes after connecting, every connection is reopened w/ exponential backoff
+         * (see dropConns()). The latest control pkt is resent as soon as the control connection is back
          * @param print_data Should received data be printed?
          */
         virtual void ControlLoopFn(const bool print_data) override;
 
         /**
-         * @brief Starts up a non-blocking function to recv video frames from server camera 
+         * @brief Reads every camera frame that has arrived & keeps the newest (called by the reactor)
          */
         virtual void VideoStreamHandler() override;
 
         /**
-         * @brief Starts up a non-blocking function to recv data from the server (not-camera related) 
+         * @brief Reads every server data pkt that has arrived & keeps the newest (called by the reactor)
+         * @param print_data Should received data be printed?
          */
         virtual void ServerDataHandler(const bool print_data) override;
 
     private:
         /******************************************** Private Variables ********************************************/
 
+        Reactor                     reactor;            // waits on all of the client's sockets from one thread
+
+        // session vars
+        const std::uint32_t         session_token;      // sent first on every connection, so the server can tell a reconnect
+        bool                        is_connected;       // false while waiting to reconnect
+        bool                        conns_lost;         // set once a connection closed (all are reconnected after the current events)
+        std::chrono::milliseconds   reconnect_backoff;  // how long to wait before the next reconnect attempt
+        std::chrono::steady_clock::time_point reconnect_at; // when to try reconnecting
+        std::chrono::steady_clock::time_point connected_at; // when the connections were last (re)made
+        std::array<bool, NUM_CHANNELS> conn_pending;    // channels whose reconnect handshake is still in progress
+        std::chrono::steady_clock::time_point connect_deadline; // when to give up on the pending handshakes
+
         int                         ctrl_data_sock_fd;  // tcp socket file descriptor that sends control data to server
         std::string                 server_ip;          // ip address of the server
         const int                   ctrl_data_port;     // port number to send control data to the server
+        MsgWriter                   ctrl_writer;        // partially sent control pkt
+        MsgReader                   ctrl_reader;        // partially received clock pong (the server's only reply on it)
+        BufferPool                  ctrl_rx_pool;       // reusable buffers clock pongs are received into
+        std::chrono::steady_clock::time_point next_clock_ping; // when to ping the server's clock next
+        bool                        ctrl_wait_writable; // true while the reactor is waiting for EPOLLOUT on the control socket
+        MuxReader                   mux_reader;         // frames & server data received on the control socket (Transport::Mux)
+        MuxWriter                   mux_writer;         // partially sent control pkt (Transport::Mux)
 
         // camera vars
         int                         cam_data_sock_fd;   // tcp file descriptor for camera data from server
         const int                   cam_data_port;      // port number for getting camera from server
+        BufferPool                  cam_rx_pool;        // reusable buffers camera frames are received into
+        MsgReader                   cam_reader;         // partially received camera frame
+        int                         cam_wait_fd;        // what the reactor waits on for frames (see getRecvWaitFd())
+        ShmFrameRing                cam_shm;            // server's camera frames (Transport::Local)
 
         // server data vars
         int                         srv_data_sock_fd;   // tcp file descriptor for server data from server
         const int                   srv_data_port;      // port number for getting "server data" from server
+        BufferPool                  srv_rx_pool;        // reusable buffers server data pkts are received into
+        MsgReader                   srv_reader;         // partially received server data pkt
+        int                         srv_wait_fd;        // what the reactor waits on for server data (see getRecvWaitFd())
+
+        // udp vars
+        sockaddr_in                 server_udp_addr;    // where control datagrams are sent (server's control port)
+        SeqFilter                   srv_rx_seq;         // newest server data datagram received
+
+        // serialization vars
+        const PktEncoding           pkt_encoding;       // how control packets are serialized when sent to server
 
         /********************************************* Helper Functions ********************************************/
 
@@ -103,10 +162,162 @@ class TcpClient : public TcpBase {
          * @param ip The ip to connect to
          * @param port The port to connect to
          * @param conn_desc Description of the connection (i.e. "camera" or "control")
-         * @return ReturnCodes 
+         * @return ReturnCodes (TryAgain if the socket is non-blocking & the handshake is still in progress)
          */
         ReturnCodes connectToServer(int& sock_fd, const std::string& ip, const int port, const std::string& conn_desc);
 
+        // a channel's stream socket & where it connects to
+        struct StreamConn {
+            int&            sock_fd;
+            const int       port;
+            const std::string desc;
+        };
+
+        /**
+         * @brief Get a channel's stream socket, port & description (control is the mux connection w/ Transport::Mux)
+         */
+        StreamConn getStreamConn(const Channel channel);
+
+        /**
+         * @brief Creates the stream sockets (& sets their options) for connectToServer()
+         * @return Error if any could not be created
+         */
+        ReturnCodes openStreamSocks();
+
+        /**
+         * @brief Connects every channel, sends each its session hello & starts watching them
+         * (control, camera & server data)
+         * @return Error if the control channel could not be setup (the others just go without)
+         * @note Blocks while connecting (only used for the first connection, see reconnect())
+         */
+        ReturnCodes setupConns();
+
+        /**
+         * @brief Sends the session hello on every connected socket, makes them non-blocking & starts watching them
+         * @return Error if the control channel could not be setup
+         */
+        ReturnCodes watchConns();
+
+        /**
+         * @brief Sends the session hello on a freshly connected socket
+         * @param sock_fd The socket
+         * @param channel The channel it is for
+         * @return Error if it could not be sent
+         */
+        ReturnCodes sendSessionHello(const int sock_fd, const Channel channel);
+
+        /**
+         * @brief Closes every connection (dropping anything half sent/received) & schedules reconnecting.
+         * Waits Constants::Network::RECONNECT_MIN_MS unless the connections dropped soon after being made,
+         * then twice as long as last time (up to RECONNECT_MAX_MS)
+         */
+        void dropConns();
+
+        /**
+         * @brief Tries to reopen every connection (w/ the same session token, so the server resumes the session)
+         * @note Connects w/o blocking, the reactor finishes the handshakes (see finishConnect()) & gives up on them
+         * after Constants::Network::ACPT_TIMEOUT. If it fails, the next attempt waits twice as long
+         * (up to Constants::Network::RECONNECT_MAX_MS)
+         */
+        void reconnect();
+
+        /**
+         * @brief Closes whatever did connect & schedules the next reconnect attempt (twice as long a wait)
+         */
+        void retryReconnect();
+
+        /**
+         * @brief Starts connecting a channel's non-blocking socket & has the reactor wait until it is writable
+         * @return Success if connecting (or nothing to connect w/ this transport), Error if it failed right away
+         */
+        ReturnCodes startConnect(const Channel channel);
+
+        /**
+         * @brief Checks how a channel's pending handshake went (SO_ERROR) & starts using the connections once
+         * every channel is done (called by the reactor once the socket is writable/failed or the deadline passed)
+         * @param channel The channel whose socket is done
+         * @param timed_out true if it did not connect by connect_deadline
+         */
+        void finishConnect(const Channel channel, const bool timed_out);
+
+        /**
+         * @brief Starts using the connections once no handshake is pending (retries later w/o a control connection)
+         */
+        void completeReconnect();
+
+        /**
+         * @brief Determine if any reconnect handshake is still pending
+         */
+        bool isConnecting() const;
+
+        /**
+         * @brief Reads camera frames out of shared memory until told to exit (Transport::Local)
+         * @note Runs in its own thread, frames are waited on w/ a futex (which the reactor cannot watch)
+         */
+        void ShmCamLoopFn();
+
+        /**
+         * @brief Sends the latest control pkt to the server
+         * @note If the previous one is still being sent, this one goes out once it is done
+         * @param print_data Should sent data be printed?
+         * @return Error if the control connection failed
+         */
+        ReturnCodes sendCtrlPkt(const bool print_data);
+
+        /**
+         * @brief Writes as much of the control pkt in progress as possible,
+         * waiting for EPOLLOUT only while the socket is full
+         * @return Error if the control connection failed
+         */
+        ReturnCodes flushCtrl();
+
+        /**
+         * @brief Sends a clock ping to the server (see ClockSync), unless a pkt is still being sent on the control channel
+         * @note Schedules the next one (Constants::Network::CLOCK_SYNC_BURST_MS apart until synced, then CLOCK_SYNC_MS)
+         * @return Error if the control connection failed
+         */
+        ReturnCodes sendClockPing();
+
+        /**
+         * @brief Reads every clock pong that has arrived on the control socket (not Transport::Mux/Udp)
+         * @return Error if the connection closed/failed
+         */
+        ReturnCodes CtrlRecvHandler();
+
+        /**
+         * @brief Adds a clock pong to the estimate of the server's clock
+         * @param pong_recv The fully received pong
+         * @param recv_us When it was received (ClockSync::now())
+         */
+        void saveClockPong(const RecvRtn& pong_recv, const std::uint64_t recv_us);
+
+        /**
+         * @brief Reads every server data datagram & clock pong that has arrived (Transport::Udp)
+         * @note Datagrams not from the server or older than one already received are dropped (pongs are always used)
+         * @param print_data Should received data be printed?
+         */
+        void recvSrvDatagrams(const bool print_data);
+
+        /**
+         * @brief Reads every camera frame, server data pkt & clock pong that has arrived on the control socket (Transport::Mux)
+         * @param print_data Should received data be printed?
+         * @return Error if the connection closed/failed
+         */
+        ReturnCodes MuxRecvHandler(const bool print_data);
+
+        /**
+         * @brief Saves a fully received camera frame as the latest one (& records how long its hops took)
+         * @note The server's times are converted to the client's clock, frames are left unstamped until it is synced
+         */
+        void saveCamFrame(const RecvRtn& img_recv);
+
+        /**
+         * @brief Decodes a server data pkt & saves it as the latest one
+         * @param srv_data_recv The fully received pkt
+         * @param print_data Should received data be printed?
+         */
+        void saveSrvData(const RecvRtn& srv_data_recv, const bool print_data);
+
         /**
          * @brief Function called at the end of running client to close the sockets
          */
@@ -11,10 +11,19 @@
 #include <unistd.h> // for socket close()
 #include <cstring> // for memset
 #include <atomic> // for memset
+#include <sys/epoll.h>
+#include <chrono>
+#include <list>
+#include <vector>
 
 // Our Includes
 #include "constants.h"
 #include "tcp_base.h"
+#include "reactor.h"
+#include "net_conn.h"
+#include "broadcast_ring.h"
+#include "shm_ring.h"
+#include "link_estimator.h"
 
 // 3rd Party Includes
 
@@ -32,30 +41,41 @@ class TcpServer : public TcpBase {
          * @param srv_data_port_num The port to send server data to client on
          * @param should_init False: do not init (most likely bc should run client)
          * @param verbosity If true, will print more information that is strictly necessary
+         * @param transport How control & server data pkts travel. Udp: both go over datagrams on the control port
+         * (server data is sent back to wherever control datagrams come from), camera frames stay on tcp.
+         * Local: control & server data over unix sockets, camera frames through shared memory (client on same machine).
+         * Mux: every channel over a single connection per client on the control port (other ports are unused)
          */
         TcpServer(
             const int ctrl_data_port,
             const int cam_send_port,
             const int srv_data_port_num,
             const bool should_init,
-            const bool verbosity=false
+            const bool verbosity=false,
+            const Transport transport=Transport::Tcp
         );
         virtual ~TcpServer();
 
         /********************************************* Getters/Setters *********************************************/
 
+        /**
+         * @brief Get how long control pkts took to get from the clients to the server (one-way, µs)
+         * @note Only pkts sent once the client's clock was synced count (see ClockSync)
+         */
+        const LatencyHistogram& getCtrlLatency() const;
 
         /********************************************* Server Functions ********************************************/
 
         /**
-         * @brief Accept a new connection and stores the IP of the client
+         * @brief Accept a pending connection (non-blocking) and stores the IP of the client
          * @param listen_sock_fd the sock file descriptor that is listening such that it can accepting client
          * @param data_sock_fd the sock file descriptor to assigned the accepted client to
          * @param conn_desc A string stating the purpose of the connection (i.e. camera/control)
          * @param port The port to accept the client connection on
-         * @note the socket file descriptors are references so they can be modified
-         * @return Success if connected successfully
-         * @return Error if failed to connect to client
+         * @note the socket file descriptors are references so they can be modified.
+         * Call once the reactor reports the listen socket is readable
+         * @return Success if connected successfully (data_sock_fd is non-blocking)
+         * @return Error if there was no connection to accept or it was refused
          */
         ReturnCodes acceptClient(
             int& listen_sock_fd,
@@ -74,18 +94,29 @@ class TcpServer : public TcpBase {
     protected:
 
         /**
-         * @brief Starts up a non-blocking function to start the server listener
+         * @brief Runs the whole server from a single reactor thread (only starts ControlLoopFn())
+         * @param print_data Should received data be printed?
+         */
+        virtual void launchNetThreads(const bool print_data) override;
+
+        /**
+         * @brief The server's reactor loop: waits (epoll) on the listen sockets, client connections
+         * & the new data eventfd and dispatches whichever are ready until told to exit
          * @param print_data Should received data be printed?
          */
         virtual void ControlLoopFn(const bool print_data) override;
 
         /**
-         * @brief Starts up a non-blocking function to send video frames from camera to client
+         * @brief Publishes the newest camera frame (if any) & sends each camera subscriber what it is missing
+         * (called by the reactor)
+         * @note Subscribers still sending an older frame catch up once done (skipping to the newest if lapped)
          */
         virtual void VideoStreamHandler() override;
 
         /**
-         * @brief Starts up a non-blocking function to send server data to the client (not-camera related) 
+         * @brief Publishes the newest server data packet (if any) & sends it to each server data subscriber
+         * (called by the reactor)
+         * @param print_data Should sent data be printed?
          */
         virtual void ServerDataHandler(const bool print_data) override;
 
@@ -93,23 +124,38 @@ class TcpServer : public TcpBase {
         /******************************************** Private Variables ********************************************/
 
         // misc vars
-        std::atomic_bool         close_conns;         // true if a connection has been closed (meaning all should)
+        std::atomic<PktEncoding> peer_encoding;       // encoding of the client's last control pkt (used for srv data)
+        Reactor                  reactor;             // waits on all of the server's sockets from one thread
+        std::vector<epoll_event> sched_events;        // ready events, most urgent channel first (see scheduleEvents())
+        std::string              public_ip;           // ip address the server can be reached at (looked up once)
 
         // control vars
         int                      ctrl_listen_sock_fd; // tcp socket file descriptor to accept connections from client
-        int                      ctrl_data_sock_fd;   // tcp socket file descriptor to recv control data from client
-        std::string              client_ip;           // ip address of connected client
+        std::list<NetConn>       ctrl_conns;          // connections to recv control data from (front is the driver)
+                                                      // (Transport::Mux: also where camera & server data go)
+        std::string              client_ip;           // ip address of the most recently connected client
         const int                ctrl_data_port;      // port number for socket receiving control data from client
+        BufferPool               ctrl_rx_pool;        // reusable buffers control pkts are received into
+        std::list<UdpPeer>       udp_peers;           // clients sending control datagrams (front is the driver)
+        LatencyHistogram         ctrl_latency;        // one-way latency of the control pkts (see getCtrlLatency())
 
         // camera vars
         int                      cam_listen_sock_fd;  // tcp file descriptor to wait for camera conn
-        int                      cam_data_sock_fd;    // tcp file descriptor to transfer camera data
+        std::list<NetConn>       cam_conns;           // camera subscribers
+        BroadcastRing<OutMsg>    cam_ring;            // most recent frames being sent to the camera subscribers
         const int                cam_data_port;       // port number for camera data transfer to client
+        ShmFrameRing             cam_shm;             // camera frames for a client on the same machine (Transport::Local)
+        VideoRateController      video_rate;          // picks the camera's encoder settings from the subscribers' links
+        std::chrono::steady_clock::time_point rate_sampled; // when the camera subscribers' links were last measured
 
         // server data vars
         int                      srv_data_listen_sock_fd;   // tcp file descriptor to wait for server data conn
-        int                      srv_data_sock_fd;          // tcp file descriptor to transfer server data to client
+        std::list<NetConn>       srv_conns;                 // server data subscribers
+        BroadcastRing<OutMsg>    srv_ring;                  // most recent server data pkts being sent to subscribers
         const int                srv_data_port;             // port number for server data transfer to client
+        OutMsg                   latest_srv_msg;            // newest server data pkt (resent to udp peers as heartbeat)
+        std::chrono::steady_clock::time_point srv_msg_sent; // when latest_srv_msg last went out to the udp peers
+        std::uint16_t            srv_pkt_seq;               // seq of the newest server data pkt (HeaderPkt_t::id, wraps)
 
         /********************************************* Helper Functions ********************************************/
 
@@ -124,6 +170,158 @@ class TcpServer : public TcpBase {
          */
         void quit() override;
 
+        /**
+         * @brief Creates a non-blocking tcp socket that listens for connections on a port
+         * (a unix socket named after the port if Transport::Local)
+         * @param port The port to listen on
+         * @param conn_desc A string stating the purpose of the connection (i.e. camera/control)
+         * @return The listen socket's file descriptor (-1 if any step failed)
+         */
+        int openListenSock(const int port, const std::string& conn_desc);
+
+        /**
+         * @brief Accepts a connection on whichever listen socket is ready & starts watching it
+         * @param listen_sock_fd The listen socket the reactor reported as readable
+         */
+        void handleAccept(const int listen_sock_fd);
+
+        /**
+         * @brief Handles a readiness event for one of the clients' connections
+         * @param sock_fd The connection the reactor reported
+         * @param events The ready epoll events
+         * @param print_data Should received data be printed?
+         * @return true if a connection was closed
+         */
+        bool handleConnEvent(const int sock_fd, const std::uint32_t events, const bool print_data);
+
+        /**
+         * @brief Reads what a subscriber sent (only ever its session hello, anything else is dropped)
+         * @param conn The camera/server data connection
+         * @return Error if the connection closed/failed
+         */
+        ReturnCodes handleSubscriberRecv(NetConn& conn);
+
+        /**
+         * @brief If a connection's session hello matches an older connection of the same list, the client
+         * reconnected before the old one timed out: the new connection takes its place (so a driver keeps driving
+         * & subscribers are not counted twice) & the old one is closed
+         * @param conns The list the connection is in
+         * @param conn The connection that may have received a session hello
+         * @param conn_desc Description of the connection (i.e. "camera" or "control")
+         * @return true if a connection was closed
+         */
+        bool resumeSession(std::list<NetConn>& conns, std::list<NetConn>::iterator conn, const std::string& conn_desc);
+
+        /**
+         * @brief Orders the reactor's ready events so the most urgent channels are handled (& sent) first:
+         * wakeups, accepts & control, then server data subscribers, then camera subscribers
+         * @param ready The ready events from the reactor
+         * @return The reordered events (valid until the next call)
+         */
+        const std::vector<epoll_event>& scheduleEvents(const std::vector<epoll_event>& ready);
+
+        /**
+         * @brief Get the channelPriority() of the channel a watched fd belongs to (control if it is not a subscriber)
+         */
+        std::uint8_t getFdPriority(const int fd) const;
+
+        /**
+         * @brief Reads & processes every control pkt that has arrived on a control connection
+         * @param conn The control connection to read from
+         * @param print_data Should received data be printed?
+         * @return Error if the connection closed/failed
+         */
+        ReturnCodes handleCtrlRecv(NetConn& conn, const bool print_data);
+
+        /**
+         * @brief Reads & processes every control datagram that has arrived (Transport::Udp)
+         * @note Stale datagrams (older than one already received from the same client) are dropped
+         * @param print_data Should received data be printed?
+         */
+        void handleCtrlDatagrams(const bool print_data);
+
+        /**
+         * @brief Make the pong for a clock ping (the ping w/ the server's times filled in)
+         * @param ping_recv The fully received ping
+         * @param recv_us When it was received (ClockSync::now())
+         * @return The pong ready to send (nothing if the ping is malformed)
+         */
+        std::optional<OutMsg> makeClockPong(const RecvRtn& ping_recv, const std::uint64_t recv_us) const;
+
+        /**
+         * @brief Answers a clock ping on a control connection
+         * @note The pong is dropped if the connection is still sending something else (the client pings again)
+         * @return Error if the connection failed
+         */
+        ReturnCodes answerClockPing(NetConn& conn, const RecvRtn& ping_recv, const std::uint64_t recv_us);
+
+        /**
+         * @brief Records the one-way latency of a control pkt (if the client stamped it, see HeaderPkt_t::getOriginTime())
+         */
+        void recordCtrlLatency(const HeaderPkt_t& header, const std::uint64_t recv_us);
+
+        /**
+         * @brief Processes a single fully received control pkt from the driver
+         * @note Only the driver's (oldest control connection/udp peer) pkts control the robot, the rest just observe
+         */
+        void processCtrlPkt(const RecvRtn& ctrl_recv, const bool print_data);
+
+        /**
+         * @brief Sends the newest server data pkt to every udp peer (Transport::Udp)
+         * @param force false: only resend if a heartbeat is due
+         */
+        void sendSrvDatagrams(const bool force);
+
+        /**
+         * @brief Writes as much of the connection's current message as possible,
+         * waiting for EPOLLOUT only while the socket is full
+         * @return Error if the connection failed
+         */
+        ReturnCodes flushSend(NetConn& conn);
+
+        /**
+         * @brief Sends a subscriber every message it has not gotten yet (until its socket is full)
+         * @param conn The subscriber's connection
+         * @param ring The messages being broadcast
+         * @note Camera subscribers whose queued frames already take longer than Constants::Camera::TARGET_LATENCY_MS
+         * to drain are held back, so they skip to the newest frame once they catch up instead of lagging further
+         * @return Error if the connection failed
+         */
+        ReturnCodes pumpSubscriber(NetConn& conn, BroadcastRing<OutMsg>& ring);
+
+        /**
+         * @brief Queues the camera frames & server data pkts a mux client has not gotten yet & sends as many
+         * fragments as its socket takes (Transport::Mux)
+         * @param conn The client's connection (one of `ctrl_conns`)
+         * @note Camera frames are held back like in pumpSubscriber() if they take too long to drain
+         * @return Error if the connection failed
+         */
+        ReturnCodes pumpMux(NetConn& conn);
+
+        /**
+         * @brief Calls pumpMux() for every mux client, closing the ones that failed (no-op unless Transport::Mux)
+         */
+        void pumpMuxConns();
+
+        /**
+         * @brief Measures the camera subscribers' links (every Constants::Network::RATE_SAMPLE_MS) & moves the
+         * camera's encoder settings (see getVideoSettings()) up/down the VIDEO_LADDER to suit the slowest one
+         */
+        void updateVideoRate();
+
+        /**
+         * @brief Closes a single connection (other connections are unaffected)
+         * @param conns The list the connection belongs to
+         * @param conn The connection to close (removed from the list)
+         * @param conn_desc A string stating the purpose of the connection (i.e. camera/control)
+         */
+        void closeConn(std::list<NetConn>& conns, std::list<NetConn>::iterator conn, const std::string& conn_desc);
+
+        /**
+         * @brief Determine if a socket has a pending error (i.e. reset by the client)
+         */
+        bool hasSockError(const int sock_fd) const;
+
 
 }; // end of TcpServer class
 
@@ -0,0 +1,195 @@
+#ifndef RPI_UDP_CHANNEL_H
+#define RPI_UDP_CHANNEL_H
+
+// Standard Includes
+#include <cstdint>
+#include <chrono>
+#include <atomic>
+#include <random>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h> // for iovec
+
+// Our Includes
+#include "constants.h"
+#include "packet.h"
+#include "buffer_pool.h"
+#include "net_conn.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Prefixed to every datagram (before the regular HeaderPkt_t) so the receiver can tell
+ * which datagrams are newer than what it already has
+ */
+struct DgramStamp {
+    std::uint64_t   seq             {0}; // per sending socket, starts at 1 & goes up by one every datagram
+    std::uint64_t   send_time_us    {0}; // sender's wall clock when sent (microseconds since epoch)
+
+    // number of bytes the stamp takes up on the wire (network byte order)
+    static constexpr std::size_t WIRE_SIZE {16};
+
+    DgramStamp() = default;
+    explicit DgramStamp(const std::uint8_t* wire_buf); // reads WIRE_SIZE bytes
+    void pack(std::uint8_t* wire_buf) const; // writes WIRE_SIZE bytes
+};
+
+// holds the return of UdpChannel::recvFrom()
+struct DgramRtn {
+    RecvRtn         msg;    // the header + data (same as a tcp message, check msg.RtnCode)
+    DgramStamp      stamp;  // when/in what order the datagram was sent
+    sockaddr_in     from;   // who sent it
+};
+
+/**
+ * @brief Tracks the newest datagram accepted from a sender & rejects anything that is not newer
+ * (duplicates, datagrams that got reordered behind a newer one)
+ */
+class SeqFilter {
+    public:
+        /**
+         * @brief Decide if a datagram is newer than everything accepted so far (& remember it if so)
+         * @param stamp The datagram's stamp
+         * @return true if it should be used, false if it is stale
+         * @note A lower seq that was sent later than the newest accepted datagram means the sender restarted,
+         * so it is accepted & the sequence starts over from it
+         */
+        bool accept(const DgramStamp& stamp);
+
+        std::uint64_t getLastSeq() const;
+        std::uint64_t getNumStale() const;
+
+    private:
+        std::uint64_t   last_seq        {0};    // seq of the newest accepted datagram
+        std::uint64_t   last_send_time  {0};    // when the newest accepted datagram was sent
+        std::uint64_t   num_stale       {0};    // how many datagrams have been rejected
+};
+
+/**
+ * @brief Someone the server exchanges datagrams with (there are no connections, so they are tracked by address)
+ */
+struct UdpPeer {
+    sockaddr_in                             addr    {};     // where datagrams came from & are sent back to
+    SeqFilter                               rx_seq  {};     // newest datagram received from them
+    std::chrono::steady_clock::time_point   last_rx {};     // when they last sent something new
+};
+
+/**
+ * @brief Simulated network loss applied to outgoing datagrams (all rates are fractions from 0 to 1)
+ * @note For testing the udp transport over loopback, which never loses anything on its own
+ */
+struct LossShim {
+    double          drop_rate       {0.0};  // datagrams that never get sent
+    double          dup_rate        {0.0};  // datagrams sent twice
+    double          reorder_rate    {0.0};  // datagrams held back & sent after the next one
+    std::uint32_t   seed            {1};    // seeds the random number generator (runs are repeatable)
+
+    bool isActive() const { return drop_rate > 0 || dup_rate > 0 || reorder_rate > 0; }
+};
+
+/**
+ * @brief A udp socket that sends/receives stamped messages (DgramStamp + HeaderPkt_t + data),
+ * each in a single datagram
+ */
+class UdpChannel {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        UdpChannel();
+        virtual ~UdpChannel();
+
+        UdpChannel(const UdpChannel&) = delete;
+        UdpChannel& operator=(const UdpChannel&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        int getFd() const;
+        bool isOpen() const;
+
+        /**
+         * @brief Inject loss into every datagram sent from now on (see LossShim)
+         * @note Set it before sending starts (not synchronized w/ sendTo())
+         */
+        void setLossShim(const LossShim& new_shim);
+
+        /**
+         * @brief Get the number of datagrams the loss shim dropped
+         */
+        std::uint64_t getNumShimDropped() const;
+
+        /********************************************** Socket Functions *******************************************/
+
+        /**
+         * @brief Open the socket
+         * @param port The port to bind to (0: let the os pick, for sockets that only talk to a known address)
+         * @param non_blocking true: recvFrom() returns WouldBlock instead of waiting
+         * @param recv_timeout_sec (blocking only) longest recvFrom() waits before returning WouldBlock
+         * @return Error if the socket could not be created/bound
+         */
+        ReturnCodes open(const int port, const bool non_blocking, const int recv_timeout_sec=0);
+
+        /**
+         * @brief Close the socket (if open)
+         */
+        void close();
+
+        /**
+         * @brief Send a message as a single datagram (stamped w/ the next seq & the current time)
+         * @param dest Where to send it
+         * @param msg The message to send (header already filled in)
+         * @return Success (w/ the data size) if sent (or dropped by the loss shim), Error otherwise.
+         * Messages larger than Constants::Network::MAX_DGRAM_SIZE are refused (Error)
+         */
+        SendRtn sendTo(const sockaddr_in& dest, const OutMsg& msg);
+
+        /**
+         * @brief Receive the next datagram straight into a pooled buffer
+         * @param pool The buffer pool to receive the data into
+         * @return Success w/ the message, WouldBlock if nothing arrived (in time),
+         * Error if the datagram was malformed (it is discarded) or the socket failed
+         */
+        DgramRtn recvFrom(BufferPool& pool);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        int                         sock_fd;        // the udp socket (-1 if closed)
+        std::atomic<std::uint64_t>  next_seq;       // seq the next datagram is stamped with
+
+        // loss shim vars
+        LossShim                    shim;           // how much loss to simulate
+        std::minstd_rand            shim_rng;       // decides which datagrams are affected
+        std::vector<std::uint8_t>   held_dgram;     // datagram being held back (reordered), empty if none
+        sockaddr_in                 held_dest;      // where the held back datagram goes
+        std::atomic<std::uint64_t>  shim_dropped;   // datagrams the shim dropped
+
+        /********************************************* Helper Functions ********************************************/
+
+        /**
+         * @brief Sends an already packed datagram (runs it through the loss shim if active)
+         * @return false if the socket failed
+         */
+        bool sendPacked(const sockaddr_in& dest, const iovec* iov, const std::size_t iov_len);
+
+        /**
+         * @brief Rolls the shim's dice
+         * @return true w/ probability `rate`
+         */
+        bool shimRoll(const double rate);
+
+}; // end of UdpChannel class
+
+/**
+ * @brief Determine if two addresses are the same host & port
+ */
+bool isSameAddr(const sockaddr_in& lhs, const sockaddr_in& rhs);
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
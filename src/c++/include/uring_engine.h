@@ -0,0 +1,186 @@
+#ifndef RPI_URING_ENGINE_H
+#define RPI_URING_ENGINE_H
+
+// Standard Includes
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+
+// Our Includes
+#include "constants.h"
+#include "packet.h"
+#include "buffer_pool.h"
+#include "net_conn.h"
+
+// 3rd Party Includes
+
+// only the kernel's definitions are needed (io_uring is driven w/ raw syscalls, no liburing)
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Reads messages (header + data) from a blocking stream socket w/ io_uring instead of a recv() per chunk
+ * @note A single multishot recv stays armed on the socket & the kernel picks one of a ring of provided buffers
+ * (registered once w/ IORING_REGISTER_PBUF_RING) for every chunk that arrives,
+ * so one io_uring_enter() both submits whatever needs (re)arming & reaps every chunk that arrived meanwhile.
+ * Headers & data are parsed out of the provided buffers (like MsgReader) & copied into pooled buffers,
+ * after which the provided buffers go straight back to the kernel.
+ * One engine per socket, only used by the thread reading that socket.
+ * Blocking sockets wait in recvMsg(), non-blocking ones never wait: a reactor waits on getRingFd() instead
+ * (readable once a chunk arrived)
+ */
+class UringEngine {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        UringEngine();
+        virtual ~UringEngine();
+
+        UringEngine(const UringEngine&) = delete;
+        UringEngine& operator=(const UringEngine&) = delete;
+
+        /********************************************* Getters/Setters *********************************************/
+
+        /**
+         * @brief Determine if the kernel has everything the engine needs
+         * (io_uring, timed waits & provided buffer rings, checked once)
+         */
+        static bool isSupported();
+
+        /**
+         * @brief Determine if the kernel refused the multishot recv (older than 6.0)
+         * @note Only set before any data was read, so the socket can carry on w/ recv()
+         */
+        bool hasFailed() const;
+
+        /**
+         * @brief Get the io_uring instance's fd (-1 if not setup), readable (epoll) whenever chunks are waiting
+         */
+        int getRingFd() const;
+
+        /********************************************* Engine Functions ********************************************/
+
+        /**
+         * @brief Sets up the rings & provided buffers for a socket
+         * @param sock_fd The connected stream socket to read (its SO_RCVTIMEO becomes recvMsg()'s timeout,
+         * set O_NONBLOCK first if a reactor waits on getRingFd())
+         * @param buf_size Size of each provided buffer
+         * @param num_bufs Number of provided buffers (power of 2)
+         * @return Error if io_uring is unavailable or any step failed
+         */
+        ReturnCodes init(
+            const int sock_fd,
+            const std::size_t buf_size=Constants::Network::URING_BUF_SIZE,
+            const unsigned num_bufs=Constants::Network::URING_NUM_BUFS
+        );
+
+        /**
+         * @brief Waits for the next full message
+         * @param pool The buffer pool to copy the message's data into
+         * @param num_syscalls Incremented for every io_uring_enter() it takes
+         * @return Success w/ the message, WouldBlock if none arrived within the socket's receive timeout
+         * (right away for non-blocking sockets),
+         * ClosedConn/Error if the connection is done.
+         * Messages too large for the pool are drained & return Error (the stream stays in sync)
+         */
+        RecvRtn recvMsg(BufferPool& pool, std::uint64_t& num_syscalls);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        // a chunk the kernel received into a provided buffer (not fully parsed yet)
+        struct Chunk {
+            std::uint16_t   buf_id;     // which provided buffer
+            std::uint32_t   offset;     // bytes already parsed
+            std::uint32_t   size;       // bytes received
+        };
+
+        int                 ring_fd;        // the io_uring instance (-1 if not setup)
+        int                 sock_fd;        // the socket being read
+        int                 timeout_ms;     // how long recvMsg() waits (-1: forever)
+
+        // submission queue (shared w/ the kernel)
+        void*               sq_map;
+        std::size_t         sq_map_size;
+        unsigned*           sq_head;
+        unsigned*           sq_tail;
+        unsigned*           sq_mask;
+        unsigned*           sq_array;
+        io_uring_sqe*       sqes;
+        std::size_t         sqes_size;
+
+        // completion queue (shared w/ the kernel)
+        void*               cq_map;
+        std::size_t         cq_map_size;
+        unsigned*           cq_head;
+        unsigned*           cq_tail;
+        unsigned*           cq_mask;
+        io_uring_cqe*       cqes;
+
+        // provided buffers
+        io_uring_buf*       buf_ring;       // ring of free buffers the kernel picks from
+        std::size_t         buf_ring_size;
+        std::uint8_t*       buf_mem;        // backing memory of every provided buffer
+        std::size_t         buf_size;
+        unsigned            num_bufs;
+        std::uint16_t       buf_tail;       // next free slot in buf_ring
+        std::deque<Chunk>   chunks;         // received chunks in arrival order
+
+        // recv state
+        unsigned            num_to_submit;  // sqes queued but not submitted yet
+        bool                is_armed;       // true while the multishot recv is active
+        bool                is_closed;      // true once the other host closed the connection
+        bool                has_error;      // true once the recv failed
+        bool                has_failed;     // true if the kernel does not support the multishot recv
+        bool                got_data;       // true once anything was received
+
+        // message parse state (same as MsgReader's)
+        std::uint8_t        header_buf[HeaderPkt_t::WIRE_SIZE]; // header bytes received so far
+        std::size_t         header_rx;      // number of header bytes received
+        HeaderPkt_t         header;         // parsed header of the message in progress
+        PooledBuf           data_buf;       // buffer the message's data is copied into
+        std::size_t         data_rx;        // number of data bytes received
+        bool                discarding;     // true if the message was too large & is being drained
+
+        /********************************************* Helper Functions ********************************************/
+
+        /**
+         * @brief Unmaps/closes everything init() setup
+         */
+        void close();
+
+        /**
+         * @brief Queues the multishot recv (submitted by the next io_uring_enter())
+         */
+        void armRecv();
+
+        /**
+         * @brief Hands a provided buffer back to the kernel
+         */
+        void recycleBuf(const std::uint16_t buf_id);
+
+        /**
+         * @brief Moves every completion into `chunks`/the recv state
+         * @return The number of completions reaped
+         */
+        unsigned reapCompletions();
+
+        /**
+         * @brief Parses the received chunks into the message in progress
+         * @param pool The buffer pool to copy the message's data into
+         * @param done Set to the message once it is complete
+         * @return true if a message completed
+         */
+        bool parseChunks(BufferPool& pool, RecvRtn& done);
+
+}; // end of UringEngine class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
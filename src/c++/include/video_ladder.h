@@ -0,0 +1,51 @@
+#ifndef RPI_VIDEO_LADDER_H
+#define RPI_VIDEO_LADDER_H
+
+// Standard Includes
+#include <array>
+#include <cstddef>
+
+// Our Includes
+#include "constants.h"
+
+// 3rd Party Includes
+
+namespace RPI {
+namespace Camera {
+
+/**
+ * @brief How the camera should encode the frames it sends (one rung of the VIDEO_LADDER)
+ */
+struct VideoSettings {
+    int     jpeg_quality;   // cv::IMWRITE_JPEG_QUALITY (0-100)
+    int     width;          // frames are scaled down to this before encoding
+    int     height;
+    int     fps;            // frames sent per second (extra grabbed frames are dropped)
+};
+
+/**
+ * @brief Encoder settings from best (index 0) to cheapest, each rung needs roughly half to two thirds
+ * of the bandwidth of the one above it. The server steps down while frames queue up on the slowest
+ * camera subscriber's connection & back up once the link has been keeping up for a while
+ */
+constexpr std::array<VideoSettings, 6> VIDEO_LADDER {{
+    {85, Constants::Camera::FRAME_WIDTH,    Constants::Camera::FRAME_HEIGHT,    Constants::Camera::VID_FRAMERATE},
+    {70, Constants::Camera::FRAME_WIDTH,    Constants::Camera::FRAME_HEIGHT,    Constants::Camera::VID_FRAMERATE},
+    {55, Constants::Camera::FRAME_WIDTH,    Constants::Camera::FRAME_HEIGHT,    20},
+    {50, Constants::Camera::FRAME_WIDTH*3/4, Constants::Camera::FRAME_HEIGHT*3/4, 15},
+    {40, Constants::Camera::FRAME_WIDTH/2,  Constants::Camera::FRAME_HEIGHT/2,  12},
+    {30, Constants::Camera::FRAME_WIDTH/2,  Constants::Camera::FRAME_HEIGHT/2,  8},
+}};
+
+/**
+ * @brief Get a rung's settings (rungs past the end clamp to the cheapest)
+ */
+constexpr const VideoSettings& getVideoSettings(const std::size_t rung) {
+    return VIDEO_LADDER[rung < VIDEO_LADDER.size() ? rung : VIDEO_LADDER.size() - 1];
+}
+
+} // end of Camera namespace
+
+}; // end of RPI namespace
+
+#endif
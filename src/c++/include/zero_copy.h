@@ -0,0 +1,100 @@
+#ifndef RPI_ZERO_COPY_H
+#define RPI_ZERO_COPY_H
+
+// Standard Includes
+#include <deque>
+#include <memory>
+#include <cstdint>
+#include <sys/socket.h>
+#include <linux/errqueue.h> // for sock_extended_err
+
+// Our Includes
+#include "constants.h"
+
+// 3rd Party Includes
+
+// older libc headers may not define the MSG_ZEROCOPY api (kernel >= 4.14)
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+namespace RPI {
+namespace Network {
+
+/**
+ * @brief Keeps buffers sent with MSG_ZEROCOPY alive until the kernel reports it is done with them
+ * @note One tracker per socket. The kernel numbers every successful MSG_ZEROCOPY send on a socket (0, 1, 2...)
+ * and reports ranges of finished sends on the socket's error queue.
+ * See https://www.kernel.org/doc/html/latest/networking/msg_zerocopy.html
+ */
+class ZeroCopyTracker {
+    public:
+        /********************************************** Constructors **********************************************/
+
+        ZeroCopyTracker();
+        virtual ~ZeroCopyTracker();
+
+        /**
+         * @brief Turns on SO_ZEROCOPY for a socket
+         * @param sock_fd The socket to enable zero copy sends on
+         * @return Success if the kernel supports it (Error otherwise & sends should just copy)
+         */
+        static ReturnCodes enable(const int sock_fd);
+
+        /********************************************* Getters/Setters *********************************************/
+
+        /**
+         * @brief Determine if the next send should use MSG_ZEROCOPY
+         * @param size The number of bytes about to be sent
+         * @return false if the buffer is too small to be worth it, too many sends are in flight,
+         * or the kernel reported it had to copy anyway (i.e. loopback)
+         */
+        bool shouldUse(const std::size_t size) const;
+
+        /**
+         * @brief Get the number of zero copy sends the kernel has not finished with yet
+         */
+        std::size_t getNumPending() const;
+
+        /****************************************** Tracking Functions *****************************************/
+
+        /**
+         * @brief Record a successful MSG_ZEROCOPY send
+         * @param keepalive Handle that owns the sent buffer (released once the kernel is done with it)
+         */
+        void track(std::shared_ptr<const void> keepalive);
+
+        /**
+         * @brief Reads any completions off the socket's error queue (non-blocking) & releases finished buffers
+         * @param sock_fd The socket the tracked sends went out on
+         */
+        void reap(const int sock_fd);
+
+    private:
+        /******************************************** Private Variables ********************************************/
+
+        struct PendingSend {
+            std::uint32_t               seq;        // kernel's sequence number for the send
+            std::shared_ptr<const void> keepalive;  // owns the buffer until the kernel is done with it
+        };
+
+        std::deque<PendingSend>     pending;        // sends in flight (oldest first)
+        std::uint32_t               next_seq;       // sequence number the kernel will give the next send
+        bool                        kernel_copied;  // true if the kernel fell back to copying (stop using it)
+
+}; // end of ZeroCopyTracker class
+
+} // end of Network namespace
+
+}; // end of RPI namespace
+
+#endif
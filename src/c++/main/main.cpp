@@ -80,6 +80,16 @@ int main(int argc, char* argv[]) {
     const int ctrl_port     {std::stoi(parse_res[RPI::CLI::Results::ParseKeys::CTRL_PORT])};
     const int cam_port      {std::stoi(parse_res[RPI::CLI::Results::ParseKeys::CAM_PORT])};
     const int srv_data_port {std::stoi(parse_res[RPI::CLI::Results::ParseKeys::SRV_DATA_PORT])};
+    const RPI::Network::PktEncoding pkt_encoding {
+        parse_res[RPI::CLI::Results::ParseKeys::PKT_ENCODING] == "bson" ?
+            RPI::Network::PktEncoding::Bson : RPI::Network::PktEncoding::Binary
+    };
+    const RPI::Network::Transport transport {
+        parse_res[RPI::CLI::Results::ParseKeys::TRANSPORT] == "udp"   ? RPI::Network::Transport::Udp :
+        parse_res[RPI::CLI::Results::ParseKeys::TRANSPORT] == "local" ? RPI::Network::Transport::Local :
+        parse_res[RPI::CLI::Results::ParseKeys::TRANSPORT] == "mux"   ? RPI::Network::Transport::Mux :
+                                                                        RPI::Network::Transport::Tcp
+    };
     static std::shared_ptr<RPI::Network::TcpBase> net_agent {
         is_client ?
             static_cast<RPI::Network::TcpBase*>(new RPI::Network::TcpClient{
@@ -88,7 +98,9 @@ int main(int argc, char* argv[]) {
                 cam_port,
                 srv_data_port,
                 is_client,
-                is_verbose
+                is_verbose,
+                pkt_encoding,
+                transport
             }) 
             :
             static_cast<RPI::Network::TcpBase*>(new RPI::Network::TcpServer{
@@ -96,10 +108,41 @@ int main(int argc, char* argv[]) {
                 cam_port,
                 srv_data_port,
                 is_server,
-                is_verbose
+                is_verbose,
+                transport
             })
     };
 
+    // skip checksums on whichever channels were requested (both ends should agree)
+    for (const std::string& channel : Helpers::splitStr(',', parse_res[RPI::CLI::Results::ParseKeys::NO_CHECKSUM])) {
+        net_agent->setChecksumEnabled(
+            channel == "control" ? RPI::Network::Channel::Control :
+            channel == "camera"  ? RPI::Network::Channel::Camera  : RPI::Network::Channel::SrvData,
+            false
+        );
+    }
+
+    // simulate a lossy link (i.e. to try out the udp transport over loopback)
+    const double sim_loss {std::stod(parse_res[RPI::CLI::Results::ParseKeys::SIM_LOSS]) / 100.0};
+    if (sim_loss > 0) {
+        RPI::Network::LossShim loss_shim {};
+        loss_shim.drop_rate     = sim_loss;
+        loss_shim.dup_rate      = sim_loss / 2;
+        loss_shim.reorder_rate  = sim_loss / 2;
+        net_agent->setLossShim(loss_shim);
+    }
+
+    // read the tcp sockets w/ io_uring (falls back to recv() if the kernel is too old)
+    if (parse_res[RPI::CLI::Results::ParseKeys::IO_ENGINE] == "uring") {
+        net_agent->setIoEngine(RPI::Network::IoEngine::Uring);
+    }
+
+    // record the session's traffic (i.e. to reproduce an issue or benchmark w/ it offline)
+    const std::string& capture_path {parse_res[RPI::CLI::Results::ParseKeys::CAPTURE]};
+    if (!capture_path.empty()) {
+        net_agent->startCapture(capture_path);
+    }
+
     // Create UI Event Listener to interact with client
     static RPI::UI::WebApp net_ui{net_agent, std::stoi(parse_res[RPI::CLI::Results::ParseKeys::WEB_PORT])};
 
@@ -109,12 +152,19 @@ int main(int argc, char* argv[]) {
     const int max_frames {std::stoi(parse_res[RPI::CLI::Results::ParseKeys::VID_FRAMES])};
     // only setup camera if available from server or camera test code
     const bool should_init_cam { is_cam || is_server };
+    RPI::Camera::DetectorConfig detector_config {};
+    detector_config.backend     = parse_res[RPI::CLI::Results::ParseKeys::DETECTOR];
+    detector_config.budget_ms   = std::stod(parse_res[RPI::CLI::Results::ParseKeys::DETECT_BUDGET]);
+    detector_config.lbp_xml     = parse_res[RPI::CLI::Results::ParseKeys::LBPXML];
+    detector_config.dnn_model   = parse_res[RPI::CLI::Results::ParseKeys::DNN_MODEL];
+    detector_config.dnn_config  = parse_res[RPI::CLI::Results::ParseKeys::DNN_CONFIG];
     static RPI::Camera::CamHandler Camera{
         is_verbose,
         max_frames,
         should_init_cam,
         parse_res[RPI::CLI::Results::ParseKeys::FACEXML],
-        parse_res[RPI::CLI::Results::ParseKeys::EYEXML]
+        parse_res[RPI::CLI::Results::ParseKeys::EYEXML],
+        detector_config
     };
 
 
@@ -169,13 +219,24 @@ int main(int argc, char* argv[]) {
             return rtn_code ? RPI::ReturnCodes::Success : RPI::ReturnCodes::Error;
         });
 
-        if(Camera.setGrabCallback([&](const std::vector<unsigned char>& grabbed_frame) {
-                net_agent->setLatestCamFrame(grabbed_frame);
+        if(Camera.setGrabCallback([&](
+                const std::vector<unsigned char>& grabbed_frame,
+                const RPI::Camera::FrameStamp& stamp
+            ) {
+                net_agent->setLatestCamFrame(grabbed_frame, stamp);
             }
         ) != RPI::ReturnCodes::Success) {
             cerr << "Error: Failed to set camera grab callback" << endl;
         }
 
+        // encode frames at whatever quality/size/fps the camera subscribers' links can keep up with
+        if(Camera.setVideoSettingsCallback([&]() {
+                return net_agent->getVideoSettings();
+            }
+        ) != RPI::ReturnCodes::Success) {
+            cerr << "Error: Failed to set camera video settings callback" << endl;
+        }
+
     } else {
         // is client (startup web app interface for receiving commands)
         thread_list.push_back(std::thread{
@@ -0,0 +1,73 @@
+#include "buffer_pool.h"
+
+namespace RPI {
+namespace Network {
+
+/********************************************** Constructors **********************************************/
+
+BufferPool::BufferPool(const std::size_t max_msg_size, const std::size_t max_idle_bufs)
+    : state{std::make_shared<PoolState>()}
+    , max_msg_size{max_msg_size}
+{
+    state->max_idle_bufs = max_idle_bufs;
+    state->idle_bufs.reserve(max_idle_bufs);
+}
+
+BufferPool::~BufferPool() {
+    // stub -- outstanding buffers hold a weak ref to the state & free themselves
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+std::size_t BufferPool::getMaxMsgSize() const {
+    return max_msg_size.load();
+}
+
+void BufferPool::setMaxMsgSize(const std::size_t new_max) {
+    max_msg_size.store(new_max);
+}
+
+std::size_t BufferPool::getNumIdle() const {
+    std::unique_lock<std::mutex> lk{state->mutex};
+    return state->idle_bufs.size();
+}
+
+/********************************************** Pool Functions *********************************************/
+
+PooledBuf BufferPool::acquire(const std::size_t size) {
+    if (size > max_msg_size.load()) {
+        return nullptr;
+    }
+
+    // reuse a released buffer if possible
+    std::unique_ptr<std::vector<u_char>> buf;
+    {
+        std::unique_lock<std::mutex> lk{state->mutex};
+        if (!state->idle_bufs.empty()) {
+            buf = std::move(state->idle_bufs.back());
+            state->idle_bufs.pop_back();
+        }
+    }
+    if (!buf) {
+        buf = std::make_unique<std::vector<u_char>>();
+    }
+
+    // recycled buffers keep their old size, so only bytes past it get zero-filled
+    buf->resize(size);
+
+    // return the buffer to the pool (if it still exists & has room) when the last handle goes away
+    std::weak_ptr<PoolState> weak_state {state};
+    return PooledBuf{buf.release(), [weak_state](std::vector<u_char>* released) {
+        std::unique_ptr<std::vector<u_char>> owned {released};
+        if (const auto pool_state = weak_state.lock()) {
+            std::unique_lock<std::mutex> lk{pool_state->mutex};
+            if (pool_state->idle_bufs.size() < pool_state->max_idle_bufs) {
+                pool_state->idle_bufs.push_back(std::move(owned));
+            }
+        }
+    }};
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
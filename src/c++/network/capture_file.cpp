@@ -0,0 +1,322 @@
+#include "capture_file.h"
+#include "clock_sync.h"
+
+#include <iostream>
+#include <algorithm> // for std::max
+#include <cstring> // for memcpy & strerror
+#include <cerrno>
+#include <fcntl.h> // for open()
+#include <unistd.h> // for close() & ftruncate()
+#include <sys/mman.h> // for mmap() & mremap()
+#include <sys/stat.h> // for fstat()
+
+namespace RPI {
+namespace Network {
+
+namespace {
+
+constexpr char          CAPTURE_MAGIC[8]        {'R', 'P', 'I', 'C', 'A', 'P', '0', '1'};
+constexpr std::uint32_t CAPTURE_VERSION         {1};
+constexpr std::size_t   CAPTURE_INITIAL_SIZE    {16 * 1024 * 1024}; // grown by doubling, trimmed by close()
+constexpr std::size_t   RECORD_ALIGN            {8};                // keeps every record's fields aligned
+
+constexpr std::size_t alignUp(const std::size_t size, const std::size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+// fields are in the capturing host's byte order (every pi & pc this runs on is little endian)
+struct FileHeader {
+    char                        magic[8];       // CAPTURE_MAGIC
+    std::uint32_t               version;        // CAPTURE_VERSION
+    std::uint32_t               reserved;
+    std::uint64_t               num_records;    // kept current while capturing
+    std::uint64_t               data_end;       // offset past the last record, kept current while capturing
+    std::uint64_t               index_offset;   // offset of the index (num_records offsets, 0 until closed)
+    std::uint64_t               start_time_us;  // ClockSync::now() when the capture was opened
+    std::uint64_t               padding[2];
+};
+
+struct RecordHeader {
+    std::uint32_t               record_size;    // bytes from this record to the next (header, data & padding)
+    std::uint8_t                dir;            // CaptureDir
+    std::uint8_t                channel;        // Channel
+    std::uint16_t               reserved;
+    std::uint64_t               time_us;        // when it was sent/received
+    std::uint8_t                header[HeaderPkt_t::WIRE_SIZE]; // HeaderPkt_t::pack()
+    std::uint32_t               size;           // bytes of data that follow
+    std::uint32_t               padding;
+};
+
+static_assert(sizeof(FileHeader) == 64, "capture file header layout changed");
+static_assert(sizeof(RecordHeader) % RECORD_ALIGN == 0, "capture records have to stay aligned");
+
+} // end of anonymous namespace
+
+/********************************************** Constructors **********************************************/
+
+CaptureWriter::CaptureWriter()
+    : fd{-1}
+    , mapping{nullptr}
+    , mapping_size{0}
+    , data_end{0}
+    , offsets{}
+{
+    // stub
+}
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+bool CaptureWriter::isOpen() const {
+    std::lock_guard<std::mutex> lock{file_mutex};
+    return mapping != nullptr;
+}
+
+std::uint64_t CaptureWriter::getNumRecords() const {
+    std::lock_guard<std::mutex> lock{file_mutex};
+    return offsets.size();
+}
+
+/******************************************** Capture Functions ********************************************/
+
+ReturnCodes CaptureWriter::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock{file_mutex};
+    if (mapping != nullptr) unmap();
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "ERROR: Failed to create capture file " << path << ": " << std::strerror(errno) << std::endl;
+        return ReturnCodes::Error;
+    }
+    if (::ftruncate(fd, CAPTURE_INITIAL_SIZE) < 0) {
+        std::cerr << "ERROR: Failed to size capture file: " << std::strerror(errno) << std::endl;
+        unmap();
+        return ReturnCodes::Error;
+    }
+
+    void* addr {::mmap(nullptr, CAPTURE_INITIAL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    if (addr == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to map capture file: " << std::strerror(errno) << std::endl;
+        unmap();
+        return ReturnCodes::Error;
+    }
+    mapping = static_cast<std::uint8_t*>(addr);
+    mapping_size = CAPTURE_INITIAL_SIZE;
+    data_end = sizeof(FileHeader);
+    offsets.clear();
+
+    FileHeader* file_header {reinterpret_cast<FileHeader*>(mapping)};
+    std::memcpy(file_header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    file_header->version = CAPTURE_VERSION;
+    file_header->num_records = 0;
+    file_header->data_end = data_end;
+    file_header->index_offset = 0;
+    file_header->start_time_us = ClockSync::now();
+    return ReturnCodes::Success;
+}
+
+ReturnCodes CaptureWriter::append(
+    const CaptureDir dir,
+    const Channel channel,
+    const HeaderPkt_t& header,
+    const void* data,
+    const std::uint32_t size,
+    const std::uint64_t time_us
+) {
+    const std::size_t record_size {alignUp(sizeof(RecordHeader) + size, RECORD_ALIGN)};
+
+    std::lock_guard<std::mutex> lock{file_mutex};
+    if (mapping == nullptr || reserve(record_size) != ReturnCodes::Success) return ReturnCodes::Error;
+
+    RecordHeader* record {reinterpret_cast<RecordHeader*>(mapping + data_end)};
+    record->record_size = static_cast<std::uint32_t>(record_size);
+    record->dir = static_cast<std::uint8_t>(dir);
+    record->channel = static_cast<std::uint8_t>(channel);
+    record->reserved = 0;
+    record->time_us = time_us;
+    header.pack(record->header);
+    record->size = size;
+    record->padding = 0;
+    if (size > 0) std::memcpy(record + 1, data, size);
+
+    // the record is complete before the file header says it is there (a crash leaves a readable capture)
+    offsets.push_back(data_end);
+    data_end += record_size;
+    FileHeader* file_header {reinterpret_cast<FileHeader*>(mapping)};
+    file_header->data_end = data_end;
+    file_header->num_records = offsets.size();
+    return ReturnCodes::Success;
+}
+
+void CaptureWriter::close() {
+    std::lock_guard<std::mutex> lock{file_mutex};
+    if (mapping == nullptr) return;
+
+    // index goes right after the last record, then the unused space is cut off
+    const std::size_t index_size {offsets.size() * sizeof(std::uint64_t)};
+    std::uint64_t file_end {data_end};
+    if (reserve(index_size) == ReturnCodes::Success) {
+        if (index_size > 0) std::memcpy(mapping + data_end, offsets.data(), index_size);
+        reinterpret_cast<FileHeader*>(mapping)->index_offset = data_end;
+        file_end += index_size;
+    }
+
+    ::munmap(mapping, mapping_size);
+    mapping = nullptr;
+    if (::ftruncate(fd, static_cast<off_t>(file_end)) < 0) {
+        std::cerr << "ERROR: Failed to trim capture file: " << std::strerror(errno) << std::endl;
+    }
+    unmap();
+}
+
+ReturnCodes CaptureWriter::reserve(const std::size_t size) {
+    if (data_end + size <= mapping_size) return ReturnCodes::Success;
+
+    // doubling keeps the number of remaps (& their syscalls) logarithmic in the capture's size
+    const std::size_t new_size {std::max(mapping_size * 2, alignUp(data_end + size, CAPTURE_INITIAL_SIZE))};
+    if (::ftruncate(fd, static_cast<off_t>(new_size)) < 0) {
+        std::cerr << "ERROR: Failed to grow capture file: " << std::strerror(errno) << std::endl;
+        return ReturnCodes::Error;
+    }
+    void* addr {::mremap(mapping, mapping_size, new_size, MREMAP_MAYMOVE)};
+    if (addr == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to remap capture file: " << std::strerror(errno) << std::endl;
+        return ReturnCodes::Error;
+    }
+    mapping = static_cast<std::uint8_t*>(addr);
+    mapping_size = new_size;
+    return ReturnCodes::Success;
+}
+
+void CaptureWriter::unmap() {
+    if (mapping != nullptr) ::munmap(mapping, mapping_size);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    mapping = nullptr;
+    mapping_size = 0;
+    data_end = 0;
+    offsets.clear();
+}
+
+/********************************************** Constructors **********************************************/
+
+CaptureReader::CaptureReader()
+    : mapping{nullptr}
+    , mapping_size{0}
+    , offsets{}
+{
+    // stub
+}
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+bool CaptureReader::isOpen() const {
+    return mapping != nullptr;
+}
+
+std::size_t CaptureReader::size() const {
+    return offsets.size();
+}
+
+CaptureRecord CaptureReader::at(const std::size_t idx) const {
+    const auto* record {reinterpret_cast<const RecordHeader*>(mapping + offsets[idx])};
+    HeaderPkt_t header {record->header};
+    header.channel = record->channel;
+    return CaptureRecord{
+        static_cast<CaptureDir>(record->dir),
+        static_cast<Channel>(record->channel),
+        record->time_us,
+        header,
+        reinterpret_cast<const std::uint8_t*>(record + 1),
+        record->size,
+    };
+}
+
+std::uint64_t CaptureReader::getDurationUs() const {
+    if (offsets.size() < 2) return 0;
+    return at(offsets.size() - 1).time_us - at(0).time_us;
+}
+
+/******************************************** Capture Functions ********************************************/
+
+ReturnCodes CaptureReader::open(const std::string& path) {
+    close();
+
+    const int fd {::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd < 0) {
+        std::cerr << "ERROR: Failed to open capture file " << path << ": " << std::strerror(errno) << std::endl;
+        return ReturnCodes::Error;
+    }
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) < 0 || static_cast<std::size_t>(file_stat.st_size) < sizeof(FileHeader)) {
+        std::cerr << "ERROR: " << path << " is not a capture file" << std::endl;
+        ::close(fd);
+        return ReturnCodes::Error;
+    }
+
+    // the mapping holds its own reference to the file
+    const std::size_t file_size {static_cast<std::size_t>(file_stat.st_size)};
+    void* addr {::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to map capture file: " << std::strerror(errno) << std::endl;
+        return ReturnCodes::Error;
+    }
+    mapping = static_cast<const std::uint8_t*>(addr);
+    mapping_size = file_size;
+
+    const auto* file_header {reinterpret_cast<const FileHeader*>(mapping)};
+    if (std::memcmp(file_header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 || file_header->version != CAPTURE_VERSION) {
+        std::cerr << "ERROR: " << path << " is not a capture file (or from an unsupported version)" << std::endl;
+        close();
+        return ReturnCodes::Error;
+    }
+
+    // w/o an index (capture cut short), walk the records up to the last one the header says is complete
+    const std::uint64_t num_records {file_header->num_records};
+    const std::uint64_t index_offset {file_header->index_offset};
+    if (index_offset != 0 && index_offset + num_records * sizeof(std::uint64_t) <= mapping_size) {
+        offsets.resize(num_records);
+        std::memcpy(offsets.data(), mapping + index_offset, num_records * sizeof(std::uint64_t));
+    } else {
+        std::uint64_t offset {sizeof(FileHeader)};
+        while (offsets.size() < num_records && offset + sizeof(RecordHeader) <= mapping_size) {
+            const std::uint32_t record_size {reinterpret_cast<const RecordHeader*>(mapping + offset)->record_size};
+            if (record_size < sizeof(RecordHeader)) break;
+            offsets.push_back(offset);
+            offset += record_size;
+        }
+    }
+
+    // a record that does not fit in the file means the file is damaged, keep what comes before it
+    const std::size_t num_valid {static_cast<std::size_t>(std::find_if(offsets.begin(), offsets.end(), [this](const std::uint64_t offset) {
+        if (offset % RECORD_ALIGN != 0 || offset + sizeof(RecordHeader) > mapping_size) return true;
+        const auto* record {reinterpret_cast<const RecordHeader*>(mapping + offset)};
+        return record->record_size < sizeof(RecordHeader) + record->size
+            || offset + record->record_size > mapping_size;
+    }) - offsets.begin())};
+    if (num_valid < offsets.size()) {
+        std::cerr << "Warning: Capture file is damaged, only the first " << num_valid << " of "
+                  << num_records << " records can be read" << std::endl;
+        offsets.resize(num_valid);
+    }
+    return ReturnCodes::Success;
+}
+
+void CaptureReader::close() {
+    if (mapping != nullptr) ::munmap(const_cast<std::uint8_t*>(mapping), mapping_size);
+    mapping = nullptr;
+    mapping_size = 0;
+    offsets.clear();
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
@@ -0,0 +1,204 @@
+#include "checksum.h"
+
+// Standard Includes
+#include <array>
+#include <cstring> // for memcpy
+
+// cpu specific crc instructions (compiled per function so the rest of the lib needs no special flags)
+#if defined(__x86_64__) || defined(__i386__)
+    #include <nmmintrin.h>
+    #define RPI_CRC_X86 1
+#elif defined(__aarch64__)
+    #include <arm_acle.h>
+    #include <sys/auxv.h>
+    #include <asm/hwcap.h>
+    #define RPI_CRC_ARM64 1
+#elif defined(__arm__) && defined(__ARM_FEATURE_CRC32)
+    // 32 bit arm (i.e. raspbian) only has them if the whole build targets armv8 (-march=armv8-a+crc)
+    #include <arm_acle.h>
+    #include <sys/auxv.h>
+    #include <asm/hwcap.h>
+    #define RPI_CRC_ARM32 1
+#endif
+
+namespace RPI {
+namespace Network {
+namespace Checksum {
+
+namespace {
+
+/******************************************** Slicing Tables ********************************************/
+
+constexpr std::uint32_t CRC32C_POLY {0x82F63B78}; // reflected Castagnoli polynomial
+
+// tables[0] is the classic bytewise table, tables[k][b] = crc of byte b followed by k zero bytes
+struct SliceTables {
+    std::uint32_t tables[8][256];
+
+    constexpr SliceTables() : tables{} {
+        for (std::uint32_t byte {0}; byte < 256; ++byte) {
+            std::uint32_t crc {byte};
+            for (int bit {0}; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+            }
+            tables[0][byte] = crc;
+        }
+        for (std::uint32_t byte {0}; byte < 256; ++byte) {
+            for (int slice {1}; slice < 8; ++slice) {
+                const std::uint32_t prev {tables[slice-1][byte]};
+                tables[slice][byte] = (prev >> 8) ^ tables[0][prev & 0xFF];
+            }
+        }
+    }
+};
+
+constexpr SliceTables SLICE_TABLES {};
+
+// slicing reads 4 byte words as little-endian
+inline std::uint32_t loadLE32(const std::uint8_t* pos) {
+    return static_cast<std::uint32_t>(pos[0])
+        | (static_cast<std::uint32_t>(pos[1]) << 8)
+        | (static_cast<std::uint32_t>(pos[2]) << 16)
+        | (static_cast<std::uint32_t>(pos[3]) << 24);
+}
+
+/******************************************** Hardware Versions ********************************************/
+
+#if defined(RPI_CRC_X86)
+__attribute__((target("sse4.2")))
+std::uint32_t crc32cSse42(const void* data, std::size_t size, std::uint32_t crc) {
+    const std::uint8_t* pos {static_cast<const std::uint8_t*>(data)};
+    crc = ~crc;
+#if defined(__x86_64__)
+    std::uint64_t crc64 {crc};
+    for (; size >= 8; size -= 8, pos += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, pos, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<std::uint32_t>(crc64);
+#endif
+    for (; size >= 4; size -= 4, pos += 4) {
+        std::uint32_t word;
+        std::memcpy(&word, pos, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; size > 0; --size, ++pos) {
+        crc = _mm_crc32_u8(crc, *pos);
+    }
+    return ~crc;
+}
+#endif
+
+#if defined(RPI_CRC_ARM64) || defined(RPI_CRC_ARM32)
+#if defined(RPI_CRC_ARM64)
+__attribute__((target("+crc")))
+#endif
+std::uint32_t crc32cArm(const void* data, std::size_t size, std::uint32_t crc) {
+    const std::uint8_t* pos {static_cast<const std::uint8_t*>(data)};
+    crc = ~crc;
+#if defined(RPI_CRC_ARM64)
+    for (; size >= 8; size -= 8, pos += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, pos, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+#endif
+    for (; size >= 4; size -= 4, pos += 4) {
+        std::uint32_t word;
+        std::memcpy(&word, pos, sizeof(word));
+        crc = __crc32cw(crc, word);
+    }
+    for (; size > 0; --size, ++pos) {
+        crc = __crc32cb(crc, *pos);
+    }
+    return ~crc;
+}
+#endif
+
+bool detectHardwareCrc() {
+#if defined(RPI_CRC_X86)
+    return __builtin_cpu_supports("sse4.2");
+#elif defined(RPI_CRC_ARM64)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#elif defined(RPI_CRC_ARM32)
+    return (getauxval(AT_HWCAP2) & HWCAP2_CRC32) != 0;
+#else
+    return false;
+#endif
+}
+
+using CrcFn = std::uint32_t (*)(const void*, std::size_t, std::uint32_t);
+
+// picked once (the first time a checksum is needed)
+CrcFn getDispatchedFn() {
+    static const CrcFn crc_fn {hasHardwareCrc() ? &crc32cHardware : &crc32cSlicing8};
+    return crc_fn;
+}
+
+} // end of anonymous namespace
+
+
+std::uint32_t crc32c(const void* data, const std::size_t size, const std::uint32_t crc) {
+    return getDispatchedFn()(data, size, crc);
+}
+
+std::uint32_t crc32cSlicing8(const void* data, const std::size_t size, const std::uint32_t crc) {
+    const std::uint8_t* pos {static_cast<const std::uint8_t*>(data)};
+    const auto& tbl {SLICE_TABLES.tables};
+    std::size_t left {size};
+    std::uint32_t curr {~crc};
+
+    // 8 bytes per step: each byte's contribution is looked up independently (no serial dependency)
+    for (; left >= 8; left -= 8, pos += 8) {
+        const std::uint32_t lo {loadLE32(pos) ^ curr};
+        const std::uint32_t hi {loadLE32(pos + 4)};
+        curr = tbl[7][lo & 0xFF]          ^ tbl[6][(lo >> 8) & 0xFF]
+             ^ tbl[5][(lo >> 16) & 0xFF]  ^ tbl[4][lo >> 24]
+             ^ tbl[3][hi & 0xFF]          ^ tbl[2][(hi >> 8) & 0xFF]
+             ^ tbl[1][(hi >> 16) & 0xFF]  ^ tbl[0][hi >> 24];
+    }
+    for (; left > 0; --left, ++pos) {
+        curr = (curr >> 8) ^ tbl[0][(curr ^ *pos) & 0xFF];
+    }
+    return ~curr;
+}
+
+std::uint32_t crc32cBytewise(const void* data, const std::size_t size, const std::uint32_t crc) {
+    const std::uint8_t* pos {static_cast<const std::uint8_t*>(data)};
+    std::uint32_t curr {~crc};
+    for (std::size_t idx {0}; idx < size; ++idx) {
+        curr = (curr >> 8) ^ SLICE_TABLES.tables[0][(curr ^ pos[idx]) & 0xFF];
+    }
+    return ~curr;
+}
+
+std::uint32_t crc32cHardware(const void* data, const std::size_t size, const std::uint32_t crc) {
+#if defined(RPI_CRC_X86)
+    return crc32cSse42(data, size, crc);
+#elif defined(RPI_CRC_ARM64) || defined(RPI_CRC_ARM32)
+    return crc32cArm(data, size, crc);
+#else
+    return crc32cSlicing8(data, size, crc);
+#endif
+}
+
+bool hasHardwareCrc() {
+    static const bool has_hw_crc {detectHardwareCrc()};
+    return has_hw_crc;
+}
+
+std::string getImplName() {
+    if (!hasHardwareCrc()) return "slicing-by-8";
+#if defined(RPI_CRC_X86)
+    return "sse4.2";
+#else
+    return "armv8-crc";
+#endif
+}
+
+} // end of Checksum namespace
+
+} // end of Network namespace
+
+}; // end of RPI namespace
@@ -0,0 +1,205 @@
+#include "clock_sync.h"
+
+#include <algorithm> // for std::min_element/clamp
+#include <chrono>
+#include <cstring> // for memcpy
+#include <endian.h> // for htobe64/be64toh
+#include <iterator> // for std::back_inserter
+
+namespace RPI {
+namespace Network {
+
+constexpr std::size_t   SYNC_WINDOW         {8};        // samples the min-RTT filter picks the best of
+constexpr std::uint64_t SYNC_MIN_SAMPLES    {4};        // samples needed before the estimate is trusted
+constexpr std::size_t   SYNC_MAX_POINTS     {32};       // filtered samples the skew model is fit through
+constexpr std::uint64_t DRIFT_MIN_SPAN_US   {10000000}; // points have to span this long (10s) before drift is fit
+constexpr double        MAX_DRIFT           {500e-6};   // crystals are off by far less than 500ppm
+constexpr std::uint64_t POINT_RTT_SLACK_US  {500};      // points w/ rtt > 2 * the best + this are left out of the fit
+
+/************************************************** Clock Ping **************************************************/
+
+ClockPing::ClockPing(const std::uint8_t* wire_buf) {
+    std::uint64_t wire_vals[3] {};
+    std::memcpy(wire_vals, wire_buf, sizeof(wire_vals));
+    client_send = be64toh(wire_vals[0]);
+    server_recv = be64toh(wire_vals[1]);
+    server_send = be64toh(wire_vals[2]);
+}
+
+void ClockPing::pack(std::uint8_t* wire_buf) const {
+    const std::uint64_t wire_vals[3] {htobe64(client_send), htobe64(server_recv), htobe64(server_send)};
+    std::memcpy(wire_buf, wire_vals, sizeof(wire_vals));
+}
+
+/********************************************** Constructors **********************************************/
+
+ClockSync::ClockSync()
+    : window{}
+    , points{}
+    , num_samples{0}
+    , base{0, 0, 0}
+    , drift{0}
+{
+    // stub
+}
+
+ClockSync::~ClockSync() {
+    // stub
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+bool ClockSync::isSynced() const {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    return num_samples >= SYNC_MIN_SAMPLES;
+}
+
+std::optional<std::int64_t> ClockSync::getOffsetUs() const {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    if (num_samples < SYNC_MIN_SAMPLES) return std::nullopt;
+    return offsetAt(now());
+}
+
+double ClockSync::getDriftPpm() const {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    return drift * 1e6;
+}
+
+std::uint64_t ClockSync::getRttUs() const {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    if (window.empty()) return 0;
+    return std::min_element(window.begin(), window.end(), [](const Sample& lhs, const Sample& rhs) {
+        return lhs.rtt_us < rhs.rtt_us;
+    })->rtt_us;
+}
+
+std::uint64_t ClockSync::getErrorUs() const {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    return base.rtt_us / 2;
+}
+
+json ClockSync::toJson() const {
+    const std::optional<std::int64_t> offset {getOffsetUs()};
+    const std::uint64_t rtt_us {getRttUs()};
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    return json{
+        {"synced",      offset.has_value()},
+        {"offset_us",   offset.value_or(0)},
+        {"drift_ppm",   drift * 1e6},
+        {"rtt_us",      rtt_us},
+        {"error_us",    base.rtt_us / 2},
+        {"samples",     num_samples},
+    };
+}
+
+/****************************************** Estimation Functions ****************************************/
+
+void ClockSync::addSample(const ClockPing& pong, const std::uint64_t local_recv) {
+    // the server's hold time can not be longer than the whole round trip
+    const std::uint64_t t1 {pong.client_send}, t2 {pong.server_recv}, t3 {pong.server_send}, t4 {local_recv};
+    if (t1 == 0 || t2 == 0 || t3 < t2 || t4 < t1 || (t4 - t1) < (t3 - t2)) return;
+
+    const Sample sample {
+        t1 + (t4 - t1) / 2,
+        (static_cast<std::int64_t>(t2 - t1) + static_cast<std::int64_t>(t3 - t4)) / 2,
+        (t4 - t1) - (t3 - t2),
+    };
+
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    window.push_back(sample);
+    if (window.size() > SYNC_WINDOW) window.pop_front();
+    ++num_samples;
+
+    // the best sample only changes when a better one comes in or the old best ages out of the window,
+    // both newer than the last point, so the points stay in order
+    const Sample& best {*std::min_element(window.begin(), window.end(), [](const Sample& lhs, const Sample& rhs) {
+        return lhs.rtt_us < rhs.rtt_us;
+    })};
+    if (points.empty() || points.back().local_us != best.local_us) {
+        points.push_back(best);
+        if (points.size() > SYNC_MAX_POINTS) points.pop_front();
+        fit();
+    }
+}
+
+std::uint64_t ClockSync::toLocal(const std::uint64_t remote_us) const {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    if (remote_us == 0 || num_samples < SYNC_MIN_SAMPLES) return remote_us;
+
+    // the offset is modeled on the local clock, so guess the local time w/ the base offset first
+    const std::int64_t guess {static_cast<std::int64_t>(remote_us) - base.offset_us};
+    const std::int64_t local {static_cast<std::int64_t>(remote_us) - offsetAt(static_cast<std::uint64_t>(std::max<std::int64_t>(guess, 0)))};
+    return static_cast<std::uint64_t>(std::max<std::int64_t>(local, 0));
+}
+
+std::uint64_t ClockSync::toRemote(const std::uint64_t local_us) const {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    if (local_us == 0 || num_samples < SYNC_MIN_SAMPLES) return local_us;
+    const std::int64_t remote {static_cast<std::int64_t>(local_us) + offsetAt(local_us)};
+    return static_cast<std::uint64_t>(std::max<std::int64_t>(remote, 0));
+}
+
+void ClockSync::reset() {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    window.clear();
+    points.clear();
+    num_samples = 0;
+    base = Sample{0, 0, 0};
+    drift = 0;
+}
+
+std::uint64_t ClockSync::now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count());
+}
+
+std::int64_t ClockSync::offsetAt(const std::uint64_t local_us) const {
+    const double elapsed {static_cast<double>(local_us) - static_cast<double>(base.local_us)};
+    return base.offset_us + static_cast<std::int64_t>(drift * elapsed);
+}
+
+void ClockSync::fit() {
+    // points that still waited in a queue (no sample in their window got through quickly) would skew the line
+    const std::uint64_t best_rtt {std::min_element(points.begin(), points.end(), [](const Sample& lhs, const Sample& rhs) {
+        return lhs.rtt_us < rhs.rtt_us;
+    })->rtt_us};
+    std::deque<Sample> good {};
+    std::copy_if(points.begin(), points.end(), std::back_inserter(good), [best_rtt](const Sample& point) {
+        return point.rtt_us <= 2 * best_rtt + POINT_RTT_SLACK_US;
+    });
+
+    // w/o enough of a time span the slope is mostly noise, so just follow the newest point
+    const Sample& newest {good.back()};
+    if (good.size() < 2 || newest.local_us - good.front().local_us < DRIFT_MIN_SPAN_US) {
+        base = newest;
+        drift = 0;
+        return;
+    }
+
+    // least squares line through the points, times relative to the newest (keeps the doubles precise)
+    double mean_t {0}, mean_offset {0};
+    for (const Sample& point : good) {
+        mean_t += static_cast<double>(point.local_us) - static_cast<double>(newest.local_us);
+        mean_offset += static_cast<double>(point.offset_us);
+    }
+    mean_t /= good.size();
+    mean_offset /= good.size();
+
+    double cov {0}, var {0};
+    for (const Sample& point : good) {
+        const double dt {static_cast<double>(point.local_us) - static_cast<double>(newest.local_us) - mean_t};
+        cov += dt * (static_cast<double>(point.offset_us) - mean_offset);
+        var += dt * dt;
+    }
+    drift = std::clamp(cov / var, -MAX_DRIFT, MAX_DRIFT);
+    base = Sample{
+        newest.local_us,
+        static_cast<std::int64_t>(mean_offset - drift * mean_t),
+        newest.rtt_us,
+    };
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
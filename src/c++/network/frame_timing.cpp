@@ -0,0 +1,207 @@
+#include "frame_timing.h"
+
+#include <algorithm> // for std::max/min
+
+namespace RPI {
+namespace Network {
+
+/********************************************** Constructors **********************************************/
+
+LatencyHistogram::LatencyHistogram()
+    : buckets{}             // value initialized (all 0)
+    , count{0}
+    , sum_us{0}
+    , max_us{0}
+{
+    // stub
+}
+
+LatencyHistogram::~LatencyHistogram() {
+    // stub
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+std::uint64_t LatencyHistogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::getMaxUs() const {
+    return max_us.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMeanUs() const {
+    const std::uint64_t num_samples {getCount()};
+    return num_samples > 0 ? static_cast<double>(sum_us.load(std::memory_order_relaxed)) / num_samples : 0;
+}
+
+std::uint64_t LatencyHistogram::getPercentileUs(const double fraction) const {
+    const std::array<std::uint64_t, NUM_BUCKETS> counts {getBuckets()};
+    std::uint64_t total {0};
+    for (const std::uint64_t bucket_count : counts) total += bucket_count;
+    if (total == 0) return 0;
+
+    // first bucket the running count reaches the wanted rank in (never past the worst sample)
+    const std::uint64_t rank {std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * total + 0.5))};
+    std::uint64_t seen {0};
+    for (std::size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) return std::min(getBucketMaxUs(bucket), getMaxUs());
+    }
+    return getMaxUs();
+}
+
+std::array<std::uint64_t, LatencyHistogram::NUM_BUCKETS> LatencyHistogram::getBuckets() const {
+    std::array<std::uint64_t, NUM_BUCKETS> counts {};
+    for (std::size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+        counts[bucket] = buckets[bucket].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+/****************************************** Recording Functions ****************************************/
+
+void LatencyHistogram::record(const std::uint64_t latency_us) {
+    buckets[getBucket(latency_us)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum_us.fetch_add(latency_us, std::memory_order_relaxed);
+
+    std::uint64_t prev_max {max_us.load(std::memory_order_relaxed)};
+    while (latency_us > prev_max && !max_us.compare_exchange_weak(prev_max, latency_us, std::memory_order_relaxed)) {
+        // prev_max reloaded by the failed exchange
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sum_us.store(0, std::memory_order_relaxed);
+    max_us.store(0, std::memory_order_relaxed);
+}
+
+std::size_t LatencyHistogram::getBucket(const std::uint64_t latency_us) {
+    // values under SUB_BUCKETS get a bucket each
+    if (latency_us < SUB_BUCKETS) return static_cast<std::size_t>(latency_us);
+    if (latency_us >> MAX_EXPONENT) return NUM_BUCKETS - 1;
+
+    // power of 2 the value is in (highest set bit), then which of its sub buckets (the next 2 bits)
+    std::size_t exponent {0};
+    for (std::uint64_t rest = latency_us >> 1; rest > 0; rest >>= 1) ++exponent;
+    const std::size_t sub_bucket {static_cast<std::size_t>(latency_us >> (exponent - 2)) & (SUB_BUCKETS - 1)};
+    return SUB_BUCKETS * (exponent - 1) + sub_bucket;
+}
+
+std::uint64_t LatencyHistogram::getBucketMaxUs(const std::size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    const std::size_t exponent {bucket / SUB_BUCKETS + 1};
+    const std::uint64_t sub_bucket {bucket % SUB_BUCKETS};
+    const std::uint64_t width {std::uint64_t{1} << (exponent - 2)};
+    return (SUB_BUCKETS + sub_bucket) * width + width - 1;
+}
+
+
+std::string getFrameStageName(const FrameStage stage) {
+    switch (stage) {
+        case FrameStage::Encode:    return "capture->encode";
+        case FrameStage::Send:      return "encode->send";
+        case FrameStage::Recv:      return "send->recv";
+        case FrameStage::Serve:     return "recv->serve";
+        case FrameStage::Total:
+        default:                    return "capture->serve";
+    }
+}
+
+/********************************************** Constructors **********************************************/
+
+FrameTimings::FrameTimings()
+    : stages{}
+    , num_skipped{0}
+    , last_seq{-1}          // nothing received yet
+{
+    // stub
+}
+
+FrameTimings::~FrameTimings() {
+    // stub
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+const LatencyHistogram& FrameTimings::getStage(const FrameStage stage) const {
+    return stages[static_cast<std::size_t>(stage)];
+}
+
+std::uint64_t FrameTimings::getNumSkipped() const {
+    return num_skipped.load(std::memory_order_relaxed);
+}
+
+json FrameTimings::toJson() const {
+    constexpr double US_PER_MS {1000.0};
+    json stages_json = json::array();
+    for (std::size_t stage_idx = 0; stage_idx < NUM_FRAME_STAGES; ++stage_idx) {
+        const LatencyHistogram& hist {stages[stage_idx]};
+
+        // most buckets are empty, so only list the ones that are not
+        json buckets_json = json::object();
+        const auto buckets {hist.getBuckets()};
+        for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+            if (buckets[bucket] == 0) continue;
+            buckets_json[std::to_string(LatencyHistogram::getBucketMaxUs(bucket))] = buckets[bucket];
+        }
+
+        stages_json.push_back({
+            {"name",    getFrameStageName(static_cast<FrameStage>(stage_idx))},
+            {"count",   hist.getCount()},
+            {"mean_ms", hist.getMeanUs() / US_PER_MS},
+            {"p50_ms",  hist.getPercentileUs(0.50) / US_PER_MS},
+            {"p90_ms",  hist.getPercentileUs(0.90) / US_PER_MS},
+            {"p99_ms",  hist.getPercentileUs(0.99) / US_PER_MS},
+            {"max_ms",  hist.getMaxUs() / US_PER_MS},
+            {"buckets", buckets_json},
+        });
+    }
+    return json{
+        {"stages",          stages_json},
+        {"frames_skipped",  getNumSkipped()},
+    };
+}
+
+/****************************************** Recording Functions ****************************************/
+
+void FrameTimings::recordReceived(const Camera::FrameStamp& stamp) {
+    if (!stamp.isStamped()) return;
+
+    // a gap in the seq means the server skipped frames for this client (or the camera dropped them)
+    const std::int32_t prev_seq {last_seq.exchange(stamp.seq, std::memory_order_relaxed)};
+    if (prev_seq >= 0) {
+        const std::uint16_t gap {static_cast<std::uint16_t>(stamp.seq - static_cast<std::uint16_t>(prev_seq))};
+        if (gap > 1) num_skipped.fetch_add(gap - 1, std::memory_order_relaxed);
+    }
+
+    record(FrameStage::Encode,  stamp.capture_us,   stamp.encoded_us);
+    record(FrameStage::Send,    stamp.encoded_us,   stamp.sent_us);
+    record(FrameStage::Recv,    stamp.sent_us,      stamp.recv_us);
+}
+
+void FrameTimings::recordServed(const Camera::FrameStamp& stamp, const std::uint64_t served_us) {
+    if (!stamp.isStamped()) return;
+    record(FrameStage::Serve,   stamp.recv_us,      served_us);
+    record(FrameStage::Total,   stamp.capture_us,   served_us);
+}
+
+void FrameTimings::reset() {
+    for (LatencyHistogram& stage : stages) stage.reset();
+    num_skipped.store(0, std::memory_order_relaxed);
+    last_seq.store(-1, std::memory_order_relaxed);
+}
+
+void FrameTimings::record(const FrameStage stage, const std::uint64_t from_us, const std::uint64_t to_us) {
+    // a hop that was not stamped (i.e. frames read from shared memory are not stamped by the server) is skipped
+    // hops timed on different hosts can come out negative by as much as the clock sync is off, those count as 0
+    if (from_us == 0 || to_us == 0) return;
+    stages[static_cast<std::size_t>(stage)].record(to_us > from_us ? to_us - from_us : 0);
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
@@ -0,0 +1,159 @@
+#include "link_estimator.h"
+
+#include <algorithm> // for std::max/min
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h> // for TCP_INFO
+#include <linux/sockios.h> // for SIOCOUTQ
+
+namespace RPI {
+namespace Network {
+
+// weight of the newest throughput measurement (rest is the previous estimate)
+constexpr double THROUGHPUT_ALPHA {0.3};
+
+/********************************************** Constructors **********************************************/
+
+LinkEstimator::LinkEstimator()
+    : queued_total{0}
+    , delivered_total{0}
+    , backlog{0}
+    , throughput{0}         // measured once the connection has something queued
+    , rtt{0}                // filled in from TCP_INFO (stays 0 for unix sockets)
+    , sampled_at{}          // never sampled
+{
+    // stub
+}
+
+LinkEstimator::~LinkEstimator() {
+    // stub
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+double LinkEstimator::getThroughput() const {
+    return throughput;
+}
+
+std::size_t LinkEstimator::getBacklog() const {
+    return backlog;
+}
+
+std::chrono::milliseconds LinkEstimator::getQueueDelay() const {
+    // nothing measured yet -> assume the link keeps up (it gets measured as soon as it falls behind)
+    const double drain_sec {backlog > 0 && throughput > 0 ? static_cast<double>(backlog) / throughput : 0};
+    const auto drain_time {std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::duration<double>(drain_sec)
+    )};
+    return drain_time + std::chrono::duration_cast<std::chrono::milliseconds>(rtt / 2);
+}
+
+std::chrono::milliseconds LinkEstimator::getQueueDelay(const int sock_fd, const std::size_t writer_unsent) const {
+    LinkEstimator fresh {*this};
+    fresh.backlog = writer_unsent + getSendQueueSize(sock_fd);
+    return fresh.getQueueDelay();
+}
+
+/****************************************** Estimation Functions ****************************************/
+
+void LinkEstimator::addQueued(const std::size_t num_bytes) {
+    queued_total += num_bytes;
+}
+
+void LinkEstimator::sample(const int sock_fd, const std::size_t writer_unsent, const clock::time_point now) {
+    const std::size_t unsent {writer_unsent + getSendQueueSize(sock_fd)};
+    const std::uint64_t delivered {std::max<std::uint64_t>(
+        queued_total > unsent ? queued_total - unsent : 0, delivered_total
+    )};
+
+    // kernel's view of the path (tcp only): rtt & how much it is allowed to have in flight
+    double cwnd_rate {0};
+    tcp_info info {};
+    socklen_t info_len {sizeof(info)};
+    if (getsockopt(sock_fd, IPPROTO_TCP, TCP_INFO, &info, &info_len) == 0 && info.tcpi_rtt > 0) {
+        rtt = std::chrono::microseconds(info.tcpi_rtt);
+        cwnd_rate = static_cast<double>(info.tcpi_snd_cwnd) * info.tcpi_snd_mss * 1e6 / info.tcpi_rtt;
+    }
+
+    if (sampled_at != clock::time_point{}) {
+        const double elapsed_sec {std::chrono::duration<double>(now - sampled_at).count()};
+        if (elapsed_sec > 0 && backlog > 0) {
+            // backlogged since the last sample -> the link delivered as fast as it could
+            const double rate {static_cast<double>(delivered - delivered_total) / elapsed_sec};
+            throughput = throughput > 0 ? (1 - THROUGHPUT_ALPHA) * throughput + THROUGHPUT_ALPHA * rate : rate;
+        } else if (backlog == 0) {
+            // idle links only show what was offered, so lean on what the congestion window allows
+            throughput = std::max(throughput, cwnd_rate);
+        }
+    }
+
+    delivered_total = delivered;
+    backlog         = unsent;
+    sampled_at      = now;
+}
+
+std::size_t LinkEstimator::getSendQueueSize(const int sock_fd) {
+    int queued {0};
+    if (sock_fd < 0 || ioctl(sock_fd, SIOCOUTQ, &queued) < 0 || queued < 0) return 0;
+    return static_cast<std::size_t>(queued);
+}
+
+
+/********************************************** Constructors **********************************************/
+
+VideoRateController::VideoRateController()
+    : rung{0}               // start at the best quality
+    , changed_at{}
+    , calm_since{}
+{
+    // stub
+}
+
+VideoRateController::~VideoRateController() {
+    // stub
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+std::size_t VideoRateController::getRung() const {
+    return rung;
+}
+
+void VideoRateController::reset() {
+    rung        = 0;
+    changed_at  = clock::time_point{};
+    calm_since  = clock::time_point{};
+}
+
+/****************************************** Control Functions ****************************************/
+
+std::size_t VideoRateController::update(const std::chrono::milliseconds queue_delay, const clock::time_point now) {
+    const std::chrono::milliseconds target      {Constants::Camera::TARGET_LATENCY_MS};
+    const std::chrono::milliseconds down_hold   {Constants::Network::RATE_DOWN_HOLD_MS};
+    const std::chrono::milliseconds up_hold     {Constants::Network::RATE_UP_HOLD_MS};
+    const std::size_t               cheapest    {Camera::VIDEO_LADDER.size() - 1};
+
+    if (queue_delay > target) {
+        // frames are piling up -> drop quality (give the last drop time to take effect first)
+        calm_since = now;
+        if (rung < cheapest && now - changed_at >= down_hold) {
+            rung        = std::min(rung + (queue_delay > 2 * target ? 2 : 1), cheapest);
+            changed_at  = now;
+        }
+    } else if (queue_delay < target / 4) {
+        // well under the target for a while -> try the next better rung
+        if (rung > 0 && now - calm_since >= up_hold && now - changed_at >= up_hold) {
+            --rung;
+            changed_at  = now;
+            calm_since  = now;
+        }
+    } else {
+        calm_since = now;
+    }
+    return rung;
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
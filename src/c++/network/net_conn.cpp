@@ -0,0 +1,604 @@
+#include "net_conn.h"
+#include "sock_tuning.h" // for getNotSentSize()
+
+#include <algorithm> // for std::min/any_of
+#include <cstring> // for memcpy
+#include <arpa/inet.h> // for htons/htonl
+
+namespace RPI {
+namespace Network {
+
+/********************************************** Message Reader **********************************************/
+
+MsgReader::MsgReader()
+    : header_buf{}
+    , header_rx{0}
+    , header{}
+    , data_buf{nullptr}
+    , data_rx{0}
+    , discarding{false}
+{
+    // stub
+}
+
+MsgReader::~MsgReader() {
+    // stub
+}
+
+void MsgReader::reset() {
+    header_rx   = 0;
+    header      = HeaderPkt_t{};
+    data_buf    = nullptr;
+    data_rx     = 0;
+    discarding  = false;
+}
+
+RecvRtn MsgReader::readSome(const int sock_fd, BufferPool& pool, std::uint64_t* num_syscalls) {
+    if (sock_fd < 0) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+    }
+
+    /*************************************** recv data pkt header *************************************/
+    while (header_rx < HeaderPkt_t::WIRE_SIZE) {
+        const ssize_t rx_size {::recv(sock_fd, header_buf+header_rx, HeaderPkt_t::WIRE_SIZE-header_rx, 0)};
+        if (num_syscalls != nullptr) ++(*num_syscalls);
+        if (rx_size < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return RecvRtn{nullptr, RecvSendRtnCodes::WouldBlock, {}};
+            }
+            return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+        } else if (rx_size == 0) {
+            return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, {}};
+        }
+        header_rx += static_cast<std::size_t>(rx_size);
+
+        // whole header arrived -> get a buffer for the data (drain it if too large)
+        if (header_rx == HeaderPkt_t::WIRE_SIZE) {
+            header      = HeaderPkt_t{header_buf};
+            data_buf    = pool.acquire(header.total_length);
+            data_rx     = 0;
+            discarding  = !data_buf;
+        }
+    }
+
+    /*********************************** recv actual data packets *************************************/
+    u_char discard_buf[Constants::Network::MAX_DATA_SIZE]; // only used to drain refused messages
+    while (data_rx < header.total_length) {
+        const std::size_t left {header.total_length - data_rx};
+        u_char* dest {discarding ? discard_buf : data_buf->data()+data_rx};
+        const std::size_t max_rx {discarding ? std::min(left, sizeof(discard_buf)) : left};
+
+        const ssize_t rx_size {::recv(sock_fd, dest, max_rx, 0)};
+        if (num_syscalls != nullptr) ++(*num_syscalls);
+        if (rx_size < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return RecvRtn{nullptr, RecvSendRtnCodes::WouldBlock, header};
+            }
+            return RecvRtn{nullptr, RecvSendRtnCodes::Error, header};
+        } else if (rx_size == 0) {
+            return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, header};
+        }
+        data_rx += static_cast<std::size_t>(rx_size);
+    }
+
+    // message complete -> hand it off & get ready for the next one
+    const HeaderPkt_t done_header {header};
+    PooledBuf done_buf {std::move(data_buf)};
+    const bool was_discarded {discarding};
+    reset();
+
+    if (was_discarded) {
+        std::cerr << "ERROR: RECV - message too large (" << done_header.total_length << "/"
+                  << pool.getMaxMsgSize() << " bytes), discarded it" << std::endl;
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, done_header};
+    }
+    return RecvRtn{std::move(done_buf), RecvSendRtnCodes::Success, done_header};
+}
+
+/********************************************** Message Writer **********************************************/
+
+MsgWriter::MsgWriter()
+    : header_buf{}
+    , data{nullptr}
+    , data_size{0}
+    , keepalive{nullptr}
+    , total_sent{0}
+    , busy{false}
+{
+    // stub
+}
+
+MsgWriter::~MsgWriter() {
+    // stub
+}
+
+bool MsgWriter::isBusy() const {
+    return busy;
+}
+
+std::size_t MsgWriter::getUnsentSize() const {
+    return busy ? HeaderPkt_t::WIRE_SIZE + data_size - total_sent : 0;
+}
+
+void MsgWriter::reset() {
+    data        = nullptr;
+    data_size   = 0;
+    keepalive   = nullptr;
+    total_sent  = 0;
+    busy        = false;
+}
+
+void MsgWriter::start(
+    const HeaderPkt_t& header,
+    const void* new_data,
+    const std::uint32_t size,
+    std::shared_ptr<const void> new_keepalive
+) {
+    header.pack(header_buf);
+    data        = static_cast<const std::uint8_t*>(new_data);
+    data_size   = size;
+    keepalive   = std::move(new_keepalive);
+    total_sent  = 0;
+    busy        = true;
+}
+
+void MsgWriter::start(const OutMsg& msg) {
+    start(msg.header, msg.data, msg.size, msg.keepalive);
+}
+
+SendRtn MsgWriter::writeSome(const int sock_fd, ZeroCopyTracker* zc_tracker) {
+    if (!busy) return SendRtn{0, RecvSendRtnCodes::Success};
+    if (sock_fd < 0) return SendRtn{0, RecvSendRtnCodes::Error};
+
+    const std::size_t total_size {HeaderPkt_t::WIRE_SIZE + data_size};
+
+    // only messages whose data is owned by a handle can outlive this call (zero copy)
+    bool use_zc {zc_tracker && keepalive && zc_tracker->shouldUse(data_size)};
+
+    while (total_sent < total_size) {
+        // skip past what has already been sent (header then data)
+        iovec iov[2];
+        int iov_cnt {0};
+        if (total_sent < HeaderPkt_t::WIRE_SIZE) {
+            iov[iov_cnt].iov_base = header_buf + total_sent;
+            iov[iov_cnt].iov_len  = HeaderPkt_t::WIRE_SIZE - total_sent;
+            ++iov_cnt;
+        }
+
+        // the kernel may re-read zero copy pages until acked, but header_buf is rewritten by the next message
+        // -> header goes out on its own (copied) & MSG_MORE keeps it in the same segment as the data
+        const bool is_zc_header {use_zc && iov_cnt > 0};
+        int send_flags {MSG_NOSIGNAL};
+        if (is_zc_header) {
+            send_flags |= MSG_MORE;
+        } else if (use_zc) {
+            send_flags |= MSG_ZEROCOPY;
+        }
+
+        const std::size_t data_sent {total_sent > HeaderPkt_t::WIRE_SIZE ? total_sent - HeaderPkt_t::WIRE_SIZE : 0};
+        if (data_sent < data_size && !is_zc_header) {
+            iov[iov_cnt].iov_base = const_cast<std::uint8_t*>(data + data_sent);
+            iov[iov_cnt].iov_len  = data_size - data_sent;
+            ++iov_cnt;
+        }
+
+        msghdr msg      {};
+        msg.msg_iov     = iov;
+        msg.msg_iovlen  = iov_cnt;
+
+        const ssize_t sent_size {::sendmsg(sock_fd, &msg, send_flags)};
+        if (sent_size < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return SendRtn{static_cast<std::uint32_t>(data_sent), RecvSendRtnCodes::WouldBlock};
+            }
+            // out of memory for pinning pages -> just copy the rest
+            if (errno == ENOBUFS && (send_flags & MSG_ZEROCOPY)) {
+                use_zc = false;
+                continue;
+            }
+            return SendRtn{static_cast<std::uint32_t>(data_sent), RecvSendRtnCodes::Error};
+        }
+
+        // every successful zero copy send gets its own completion (buffer must outlive all of them)
+        if (send_flags & MSG_ZEROCOPY) {
+            zc_tracker->track(keepalive);
+        }
+        total_sent += static_cast<std::size_t>(sent_size);
+    }
+
+    const std::uint32_t sent_data_size {data_size};
+    reset();
+    return SendRtn{sent_data_size, RecvSendRtnCodes::Success};
+}
+
+/************************************************ Mux Header ************************************************/
+
+MuxHeader::MuxHeader() {
+    // stub (default member initializers zero everything)
+}
+
+MuxHeader::MuxHeader(const HeaderPkt_t& header, const std::uint32_t offset)
+    : channel{static_cast<Channel>(header.channel)}
+    , priority{header.tos}
+    , flags{0}
+    , protocol{header.protocol}
+    , frag_len{static_cast<std::uint16_t>(
+        std::min<std::size_t>(header.total_length - offset, Constants::Network::MUX_FRAG_SIZE)
+    )}
+    , msg_len{header.total_length}
+    , checksum{header.checksum}
+    , has_stamp{offset == 0}
+    , origin_us{header.getOriginTime()}
+    , seq{header.id}
+    , send_ms{static_cast<std::uint16_t>(header.flags_fo & HeaderPkt_t::FO_MASK)}
+    , encode_ms{header.ttl}
+{
+    if (offset + frag_len >= msg_len) flags |= FLAG_FIN;
+    if (!header.hasChecksum()) flags |= FLAG_NO_CHECKSUM;
+    if (header.isSessionHello()) flags |= FLAG_SESSION;
+    if (header.isClockPing()) flags |= FLAG_CLOCK;
+}
+
+MuxHeader::MuxHeader(const std::uint8_t* wire_buf) {
+    channel     = static_cast<Channel>(wire_buf[0] >> 4);
+    priority    = wire_buf[0] & 0x0F;
+    flags       = wire_buf[1] >> 4;
+    protocol    = wire_buf[1] & 0x0F;
+
+    std::uint16_t   net_frag_len;
+    std::uint32_t   net_msg_len;
+    std::uint32_t   net_checksum;
+    std::memcpy(&net_frag_len, wire_buf + 2, sizeof(net_frag_len));
+    std::memcpy(&net_msg_len,  wire_buf + 4, sizeof(net_msg_len));
+    std::memcpy(&net_checksum, wire_buf + 8, sizeof(net_checksum));
+    frag_len    = ntohs(net_frag_len);
+    msg_len     = ntohl(net_msg_len);
+    checksum    = ntohl(net_checksum);
+}
+
+void MuxHeader::pack(std::uint8_t* wire_buf) const {
+    wire_buf[0] = static_cast<std::uint8_t>((static_cast<std::uint8_t>(channel) << 4) | (priority & 0x0F));
+    wire_buf[1] = static_cast<std::uint8_t>((flags << 4) | (protocol & 0x0F));
+
+    const std::uint16_t net_frag_len {htons(frag_len)};
+    const std::uint32_t net_msg_len  {htonl(msg_len)};
+    const std::uint32_t net_checksum {htonl(checksum)};
+    std::memcpy(wire_buf + 2, &net_frag_len, sizeof(net_frag_len));
+    std::memcpy(wire_buf + 4, &net_msg_len,  sizeof(net_msg_len));
+    std::memcpy(wire_buf + 8, &net_checksum, sizeof(net_checksum));
+    if (!has_stamp) return;
+
+    std::uint8_t* const stamp_buf {wire_buf + WIRE_SIZE};
+    const std::uint32_t net_origin_hi   {htonl(static_cast<std::uint32_t>(origin_us >> 32))};
+    const std::uint32_t net_origin_lo   {htonl(static_cast<std::uint32_t>(origin_us))};
+    const std::uint16_t net_seq         {htons(seq)};
+    const std::uint16_t net_send_ms     {htons(send_ms)};
+    std::memcpy(stamp_buf + 0,  &net_origin_hi, sizeof(net_origin_hi));
+    std::memcpy(stamp_buf + 4,  &net_origin_lo, sizeof(net_origin_lo));
+    std::memcpy(stamp_buf + 8,  &net_seq,       sizeof(net_seq));
+    std::memcpy(stamp_buf + 10, &net_send_ms,   sizeof(net_send_ms));
+    stamp_buf[12] = encode_ms;
+}
+
+void MuxHeader::unpackStamp(const std::uint8_t* wire_buf) {
+    const std::uint8_t* const stamp_buf {wire_buf + WIRE_SIZE};
+    std::uint32_t   net_origin_hi;
+    std::uint32_t   net_origin_lo;
+    std::uint16_t   net_seq;
+    std::uint16_t   net_send_ms;
+    std::memcpy(&net_origin_hi, stamp_buf + 0,  sizeof(net_origin_hi));
+    std::memcpy(&net_origin_lo, stamp_buf + 4,  sizeof(net_origin_lo));
+    std::memcpy(&net_seq,       stamp_buf + 8,  sizeof(net_seq));
+    std::memcpy(&net_send_ms,   stamp_buf + 10, sizeof(net_send_ms));
+    has_stamp   = true;
+    origin_us   = (static_cast<std::uint64_t>(ntohl(net_origin_hi)) << 32) | ntohl(net_origin_lo);
+    seq         = ntohs(net_seq);
+    send_ms     = ntohs(net_send_ms);
+    encode_ms   = stamp_buf[12];
+}
+
+std::size_t MuxHeader::getHeaderSize() const {
+    return has_stamp ? MAX_WIRE_SIZE : WIRE_SIZE;
+}
+
+HeaderPkt_t MuxHeader::toHeader() const {
+    HeaderPkt_t header  {};
+    header.total_length = msg_len;
+    header.protocol     = protocol;
+    header.checksum     = checksum;
+    header.tos          = priority;
+    header.channel      = static_cast<std::uint8_t>(channel);
+    header.id           = seq;
+    header.ttl          = encode_ms;
+    header.flags_fo     = send_ms & HeaderPkt_t::FO_MASK;
+    header.setOriginTime(origin_us);
+    if (flags & FLAG_NO_CHECKSUM) header.flags_fo |= HeaderPkt_t::FLAG_NO_CHECKSUM;
+    if (flags & FLAG_SESSION) header.flags_fo |= HeaderPkt_t::FLAG_SESSION;
+    if (flags & FLAG_CLOCK) header.flags_fo |= HeaderPkt_t::FLAG_CLOCK;
+    return header;
+}
+
+bool MuxHeader::isFin() const {
+    return flags & FLAG_FIN;
+}
+
+bool MuxHeader::isValid() const {
+    return static_cast<std::size_t>(channel) < NUM_CHANNELS
+        && protocol <= static_cast<std::uint8_t>(PktEncoding::Raw)
+        && frag_len <= msg_len;
+}
+
+/************************************************ Mux Reader ************************************************/
+
+MuxReader::MuxReader()
+    : header_buf{}
+    , header_rx{0}
+    , header_len{MuxHeader::WIRE_SIZE}
+    , frag{}
+    , frag_rx{0}
+    , assemblies{}
+{
+    // stub
+}
+
+MuxReader::~MuxReader() {
+    // stub
+}
+
+void MuxReader::reset() {
+    header_rx   = 0;
+    header_len  = MuxHeader::WIRE_SIZE;
+    frag        = MuxHeader{};
+    frag_rx     = 0;
+    assemblies  = {};
+}
+
+RecvRtn MuxReader::readSome(const int sock_fd, const MuxPools& pools, std::uint64_t* num_syscalls) {
+    if (sock_fd < 0) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+    }
+
+    u_char discard_buf[Constants::Network::MAX_DATA_SIZE]; // only used to drain refused messages
+    while (true) {
+        /************************************* recv fragment header ***********************************/
+        while (header_rx < header_len) {
+            const ssize_t rx_size {::recv(sock_fd, header_buf+header_rx, header_len-header_rx, 0)};
+            if (num_syscalls != nullptr) ++(*num_syscalls);
+            if (rx_size < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return RecvRtn{nullptr, RecvSendRtnCodes::WouldBlock, {}};
+                }
+                return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+            } else if (rx_size == 0) {
+                return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, {}};
+            }
+            header_rx += static_cast<std::size_t>(rx_size);
+
+            // whole header arrived -> find (or start) the message it belongs to
+            if (header_rx == MuxHeader::WIRE_SIZE) {
+                frag    = MuxHeader{header_buf};
+                frag_rx = 0;
+
+                // garbage header -> there is no telling where the next one starts, so the connection is done
+                if (!frag.isValid()) {
+                    std::cerr << "ERROR: RECV - malformed mux header, stream is out of sync" << std::endl;
+                    return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, {}};
+                }
+
+                Assembly& assembly {assemblies[static_cast<std::size_t>(frag.channel)]};
+                if (!assembly.active) {
+                    BufferPool* const pool {pools[static_cast<std::size_t>(frag.channel)]};
+                    assembly.active     = true;
+                    assembly.msg_len    = frag.msg_len;
+                    assembly.rx         = 0;
+                    assembly.buf        = pool != nullptr ? pool->acquire(frag.msg_len) : nullptr;
+                    assembly.discarding = !assembly.buf;
+
+                    // first fragment of the message -> its stamp comes next
+                    header_len = MuxHeader::MAX_WIRE_SIZE;
+                }
+
+                // fragment does not fit the message it claims to be part of -> drop the message
+                if (frag.msg_len != assembly.msg_len || assembly.rx + frag.frag_len > assembly.msg_len) {
+                    assembly.discarding = true;
+                }
+            }
+
+            // stamp arrived -> the message's header is complete (the other fragments only add data)
+            if (header_rx == MuxHeader::MAX_WIRE_SIZE) {
+                frag.unpackStamp(header_buf);
+                assemblies[static_cast<std::size_t>(frag.channel)].header = frag.toHeader();
+            }
+        }
+
+        /************************************* recv fragment data *************************************/
+        Assembly& assembly {assemblies[static_cast<std::size_t>(frag.channel)]};
+        while (frag_rx < frag.frag_len) {
+            const std::size_t left {frag.frag_len - frag_rx};
+            u_char* dest {assembly.discarding ? discard_buf : assembly.buf->data()+assembly.rx+frag_rx};
+            const std::size_t max_rx {assembly.discarding ? std::min(left, sizeof(discard_buf)) : left};
+
+            const ssize_t rx_size {::recv(sock_fd, dest, max_rx, 0)};
+            if (num_syscalls != nullptr) ++(*num_syscalls);
+            if (rx_size < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return RecvRtn{nullptr, RecvSendRtnCodes::WouldBlock, {}};
+                }
+                return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+            } else if (rx_size == 0) {
+                return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, {}};
+            }
+            frag_rx += static_cast<std::size_t>(rx_size);
+        }
+
+        // fragment complete -> on to the next header (the message is done once its last fragment is in)
+        header_rx   = 0;
+        header_len  = MuxHeader::WIRE_SIZE;
+        assembly.rx += frag.frag_len;
+        if (!frag.isFin()) continue;
+
+        const HeaderPkt_t done_header {assembly.header};
+        PooledBuf done_buf {std::move(assembly.buf)};
+        const bool was_discarded {assembly.discarding || assembly.rx != assembly.msg_len};
+        assembly = Assembly{};
+
+        if (was_discarded) {
+            std::cerr << "ERROR: RECV - mux message refused or malformed (" << done_header.total_length
+                      << " bytes), discarded it" << std::endl;
+            return RecvRtn{nullptr, RecvSendRtnCodes::Error, done_header};
+        }
+        return RecvRtn{std::move(done_buf), RecvSendRtnCodes::Success, done_header};
+    }
+}
+
+/************************************************ Mux Writer ************************************************/
+
+MuxWriter::MuxWriter()
+    : slots{}
+    , header_buf{}
+    , header_len{0}
+    , frag_slot{0}
+    , frag_len{0}
+    , frag_sent{0}
+    , frag_active{false}
+    , notsent_gate{true}
+{
+    // stub
+}
+
+MuxWriter::~MuxWriter() {
+    // stub
+}
+
+bool MuxWriter::isBusy() const {
+    return std::any_of(slots.begin(), slots.end(), [](const Slot& slot){ return slot.busy; });
+}
+
+bool MuxWriter::isBusy(const Channel channel) const {
+    return slots[static_cast<std::size_t>(channel)].busy;
+}
+
+std::size_t MuxWriter::getWireSize(const std::uint32_t size) {
+    const std::size_t num_frags {
+        size == 0 ? 1 : (size + Constants::Network::MUX_FRAG_SIZE - 1) / Constants::Network::MUX_FRAG_SIZE
+    };
+    return size + num_frags * MuxHeader::WIRE_SIZE + MuxHeader::STAMP_SIZE;
+}
+
+std::size_t MuxWriter::getUnsentSize() const {
+    std::size_t unsent {0};
+    for (const Slot& slot : slots) {
+        // the stamp only goes out w/ the first fragment
+        if (slot.busy) unsent += getWireSize(slot.msg.size - slot.offset) - (slot.offset > 0 ? MuxHeader::STAMP_SIZE : 0);
+    }
+    return unsent - (frag_active ? frag_sent : 0);
+}
+
+void MuxWriter::setNotSentGate(const bool enabled) {
+    notsent_gate = enabled;
+}
+
+ReturnCodes MuxWriter::start(const OutMsg& msg) {
+    // anything else would go out as a malformed message (& at whatever priority its slot has)
+    if (msg.header.channel >= NUM_CHANNELS) return ReturnCodes::Error;
+
+    Slot& slot  {slots[msg.header.channel]};
+    slot.msg    = msg;
+    slot.offset = 0;
+    slot.busy   = true;
+    return ReturnCodes::Success;
+}
+
+void MuxWriter::reset() {
+    slots       = {};
+    frag_len    = 0;
+    frag_sent   = 0;
+    frag_active = false;
+}
+
+MuxWriter::Slot* MuxWriter::pickNext() {
+    Slot* next {nullptr};
+    for (Slot& slot : slots) {
+        if (slot.busy && (next == nullptr || slot.msg.header.tos < next->msg.header.tos)) {
+            next = &slot;
+        }
+    }
+    return next;
+}
+
+SendRtn MuxWriter::writeSome(const int sock_fd) {
+    if (sock_fd < 0) return SendRtn{0, RecvSendRtnCodes::Error};
+
+    std::uint32_t data_sent {0};
+    while (true) {
+        // previous fragment is done -> the most urgent channel goes next
+        if (!frag_active) {
+            Slot* const next {pickNext()};
+            if (next == nullptr) break;
+
+            // whatever the kernel holds goes out before anything picked here, so keep that to about a fragment
+            if (notsent_gate && SockTuning::getNotSentSize(sock_fd) >= Constants::Network::MUX_NOTSENT_LOWAT) {
+                return SendRtn{data_sent, RecvSendRtnCodes::WouldBlock};
+            }
+
+            const MuxHeader frag {next->msg.header, next->offset};
+            frag.pack(header_buf);
+            header_len  = frag.getHeaderSize();
+            frag_slot   = static_cast<std::size_t>(next - slots.data());
+            frag_len    = frag.frag_len;
+            frag_sent   = 0;
+            frag_active = true;
+        }
+
+        // skip past what has already been sent of the fragment (header then data)
+        Slot& slot {slots[frag_slot]};
+        const std::size_t frag_total {header_len + frag_len};
+        iovec iov[2];
+        int iov_cnt {0};
+        if (frag_sent < header_len) {
+            iov[iov_cnt].iov_base = header_buf + frag_sent;
+            iov[iov_cnt].iov_len  = header_len - frag_sent;
+            ++iov_cnt;
+        }
+        const std::size_t frag_data_sent {frag_sent > header_len ? frag_sent - header_len : 0};
+        if (frag_data_sent < frag_len) {
+            const std::uint8_t* data {static_cast<const std::uint8_t*>(slot.msg.data) + slot.offset};
+            iov[iov_cnt].iov_base = const_cast<std::uint8_t*>(data + frag_data_sent);
+            iov[iov_cnt].iov_len  = frag_len - frag_data_sent;
+            ++iov_cnt;
+        }
+
+        msghdr msg      {};
+        msg.msg_iov     = iov;
+        msg.msg_iovlen  = iov_cnt;
+
+        const ssize_t sent_size {::sendmsg(sock_fd, &msg, MSG_NOSIGNAL)};
+        if (sent_size < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return SendRtn{data_sent, RecvSendRtnCodes::WouldBlock};
+            }
+            return SendRtn{data_sent, RecvSendRtnCodes::Error};
+        }
+        frag_sent += static_cast<std::size_t>(sent_size);
+        if (frag_sent < frag_total) continue;
+
+        // fragment done -> message is done once its last fragment is out
+        frag_active  = false;
+        slot.offset += static_cast<std::uint32_t>(frag_len);
+        data_sent   += static_cast<std::uint32_t>(frag_len);
+        if (slot.offset >= slot.msg.size) {
+            slot = Slot{};
+        }
+    }
+    return SendRtn{data_sent, RecvSendRtnCodes::Success};
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
@@ -1,5 +1,7 @@
 #include "packet.h"
 
+#include <algorithm> // for std::min
+
 namespace RPI {
 namespace Network {
 
@@ -8,6 +10,252 @@ using std::cout;
 using std::cerr;
 using std::endl;
 
+/********************************************* Binary Codec Helpers ********************************************/
+
+namespace {
+
+// bit positions within the binary codec's flag bytes
+enum CmnFlagBits : std::uint8_t {
+    LED_RED         = 1 << 0,
+    LED_YELLOW      = 1 << 1,
+    LED_GREEN       = 1 << 2,
+    LED_BLUE        = 1 << 3,
+    MOTOR_FORWARD   = 1 << 4,
+    MOTOR_BACKWARD  = 1 << 5,
+    MOTOR_RIGHT     = 1 << 6,
+    MOTOR_LEFT      = 1 << 7,
+};
+
+enum MiscFlagBits : std::uint8_t {
+    CAMERA_ON       = 1 << 0,
+    ACK             = 1 << 1,
+};
+
+// zigzag maps small negative servo deltas to small unsigned values (-1 -> 1, 1 -> 2) so they fit in 1 varint byte
+inline std::uint32_t zigzagEncode(const std::int32_t val) {
+    return (static_cast<std::uint32_t>(val) << 1) ^ static_cast<std::uint32_t>(val >> 31);
+}
+
+inline std::int32_t zigzagDecode(const std::uint32_t val) {
+    return static_cast<std::int32_t>((val >> 1) ^ (~(val & 1) + 1));
+}
+
+// LEB128 style varint: 7 bits per byte, least significant group first, msb set if more bytes follow
+inline void putVarint(std::string& out, std::uint32_t val) {
+    while (val >= 0x80) {
+        out.push_back(static_cast<char>((val & 0x7F) | 0x80));
+        val >>= 7;
+    }
+    out.push_back(static_cast<char>(val));
+}
+
+inline std::uint32_t getVarint(const unsigned char*& pos, const unsigned char* end) {
+    std::uint32_t val {0};
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (pos >= end) {
+            throw std::runtime_error{"binary packet truncated inside varint"};
+        }
+        const std::uint8_t byte {*pos++};
+        val |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return val;
+    }
+    throw std::runtime_error{"binary packet varint is too long"};
+}
+
+// check version & packet type bytes that every binary packet starts with
+inline void checkBinPreamble(const unsigned char* buf, const std::size_t size, const PktType type) {
+    if (size < 2) {
+        throw std::runtime_error{"binary packet too short"};
+    }
+    if (buf[0] != BinCodec::VERSION) {
+        throw std::runtime_error{"unsupported binary packet version " + std::to_string(buf[0])};
+    }
+    if (buf[1] != static_cast<std::uint8_t>(type)) {
+        throw std::runtime_error{"unexpected binary packet type " + std::to_string(buf[1])};
+    }
+}
+
+/*********************************************** Packet Field Schema *********************************************/
+// Maps every json/bson key path (see pkt_sample.json) straight to the struct member it fills,
+// so partial updates can be merged into a packet without building any intermediate json objects
+
+enum class FieldType : std::uint8_t {
+    Bool,
+    Int,
+    Float,
+};
+
+constexpr std::size_t MAX_FIELD_DEPTH {3};
+
+struct PktField {
+    const char*     path[MAX_FIELD_DEPTH];  // keys from root to leaf (unused trailing keys are nullptr)
+    FieldType       type;                   // type of the struct member
+    std::size_t     offset;                 // offset of the member within the packet struct
+};
+
+static_assert(std::is_standard_layout<CommonPkt>::value, "CommonPkt fields are located via offsetof");
+static_assert(std::is_standard_layout<SrvDataPkt>::value, "SrvDataPkt fields are located via offsetof");
+
+constexpr PktField CMN_PKT_FIELDS[] {
+    {{"control",    "led",      "red"       },  FieldType::Bool,    offsetof(CommonPkt, cntrl.led.red)          },
+    {{"control",    "led",      "yellow"    },  FieldType::Bool,    offsetof(CommonPkt, cntrl.led.yellow)       },
+    {{"control",    "led",      "green"     },  FieldType::Bool,    offsetof(CommonPkt, cntrl.led.green)        },
+    {{"control",    "led",      "blue"      },  FieldType::Bool,    offsetof(CommonPkt, cntrl.led.blue)         },
+    {{"control",    "motor",    "forward"   },  FieldType::Bool,    offsetof(CommonPkt, cntrl.motor.forward)    },
+    {{"control",    "motor",    "backward"  },  FieldType::Bool,    offsetof(CommonPkt, cntrl.motor.backward)   },
+    {{"control",    "motor",    "right"     },  FieldType::Bool,    offsetof(CommonPkt, cntrl.motor.right)      },
+    {{"control",    "motor",    "left"      },  FieldType::Bool,    offsetof(CommonPkt, cntrl.motor.left)       },
+    {{"control",    "servo",    "horiz"     },  FieldType::Int,     offsetof(CommonPkt, cntrl.servo.horiz)      },
+    {{"control",    "servo",    "vert"      },  FieldType::Int,     offsetof(CommonPkt, cntrl.servo.vert)       },
+    {{"control",    "camera",   "is_on"     },  FieldType::Bool,    offsetof(CommonPkt, cntrl.camera.is_on)     },
+    {{"ACK",        nullptr,    nullptr     },  FieldType::Bool,    offsetof(CommonPkt, ACK)                    },
+};
+
+constexpr PktField SRV_PKT_FIELDS[] {
+    {{"ultrasonic", "dist",     nullptr     },  FieldType::Float,   offsetof(SrvDataPkt, ultrasonic.dist)       },
+    {{"ACK",        nullptr,    nullptr     },  FieldType::Bool,    offsetof(SrvDataPkt, ACK)                   },
+};
+
+// selects the schema of a packet type at compile time
+template<typename PktT> struct PktSchema;
+template<> struct PktSchema<CommonPkt>  { static constexpr const auto& fields {CMN_PKT_FIELDS}; };
+template<> struct PktSchema<SrvDataPkt> { static constexpr const auto& fields {SRV_PKT_FIELDS}; };
+
+/**
+ * @brief Writes a value into the packet member described by field
+ * @note Bools only accept bools (matches json::get<bool>), numbers accept bools & any number
+ */
+template<typename PktT, typename ValT>
+void setField(PktT& pkt, const PktField& field, const ValT val, const bool is_bool) {
+    char* member {reinterpret_cast<char*>(&pkt) + field.offset};
+    switch (field.type) {
+        case FieldType::Bool:
+            if (!is_bool) {
+                throw std::runtime_error{std::string{"expected a bool for key '"} + field.path[0] + "'"};
+            }
+            *reinterpret_cast<bool*>(member) = static_cast<bool>(val);
+            break;
+        case FieldType::Int:
+            *reinterpret_cast<int*>(member) = static_cast<int>(val);
+            break;
+        case FieldType::Float:
+            *reinterpret_cast<float*>(member) = static_cast<float>(val);
+            break;
+    }
+}
+
+/**
+ * @brief SAX consumer that merges a json/bson document straight into a packet struct in a single pass
+ * (keys that are not in the document keep the packet's current value & unknown keys are ignored)
+ */
+template<typename PktT>
+class PktMergeSax {
+    public:
+        using number_integer_t  = json::number_integer_t;
+        using number_unsigned_t = json::number_unsigned_t;
+        using number_float_t    = json::number_float_t;
+        using string_t          = json::string_t;
+        using binary_t          = json::binary_t;
+
+        explicit PktMergeSax(PktT& pkt) : pkt{pkt}, obj_depth{0}, array_depth{0} {}
+
+        bool null()                                     { return true; }
+        bool boolean(bool val)                          { return setLeaf(val, true); }
+        bool number_integer(number_integer_t val)       { return setLeaf(val, false); }
+        bool number_unsigned(number_unsigned_t val)     { return setLeaf(val, false); }
+        bool number_float(number_float_t val, const string_t&) { return setLeaf(val, false); }
+        bool string(string_t&)                          { return true; }
+        bool binary(binary_t&)                          { return true; }
+        bool start_object(std::size_t)                  { ++obj_depth; return true; }
+        bool end_object()                               { --obj_depth; return true; }
+        bool start_array(std::size_t)                   { ++array_depth; return true; }
+        bool end_array()                                { --array_depth; return true; }
+
+        bool key(string_t& val) {
+            // reuses the same strings each time, so short keys never allocate
+            if (array_depth == 0 && obj_depth >= 1 && obj_depth <= MAX_FIELD_DEPTH) {
+                keys[obj_depth-1] = val;
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& err) {
+            throw std::runtime_error{err.what()};
+        }
+
+    private:
+        PktT&           pkt;
+        std::string     keys[MAX_FIELD_DEPTH];  // the key path to the value currently being parsed
+        std::size_t     obj_depth;              // how many objects deep the parser is
+        std::size_t     array_depth;            // values inside arrays never map to a field
+
+        template<typename ValT>
+        bool setLeaf(const ValT val, const bool is_bool) {
+            if (array_depth != 0 || obj_depth == 0 || obj_depth > MAX_FIELD_DEPTH) return true;
+
+            for (const PktField& field : PktSchema<PktT>::fields) {
+                if (matchesPath(field)) {
+                    setField(pkt, field, val, is_bool);
+                    break;
+                }
+            }
+            return true;
+        }
+
+        bool matchesPath(const PktField& field) const {
+            for (std::size_t depth = 0; depth < obj_depth; ++depth) {
+                if (field.path[depth] == nullptr || keys[depth] != field.path[depth]) return false;
+            }
+            // the field must end exactly at this depth
+            return obj_depth == MAX_FIELD_DEPTH || field.path[obj_depth] == nullptr;
+        }
+};
+
+/**
+ * @brief Merges a serialized json/bson packet into `pkt` (which should start as the current packet)
+ */
+template<typename PktT>
+void mergeSerializedPkt(PktT& pkt, const char* pkt_buf, const std::size_t size, const bool is_bson) {
+    PktMergeSax<PktT> merger {pkt};
+    json::sax_parse(
+        pkt_buf, pkt_buf + size,
+        &merger,
+        is_bson ? json::input_format_t::bson : json::input_format_t::json
+    );
+}
+
+/**
+ * @brief Merges an already parsed json packet into `pkt` (which should start as the current packet)
+ * @note Walks the json by pointer so no part of it is copied
+ */
+template<typename PktT>
+void mergeJsonPkt(PktT& pkt, const json& pkt_json) {
+    for (const PktField& field : PktSchema<PktT>::fields) {
+        const json* node {&pkt_json};
+        for (std::size_t depth = 0; depth < MAX_FIELD_DEPTH && field.path[depth] != nullptr && node; ++depth) {
+            if (!node->is_object()) {
+                node = nullptr;
+                break;
+            }
+            const auto found {node->find(field.path[depth])};
+            node = found != node->end() ? &*found : nullptr;
+        }
+
+        // missing key keeps the stored value
+        if (node == nullptr) continue;
+
+        if (node->is_boolean()) {
+            setField(pkt, field, node->get<bool>(), true);
+        } else if (node->is_number()) {
+            setField(pkt, field, node->get<double>(), false);
+        } else {
+            throw std::runtime_error{std::string{"unexpected value type for key '"} + field.path[0] + "'"};
+        }
+    }
+}
+
+} // end of anonymous namespace
+
 /************************************************ Common Packet Structs ******************************************/
 
 std::uint8_t HeaderPkt_t::ihl() const {
@@ -18,72 +266,121 @@ std::size_t HeaderPkt_t::size() const {
     return ihl() * sizeof(std::uint32_t);
 }
 
-std::string HeaderPkt_t::toString() {
-    // convert from standard network format (pay attention to which ones are longs = uint32_t)
-    // total_length    = htonl(total_length);
-    // id              = htons(id);
-    // flags_fo        = htons(flags_fo);
-    // checksum        = htons(checksum);
-    // src_addr        = htonl(src_addr);
-    // dst_addr        = htonl(dst_addr);
-
-    std::ostringstream pkt_stream;
-    pkt_stream.write((char*)&ver_ihl,      sizeof(ver_ihl));
-    pkt_stream.write((char*)&tos,          sizeof(tos));
-    pkt_stream.write((char*)&total_length, sizeof(total_length));
-    pkt_stream.write((char*)&id,           sizeof(id));
-    pkt_stream.write((char*)&flags_fo,     sizeof(flags_fo));
-    pkt_stream.write((char*)&ttl,          sizeof(ttl));
-    pkt_stream.write((char*)&protocol,     sizeof(protocol));
-    pkt_stream.write((char*)&checksum,     sizeof(checksum));
-    pkt_stream.write((char*)&src_addr,     sizeof(src_addr));
-    pkt_stream.write((char*)&dst_addr,     sizeof(dst_addr));
-    return pkt_stream.str();
+namespace {
+
+// helpers to (de)serialize header fields in network byte order (big-endian) without padding
+template<typename UintT>
+inline std::uint8_t* putBigEndian(std::uint8_t* pos, const UintT val) {
+    for (std::size_t byte = sizeof(UintT); byte > 0; --byte) {
+        *pos++ = static_cast<std::uint8_t>(val >> (8 * (byte-1)));
+    }
+    return pos;
+}
+
+template<typename UintT>
+inline const std::uint8_t* getBigEndian(const std::uint8_t* pos, UintT& val) {
+    val = 0;
+    for (std::size_t byte = 0; byte < sizeof(UintT); ++byte) {
+        val = static_cast<UintT>((val << 8) | *pos++);
+    }
+    return pos;
+}
+
+} // end of anonymous namespace
+
+void HeaderPkt_t::pack(std::uint8_t* wire_buf) const {
+    std::uint8_t* pos {wire_buf};
+    pos = putBigEndian(pos, ver_ihl);
+    pos = putBigEndian(pos, tos);
+    pos = putBigEndian(pos, total_length);
+    pos = putBigEndian(pos, id);
+    pos = putBigEndian(pos, flags_fo);
+    pos = putBigEndian(pos, ttl);
+    pos = putBigEndian(pos, protocol);
+    pos = putBigEndian(pos, checksum);
+    pos = putBigEndian(pos, src_addr);
+    pos = putBigEndian(pos, dst_addr);
+}
+
+std::string HeaderPkt_t::toString() const {
+    std::uint8_t wire_buf[WIRE_SIZE];
+    pack(wire_buf);
+    return std::string{reinterpret_cast<const char*>(wire_buf), WIRE_SIZE};
 }
 
 HeaderPkt_t::HeaderPkt_t() {
-    // stub to init everything to defaults (aka 0)
+    // stub (default member initializers zero everything)
+}
+
+HeaderPkt_t::HeaderPkt_t(const std::uint8_t* wire_buf) {
+    const std::uint8_t* pos {wire_buf};
+    pos = getBigEndian(pos, ver_ihl);
+    pos = getBigEndian(pos, tos);
+    pos = getBigEndian(pos, total_length);
+    pos = getBigEndian(pos, id);
+    pos = getBigEndian(pos, flags_fo);
+    pos = getBigEndian(pos, ttl);
+    pos = getBigEndian(pos, protocol);
+    pos = getBigEndian(pos, checksum);
+    pos = getBigEndian(pos, src_addr);
+    pos = getBigEndian(pos, dst_addr);
 }
 
 HeaderPkt_t::HeaderPkt_t(std::istream& stream) {
-    stream.read((char*)&ver_ihl,      sizeof(ver_ihl));
-    stream.read((char*)&tos,          sizeof(tos));
-    stream.read((char*)&total_length, sizeof(total_length));
-    stream.read((char*)&id,           sizeof(id));
-    stream.read((char*)&flags_fo,     sizeof(flags_fo));
-    stream.read((char*)&ttl,          sizeof(ttl));
-    stream.read((char*)&protocol,     sizeof(protocol));
-    stream.read((char*)&checksum,     sizeof(checksum));
-    stream.read((char*)&src_addr,     sizeof(src_addr));
-    stream.read((char*)&dst_addr,     sizeof(dst_addr));
-
-    // convert to standard network format (pay attention to which ones are longs = uint32_t)
-    // total_length    = ntohl(total_length);
-    // id              = ntohs(id);
-    // flags_fo        = ntohs(flags_fo);
-    // checksum        = ntohs(checksum);
-    // src_addr        = ntohl(src_addr);
-    // dst_addr        = ntohl(dst_addr);
-}
-
-// credit: https://stackoverflow.com/a/23726131/13933174
-std::uint16_t HeaderPkt_t::CalcChecksum(const void* data_buf, std::size_t size) {
-    unsigned char x;
-    unsigned short crc = 0xFFFF;
-
-    while (size--){
-        const unsigned char* ucharptr { static_cast<const unsigned char*>(data_buf) };
-        // have to remove constness to increment position
-        unsigned char* data_ptr { const_cast<unsigned char*>(ucharptr) };
-        x = crc >> 8 ^ *(data_ptr++);
-        x ^= x >> 4;
-        crc = ( crc << 8 )
-            ^ ( static_cast<unsigned short>(x << 12) )
-            ^ ( static_cast<unsigned short>(x << 5)  )
-            ^ ( static_cast<unsigned short>(x)       )
-            ;
-    }
-    return crc;
+    std::uint8_t wire_buf[WIRE_SIZE] {};
+    stream.read(reinterpret_cast<char*>(wire_buf), WIRE_SIZE);
+    *this = HeaderPkt_t{wire_buf};
+}
+
+std::uint32_t HeaderPkt_t::CalcChecksum(const void* data_buf, std::size_t size) {
+    return Checksum::crc32c(data_buf, size);
+}
+
+bool HeaderPkt_t::hasChecksum() const {
+    return (flags_fo & FLAG_NO_CHECKSUM) == 0;
+}
+
+bool HeaderPkt_t::isSessionHello() const {
+    return (flags_fo & FLAG_SESSION) != 0;
+}
+
+bool HeaderPkt_t::isClockPing() const {
+    return (flags_fo & FLAG_CLOCK) != 0;
+}
+
+void HeaderPkt_t::setOriginTime(const std::uint64_t time_us) {
+    src_addr    = static_cast<std::uint32_t>(time_us >> 32);
+    dst_addr    = static_cast<std::uint32_t>(time_us);
+}
+
+std::uint64_t HeaderPkt_t::getOriginTime() const {
+    return (static_cast<std::uint64_t>(src_addr) << 32) | dst_addr;
+}
+
+void HeaderPkt_t::setStamp(const Camera::FrameStamp& stamp) {
+    // rounds a later hop's delay to the ms, saturating at the field's max
+    const auto delay_ms {[](const std::uint64_t from_us, const std::uint64_t to_us, const std::uint64_t max_ms) {
+        const std::uint64_t delay_us {from_us > 0 && to_us > from_us ? to_us - from_us : 0};
+        return std::min((delay_us + 500) / 1000, max_ms);
+    }};
+
+    id          = stamp.seq;
+    setOriginTime(stamp.capture_us);
+    ttl         = static_cast<std::uint8_t>(delay_ms(stamp.capture_us, stamp.encoded_us, 0xFF));
+    flags_fo    = static_cast<std::uint16_t>(
+        (flags_fo & ~FO_MASK) | delay_ms(stamp.encoded_us, stamp.sent_us, FO_MASK)
+    );
+}
+
+Camera::FrameStamp HeaderPkt_t::getStamp() const {
+    Camera::FrameStamp stamp {};
+    stamp.capture_us = getOriginTime();
+    if (!stamp.isStamped()) return stamp;
+
+    stamp.seq           = id;
+    stamp.encoded_us    = stamp.capture_us + ttl * std::uint64_t{1000};
+    stamp.sent_us       = stamp.encoded_us + (flags_fo & FO_MASK) * std::uint64_t{1000};
+    return stamp;
 }
 
 
@@ -92,68 +389,121 @@ Packet::Packet()
     : cmn_pkt_ready{true}                               // will be set false immediately after sending first message
     , cam_pkt_ready{true}                               // will be set false immediately after sending first message
     , srv_pkt_ready{true}                               // will be set false immediately after sending first message
-    , latest_frame(Constants::Camera::FRAME_SIZE, '0')  // init to black frame (0s) to make sure size != 0
+    , latest_frame{StampedFrame{std::make_shared<const std::vector<unsigned char>>(
+        Constants::Camera::FRAME_SIZE, '0'), {}}}       // init to black frame (0s) to make sure size != 0
+    , data_event_fd{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
 {
-    // stub
+    if (data_event_fd < 0) {
+        std::cerr << "ERROR: Creating new data eventfd" << std::endl;
+    }
 }
 
 Packet::~Packet() {
-    // stub
+    if (data_event_fd >= 0) {
+        close(data_event_fd);
+    }
 }
 
 /********************************************* Getters/Setters *********************************************/
 
-const CommonPkt& Packet::getCurrentCmnPkt() const {
-    // lock to make sure data can be gotten without new data being written
-    std::unique_lock<std::mutex> lk{cmn_data_pkt_mutex};
-    return latest_ctrl_pkt;
+CommonPkt Packet::getCurrentCmnPkt() const {
+    return latest_ctrl_pkt.load();
 }
 
-const SrvDataPkt& Packet::getCurrentSrvPkt() const {
-    // lock to make sure data can be gotten without new data being written
-    std::unique_lock<std::mutex> lk{srv_data_pkt_mutex};
-    return latest_srv_data_pkt;
+SrvDataPkt Packet::getCurrentSrvPkt() const {
+    return latest_srv_data_pkt.load();
 }
 
 
 ReturnCodes Packet::updatePkt(const CommonPkt& updated_pkt) {
-    // lock to make sure data can be written without it trying to be read simultaneously
-    std::unique_lock<std::mutex> lk{cmn_data_pkt_mutex};
-    latest_ctrl_pkt = updated_pkt;
-    lk.unlock();
-    cmn_pkt_ready.store(true); // atomic should be done outside of lock
+    // readers never wait on this, only the thread waiting for `has_new_cmn_data` shares the lock
+    latest_ctrl_pkt.publish(updated_pkt);
+    {
+        std::unique_lock<std::mutex> lk{cmn_data_pkt_mutex};
+        cmn_pkt_ready.store(true);
+    }
     has_new_cmn_data.notify_all();
+    notifyDataEvent();
     return ReturnCodes::Success;
 }
 
 ReturnCodes Packet::updatePkt(const SrvDataPkt& updated_pkt) {
-    // lock to make sure data can be written without it trying to be read simultaneously
-    std::unique_lock<std::mutex> lk{srv_data_pkt_mutex};
-    latest_srv_data_pkt = updated_pkt;
-    lk.unlock();
-    srv_pkt_ready.store(true); // atomic should be done outside of lock
+    // readers never wait on this, only the thread waiting for `has_new_srv_data` shares the lock
+    latest_srv_data_pkt.publish(updated_pkt);
+    {
+        std::unique_lock<std::mutex> lk{srv_data_pkt_mutex};
+        srv_pkt_ready.store(true);
+    }
     has_new_srv_data.notify_all();
+    notifyDataEvent();
     return ReturnCodes::Success;
 }
 
 
-const std::vector<unsigned char>& Packet::getLatestCamFrame() const {
-    // lock to make sure data can be gotten without new data being written
-    std::unique_lock<std::mutex> lk{frame_mutex};
-    return latest_frame;
+CamFrame Packet::getLatestCamFramePtr() const {
+    // copying the handle keeps the frame alive for the caller (the frame itself is not copied)
+    return latest_frame.read()->frame;
 }
 
+CamFrameSnapshot Packet::getLatestCamFrameSnapshot() const {
+    const auto snapshot {latest_frame.read()};
+    return CamFrameSnapshot{snapshot->frame, snapshot.getGeneration(), snapshot->stamp};
+}
+
+CamFrameSnapshot Packet::waitForNewCamFrame(const std::uint64_t last_generation, const int timeout_ms) const {
+    {
+        // the frame is published before the mutex is taken to notify, so checking under it cannot miss one
+        std::unique_lock<std::mutex> lk{cam_data_pkt_mutex};
+        new_frame_set.wait_for(lk, std::chrono::milliseconds(timeout_ms), [&]() {
+            return latest_frame.getGeneration() != last_generation;
+        });
+    }
+    return getLatestCamFrameSnapshot();
+}
 
-ReturnCodes Packet::setLatestCamFrame(const std::vector<unsigned char>& new_frame) {
-    // lock to make sure data can be written without it trying to be read simultaneously
-    std::unique_lock<std::mutex> lk{frame_mutex};
-    latest_frame = new_frame;
-    lk.unlock();
-    cam_pkt_ready.store(true);
+
+ReturnCodes Packet::setLatestCamFrame(const std::vector<unsigned char>& new_frame, const Camera::FrameStamp& stamp) {
+    return setLatestCamFrame(std::make_shared<const std::vector<unsigned char>>(new_frame), stamp);
+}
+
+ReturnCodes Packet::setLatestCamFrame(std::vector<unsigned char>&& new_frame, const Camera::FrameStamp& stamp) {
+    return setLatestCamFrame(std::make_shared<const std::vector<unsigned char>>(std::move(new_frame)), stamp);
+}
+
+ReturnCodes Packet::setLatestCamFrame(CamFrame new_frame, const Camera::FrameStamp& stamp) {
+    if (!new_frame) return ReturnCodes::Error;
+
+    // old frame is released once no reader holds a handle to it
+    latest_frame.publish(StampedFrame{std::move(new_frame), stamp});
+    {
+        std::unique_lock<std::mutex> lk{cam_data_pkt_mutex};
+        cam_pkt_ready.store(true);
+    }
     has_new_cam_data.notify_one();
+    new_frame_set.notify_all();
+    notifyDataEvent();
     return ReturnCodes::Success;
 }
 
+int Packet::getDataEventFd() const {
+    return data_event_fd;
+}
+
+void Packet::notifyDataEvent() const {
+    // counter just accumulates until the reactor reads it (cant block, eventfd is non-blocking)
+    const std::uint64_t one {1};
+    if (data_event_fd >= 0) {
+        [[maybe_unused]] const ssize_t written {::write(data_event_fd, &one, sizeof(one))};
+    }
+}
+
+void Packet::clearDataEvent() const {
+    std::uint64_t count {0};
+    if (data_event_fd >= 0) {
+        [[maybe_unused]] const ssize_t rd {::read(data_event_fd, &count, sizeof(count))};
+    }
+}
+
 
 /*************************************** Packet Read/Write Functions ***************************************/
 // note: when using copy constructor cannot use {} because stores original json into an array
@@ -167,36 +517,25 @@ json Packet::readCmnPkt(const char* pkt_buf, const std::size_t size) const {
 
 
 CommonPkt Packet::readCmnPkt(const char* pkt_buf, const std::size_t size, const bool is_bson) const {
+    // start from the current packet so missing keys keep their stored values
+    CommonPkt pkt {getCurrentCmnPkt()};
+
     // if no data sent, just use current packet
-    if (std::strlen(pkt_buf) == 0 || size == 0) {
-        return getCurrentCmnPkt();
+    if (size == 0) {
+        return pkt;
     }
 
-    // if valid str, parse and convert stringified bson to json covnert to standard pkt
-    // (use bson for faster/concise pkt transfers)
-    const json& pkt_json = is_bson ? readCmnPkt(pkt_buf, size) : json::parse(pkt_buf);
-    return readCmnPkt(pkt_json);
+    // merge the serialized packet straight into the struct (no intermediate json)
+    mergeSerializedPkt(pkt, pkt_buf, size, is_bson);
+    return pkt;
 }
 
 
 CommonPkt Packet::readCmnPkt(const json& pkt_json) const {
     // see pkt_sample.json for format
-    // actually parse packet and save into struct
-    CommonPkt pkt;
-
-    pkt.cntrl.led.red        = findIfExists<bool>(pkt_json, {"control",  "led",      "red"       });
-    pkt.cntrl.led.yellow     = findIfExists<bool>(pkt_json, {"control",  "led",      "yellow"    });
-    pkt.cntrl.led.green      = findIfExists<bool>(pkt_json, {"control",  "led",      "green"     });
-    pkt.cntrl.led.blue       = findIfExists<bool>(pkt_json, {"control",  "led",      "blue"      });
-    pkt.cntrl.motor.forward  = findIfExists<bool>(pkt_json, {"control",  "motor",    "forward"   });
-    pkt.cntrl.motor.backward = findIfExists<bool>(pkt_json, {"control",  "motor",    "backward"  });
-    pkt.cntrl.motor.right    = findIfExists<bool>(pkt_json, {"control",  "motor",    "right"     });
-    pkt.cntrl.motor.left     = findIfExists<bool>(pkt_json, {"control",  "motor",    "left"      });
-    pkt.cntrl.servo.horiz    = findIfExists<int> (pkt_json, {"control",  "servo",    "horiz"     });
-    pkt.cntrl.servo.vert     = findIfExists<int> (pkt_json, {"control",  "servo",    "vert"      });
-    pkt.cntrl.camera.is_on   = findIfExists<bool>(pkt_json, {"control",  "camera",   "is_on"     });
-    pkt.ACK                  = findIfExists<bool>(pkt_json, {"ACK"});
-
+    // start from the current packet so missing keys keep their stored values
+    CommonPkt pkt {getCurrentCmnPkt()};
+    mergeJsonPkt(pkt, pkt_json);
     return pkt;
 }
 
@@ -245,26 +584,25 @@ json Packet::readSrvPkt(const char* pkt_buf, const std::size_t size) const {
 
 
 SrvDataPkt Packet::readSrvPkt(const char* pkt_buf, const std::size_t size, const bool is_bson) const {
+    // start from the current packet so missing keys keep their stored values
+    SrvDataPkt pkt {getCurrentSrvPkt()};
+
     // if no data sent, just use current packet
-    if (std::strlen(pkt_buf) == 0 || size == 0) {
-        return getCurrentSrvPkt();
+    if (size == 0) {
+        return pkt;
     }
 
-    // if valid str, parse and convert stringified bson to json covnert to standard pkt
-    // (use bson for faster/concise pkt transfers)
-    const json& pkt_json = is_bson ? readSrvPkt(pkt_buf, size) : json::parse(pkt_buf);
-    return readSrvPkt(pkt_json);
+    // merge the serialized packet straight into the struct (no intermediate json)
+    mergeSerializedPkt(pkt, pkt_buf, size, is_bson);
+    return pkt;
 }
 
 
 SrvDataPkt Packet::readSrvPkt(const json& pkt_json) const {
     // see pkt_sample.json for format
-    // actually parse packet and save into struct
-    SrvDataPkt pkt;
-
-    pkt.ultrasonic.dist = findIfExists<float>(pkt_json, {"ultrasonic", "dist"});
-    pkt.ACK = findIfExists<bool>(pkt_json, {"ACK"});
-
+    // start from the current packet so missing keys keep their stored values
+    SrvDataPkt pkt {getCurrentSrvPkt()};
+    mergeJsonPkt(pkt, pkt_json);
     return pkt;
 }
 
@@ -297,37 +635,138 @@ std::string Packet::writePkt(const json& pkt_to_send) const {
     return pkt_bson_str;
 }
 
-/********************************************* Helper Functions ********************************************/
+std::string Packet::writePkt(const CommonPkt& pkt_to_send, const PktEncoding encoding) const {
+    switch (encoding) {
+        case PktEncoding::Binary:   return encodeBinPkt(pkt_to_send);
+        case PktEncoding::Bson:     return writePkt(pkt_to_send);
+        default:                    throw std::invalid_argument{"common packets cannot be sent raw"};
+    }
+}
 
-template<typename rtnType>
-rtnType Packet::findIfExists(const json& json_to_check, const std::vector<std::string>& keys) const {
-    // use current packet to fill in missing values
-    // make copies of jsons to recur through
-    // as parse thru keys, move deeper into the jsons so researching not needed
+std::string Packet::writePkt(const SrvDataPkt& pkt_to_send, const PktEncoding encoding) const {
+    switch (encoding) {
+        case PktEncoding::Binary:   return encodeBinPkt(pkt_to_send);
+        case PktEncoding::Bson:     return writePkt(pkt_to_send);
+        default:                    throw std::invalid_argument{"server data packets cannot be sent raw"};
+    }
+}
 
-    // note: when using copy constructor cannot use {} because stores original json into an array
-    // see: https://github.com/nlohmann/json/issues/1359
-    json recv_curr = json_to_check;                        // the received packet to parse through
-    json curr_pkt  = convertPktToJson(getCurrentCmnPkt());    // valid json of current stored pkt (source of truth)
+CommonPkt Packet::readCmnPkt(const char* pkt_buf, const std::size_t size, const PktEncoding encoding) const {
+    switch (encoding) {
+        case PktEncoding::Binary:   return decodeBinCmnPkt(pkt_buf, size);
+        case PktEncoding::Bson:     return readCmnPkt(pkt_buf, size, true);
+        default:                    throw std::invalid_argument{"common packets cannot be read raw"};
+    }
+}
 
-    // loop condition checkers
-    const std::size_t len_keys {keys.size()};
-    std::size_t idx_counter {0};
+SrvDataPkt Packet::readSrvPkt(const char* pkt_buf, const std::size_t size, const PktEncoding encoding) const {
+    switch (encoding) {
+        case PktEncoding::Binary:   return decodeBinSrvPkt(pkt_buf, size);
+        case PktEncoding::Bson:     return readSrvPkt(pkt_buf, size, true);
+        default:                    throw std::invalid_argument{"server data packets cannot be read raw"};
+    }
+}
 
-    for (auto& key : keys) {
-        // go deeper into json (select key and ignore rest)
-        curr_pkt = curr_pkt[key]; // no worries with this not existing
-        recv_curr = recv_curr.contains(key) ? recv_curr[key] : curr_pkt; // if dne, just use curr pkt (which has already zeroed in on the key)
-        ++idx_counter;
+/****************************************** Binary Wire Codec *****************************************/
+// Every binary packet starts with [version (1B)][PktType (1B)], multi-byte fields are little-endian.
+//
+// CommonPkt (6B typical, BinCodec::CMN_MAX_SIZE max):
+//   [led/motor flags (1B)][camera/ACK flags (1B)][servo horiz (zigzag varint)][servo vert (zigzag varint)]
+//   led/motor bits (lsb first): red, yellow, green, blue, forward, backward, right, left
+//   camera/ACK bits (lsb first): camera.is_on, ACK
+//
+// SrvDataPkt (BinCodec::SRV_SIZE):
+//   [flags (1B): ACK][ultrasonic dist (IEEE-754 float, 4B)]
+
+std::string Packet::encodeBinPkt(const CommonPkt& pkt) {
+    std::string out;
+    out.reserve(BinCodec::CMN_MAX_SIZE);
+    out.push_back(static_cast<char>(BinCodec::VERSION));
+    out.push_back(static_cast<char>(PktType::Common));
+
+    const control_t& cntrl {pkt.cntrl};
+    std::uint8_t flags {0};
+    flags |= cntrl.led.red          ? LED_RED           : 0;
+    flags |= cntrl.led.yellow       ? LED_YELLOW        : 0;
+    flags |= cntrl.led.green        ? LED_GREEN         : 0;
+    flags |= cntrl.led.blue         ? LED_BLUE          : 0;
+    flags |= cntrl.motor.forward    ? MOTOR_FORWARD     : 0;
+    flags |= cntrl.motor.backward   ? MOTOR_BACKWARD    : 0;
+    flags |= cntrl.motor.right      ? MOTOR_RIGHT       : 0;
+    flags |= cntrl.motor.left       ? MOTOR_LEFT        : 0;
+    out.push_back(static_cast<char>(flags));
+
+    std::uint8_t misc {0};
+    misc |= cntrl.camera.is_on      ? CAMERA_ON         : 0;
+    misc |= pkt.ACK                 ? ACK               : 0;
+    out.push_back(static_cast<char>(misc));
+
+    putVarint(out, zigzagEncode(cntrl.servo.horiz));
+    putVarint(out, zigzagEncode(cntrl.servo.vert));
+    return out;
+}
 
-        // first check that this is not the element to return
-        // at the end of the key list
-        if(idx_counter == len_keys) {
-            return recv_curr.get<rtnType>();
-        }
+std::string Packet::encodeBinPkt(const SrvDataPkt& pkt) {
+    std::string out;
+    out.reserve(BinCodec::SRV_SIZE);
+    out.push_back(static_cast<char>(BinCodec::VERSION));
+    out.push_back(static_cast<char>(PktType::SrvData));
+    out.push_back(static_cast<char>(pkt.ACK ? ACK : 0));
+
+    // copy out the float's bits & write them least significant byte first
+    std::uint32_t dist_bits;
+    static_assert(sizeof(dist_bits) == sizeof(pkt.ultrasonic.dist), "float must be 32 bits");
+    std::memcpy(&dist_bits, &pkt.ultrasonic.dist, sizeof(dist_bits));
+    for (int byte = 0; byte < 4; ++byte) {
+        out.push_back(static_cast<char>((dist_bits >> (8 * byte)) & 0xFF));
     }
-    // never going to reach this point
-    return curr_pkt;
+    return out;
+}
+
+CommonPkt Packet::decodeBinCmnPkt(const char* pkt_buf, const std::size_t size) {
+    const unsigned char* pos {reinterpret_cast<const unsigned char*>(pkt_buf)};
+    const unsigned char* end {pos + size};
+    checkBinPreamble(pos, size, PktType::Common);
+    pos += 2;
+
+    if (end - pos < 2) {
+        throw std::runtime_error{"binary common packet truncated"};
+    }
+    const std::uint8_t flags {*pos++};
+    const std::uint8_t misc  {*pos++};
+
+    CommonPkt pkt;
+    pkt.cntrl.led.red           = flags & LED_RED;
+    pkt.cntrl.led.yellow        = flags & LED_YELLOW;
+    pkt.cntrl.led.green         = flags & LED_GREEN;
+    pkt.cntrl.led.blue          = flags & LED_BLUE;
+    pkt.cntrl.motor.forward     = flags & MOTOR_FORWARD;
+    pkt.cntrl.motor.backward    = flags & MOTOR_BACKWARD;
+    pkt.cntrl.motor.right       = flags & MOTOR_RIGHT;
+    pkt.cntrl.motor.left        = flags & MOTOR_LEFT;
+    pkt.cntrl.camera.is_on      = misc & CAMERA_ON;
+    pkt.ACK                     = misc & ACK;
+    pkt.cntrl.servo.horiz       = zigzagDecode(getVarint(pos, end));
+    pkt.cntrl.servo.vert        = zigzagDecode(getVarint(pos, end));
+    return pkt;
+}
+
+SrvDataPkt Packet::decodeBinSrvPkt(const char* pkt_buf, const std::size_t size) {
+    const unsigned char* buf {reinterpret_cast<const unsigned char*>(pkt_buf)};
+    checkBinPreamble(buf, size, PktType::SrvData);
+    if (size < BinCodec::SRV_SIZE) {
+        throw std::runtime_error{"binary server data packet truncated"};
+    }
+
+    std::uint32_t dist_bits {0};
+    for (int byte = 0; byte < 4; ++byte) {
+        dist_bits |= static_cast<std::uint32_t>(buf[3 + byte]) << (8 * byte);
+    }
+
+    SrvDataPkt pkt;
+    pkt.ACK = buf[2] & ACK;
+    std::memcpy(&pkt.ultrasonic.dist, &dist_bits, sizeof(dist_bits));
+    return pkt;
 }
 
 } // end of Network namespace
@@ -0,0 +1,60 @@
+#include "reactor.h"
+
+// Standard Includes
+#include <unistd.h> // for close()
+#include <cerrno>
+
+namespace RPI {
+namespace Network {
+
+/********************************************** Constructors **********************************************/
+
+Reactor::Reactor()
+    : epoll_fd{epoll_create1(EPOLL_CLOEXEC)}
+    , ready_events(Constants::Network::MAX_REACTOR_EVENTS)
+{
+    // stub
+}
+
+Reactor::~Reactor() {
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+    }
+}
+
+bool Reactor::isValid() const {
+    return epoll_fd >= 0;
+}
+
+/********************************************* Watch Functions *********************************************/
+
+ReturnCodes Reactor::add(const int fd, const std::uint32_t events) {
+    epoll_event ev {};
+    ev.events   = events;
+    ev.data.fd  = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0 ? ReturnCodes::Success : ReturnCodes::Error;
+}
+
+ReturnCodes Reactor::modify(const int fd, const std::uint32_t events) {
+    epoll_event ev {};
+    ev.events   = events;
+    ev.data.fd  = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0 ? ReturnCodes::Success : ReturnCodes::Error;
+}
+
+ReturnCodes Reactor::remove(const int fd) {
+    return epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr) == 0 ? ReturnCodes::Success : ReturnCodes::Error;
+}
+
+const std::vector<epoll_event>& Reactor::wait(const int timeout_ms) {
+    ready_events.resize(Constants::Network::MAX_REACTOR_EVENTS);
+    const int num_ready {epoll_wait(epoll_fd, ready_events.data(), static_cast<int>(ready_events.size()), timeout_ms)};
+
+    // EINTR (i.e. ctrl+c) is not an error, just nothing to handle
+    ready_events.resize(num_ready > 0 ? static_cast<std::size_t>(num_ready) : 0);
+    return ready_events;
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
@@ -0,0 +1,277 @@
+#include "shm_ring.h"
+
+#include <iostream>
+#include <new> // for placement new
+#include <chrono>
+#include <algorithm> // for std::min
+#include <cstring> // for memcpy
+#include <cerrno>
+#include <climits> // for INT_MAX
+#include <ctime> // for timespec
+#include <fcntl.h> // for O_* constants
+#include <unistd.h> // for close() & ftruncate()
+#include <sys/mman.h> // for shm_open() & mmap()
+#include <sys/stat.h> // for fstat()
+#include <sys/syscall.h> // for SYS_futex
+#include <linux/futex.h>
+
+namespace RPI {
+namespace Network {
+
+namespace {
+
+constexpr std::uint32_t RING_MAGIC      {0x52504947}; // "RPIG" (bump whenever the layout changes)
+constexpr std::size_t   SLOT_ALIGN      {64};         // keep every slot on its own cache lines
+
+constexpr std::size_t alignUp(const std::size_t size, const std::size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+// process-shared futex (no FUTEX_PRIVATE_FLAG), the word lives in the shared mapping
+long futexWait(std::atomic<std::uint32_t>* word, const std::uint32_t expected, const int timeout_ms) {
+    timespec timeout    {};
+    timeout.tv_sec      = timeout_ms / 1000;
+    timeout.tv_nsec     = static_cast<long>(timeout_ms % 1000) * 1000000L;
+    return ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void futexWakeAll(std::atomic<std::uint32_t>* word) {
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} // end of anonymous namespace
+
+/************************************************* Ring Layout **************************************************/
+
+struct ShmFrameRing::RingHeader {
+    std::atomic<std::uint32_t>  magic;          // RING_MAGIC once the ring is ready to be read
+    std::uint32_t               num_slots;      // number of frames kept
+    std::uint64_t               slot_size;      // largest frame that fits in a slot
+    std::uint64_t               slot_stride;    // bytes from one slot to the next
+    std::atomic<std::uint32_t>  latest_seq;     // seq of the newest complete frame (0: none yet), readers' futex
+    std::atomic<std::uint32_t>  closed;         // 1 once the writer is gone
+};
+
+struct ShmFrameRing::SlotHeader {
+    std::atomic<std::uint32_t>  seq_begin;      // seq of the frame being written (set before the data changes)
+    std::atomic<std::uint32_t>  seq_end;        // seq of the frame fully written (set after the data changed)
+    std::atomic<std::uint32_t>  size;           // number of bytes of frame data
+    std::uint8_t                header[HeaderPkt_t::WIRE_SIZE]; // packed header of the frame (w/ its stamp)
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "shared memory ring needs lock-free 32 bit atomics");
+
+/********************************************** Constructors **********************************************/
+
+ShmFrameRing::ShmFrameRing()
+    : shm_name{}
+    , mapping{nullptr}
+    , mapping_size{0}
+    , is_writer{false}
+{
+    // stub
+}
+
+ShmFrameRing::~ShmFrameRing() {
+    close();
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+bool ShmFrameRing::isOpen() const {
+    return mapping != nullptr;
+}
+
+std::string ShmFrameRing::makeName(const int port) {
+    return "/rpi_driver.cam." + std::to_string(port);
+}
+
+/********************************************** Ring Functions *********************************************/
+
+ReturnCodes ShmFrameRing::create(const std::string& name, const std::size_t num_slots, const std::size_t slot_size) {
+    close();
+
+    const std::size_t slot_stride   {alignUp(sizeof(SlotHeader), SLOT_ALIGN) + alignUp(slot_size, SLOT_ALIGN)};
+    const std::size_t total_size    {alignUp(sizeof(RingHeader), SLOT_ALIGN) + slot_stride * num_slots};
+
+    // a ring left behind by a server that crashed is just reinitialized
+    // (tmpfs only backs the pages frames are actually written to)
+    const int shm_fd {::shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0600)};
+    if (shm_fd < 0) {
+        std::cerr << "ERROR: Failed to create shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        return ReturnCodes::Error;
+    }
+    if (::ftruncate(shm_fd, 0) < 0 || ::ftruncate(shm_fd, static_cast<off_t>(total_size)) < 0) {
+        std::cerr << "ERROR: Failed to size shared memory " << name << std::endl;
+        ::close(shm_fd);
+        ::shm_unlink(name.c_str());
+        return ReturnCodes::Error;
+    }
+    if (mapFd(shm_fd, total_size) != ReturnCodes::Success) {
+        ::shm_unlink(name.c_str());
+        return ReturnCodes::Error;
+    }
+    shm_name    = name;
+    is_writer   = true;
+
+    // fresh (zeroed) pages -> fill in the layout & only then mark it readable
+    RingHeader* header  {new (mapping) RingHeader{}};
+    header->num_slots   = static_cast<std::uint32_t>(num_slots);
+    header->slot_size   = slot_size;
+    header->slot_stride = slot_stride;
+    for (std::uint32_t slot = 0; slot < num_slots; ++slot) {
+        new (getSlot(slot)) SlotHeader{};
+    }
+    header->magic.store(RING_MAGIC, std::memory_order_release);
+    return ReturnCodes::Success;
+}
+
+ReturnCodes ShmFrameRing::open(const std::string& name) {
+    close();
+
+    const int shm_fd {::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0)};
+    if (shm_fd < 0) {
+        std::cerr << "ERROR: Failed to open shared memory " << name << " (is the server running?)" << std::endl;
+        return ReturnCodes::Error;
+    }
+
+    struct stat shm_stat {};
+    if (::fstat(shm_fd, &shm_stat) < 0 || static_cast<std::size_t>(shm_stat.st_size) < sizeof(RingHeader)) {
+        std::cerr << "ERROR: Shared memory " << name << " is not a frame ring" << std::endl;
+        ::close(shm_fd);
+        return ReturnCodes::Error;
+    }
+    if (mapFd(shm_fd, static_cast<std::size_t>(shm_stat.st_size)) != ReturnCodes::Success) {
+        return ReturnCodes::Error;
+    }
+    shm_name    = name;
+    is_writer   = false;
+
+    // make sure the writer finished laying it out & every slot is within the mapping
+    const RingHeader* header {getHeader()};
+    const bool is_valid {
+        header->magic.load(std::memory_order_acquire) == RING_MAGIC && header->num_slots > 0
+        && alignUp(sizeof(RingHeader), SLOT_ALIGN) + header->slot_stride * header->num_slots <= mapping_size
+    };
+    if (!is_valid) {
+        std::cerr << "ERROR: Shared memory " << name << " is not a frame ring" << std::endl;
+        close();
+        return ReturnCodes::Error;
+    }
+    return ReturnCodes::Success;
+}
+
+void ShmFrameRing::close() {
+    if (mapping == nullptr) return;
+
+    // let the readers know there will be no more frames (they stop waiting & can unmap it)
+    if (is_writer) {
+        getHeader()->closed.store(1, std::memory_order_release);
+        futexWakeAll(&getHeader()->latest_seq);
+        ::shm_unlink(shm_name.c_str());
+    }
+
+    ::munmap(mapping, mapping_size);
+    mapping         = nullptr;
+    mapping_size    = 0;
+    is_writer       = false;
+    shm_name.clear();
+}
+
+std::uint32_t ShmFrameRing::publish(const HeaderPkt_t& header, const void* data, const std::size_t size) {
+    if (!is_writer || size > getHeader()->slot_size) return 0;
+
+    // 0 means "no frame yet", so skip it when the seq wraps
+    RingHeader* ring    {getHeader()};
+    std::uint32_t seq   {ring->latest_seq.load(std::memory_order_relaxed) + 1};
+    if (seq == 0) seq = 1;
+
+    // seqlock: mark the slot as changing before touching the data, readers that copied it meanwhile retry
+    SlotHeader* slot {getSlot(seq)};
+    slot->seq_begin.store(seq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header.pack(slot->header);
+    std::memcpy(reinterpret_cast<std::uint8_t*>(slot) + alignUp(sizeof(SlotHeader), SLOT_ALIGN), data, size);
+    slot->size.store(static_cast<std::uint32_t>(size), std::memory_order_relaxed);
+    slot->seq_end.store(seq, std::memory_order_release);
+
+    ring->latest_seq.store(seq, std::memory_order_release);
+    futexWakeAll(&ring->latest_seq);
+    return seq;
+}
+
+RecvRtn ShmFrameRing::waitNext(BufferPool& pool, std::uint32_t& cursor, const int timeout_ms) {
+    if (mapping == nullptr) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+    }
+
+    RingHeader* header {getHeader()};
+    const auto deadline {std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms)};
+    while (true) {
+        if (header->closed.load(std::memory_order_acquire)) {
+            return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, {}};
+        }
+
+        const std::uint32_t seq {header->latest_seq.load(std::memory_order_acquire)};
+        if (seq != 0 && seq != cursor) {
+            const SlotHeader* slot {getSlot(seq)};
+            if (slot->seq_end.load(std::memory_order_acquire) == seq) {
+                const std::size_t size {std::min<std::size_t>(slot->size.load(std::memory_order_relaxed), header->slot_size)};
+                PooledBuf frame {pool.acquire(size)};
+                if (!frame) {
+                    cursor = seq; // too large for the pool, skip it
+                    return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+                }
+                std::memcpy(frame->data(), reinterpret_cast<const std::uint8_t*>(slot) + alignUp(sizeof(SlotHeader), SLOT_ALIGN), size);
+                HeaderPkt_t frame_header {slot->header};
+
+                // still the same frame after copying -> writer did not lap us mid copy
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot->seq_begin.load(std::memory_order_relaxed) == seq) {
+                    cursor = seq;
+                    frame_header.total_length = static_cast<std::uint32_t>(size);
+                    return RecvRtn{std::move(frame), RecvSendRtnCodes::Success, frame_header};
+                }
+            }
+            // torn/unfinished slot -> the writer has (or is about to have) a newer frame, look again
+            continue;
+        }
+
+        // nothing new -> sleep until the writer bumps the latest seq (or time runs out)
+        const auto time_left {std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()
+        ).count()};
+        if (time_left <= 0) {
+            return RecvRtn{nullptr, RecvSendRtnCodes::WouldBlock, {}};
+        }
+        futexWait(&header->latest_seq, seq, static_cast<int>(time_left));
+    }
+}
+
+/********************************************* Helper Functions ********************************************/
+
+ShmFrameRing::RingHeader* ShmFrameRing::getHeader() const {
+    return static_cast<RingHeader*>(mapping);
+}
+
+ShmFrameRing::SlotHeader* ShmFrameRing::getSlot(const std::uint32_t seq) const {
+    const RingHeader* header {getHeader()};
+    std::uint8_t* slots {static_cast<std::uint8_t*>(mapping) + alignUp(sizeof(RingHeader), SLOT_ALIGN)};
+    return reinterpret_cast<SlotHeader*>(slots + (seq % header->num_slots) * header->slot_stride);
+}
+
+ReturnCodes ShmFrameRing::mapFd(const int shm_fd, const std::size_t size) {
+    void* const mapped {::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0)};
+    ::close(shm_fd); // mapping keeps the shared memory alive
+    if (mapped == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to map shared memory" << std::endl;
+        return ReturnCodes::Error;
+    }
+    mapping         = mapped;
+    mapping_size    = size;
+    return ReturnCodes::Success;
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
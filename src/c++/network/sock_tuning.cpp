@@ -0,0 +1,74 @@
+#include "sock_tuning.h"
+
+// Standard Includes
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>     // for IP_TOS
+#include <netinet/tcp.h>    // for TCP_NODELAY & TCP_NOTSENT_LOWAT
+#include <linux/sockios.h>  // for SIOCOUTQNSD
+
+// older libc headers may not define it (kernel >= 3.12)
+#ifndef TCP_NOTSENT_LOWAT
+#define TCP_NOTSENT_LOWAT 25
+#endif
+
+namespace RPI {
+namespace Network {
+namespace SockTuning {
+
+ReturnCodes tune(const int sock_fd, const Channel channel, const bool is_mux, bool* has_lowat) {
+    const ChannelTuning tuning {getChannelTuning(channel, is_mux)};
+    bool ok {true};
+    if (has_lowat != nullptr) *has_lowat = false;
+
+    // only inet sockets have the ip options (& only tcp ones the tcp options), unix sockets still get queued by priority
+    int domain {AF_UNSPEC};
+    int type {0};
+    socklen_t domain_len {sizeof(domain)};
+    socklen_t type_len {sizeof(type)};
+    const bool is_inet {getsockopt(sock_fd, SOL_SOCKET, SO_DOMAIN, &domain, &domain_len) == 0 && domain == AF_INET};
+    const bool is_tcp {is_inet && getsockopt(sock_fd, SOL_SOCKET, SO_TYPE, &type, &type_len) == 0 && type == SOCK_STREAM};
+
+    if (is_inet) {
+        const int tos {tuning.dscp << 2};
+        ok &= setsockopt(sock_fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) == 0;
+    }
+
+    if (is_tcp) {
+        // pkts are already batched into whole messages, so nagle only delays the small ones
+        const int no_delay {1};
+        ok &= setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)) == 0;
+
+        if (tuning.notsent_lowat > 0) {
+            const int lowat {static_cast<int>(tuning.notsent_lowat)};
+            ok &= setsockopt(sock_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(lowat)) == 0;
+
+            // read it back, the socket's writability only follows the mark if the kernel took it
+            int set_lowat {0};
+            socklen_t set_lowat_len {sizeof(set_lowat)};
+            const bool is_set {
+                getsockopt(sock_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &set_lowat, &set_lowat_len) == 0
+                && set_lowat == lowat
+            };
+            if (has_lowat != nullptr) *has_lowat = is_set;
+        }
+    }
+
+    // after IP_TOS, which overwrites the priority w/ one derived from the tos
+    ok &= setsockopt(sock_fd, SOL_SOCKET, SO_PRIORITY, &tuning.priority, sizeof(tuning.priority)) == 0;
+
+    return ok ? ReturnCodes::Success : ReturnCodes::Error;
+}
+
+std::size_t getNotSentSize(const int sock_fd) {
+    int not_sent {0};
+    if (sock_fd < 0 || ioctl(sock_fd, SIOCOUTQNSD, &not_sent) < 0 || not_sent < 0) return 0;
+    return static_cast<std::size_t>(not_sent);
+}
+
+} // end of SockTuning namespace
+
+} // end of Network namespace
+
+}; // end of RPI namespace
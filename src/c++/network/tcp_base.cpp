@@ -10,16 +10,28 @@ using std::endl;
 
 /********************************************** Constructors **********************************************/
 
-TcpBase::TcpBase(const bool verbosity)
+TcpBase::TcpBase(const bool verbosity, const Transport transport)
     : Packet{}
+    , recv_cb{}
+    , udp_chan{}                    // opened by the derived class if using Transport::Udp
+    , frame_timings{}               // filled in as stamped frames are received/served
     , is_verbose{verbosity}
+    , transport{transport}
     , should_exit{false}
-    , control_thread{}
+    , net_threads{}
     , started_threads{false}
     , is_init{false}
     , has_cleaned_up{false}
+    , io_engine{IoEngine::Posix}    // recv() unless setIoEngine() says otherwise
+    , uring_engines{}               // setup per socket on first recvData()
+    , recv_syscalls{0}
+    , video_rung{0}                 // best quality until the server measures its camera subscribers
+    , capture{}                     // opened by startCapture()
+    , is_capturing{false}
 {
-    // stub
+    for (auto& enabled : checksum_enabled) {
+        enabled.store(true);
+    }
 }
 
 TcpBase::~TcpBase() {
@@ -40,22 +52,17 @@ ReturnCodes TcpBase::cleanup() {
         [&](){ return started_threads.load(); }
     );
 
-    // block until thread ends
-    if (control_thread.joinable()) {
-        control_thread.join();
-    }
-
-    if(cam_vid_thread.joinable()) {
-        cam_vid_thread.join();
-    }
-
-    if(srv_data_thread.joinable()) {
-        srv_data_thread.join();
+    // block until threads end
+    for (auto& net_thread : net_threads) {
+        if (net_thread.joinable()) {
+            net_thread.join();
+        }
     }
 
     // call quit once thread for derived client/server is over
     // quit should be overriden by derived classes for proper cleanup
     quit();
+    stopCapture();
 
     has_cleaned_up.store(true);
     return ReturnCodes::Success;
@@ -69,6 +76,8 @@ bool TcpBase::isVerbose() const {
 
 ReturnCodes TcpBase::setExitCode(const bool new_exit) {
     should_exit.store(new_exit);
+    // wake up any reactor waiting on new data so it sees the exit promptly
+    notifyDataEvent();
     return ReturnCodes::Success;
 }
 
@@ -88,37 +97,147 @@ void TcpBase::setIsInit(const bool new_status) {
     is_init.store(new_status);
 }
 
+void TcpBase::setChecksumEnabled(const Channel channel, const bool enabled) {
+    checksum_enabled[static_cast<std::size_t>(channel)].store(enabled);
+}
+
+bool TcpBase::isChecksumEnabled(const Channel channel) const {
+    return checksum_enabled[static_cast<std::size_t>(channel)].load();
+}
+
 /****************************************** Shared Common Functions ****************************************/
 
+Transport TcpBase::getTransport() const {
+    return transport;
+}
+
+void TcpBase::setLossShim(const LossShim& shim) {
+    udp_chan.setLossShim(shim);
+}
+
+ReturnCodes TcpBase::setIoEngine(const IoEngine engine) {
+    if (engine == IoEngine::Uring && !UringEngine::isSupported()) {
+        cerr << "WARNING: io_uring is not available (needs linux 6.0+), reading sockets w/ recv()" << endl;
+        io_engine.store(IoEngine::Posix);
+        return ReturnCodes::Error;
+    }
+    io_engine.store(engine);
+    return ReturnCodes::Success;
+}
+
+IoEngine TcpBase::getIoEngine() const {
+    return io_engine.load();
+}
+
+std::uint64_t TcpBase::getNumRecvSyscalls() const {
+    return recv_syscalls.load();
+}
+
+Camera::VideoSettings TcpBase::getVideoSettings() const {
+    return Camera::getVideoSettings(video_rung.load());
+}
+
+std::size_t TcpBase::getVideoRung() const {
+    return video_rung.load();
+}
+
+const FrameTimings& TcpBase::getFrameTimings() const {
+    return frame_timings;
+}
+
+void TcpBase::recordFrameServed(const Camera::FrameStamp& stamp) {
+    frame_timings.recordServed(stamp, Camera::FrameStamp::now());
+}
+
+const ClockSync& TcpBase::getClockSync() const {
+    return clock_sync;
+}
+
+ReturnCodes TcpBase::startCapture(const std::string& path) {
+    if (capture.open(path) != ReturnCodes::Success) return ReturnCodes::Error;
+    is_capturing.store(true);
+    if (isVerbose()) cout << "Capturing network traffic to " << path << endl;
+    return ReturnCodes::Success;
+}
+
+void TcpBase::stopCapture() {
+    if (!is_capturing.exchange(false)) return;
+    const std::uint64_t num_records {capture.getNumRecords()};
+    capture.close();
+    if (isVerbose()) cout << "Captured " << num_records << " messages" << endl;
+}
+
+bool TcpBase::isCapturing() const {
+    return is_capturing.load();
+}
+
+void TcpBase::setVideoRung(const std::size_t rung) {
+    video_rung.store(rung);
+}
+
 int TcpBase::CloseOpenSock(int sock_fd) {
     if(sock_fd >= 0) {
+        // buffers still pinned by zero copy sends can be released since the conn is going away
+        {
+            std::unique_lock<std::mutex> lk{zc_mutex};
+            zc_trackers.erase(sock_fd);
+        }
+        // the io_uring recv has to stop before the socket (& its fd number) goes away
+        {
+            std::unique_lock<std::mutex> lk{uring_mutex};
+            uring_engines.erase(sock_fd);
+        }
         close(sock_fd);
         sock_fd = - 1;
     }
     return sock_fd;
 }
 
+ReturnCodes TcpBase::enableZeroCopy(const int socket_fd) {
+    if (socket_fd < 0 || ZeroCopyTracker::enable(socket_fd) != ReturnCodes::Success) {
+        return ReturnCodes::Error;
+    }
+    std::unique_lock<std::mutex> lk{zc_mutex};
+    zc_trackers[socket_fd] = ZeroCopyTracker{};
+    return ReturnCodes::Success;
+}
+
+bool TcpBase::tuneSock(const int socket_fd, const Channel channel) {
+    if (socket_fd < 0) return false;
+    const bool is_mux {getTransport() == Transport::Mux};
+    bool has_lowat {false};
+    if (SockTuning::tune(socket_fd, channel, is_mux, &has_lowat) != ReturnCodes::Success && isVerbose()) {
+        cout << "Failed to set the socket priority/options of channel " << static_cast<int>(channel) << endl;
+    }
+    if (is_mux && !has_lowat) {
+        cerr << "Error: Failed to limit the mux connection's send queue, control pkts may wait behind frames" << endl;
+    }
+    return has_lowat;
+}
+
+UringEngine* TcpBase::getUringEngine(const int socket_fd) {
+    // a socket is only ever read (& closed) by one thread, so the engine outlives the lock
+    std::unique_lock<std::mutex> lk{uring_mutex};
+    const auto found {uring_engines.find(socket_fd)};
+    if (found != uring_engines.end()) return found->second.get();
+
+    // setup failures are remembered (null) so the socket just uses recv()
+    std::unique_ptr<UringEngine> engine {new UringEngine{}};
+    if (engine->init(socket_fd) != ReturnCodes::Success) {
+        cerr << "WARNING: Failed to setup io_uring for socket " << socket_fd << ", reading it w/ recv()" << endl;
+        engine.reset();
+    }
+    return (uring_engines[socket_fd] = std::move(engine)).get();
+}
+
 
 void TcpBase::runNetAgent(const bool print_data) {
     // create a lock that prevents joiner from trying to join() before ready
     // if thread is not initialized yet, join() will occur before thread is started
     std::unique_lock<std::mutex> start_thread_lk{thread_mutex};
 
-    // startup client/server agent in a thread
-    // cannot capture by reference in locally existing lambda
-    control_thread = std::thread{[this, print_data]() mutable {
-        // dont pin fn to TcpBase since it should be overridden by derived classes
-        ControlLoopFn(print_data);
-    }};
-
-    cam_vid_thread = std::thread{[this]() {
-        // dont pin fn to TcpBase since it should be overridden by derived classes
-        VideoStreamHandler();
-    }};
-
-    srv_data_thread = std::thread{[this, print_data]() {
-        ServerDataHandler(print_data);
-    }};
+    // startup client/server agent's threads
+    launchNetThreads(print_data);
 
     // unlock & notify so joiner can continue
     started_threads.store(true);
@@ -127,164 +246,334 @@ void TcpBase::runNetAgent(const bool print_data) {
     
 }
 
+void TcpBase::launchNetThreads(const bool print_data) {
+    // cannot capture by reference in locally existing lambda
+    // dont pin fns to TcpBase since they should be overridden by derived classes
+    startNetThread([this, print_data]() { ControlLoopFn(print_data); });
+    startNetThread([this]() { VideoStreamHandler(); });
+    startNetThread([this, print_data]() { ServerDataHandler(print_data); });
+}
+
+void TcpBase::startNetThread(std::function<void()> thread_fn) {
+    net_threads.emplace_back(std::move(thread_fn));
+}
+
 std::string TcpBase::formatIpAddr(const std::string& ip, const int port) const {
     return {ip + ":" + std::to_string(port)};
 }
 
-RecvRtn TcpBase::recvData(int socket_fd) {
+socklen_t TcpBase::makeLocalAddr(const int port, sockaddr_un& addr) const {
+    // leading '\0' puts the name in the abstract namespace (no socket file to clean up if the server crashes)
+    const std::string name {"rpi_driver." + std::to_string(port)};
+    addr            = sockaddr_un{};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path + 1, name.data(), name.size());
+    return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+}
+
+RecvRtn TcpBase::recvData(int socket_fd, BufferPool& pool, const Channel channel) {
     // make sure data socket is open/valid first
     if(socket_fd < 0) {
-        return RecvRtn{{}, RecvSendRtnCodes::Error};
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+    }
+
+    /******************************************* io_uring engine **************************************/
+    UringEngine* const engine {io_engine.load() == IoEngine::Uring ? getUringEngine(socket_fd) : nullptr};
+    if (engine != nullptr) {
+        std::uint64_t num_syscalls {0};
+        const RecvRtn uring_rtn {engine->recvMsg(pool, num_syscalls)};
+        recv_syscalls.fetch_add(num_syscalls, std::memory_order_relaxed);
+
+        if (!engine->hasFailed()) {
+            if (uring_rtn.RtnCode == RecvSendRtnCodes::Success && !verifyChecksum(uring_rtn, channel)) {
+                return RecvRtn{nullptr, RecvSendRtnCodes::Error, uring_rtn.header};
+            }
+            return uring_rtn;
+        }
+
+        // kernel refused the multishot recv before anything was read -> recv() from here on
+        cerr << "WARNING: io_uring multishot recv is not supported (needs linux 6.0+), reading w/ recv()" << endl;
+        std::unique_lock<std::mutex> lk{uring_mutex};
+        uring_engines[socket_fd] = nullptr;
     }
 
     /*************************************** recv data pkt header *************************************/
     // first recv packet header to see how much data is expected (keep looping until it all arrives)
-    const int max_header_size {sizeof(HeaderPkt_t)};
-    char header_buf[max_header_size];
+    const int max_header_size {HeaderPkt_t::WIRE_SIZE};
+    std::uint8_t header_buf[max_header_size];
     int header_rx_size {0};
     while (header_rx_size < max_header_size) {
-        const int max_stream_left { std::min(
-            max_header_size-header_rx_size, // amount of header pkt left to recv
-            static_cast<int>(Constants::Network::MAX_DATA_SIZE)
-        )};
+        const int max_stream_left {max_header_size-header_rx_size}; // amount of header pkt left to recv
         const int header_rx_partial = ::recv(socket_fd, header_buf+header_rx_size, max_stream_left, 0);
+        recv_syscalls.fetch_add(1, std::memory_order_relaxed);
         if (header_rx_partial < 0) {
             if(isVerbose()) {
                 cerr << "Error: receiving header packet" << endl;
             }
-            return RecvRtn{{}, RecvSendRtnCodes::Error};
+            return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
         } 
         else if (header_rx_partial == 0) {
             // end of stream
             if(isVerbose()) {
                 cerr << "Error: other host closed connection while sending header packet" << endl;
             }
-            return RecvRtn{{}, RecvSendRtnCodes::ClosedConn};
+            return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, {}};
         }
         header_rx_size += header_rx_partial;
     }
     
-    // reconstitute header packet into struct (in binary stream form)
-    std::istringstream header_pkt_stream{ std::string{header_buf, static_cast<std::size_t>(header_rx_size)} };
-    // convert into actual struct
-    HeaderPkt_t header { header_pkt_stream };
+    // reconstitute header packet into struct
+    const HeaderPkt_t header { header_buf };
 
     /*********************************** recv actual data packets *************************************/
 
-    // prepare bufs for receiving
+    // get a reusable buffer big enough for the whole message (refused if larger than allowed)
+    PooledBuf recv_buf {pool.acquire(header.total_length)};
+    u_char    discard_buf[Constants::Network::MAX_DATA_SIZE]; // only used to drain refused messages
+    if (!recv_buf) {
+        cerr << "ERROR: RECV - message too large (" << header.total_length << "/"
+             << pool.getMaxMsgSize() << " bytes), discarding it" << endl;
+    }
+
     std::uint32_t total_recv_size {0};
-    char recv_buf[header.total_length];
-    RecvSendRtnCodes rtn_code {RecvSendRtnCodes::Success}; // default to success
     while (total_recv_size < header.total_length) {
         // append new data to top of buf (new start = start + curr size)
-        const std::uint32_t max_stream_size {std::min(
-            header.total_length-total_recv_size, // the amount of stream data left to receive
-            static_cast<std::uint32_t>(Constants::Network::MAX_DATA_SIZE)
-        )};
+        // (ask for everything left, only the discard buffer caps it)
+        const std::uint32_t left {header.total_length-total_recv_size}; // the amount of stream data left to receive
+        const std::uint32_t max_stream_size {recv_buf ?
+            left : std::min(left, static_cast<std::uint32_t>(sizeof(discard_buf)))
+        };
 
-        // actually recv data
-        const int rcv_size = ::recv(socket_fd, recv_buf+total_recv_size, max_stream_size, 0);
+        // actually recv data (if refused, keep draining it so the stream stays in sync)
+        u_char* dest {recv_buf ? recv_buf->data()+total_recv_size : discard_buf};
+        const int rcv_size = ::recv(socket_fd, dest, max_stream_size, 0);
+        recv_syscalls.fetch_add(1, std::memory_order_relaxed);
 
         // error checking
         if(rcv_size < 0) {
             if(isVerbose()) {
                 cerr << "ERROR: RECV (" << total_recv_size << "/" << header.total_length << ")" << endl;
             }
-            rtn_code = RecvSendRtnCodes::Error;
-            break;
+            return RecvRtn{nullptr, RecvSendRtnCodes::Error, header};
         }
 
         else if (rcv_size == 0) {
             if(isVerbose()) {
                 cerr << "ERROR: RECV - other host closed connection" << endl;
             }
-            rtn_code = RecvSendRtnCodes::ClosedConn;
-            break;
+            return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, header};
         }
 
         // increment progress
         total_recv_size += rcv_size;
     }
 
-    return RecvRtn{
-        std::vector<u_char>{recv_buf, recv_buf+total_recv_size},
-        rtn_code
+    if (!recv_buf) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, header};
+    }
+
+    RecvRtn recv_rtn {
+        std::move(recv_buf),
+        RecvSendRtnCodes::Success,
+        header
     };
+
+    // whole message arrived, so the stream is still in sync even if the data is corrupt
+    if (!verifyChecksum(recv_rtn, channel)) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, header};
+    }
+    return recv_rtn;
 }
 
 SendRtn TcpBase::sendData(
     int& socket_fd,
+    const Channel channel,
     const void* buf,
-    const std::uint32_t size_to_tx
+    const std::uint32_t size_to_tx,
+    const PktEncoding encoding,
+    const std::shared_ptr<const void>& keepalive
 ) {
     // make sure data socket is open/valid first
     if(socket_fd < 0) {
         return SendRtn{0, RecvSendRtnCodes::Error};
     }
 
-    // construct header packet to send pkt to send prior to data
+    // same writer the reactor uses, the socket just blocks (up to its send timeout) instead of waiting on EPOLLOUT
+    MsgWriter writer {};
+    writer.start(makeHeader(buf, size_to_tx, encoding, channel), buf, size_to_tx, keepalive);
+    while (true) {
+        const SendRtn send_rtn {continueSend(socket_fd, writer)};
+
+        // send timeout hit (receiver is slow) -- keep going unless told to exit since a half sent msg
+        // would leave the stream out of sync
+        if (send_rtn.RtnCode == RecvSendRtnCodes::WouldBlock && !getExitCode()) continue;
+
+        if (send_rtn.RtnCode != RecvSendRtnCodes::Success) {
+            cerr << "ERROR: Sending Data (" << send_rtn.size << "/" << size_to_tx << ")" << endl;
+            return SendRtn{send_rtn.size, RecvSendRtnCodes::Error};
+        }
+        return send_rtn;
+    }
+}
+
+HeaderPkt_t TcpBase::makeHeader(
+    const void* buf,
+    const std::uint32_t size_to_tx,
+    const PktEncoding encoding,
+    const Channel channel
+) const {
     HeaderPkt_t header_pkt      {};
     header_pkt.total_length     = size_to_tx;
-    header_pkt.checksum         = header_pkt.CalcChecksum(buf, size_to_tx);
+    header_pkt.protocol         = static_cast<std::uint8_t>(encoding);
+    header_pkt.channel          = static_cast<std::uint8_t>(channel);
+    header_pkt.tos              = channelPriority(channel);
+    if (isChecksumEnabled(channel)) {
+        header_pkt.checksum     = HeaderPkt_t::CalcChecksum(buf, size_to_tx);
+    } else {
+        header_pkt.flags_fo    |= HeaderPkt_t::FLAG_NO_CHECKSUM;
+    }
+    return header_pkt;
+}
 
-    /*************************************** send data pkt header *************************************/
-    // send the header for the packet so recv can know size (send with no special props)
-    // const std::string str_pkt {header_pkt.toString()};
-    std::string str_pkt {header_pkt.toString()};
+OutMsg TcpBase::makeSessionHello(const std::uint32_t session_token, const Channel channel) const {
+    const auto net_token {std::make_shared<const std::uint32_t>(htonl(session_token))};
+    HeaderPkt_t header {makeHeader(net_token.get(), sizeof(*net_token), PktEncoding::Raw, channel)};
+    header.flags_fo |= HeaderPkt_t::FLAG_SESSION;
+    return OutMsg{header, net_token.get(), sizeof(*net_token), net_token};
+}
 
-    const int max_header_size {sizeof(HeaderPkt_t)};
-    const int header_sent_size = ::send(socket_fd, str_pkt.c_str(), max_header_size, MSG_NOSIGNAL);
-    if(header_sent_size < 0) {
-        cerr << "ERROR: Send header packet (" << header_sent_size << "/" << max_header_size << ")" << endl;
-        return SendRtn{0, RecvSendRtnCodes::Error};
+std::uint32_t TcpBase::readSessionToken(const RecvRtn& hello) {
+    std::uint32_t net_token {0};
+    if (!hello.header.isSessionHello() || !hello.buf || hello.buf->size() != sizeof(net_token)) return 0;
+    std::memcpy(&net_token, hello.buf->data(), sizeof(net_token));
+    return ntohl(net_token);
+}
+
+OutMsg TcpBase::makeClockMsg(const ClockPing& ping) const {
+    const auto wire_ping {std::make_shared<std::array<std::uint8_t, ClockPing::WIRE_SIZE>>()};
+    ping.pack(wire_ping->data());
+    constexpr std::uint32_t size {ClockPing::WIRE_SIZE};
+    HeaderPkt_t header {makeHeader(wire_ping->data(), size, PktEncoding::Raw, Channel::Control)};
+    header.flags_fo |= HeaderPkt_t::FLAG_CLOCK;
+    return OutMsg{header, wire_ping->data(), size, wire_ping};
+}
+
+std::optional<ClockPing> TcpBase::readClockMsg(const RecvRtn& msg) {
+    if (!msg.header.isClockPing() || !msg.buf || msg.buf->size() != ClockPing::WIRE_SIZE) return std::nullopt;
+    return ClockPing{msg.buf->data()};
+}
+
+void TcpBase::captureMsg(
+    const CaptureDir dir,
+    const Channel channel,
+    const HeaderPkt_t& header,
+    const void* data,
+    const std::uint32_t size
+) {
+    // a late append after stopCapture() is refused by the closed writer
+    if (!is_capturing.load(std::memory_order_relaxed)) return;
+    capture.append(dir, channel, header, data, size, ClockSync::now());
+}
+
+bool TcpBase::verifyChecksum(const RecvRtn& recv, const Channel channel) const {
+    if (!recv.buf || !recv.header.hasChecksum() || !isChecksumEnabled(channel)) return true;
+
+    const std::uint32_t calc_checksum {HeaderPkt_t::CalcChecksum(recv.buf->data(), recv.buf->size())};
+    if (calc_checksum != recv.header.checksum) {
+        cerr << "ERROR: RECV - checksum mismatch (" << recv.buf->size() << " bytes), dropping message" << endl;
+        return false;
     }
+    return true;
+}
 
+SendRtn TcpBase::sendDatagram(const sockaddr_in& dest, const OutMsg& msg) {
+    return udp_chan.sendTo(dest, msg);
+}
+
+DgramRtn TcpBase::recvDatagram(BufferPool& pool, const Channel channel) {
+    DgramRtn dgram {udp_chan.recvFrom(pool)};
+    if (!verifyChecksum(dgram.msg, channel)) {
+        dgram.msg.buf       = nullptr;
+        dgram.msg.RtnCode   = RecvSendRtnCodes::Error;
+    }
+    return dgram;
+}
 
-    /************************************** send actual data pkts *************************************/
-    // send actual data now that other side knows size of this packet
-    const int sent_size = ::send(socket_fd, buf, size_to_tx, MSG_NOSIGNAL);
-    if (sent_size < 0 || sent_size != static_cast<int>(size_to_tx)) {
-        cerr << "ERROR: Sending Data (" << sent_size << "/" << size_to_tx << ")" << endl;
-        return SendRtn{static_cast<std::uint32_t>(sent_size), RecvSendRtnCodes::Error};
+SendRtn TcpBase::continueSend(const int socket_fd, MsgWriter& writer) {
+    // reactor owns the socket, but zero copy trackers are shared w/ CloseOpenSock()
+    std::unique_lock<std::mutex> lk{zc_mutex};
+    const auto found {zc_trackers.find(socket_fd)};
+    ZeroCopyTracker* zc_tracker {nullptr};
+    if (found != zc_trackers.end()) {
+        found->second.reap(socket_fd); // release buffers of finished sends first
+        zc_tracker = &found->second;
     }
+    return writer.writeSome(socket_fd, zc_tracker);
+}
+
+RecvRtn TcpBase::continueRecv(const int socket_fd, MsgReader& reader, BufferPool& pool, const Channel channel) {
+    UringEngine* const engine {io_engine.load() == IoEngine::Uring ? getUringEngine(socket_fd) : nullptr};
+    std::uint64_t num_syscalls {0};
+    const RecvRtn recv_rtn {engine != nullptr ?
+        engine->recvMsg(pool, num_syscalls) :
+        reader.readSome(socket_fd, pool, &num_syscalls)
+    };
+    recv_syscalls.fetch_add(num_syscalls, std::memory_order_relaxed);
 
-    // iff successful, sent_size >= 0 so can safely cast to uint
-    return SendRtn{static_cast<std::uint32_t>(sent_size), RecvSendRtnCodes::Success};
+    // whole message arrived, so the stream is still in sync even if the data is corrupt
+    if (recv_rtn.RtnCode == RecvSendRtnCodes::Success && !verifyChecksum(recv_rtn, channel)) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, recv_rtn.header};
+    }
+    return recv_rtn;
 }
 
+SendRtn TcpBase::continueSend(const int socket_fd, MuxWriter& writer) {
+    return writer.writeSome(socket_fd);
+}
 
-/********************************************* Helper Functions ********************************************/
+RecvRtn TcpBase::continueRecv(const int socket_fd, MuxReader& reader, const MuxPools& pools) {
+    std::uint64_t num_syscalls {0};
+    const RecvRtn recv_rtn {reader.readSome(socket_fd, pools, &num_syscalls)};
+    recv_syscalls.fetch_add(num_syscalls, std::memory_order_relaxed);
 
-// Credit: https://stackoverflow.com/a/3120382/13933174
-std::string TcpBase::GetPublicIp() const {
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) {
-        cerr << "ERROR: Creating temp socket to get public ip" << endl;
+    // whole message arrived, so the stream is still in sync even if the data is corrupt
+    const Channel channel {static_cast<Channel>(recv_rtn.header.channel)};
+    if (recv_rtn.RtnCode == RecvSendRtnCodes::Success && !verifyChecksum(recv_rtn, channel)) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, recv_rtn.header};
     }
+    return recv_rtn;
+}
 
-    const char* kGoogleDnsIp = "8.8.8.8";
-    uint16_t kDnsPort = 53;
-    struct sockaddr_in serv;
-    memset(&serv, 0, sizeof(serv));
-    serv.sin_family = AF_INET;
-    serv.sin_addr.s_addr = inet_addr(kGoogleDnsIp);
-    serv.sin_port = htons(kDnsPort);
+int TcpBase::getRecvWaitFd(const int socket_fd) {
+    UringEngine* const engine {io_engine.load() == IoEngine::Uring ? getUringEngine(socket_fd) : nullptr};
+    return engine != nullptr ? engine->getRingFd() : socket_fd;
+}
 
-    int err = connect(sock, (const sockaddr*) &serv, sizeof(serv));
-    assert(err != -1);
 
-    sockaddr_in name;
-    socklen_t namelen = sizeof(name);
-    err = getsockname(sock, (sockaddr*) &name, &namelen);
-    assert(err != -1);
+/********************************************* Helper Functions ********************************************/
 
-    char ip_buf[16];
-    const char* p = inet_ntop(AF_INET, &name.sin_addr, ip_buf, sizeof(ip_buf));
-    assert(p);
+// first non loopback ipv4 address of an interface that is up (no packets sent, works w/o internet)
+std::string TcpBase::GetPublicIp() const {
+    ifaddrs* if_list {nullptr};
+    if (getifaddrs(&if_list) < 0) {
+        cerr << "ERROR: Reading the network interfaces to get the public ip" << endl;
+        return "127.0.0.1";
+    }
 
-    close(sock);
+    std::string ip {"127.0.0.1"};
+    for (const ifaddrs* iface = if_list; iface != nullptr; iface = iface->ifa_next) {
+        if (iface->ifa_addr == nullptr || iface->ifa_addr->sa_family != AF_INET) continue;
+        if (!(iface->ifa_flags & IFF_UP) || (iface->ifa_flags & IFF_LOOPBACK)) continue;
 
-    return std::string(ip_buf);
+        char ip_buf[INET_ADDRSTRLEN];
+        const auto& if_addr {reinterpret_cast<const sockaddr_in*>(iface->ifa_addr)->sin_addr};
+        if (inet_ntop(AF_INET, &if_addr, ip_buf, sizeof(ip_buf)) != nullptr) {
+            ip = ip_buf;
+            break;
+        }
+    }
+    freeifaddrs(if_list);
+    return ip;
 }
 
 } // end of Network namespace
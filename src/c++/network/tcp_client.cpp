@@ -7,6 +7,23 @@ using std::cout;
 using std::cerr;
 using std::endl;
 
+namespace {
+
+/**
+ * @brief Picks a random, non-zero session token (0 means "no session" to the server)
+ */
+std::uint32_t makeSessionToken() {
+    std::random_device rand_dev {};
+    std::uint32_t token {0};
+    while (token == 0) token = rand_dev();
+    return token;
+}
+
+// every channel that can have a stream socket of its own (see getStreamConn())
+constexpr std::array<Channel, NUM_CHANNELS> STREAM_CHANNELS {Channel::Control, Channel::Camera, Channel::SrvData};
+
+} // end of anonymous namespace
+
 /********************************************** Constructors **********************************************/
 
 TcpClient::TcpClient(
@@ -15,16 +32,44 @@ TcpClient::TcpClient(
     const int cam_port_num,
     const int srv_data_port_num,
     const bool should_init,
-    const bool verbosity
+    const bool verbosity,
+    const PktEncoding encoding,
+    const Transport transport
 )
-    : TcpBase{verbosity}
+    : TcpBase{verbosity, transport}
+    , reactor{}                             // sockets are added once connected
+    , session_token{makeSessionToken()}
+    , is_connected{false}                   // connected by the reactor
+    , conns_lost{false}
+    , reconnect_backoff{Constants::Network::RECONNECT_MIN_MS}
+    , reconnect_at{}
+    , connected_at{}
+    , conn_pending{}                        // nothing connecting yet
+    , connect_deadline{}
     , ctrl_data_sock_fd{-1}                 // init to invalid
     , server_ip{ip_addr}                    // ip address to try to reach server
     , ctrl_data_port{ctrl_port_num}         // port the client tries to reach the server at for sending control pkts
+    , ctrl_writer{}                         // nothing to send yet
+    , ctrl_reader{}                         // nothing received yet
+    , ctrl_rx_pool{Constants::Network::MAX_CTRL_MSG_SIZE}
+    , next_clock_ping{}                     // first ping goes out once connected
+    , ctrl_wait_writable{false}
+    , mux_reader{}                          // nothing received yet (Transport::Mux)
+    , mux_writer{}                          // nothing to send yet (Transport::Mux)
     , cam_data_sock_fd{-1}                  // init to invalid
     , cam_data_port{cam_port_num}           // port to attempt to connect to server to recv camera data
+    , cam_rx_pool{Constants::Network::MAX_FRAME_MSG_SIZE}
+    , cam_reader{}                          // nothing received yet
+    , cam_wait_fd{-1}                       // set once connected
+    , cam_shm{}                             // opened once the camera thread starts (Transport::Local)
     , srv_data_sock_fd{-1}                  // init to invalid
     , srv_data_port{srv_data_port_num}      // port to attempt to connect to server to recv server data
+    , srv_rx_pool{Constants::Network::MAX_CTRL_MSG_SIZE}
+    , srv_reader{}                          // nothing received yet
+    , srv_wait_fd{-1}                       // set once connected
+    , server_udp_addr{}                     // filled in by initSock()
+    , srv_rx_seq{}                          // nothing received yet
+    , pkt_encoding{encoding}                // server answers in whatever encoding the control pkts use
 {
     // first check if should not init
     if (!should_init) return;
@@ -58,184 +103,263 @@ ReturnCodes TcpClient::sendResetPkt() {
     return updatePkt(reset_pkt);
 }
 
+void TcpClient::launchNetThreads(const bool print_data) {
+    // the reactor handles every socket, so it is the only thread needed
+    // (except for shared memory frames, which are waited on w/ a futex)
+    startNetThread([this, print_data]() { ControlLoopFn(print_data); });
+    if (getTransport() == Transport::Local) {
+        startNetThread([this]() { ShmCamLoopFn(); });
+    }
+}
+
 void TcpClient::ControlLoopFn(const bool print_data) {
     /********************************* Connect Setup  ********************************/
     // connect to server (if failed to connect, just stop)
-    if(connectToServer(ctrl_data_sock_fd, server_ip, ctrl_data_port, "control") != ReturnCodes::Success) {
-        // if issue, return immediately to prevent further errors
+    const bool use_udp {getTransport() == Transport::Udp};
+    if(!reactor.isValid()
+        || reactor.add(getDataEventFd(), EPOLLIN) != ReturnCodes::Success
+        || (use_udp && reactor.add(udp_chan.getFd(), EPOLLIN) != ReturnCodes::Success)
+    ) {
+        cerr << "ERROR: Failed to setup client reactor" << endl;
+        setExitCode(true);
+        return;
+    }
+    if (setupConns() != ReturnCodes::Success) {
+        setExitCode(true); // end program (make sure camera thread also ends)
+        cout << "Exiting Client Reactor" << endl;
         return;
     }
 
-    // loop to receive data and send data to server
+    // a lost datagram is only made up for by the next one, so udp resends the latest state much more often
+    const int timeout_sec = Constants::Network::RX_TX_TIMEOUT-1;
+    const std::chrono::milliseconds heartbeat {
+        use_udp         ? std::chrono::milliseconds(Constants::Network::UDP_HEARTBEAT_MS) :
+        timeout_sec > 0 ? std::chrono::milliseconds(std::chrono::seconds(timeout_sec))
+                        : std::chrono::milliseconds(500)
+    };
+
+    // sleep until something arrives, there is a new pkt to send (data eventfd), the server is about to timeout
+    // or it is time to try reconnecting (setExitCode() also wakes the reactor through the data eventfd)
+    auto next_heartbeat {std::chrono::steady_clock::now()};
     while(!getExitCode()) {
-        // wait until there is a new message (or first message)
-        // or until server is about to timeout
-        const int timeout_sec = Constants::Network::RX_TX_TIMEOUT-1;
-        std::unique_lock<std::mutex> data_lock(cmn_data_pkt_mutex);
-        has_new_cmn_data.wait_for(
-            data_lock,
-            timeout_sec > 0 ? std::chrono::seconds(timeout_sec) : std::chrono::milliseconds(500),
-            [&](){return cmn_pkt_ready.load();}
-        );
-
-        // bc of class scope of cv, need to manually unlock
-        // or else gets stuck when mutex needed in "getCurrentCmnPkt()"
-        data_lock.unlock();
-
-        // prevent predicate from being triggered in future iterations w/o being set by another thread
-        cmn_pkt_ready.store(false);
-
-        /********************************* Sending To Server ********************************/
-        // client starts by sending data to other endpoint
-        // on first transfer will be sending zeroed out struct
-        // the client should be continuously updating the packet so it is ready to send
-        const CommonPkt&    curr_pkt    {getCurrentCmnPkt()};
-        const json&         pkt_json    {convertPktToJson(curr_pkt)};
-        const std::string   bson_str    {writePkt(pkt_json)};
-        const char*         send_pkt    {bson_str.c_str()};
-        const std::size_t   pkt_size    {bson_str.size()};
-
-        // print the stringified json if told to
-        if (print_data) {
-            cout << "Sending (" << pkt_size << "Bytes): " << pkt_json.dump() << endl;
+        const auto next_send {std::min(next_heartbeat, next_clock_ping)};
+        const auto next_wakeup {is_connected ? next_send : std::min(next_send, isConnecting() ? connect_deadline : reconnect_at)};
+        const auto until_wakeup {std::chrono::duration_cast<std::chrono::milliseconds>(
+            next_wakeup - std::chrono::steady_clock::now()
+        )};
+        const int wait_ms {static_cast<int>(std::max<std::int64_t>(0, until_wakeup.count()))};
+
+        bool ctrl_failed {false};
+        for (const epoll_event& ready : reactor.wait(wait_ms)) {
+            const int fd {ready.data.fd};
+
+            // a reconnecting socket's handshake is done (or failed), it is only read from once every channel is
+            const auto pending {std::find_if(STREAM_CHANNELS.begin(), STREAM_CHANNELS.end(), [this, fd](const Channel channel) {
+                return conn_pending[static_cast<std::size_t>(channel)] && getStreamConn(channel).sock_fd == fd;
+            })};
+            if (pending != STREAM_CHANNELS.end()) {
+                finishConnect(*pending, false);
+            }
+            else if (fd == getDataEventFd()) {
+                // a new control pkt is picked up below (cmn_pkt_ready says so)
+                clearDataEvent();
+            }
+            else if (fd == cam_wait_fd) {
+                VideoStreamHandler();
+            }
+            else if (fd == srv_wait_fd || (use_udp && fd == udp_chan.getFd())) {
+                ServerDataHandler(print_data);
+            }
+            else if (fd == ctrl_data_sock_fd && getTransport() == Transport::Mux) {
+                // camera frames & server data arrive on the same connection (closing shows up as a failed read)
+                ctrl_failed = MuxRecvHandler(print_data) != ReturnCodes::Success || flushCtrl() != ReturnCodes::Success;
+            }
+            else if (fd == ctrl_data_sock_fd) {
+                ctrl_failed = (ready.events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR))
+                    || CtrlRecvHandler() != ReturnCodes::Success
+                    || flushCtrl() != ReturnCodes::Success;
+            }
         }
 
-        // send the stringified json to the server
-        const SendRtn send_rtn {sendData(ctrl_data_sock_fd, send_pkt, pkt_size)};
-        if(send_rtn.RtnCode != RecvSendRtnCodes::Success) {
-            cout << "Terminate - the server's control endpoint has closed the socket" << endl;
-            setExitCode(true); // end program
-            break;
+        /********************************* Reconnecting ********************************/
+        // the remaining ready events were already skipped/handled, so the fds can go away now
+        if (ctrl_failed) {
+            cout << "Error - the server's control endpoint has closed the socket" << endl;
+        }
+        if (ctrl_failed || conns_lost) {
+            dropConns();
         }
+        const bool was_connected {is_connected};
+        if (isConnecting() && std::chrono::steady_clock::now() >= connect_deadline) {
+            // give up on whatever has not connected by now (the server is not answering)
+            for (const Channel channel : STREAM_CHANNELS) {
+                if (conn_pending[static_cast<std::size_t>(channel)]) finishConnect(channel, true);
+            }
+        } else if (!is_connected && !isConnecting() && std::chrono::steady_clock::now() >= reconnect_at) {
+            reconnect();
+        }
+
+        // server gets the latest control state right away (& the clocks are synced again)
+        if (!was_connected && is_connected) next_heartbeat = next_clock_ping = std::chrono::steady_clock::now();
 
-        // inform updatePkt function that packet has been sent
-        has_new_cmn_data.notify_one();
+        /********************************* Sending To Server ********************************/
+        // send the latest pkt as soon as it changes (or once the heartbeat is due)
+        // prevent it from being sent again w/o being set by another thread
+        // (datagrams do not need a connection, while reconnecting the latest pkt is kept for when it is back)
+        const bool is_new_pkt {cmn_pkt_ready.exchange(false)};
+        const bool can_send {is_connected || use_udp};
+        if (can_send && (is_new_pkt || std::chrono::steady_clock::now() >= next_heartbeat)) {
+            next_heartbeat = std::chrono::steady_clock::now() + heartbeat;
+            if (sendCtrlPkt(print_data) != ReturnCodes::Success) {
+                cout << "Error - the server's control endpoint has closed the socket" << endl;
+                dropConns();
+            }
+        }
+        if (can_send && std::chrono::steady_clock::now() >= next_clock_ping && sendClockPing() != ReturnCodes::Success) {
+            cout << "Error - the server's control endpoint has closed the socket" << endl;
+            dropConns();
+        }
     }
-    cout << "Exiting Client Control Sender" << endl;
+
+    // the reactor owns the sockets, so it is the one to close them
+    cout << "Exiting Client Reactor" << endl;
+    ctrl_data_sock_fd = CloseOpenSock(ctrl_data_sock_fd);
+    cam_data_sock_fd = CloseOpenSock(cam_data_sock_fd);
+    srv_data_sock_fd = CloseOpenSock(srv_data_sock_fd);
 }
 
 void TcpClient::VideoStreamHandler() {
-    // connect to camera server (if failed to connect, just stop)
-    // add space at end of "camera" to make prints even
-    if(connectToServer(cam_data_sock_fd, server_ip, cam_data_port, "camera ") != ReturnCodes::Success) {
-        // if issue, return immediately to prevent further errors
-        return;
-    }
-
-    /********************************* Receiving From Server ********************************/
-    while(!getExitCode()) {
+    // keep reading until the socket is drained (only the newest frame really matters)
+    while (true) {
+        /********************************* Receiving From Server ********************************/
+        // frames are received straight into a reusable pooled buffer (can take several calls to arrive)
+        const RecvRtn img_recv {continueRecv(cam_data_sock_fd, cam_reader, cam_rx_pool, Channel::Camera)};
 
-        // recv image/frame in the form of a string container (to also store size)
-        const RecvRtn img_recv { recvData(cam_data_sock_fd) };
+        // rest of the frame has not arrived yet, the reactor calls back once it has
+        if (img_recv.RtnCode == RecvSendRtnCodes::WouldBlock) return;
 
         // check if the data_size is smaller than 0
         // (if so, print message bc might have been fluke)
         if (img_recv.RtnCode == RecvSendRtnCodes::Error) {
             cout << "Error: Failed to recv camera data" << endl;
-            continue; // dont try to save a bad frame
+            return; // dont try to save a bad frame
         }
 
-        // check if server killed conn
-        // break, but dont exit so server can wait for new client to connect
+        // check if server killed conn (reconnected once the reactor is done w/ the current events)
         else if (img_recv.RtnCode == RecvSendRtnCodes::ClosedConn) {
-            cout << "Terminate - the server's camera endpoint has closed the socket" << endl;
-            setExitCode(true); // end program (make sure control socket also ends)
-            break;
+            cout << "Error - the server's camera endpoint has closed the socket" << endl;
+            conns_lost = true;
+            return;
         }
 
-        // if no issues, save the new video frame
-        constexpr auto save_frame_err {"Failed to update camera data from server"};
-        try {
-            // convert string -> std::vector<unsigned char> by providing the start ptr and end
-            if(setLatestCamFrame(img_recv.buf) != ReturnCodes::Success) {
-                cerr << save_frame_err << endl;
-            }
-        } catch (std::exception& err) {
-            cerr << save_frame_err << endl;
-            cerr << err.what() << endl;
-        }
+        saveCamFrame(img_recv);
     }
-
-    // at end of while, reset data socket to attempt to make new connection with same listener
-    cout << "Exiting Client Camera Receiver" << endl;
-    cam_data_sock_fd = CloseOpenSock(cam_data_sock_fd);
 }
 
 void TcpClient::ServerDataHandler(const bool print_data) {
-    // connect to server's listener trying to send out server data (if failed to connect, just stop)
-    if(connectToServer(srv_data_sock_fd, server_ip, srv_data_port, "srv data") != ReturnCodes::Success) {
-        // if issue, return immediately to prevent further errors
+    // over udp, server data comes back to the socket control datagrams are sent from
+    if (getTransport() == Transport::Udp) {
+        recvSrvDatagrams(print_data);
         return;
     }
 
-    /********************************* Receiving From Server ********************************/
-    while(!getExitCode()) {
+    // keep reading until the socket is drained (several pkts may have arrived at once)
+    while (true) {
+        /********************************* Receiving From Server ********************************/
+        const RecvRtn srv_data_recv {continueRecv(srv_data_sock_fd, srv_reader, srv_rx_pool, Channel::SrvData)};
 
-        // recv image/frame in the form of a string container (to also store size)
-        const RecvRtn       srv_data_recv { recvData(srv_data_sock_fd) };
-        const std::string&  data          { std::string{srv_data_recv.buf.begin(), srv_data_recv.buf.end()} };
+        // rest of the pkt has not arrived yet, the reactor calls back once it has
+        if (srv_data_recv.RtnCode == RecvSendRtnCodes::WouldBlock) return;
 
         // check if the data_size is smaller than 0
         // (if so, print message bc might have been fluke)
         if (srv_data_recv.RtnCode == RecvSendRtnCodes::Error) {
             cout << "Error: Failed to recv server data" << endl;
-            continue; // dont try to save a bad frame
+            return; // dont try to save a bad pkt
         }
 
-        // check if server killed conn
-        // break, but dont exit so server can wait for new client to connect
+        // check if server killed conn (reconnected once the reactor is done w/ the current events)
         else if (srv_data_recv.RtnCode == RecvSendRtnCodes::ClosedConn) {
-            cout << "Terminate - the server data endpoint has closed the socket" << endl;
-            setExitCode(true); // end program (make sure control socket also ends)
-            break;
+            cout << "Error - the server data endpoint has closed the socket" << endl;
+            conns_lost = true;
+            return;
         }
 
-        // if no issues, save the packet
-        constexpr auto save_srv_data_err {"Failed to update server data pkt from server"};
-        try {
-                // note: data is transmitted as bson so have to interpret & parse pkt first
-            const json& recv_json = readSrvPkt(data.c_str(), data.size());
-
-            // parse & print the buf to the terminal(if told to)
-            if (print_data) {
-                cout << "Recv Server Data: " + recv_json.dump() << endl;
-            }
-
-            // actually try to parse recv packet into the struct
-            const SrvDataPkt pkt {readSrvPkt(recv_json)};
+        saveSrvData(srv_data_recv, print_data);
+    }
+}
 
-            // actually update the saved most recent packet in memory
-            if(updatePkt(pkt) != ReturnCodes::Success) {
-                cerr << "Failed to update from server data pkt" << endl;
-            }
+ReturnCodes TcpClient::MuxRecvHandler(const bool print_data) {
+    // the server only sends clock pongs on the control channel
+    const MuxPools pools {&ctrl_rx_pool, &cam_rx_pool, &srv_rx_pool};
+
+    // keep reading until the socket is drained (messages of every channel arrive interleaved)
+    while (true) {
+        /********************************* Receiving From Server ********************************/
+        const RecvRtn mux_recv {continueRecv(ctrl_data_sock_fd, mux_reader, pools)};
+
+        switch (mux_recv.RtnCode) {
+            case RecvSendRtnCodes::Success:
+                if (static_cast<Channel>(mux_recv.header.channel) == Channel::Control) {
+                    saveClockPong(mux_recv, ClockSync::now());
+                } else if (static_cast<Channel>(mux_recv.header.channel) == Channel::Camera) {
+                    saveCamFrame(mux_recv);
+                } else {
+                    saveSrvData(mux_recv, print_data);
+                }
+                break;
+            case RecvSendRtnCodes::WouldBlock:
+                return ReturnCodes::Success;
+            case RecvSendRtnCodes::Error:
+                // bad message was dropped, but the stream is still in sync
+                cout << "Error: Failed to recv data from server" << endl;
+                break;
+            case RecvSendRtnCodes::ClosedConn:
+            default:
+                return ReturnCodes::Error;
+        }
+    }
+}
 
-        } catch (std::exception& err) {
-            cerr << save_srv_data_err << endl;
-            cerr << err.what() << endl;
+ReturnCodes TcpClient::initSock() {
+    // over udp, control & server data share a single non-blocking datagram socket
+    // (bound to whatever port the os picks) that only talks to the server's control port
+    if (getTransport() == Transport::Udp) {
+        server_udp_addr.sin_family      = AF_INET;
+        server_udp_addr.sin_addr.s_addr = inet_addr(server_ip.c_str());
+        server_udp_addr.sin_port        = htons(ctrl_data_port);
+        if (udp_chan.open(0, true) != ReturnCodes::Success) {
+            cout << "ERROR: Opening Client Control UDP Socket" << endl;
+            return ReturnCodes::Error;
         }
+        tuneSock(udp_chan.getFd(), Channel::Control);
     }
 
-    // at end of while, reset data socket to attempt to make new connection with same listener
-    cout << "Exiting Client Server Data Receiver" << endl;
-    srv_data_sock_fd = CloseOpenSock(srv_data_sock_fd);
+    return openStreamSocks();
 }
 
-ReturnCodes TcpClient::initSock() {
+ReturnCodes TcpClient::openStreamSocks() {
     // open the listen socket of type SOCK_STREAM (TCP)
-    ctrl_data_sock_fd = socket(AF_INET, SOCK_STREAM, 0);
-    cam_data_sock_fd = socket(AF_INET, SOCK_STREAM, 0);
-    srv_data_sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+    // (unix sockets if the server is on the same machine, which shares camera frames through shared memory instead)
+    // (or a single connection every channel shares)
+    const bool is_local {getTransport() == Transport::Local};
+    const bool use_mux {getTransport() == Transport::Mux};
+    const bool use_stream {getTransport() != Transport::Udp};
+    const int family {is_local ? AF_UNIX : AF_INET};
+    ctrl_data_sock_fd = use_stream ? socket(family, SOCK_STREAM, 0) : -1;
+    cam_data_sock_fd = !is_local && !use_mux ? socket(AF_INET, SOCK_STREAM, 0) : -1;
+    srv_data_sock_fd = use_stream && !use_mux ? socket(family, SOCK_STREAM, 0) : -1;
 
     // check if the socket creation was successful
-    if (ctrl_data_sock_fd < 0){ 
+    if (use_stream && ctrl_data_sock_fd < 0){ 
         cout << "ERROR: Opening Client Control Socket" << endl;
         return ReturnCodes::Error;
     }
-    if (cam_data_sock_fd < 0){ 
+    if (!is_local && !use_mux && cam_data_sock_fd < 0){ 
         cout << "ERROR: Opening Client Camera Socket" << endl;
         return ReturnCodes::Error;
     }
-    if (srv_data_sock_fd < 0){ 
+    if (use_stream && !use_mux && srv_data_sock_fd < 0){ 
         cout << "ERROR: Opening Client 'Server Data' Socket" << endl;
         return ReturnCodes::Error;
     }
@@ -246,14 +370,21 @@ ReturnCodes TcpClient::initSock() {
     setsockopt(cam_data_sock_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
     setsockopt(srv_data_sock_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
 
-    // set receive timeout so that runNetAgent loop can be stopped/killed
-    // without timeout accept connection might be blocking until a connection forms
+    // set receive & send timeouts so connecting cannot hang forever (i.e. while reconnecting w/o a link)
+    // (sockets are switched to non-blocking for the reactor once connected)
     struct timeval timeout;
     timeout.tv_sec = Constants::Network::ACPT_TIMEOUT;
     timeout.tv_usec = 0;
-    setsockopt(ctrl_data_sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(cam_data_sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(srv_data_sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    for (const int sock_fd : {ctrl_data_sock_fd, cam_data_sock_fd, srv_data_sock_fd}) {
+        setsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+        setsockopt(sock_fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+    }
+
+    // before connecting, so the handshake is already marked w/ the channel's priority
+    // w/o the low water mark the mux connection would spin on EPOLLOUT while MuxWriter waits for the kernel
+    mux_writer.setNotSentGate(tuneSock(ctrl_data_sock_fd, Channel::Control));
+    tuneSock(cam_data_sock_fd, Channel::Camera);
+    tuneSock(srv_data_sock_fd, Channel::SrvData);
 
     return ReturnCodes::Success;
 }
@@ -268,6 +399,7 @@ void TcpClient::quit() {
     // if client socket is open, close it and set to -1
     cout << "Cleanup: closing control sockets" << endl;
     ctrl_data_sock_fd = CloseOpenSock(ctrl_data_sock_fd);
+    udp_chan.close();
     cout << "Cleanup: closing camera sockets" << endl;
     cam_data_sock_fd = CloseOpenSock(cam_data_sock_fd);
     cout << "Cleanup: closing server data sockets" << endl;
@@ -285,13 +417,26 @@ ReturnCodes TcpClient::connectToServer(
     server_addr.sin_addr.s_addr = inet_addr(ip.c_str());    // convert str ip to binary ip representation
     server_addr.sin_port        = htons(port);              // convert port to network number format
 
+    // a server on the same machine listens on unix sockets named after the ports
+    sockaddr_un local_addr      {};
+    const socklen_t local_addr_l {makeLocalAddr(port, local_addr)};
+    const int conn_rtn {getTransport() == Transport::Local ?
+        connect(sock_fd, (struct sockaddr*)&local_addr, local_addr_l) :
+        connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr))
+    };
+
+    const std::string conn_ip {getTransport() == Transport::Local ? "localhost" : ip};
+
+    // non-blocking socket -> the handshake finishes later (see finishConnect())
+    if (conn_rtn < 0 && errno == EINPROGRESS) return ReturnCodes::TryAgain;
+
     // note, due to threading cout stream overlapping, couts should print a single concated string 
-    if (connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        cerr << "ERROR: Failed to connect to server " + conn_desc + " @" + formatIpAddr(ip, port) + "\n";
+    if (conn_rtn < 0) {
+        cerr << "ERROR: Failed to connect to server " + conn_desc + " @" + formatIpAddr(conn_ip, port) + "\n";
         sock_fd = CloseOpenSock(sock_fd);
         return ReturnCodes::Error;
     } else {
-        cout << "Success: Connected to server " + conn_desc + " stream @" + formatIpAddr(ip, port) + "\n";
+        cout << "Success: Connected to server " + conn_desc + " stream @" + formatIpAddr(conn_ip, port) + "\n";
     }
 
     return ReturnCodes::Success;
@@ -300,6 +445,483 @@ ReturnCodes TcpClient::connectToServer(
 
 /********************************************* Helper Functions ********************************************/
 
+ReturnCodes TcpClient::setupConns() {
+    // udp has nothing to connect, datagrams just start going out to the server
+    // add space at end of "camera" to make prints even
+    // a server on the same machine shares its frames through shared memory instead (read by ShmCamLoopFn())
+    // mux: camera frames & server data come back over the control connection
+    const bool use_udp {getTransport() == Transport::Udp};
+    const bool use_shm {getTransport() == Transport::Local};
+    const bool use_mux {getTransport() == Transport::Mux};
+    if (use_udp) {
+        if (connected_at == std::chrono::steady_clock::time_point{}) {
+            cout << "Sending control datagrams to server @" + formatIpAddr(server_ip, ctrl_data_port) + " (udp)\n";
+        }
+    } else if(connectToServer(ctrl_data_sock_fd, server_ip, ctrl_data_port, use_mux ? "mux" : "control")
+        != ReturnCodes::Success
+    ) {
+        // if issue, return immediately to prevent further errors
+        return ReturnCodes::Error;
+    }
+
+    // the camera & server data streams are optional, the client keeps controlling the robot w/o them
+    if (!use_shm && !use_mux) {
+        connectToServer(cam_data_sock_fd, server_ip, cam_data_port, "camera ");
+    }
+    if (!use_udp && !use_mux) {
+        connectToServer(srv_data_sock_fd, server_ip, srv_data_port, "srv data");
+    }
+    return watchConns();
+}
+
+ReturnCodes TcpClient::watchConns() {
+    // w/o its session hello the server cannot replace a stale connection, but the stream itself still works
+    if (ctrl_data_sock_fd >= 0 && sendSessionHello(ctrl_data_sock_fd, Channel::Control) != ReturnCodes::Success) {
+        return ReturnCodes::Error;
+    }
+    if (cam_data_sock_fd >= 0) sendSessionHello(cam_data_sock_fd, Channel::Camera);
+    if (srv_data_sock_fd >= 0) sendSessionHello(srv_data_sock_fd, Channel::SrvData);
+
+    // the reactor never blocks on a single socket
+    for (const int sock_fd : {ctrl_data_sock_fd, cam_data_sock_fd, srv_data_sock_fd}) {
+        if (sock_fd >= 0) fcntl(sock_fd, F_SETFL, fcntl(sock_fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    // streams are waited on through their io engine (the socket itself unless it is io_uring)
+    cam_wait_fd = cam_data_sock_fd >= 0 ? getRecvWaitFd(cam_data_sock_fd) : -1;
+    srv_wait_fd = srv_data_sock_fd >= 0 ? getRecvWaitFd(srv_data_sock_fd) : -1;
+
+    // the control socket brings back clock pongs (& everything else if mux), also watch for it closing
+    // (& for room while a pkt is stuck)
+    if((ctrl_data_sock_fd >= 0 && reactor.add(ctrl_data_sock_fd, EPOLLIN | EPOLLRDHUP) != ReturnCodes::Success)
+        || (cam_wait_fd >= 0 && reactor.add(cam_wait_fd, EPOLLIN) != ReturnCodes::Success)
+        || (srv_wait_fd >= 0 && reactor.add(srv_wait_fd, EPOLLIN) != ReturnCodes::Success)
+    ) {
+        cerr << "ERROR: Failed to setup client reactor" << endl;
+        return ReturnCodes::Error;
+    }
+
+    is_connected = true;
+    connected_at = std::chrono::steady_clock::now();
+    return ReturnCodes::Success;
+}
+
+ReturnCodes TcpClient::sendSessionHello(const int sock_fd, const Channel channel) {
+    // nothing else was sent on the fresh connection yet, so the whole (tiny) message fits in one call
+    const OutMsg hello {makeSessionHello(session_token, channel)};
+    SendRtn sent {};
+    if (getTransport() == Transport::Mux) {
+        MuxWriter writer {};
+        writer.start(hello);
+        sent = continueSend(sock_fd, writer);
+    } else {
+        MsgWriter writer {};
+        writer.start(hello);
+        sent = continueSend(sock_fd, writer);
+    }
+
+    if (sent.RtnCode != RecvSendRtnCodes::Success) {
+        cerr << "ERROR: Failed to send the session hello to the server" << endl;
+        return ReturnCodes::Error;
+    }
+    return ReturnCodes::Success;
+}
+
+void TcpClient::dropConns() {
+    // stop watching before closing (fd numbers get reused by the next connections)
+    for (const int fd : {ctrl_data_sock_fd, cam_wait_fd, srv_wait_fd}) {
+        if (fd >= 0) reactor.remove(fd);
+    }
+    for (const Channel channel : STREAM_CHANNELS) {
+        if (conn_pending[static_cast<std::size_t>(channel)]) reactor.remove(getStreamConn(channel).sock_fd);
+    }
+    conn_pending        = {};
+    ctrl_data_sock_fd   = CloseOpenSock(ctrl_data_sock_fd);
+    cam_data_sock_fd    = CloseOpenSock(cam_data_sock_fd);
+    srv_data_sock_fd    = CloseOpenSock(srv_data_sock_fd);
+    cam_wait_fd         = -1;
+    srv_wait_fd         = -1;
+
+    // anything half sent/received is gone w/ the connection (the latest frame & pkts are kept)
+    ctrl_writer.reset();
+    ctrl_reader.reset();
+    ctrl_wait_writable  = false;
+    mux_reader.reset();
+    mux_writer.reset();
+    cam_reader.reset();
+    srv_reader.reset();
+    conns_lost          = false;
+
+    if (!is_connected) return;
+    is_connected = false;
+
+    // the server may have restarted (or moved), its clock is estimated from scratch once reconnected
+    clock_sync.reset();
+
+    // a connection that drops right after being made (i.e. turned away by a full server) keeps backing off
+    const auto now {std::chrono::steady_clock::now()};
+    const std::chrono::milliseconds min_backoff {Constants::Network::RECONNECT_MIN_MS};
+    const std::chrono::milliseconds max_backoff {Constants::Network::RECONNECT_MAX_MS};
+    reconnect_backoff   = now - connected_at >= max_backoff ? min_backoff : std::min(reconnect_backoff * 2, max_backoff);
+    reconnect_at        = now + reconnect_backoff;
+    cout << "Lost connection to the server, reconnecting in " << reconnect_backoff.count() << "ms" << endl;
+}
+
+void TcpClient::reconnect() {
+    // connects in the background, the reactor finishes each handshake (see finishConnect()) so it never waits on it
+    if (openStreamSocks() == ReturnCodes::Success && startConnect(Channel::Control) == ReturnCodes::Success) {
+        startConnect(Channel::Camera);
+        startConnect(Channel::SrvData);
+        connect_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(Constants::Network::ACPT_TIMEOUT);
+
+        // nothing to wait for (i.e. udp or every socket connected right away)
+        if (!isConnecting()) completeReconnect();
+        return;
+    }
+    retryReconnect();
+}
+
+void TcpClient::retryReconnect() {
+    // close whatever did connect & try again later
+    dropConns();
+    const std::chrono::milliseconds max_backoff {Constants::Network::RECONNECT_MAX_MS};
+    reconnect_backoff   = std::min(reconnect_backoff * 2, max_backoff);
+    reconnect_at        = std::chrono::steady_clock::now() + reconnect_backoff;
+}
+
+ReturnCodes TcpClient::startConnect(const Channel channel) {
+    // channel has no stream socket w/ this transport (i.e. camera frames through shared memory)
+    const StreamConn conn {getStreamConn(channel)};
+    if (conn.sock_fd < 0) return ReturnCodes::Success;
+
+    fcntl(conn.sock_fd, F_SETFL, fcntl(conn.sock_fd, F_GETFL) | O_NONBLOCK);
+    const ReturnCodes conn_rtn {connectToServer(conn.sock_fd, server_ip, conn.port, conn.desc)};
+    if (conn_rtn != ReturnCodes::TryAgain) return conn_rtn;
+
+    // writable once the handshake is done, error/hang up if it failed
+    if (reactor.add(conn.sock_fd, EPOLLOUT) != ReturnCodes::Success) {
+        cerr << "ERROR: Failed to setup client reactor" << endl;
+        conn.sock_fd = CloseOpenSock(conn.sock_fd);
+        return ReturnCodes::Error;
+    }
+    conn_pending[static_cast<std::size_t>(channel)] = true;
+    return ReturnCodes::Success;
+}
+
+void TcpClient::finishConnect(const Channel channel, const bool timed_out) {
+    const StreamConn conn {getStreamConn(channel)};
+    conn_pending[static_cast<std::size_t>(channel)] = false;
+    reactor.remove(conn.sock_fd);
+
+    int sock_err {0};
+    socklen_t err_len {sizeof(sock_err)};
+    const bool is_conn_done {
+        !timed_out && getsockopt(conn.sock_fd, SOL_SOCKET, SO_ERROR, &sock_err, &err_len) == 0 && sock_err == 0
+    };
+
+    const std::string conn_ip {getTransport() == Transport::Local ? "localhost" : server_ip};
+    if (is_conn_done) {
+        cout << "Success: Connected to server " + conn.desc + " stream @" + formatIpAddr(conn_ip, conn.port) + "\n";
+    } else {
+        cerr << "ERROR: Failed to connect to server " + conn.desc + " @" + formatIpAddr(conn_ip, conn.port)
+                + (timed_out ? " (timed out)\n" : "\n");
+        conn.sock_fd = CloseOpenSock(conn.sock_fd);
+
+        // no point waiting on the optional streams w/o the control connection
+        if (channel == Channel::Control) {
+            retryReconnect();
+            return;
+        }
+    }
+
+    // every channel is done -> start using the connections
+    if (!isConnecting()) completeReconnect();
+}
+
+void TcpClient::completeReconnect() {
+    // the control connection is required, the others are optional (same as the first time, see setupConns())
+    const bool has_ctrl {getTransport() == Transport::Udp || ctrl_data_sock_fd >= 0};
+    if (!has_ctrl || watchConns() != ReturnCodes::Success) {
+        retryReconnect();
+        return;
+    }
+    cout << "Success: Reconnected to server" << endl;
+}
+
+bool TcpClient::isConnecting() const {
+    return std::any_of(conn_pending.begin(), conn_pending.end(), [](const bool pending){ return pending; });
+}
+
+TcpClient::StreamConn TcpClient::getStreamConn(const Channel channel) {
+    switch (channel) {
+        case Channel::Camera:
+            return StreamConn{cam_data_sock_fd, cam_data_port, "camera "};
+        case Channel::SrvData:
+            return StreamConn{srv_data_sock_fd, srv_data_port, "srv data"};
+        case Channel::Control:
+        default:
+            return StreamConn{ctrl_data_sock_fd, ctrl_data_port, getTransport() == Transport::Mux ? "mux" : "control"};
+    }
+}
+
+void TcpClient::ShmCamLoopFn() {
+    const std::string shm_name {ShmFrameRing::makeName(cam_data_port)};
+
+    // same backoff as reconnecting the sockets (this thread keeps its own, the reactor owns reconnect_backoff)
+    const std::chrono::milliseconds min_backoff {Constants::Network::RECONNECT_MIN_MS};
+    const std::chrono::milliseconds max_backoff {Constants::Network::RECONNECT_MAX_MS};
+    std::chrono::milliseconds shm_backoff {min_backoff};
+
+    /********************************* Receiving From Server ********************************/
+    std::uint32_t shm_cursor {0}; // seq of the last frame read from shared memory
+    const int shm_timeout_ms {Constants::Network::RX_TX_TIMEOUT * 1000};
+    while(!getExitCode()) {
+        // the server creates the ring when it starts (& recreates it if restarted), keep trying until it exists
+        if (!cam_shm.isOpen()) {
+            if (cam_shm.open(shm_name) != ReturnCodes::Success) {
+                std::this_thread::sleep_for(shm_backoff);
+                shm_backoff = std::min(shm_backoff * 2, max_backoff);
+                continue;
+            }
+            shm_cursor = 0; // a new ring counts its frames from the start
+            cout << "Success: Reading server camera frames from shared memory " + shm_name + "\n";
+        }
+
+        const RecvRtn img_recv {cam_shm.waitNext(cam_rx_pool, shm_cursor, shm_timeout_ms)};
+
+        // server closed the ring (i.e. stopped/restarting) -> let go of it & reopen the new one later
+        if (img_recv.RtnCode == RecvSendRtnCodes::ClosedConn) {
+            cam_shm.close();
+            cout << "Server closed shared memory " + shm_name + ", reopening in " << shm_backoff.count() << "ms" << endl;
+            std::this_thread::sleep_for(shm_backoff);
+            shm_backoff = std::min(shm_backoff * 2, max_backoff);
+            continue;
+        }
+
+        // no new frame in time, check if should exit & keep waiting
+        if (img_recv.RtnCode != RecvSendRtnCodes::Success) continue;
+
+        shm_backoff = min_backoff;
+        saveCamFrame(img_recv);
+    }
+
+    cout << "Exiting Client Camera Receiver" << endl;
+    cam_shm.close();
+}
+
+ReturnCodes TcpClient::sendCtrlPkt(const bool print_data) {
+    // the previous pkt is still stuck in the socket, this one goes out once it is done
+    const bool use_mux {getTransport() == Transport::Mux};
+    if (use_mux ? mux_writer.isBusy(Channel::Control) : ctrl_writer.isBusy()) {
+        cmn_pkt_ready.store(true);
+        return ReturnCodes::Success;
+    }
+
+    // client starts by sending data to other endpoint
+    // on first transfer will be sending zeroed out struct
+    // the client should be continuously updating the packet so it is ready to send
+    const CommonPkt     curr_pkt    {getCurrentCmnPkt()};
+    const auto          pkt_str     {std::make_shared<const std::string>(writePkt(curr_pkt, pkt_encoding))};
+    const std::uint32_t pkt_size    {static_cast<std::uint32_t>(pkt_str->size())};
+
+    // print the stringified json if told to
+    if (print_data) {
+        cout << "Sending (" << pkt_size << "Bytes): " << convertPktToJson(curr_pkt).dump() << endl;
+    }
+
+    // send the serialized packet to the server (w/o waiting on anything lost before it if over udp)
+    // once synced, the pkt is stamped w/ when it was sent on the server's clock (so it can time the one-way trip)
+    HeaderPkt_t ctrl_header {makeHeader(pkt_str->data(), pkt_size, pkt_encoding, Channel::Control)};
+    if (clock_sync.isSynced()) ctrl_header.setOriginTime(clock_sync.toRemote(ClockSync::now()));
+    const OutMsg ctrl_msg {ctrl_header, pkt_str->data(), pkt_size, pkt_str};
+    captureMsg(CaptureDir::Sent, Channel::Control, ctrl_header, pkt_str->data(), pkt_size);
+    if (getTransport() == Transport::Udp) {
+        if(sendDatagram(server_udp_addr, ctrl_msg).RtnCode != RecvSendRtnCodes::Success) {
+            cout << "Error: Failed to send control datagram to server" << endl;
+        }
+        return ReturnCodes::Success;
+    }
+
+    if (use_mux) {
+        if (mux_writer.start(ctrl_msg) != ReturnCodes::Success) return ReturnCodes::Error;
+    } else {
+        ctrl_writer.start(ctrl_msg);
+    }
+    return flushCtrl();
+}
+
+ReturnCodes TcpClient::flushCtrl() {
+    // the control connection is also read from (clock pongs, camera frames & server data if mux)
+    const bool use_mux {getTransport() == Transport::Mux};
+    const std::uint32_t base_events {EPOLLIN | EPOLLRDHUP};
+    const SendRtn send_rtn {use_mux ? continueSend(ctrl_data_sock_fd, mux_writer) : continueSend(ctrl_data_sock_fd, ctrl_writer)};
+
+    // only wait for EPOLLOUT while the socket is full (otherwise it would wake the reactor constantly)
+    bool wait_writable {ctrl_wait_writable};
+    if (send_rtn.RtnCode == RecvSendRtnCodes::WouldBlock) {
+        wait_writable = true;
+    } else if (send_rtn.RtnCode == RecvSendRtnCodes::Success) {
+        wait_writable = false;
+    } else {
+        return ReturnCodes::Error;
+    }
+
+    if (wait_writable != ctrl_wait_writable) {
+        ctrl_wait_writable = wait_writable;
+        const std::uint32_t writable_event {wait_writable ? static_cast<std::uint32_t>(EPOLLOUT) : 0u};
+        return reactor.modify(ctrl_data_sock_fd, base_events | writable_event);
+    }
+    return ReturnCodes::Success;
+}
+
+ReturnCodes TcpClient::sendClockPing() {
+    // a ping stuck behind a pkt would come back w/ a useless rtt, so it just waits a bit
+    const bool use_mux {getTransport() == Transport::Mux};
+    const bool use_udp {getTransport() == Transport::Udp};
+    const auto now {std::chrono::steady_clock::now()};
+    if (!use_udp && (use_mux ? mux_writer.isBusy(Channel::Control) : ctrl_writer.isBusy())) {
+        next_clock_ping = now + std::chrono::milliseconds(Constants::Network::CLOCK_SYNC_BURST_MS);
+        return ReturnCodes::Success;
+    }
+
+    // quick pings until the estimate is good, then just often enough to keep up w/ the drift
+    const int ping_ms {clock_sync.isSynced() ? Constants::Network::CLOCK_SYNC_MS : Constants::Network::CLOCK_SYNC_BURST_MS};
+    next_clock_ping = now + std::chrono::milliseconds(ping_ms);
+
+    ClockPing ping {};
+    ping.client_send = ClockSync::now();
+    const OutMsg ping_msg {makeClockMsg(ping)};
+    if (use_udp) {
+        if(sendDatagram(server_udp_addr, ping_msg).RtnCode != RecvSendRtnCodes::Success) {
+            cout << "Error: Failed to send clock ping to server" << endl;
+        }
+        return ReturnCodes::Success;
+    }
+
+    if (use_mux) {
+        if (mux_writer.start(ping_msg) != ReturnCodes::Success) return ReturnCodes::Error;
+    } else {
+        ctrl_writer.start(ping_msg);
+    }
+    return flushCtrl();
+}
+
+ReturnCodes TcpClient::CtrlRecvHandler() {
+    // keep reading until the socket is drained (read w/ recv(), the pongs are tiny & rare)
+    while (true) {
+        const RecvRtn pong_recv {ctrl_reader.readSome(ctrl_data_sock_fd, ctrl_rx_pool)};
+        const std::uint64_t recv_us {ClockSync::now()};
+
+        switch (pong_recv.RtnCode) {
+            case RecvSendRtnCodes::Success:
+                if (verifyChecksum(pong_recv, Channel::Control)) saveClockPong(pong_recv, recv_us);
+                break;
+            case RecvSendRtnCodes::WouldBlock:
+                return ReturnCodes::Success;
+            case RecvSendRtnCodes::Error:
+                // bad message was dropped, but the stream is still in sync
+                cout << "Error: Failed to recv clock pong from server" << endl;
+                break;
+            case RecvSendRtnCodes::ClosedConn:
+            default:
+                return ReturnCodes::Error;
+        }
+    }
+}
+
+void TcpClient::saveClockPong(const RecvRtn& pong_recv, const std::uint64_t recv_us) {
+    const std::optional<ClockPing> pong {readClockMsg(pong_recv)};
+    if (!pong) return;
+
+    const bool was_synced {clock_sync.isSynced()};
+    clock_sync.addSample(*pong, recv_us);
+    if (!was_synced && clock_sync.isSynced()) {
+        cout << "Success: Synced clocks w/ server (offset " << clock_sync.getOffsetUs().value_or(0) << "us, +/- "
+             << clock_sync.getErrorUs() << "us)" << endl;
+    }
+}
+
+void TcpClient::recvSrvDatagrams(const bool print_data) {
+    // keep reading until the socket is drained (only the newest pkt really matters)
+    while (true) {
+        const DgramRtn dgram {recvDatagram(srv_rx_pool, Channel::SrvData)};
+        if (dgram.msg.RtnCode == RecvSendRtnCodes::WouldBlock) return;
+
+        // corrupt/malformed datagram was dropped (the next heartbeat should bring the state back)
+        if (dgram.msg.RtnCode != RecvSendRtnCodes::Success) continue;
+
+        // ignore anything not from the server & anything older than the newest pkt already used
+        // (pongs are numbered along w/ the server data, but a late one is still a good sample)
+        if (!isSameAddr(dgram.from, server_udp_addr)) continue;
+        if (dgram.msg.header.isClockPing()) {
+            saveClockPong(dgram.msg, ClockSync::now());
+            continue;
+        }
+        if (!srv_rx_seq.accept(dgram.stamp)) {
+            if (isVerbose()) {
+                cout << "Dropped stale server data datagram #" << dgram.stamp.seq
+                     << " (newest is #" << srv_rx_seq.getLastSeq() << ")" << endl;
+            }
+            continue;
+        }
+
+        saveSrvData(dgram.msg, print_data);
+    }
+}
+
+void TcpClient::saveCamFrame(const RecvRtn& img_recv) {
+    // if no issues, save the new video frame
+    constexpr auto save_frame_err {"Failed to update camera data from server"};
+    captureMsg(CaptureDir::Recv, Channel::Camera, img_recv.header, img_recv.buf->data(), static_cast<std::uint32_t>(img_recv.buf->size()));
+    try {
+        // time the hops the frame took so far
+        // the server's times are on its clock, until it is synced only the hops timed on the server are recorded
+        Camera::FrameStamp stamp {img_recv.header.getStamp()};
+        const bool is_synced {clock_sync.isSynced()};
+        if (stamp.isStamped() && is_synced) {
+            stamp.capture_us    = clock_sync.toLocal(stamp.capture_us);
+            stamp.encoded_us    = clock_sync.toLocal(stamp.encoded_us);
+            stamp.sent_us       = clock_sync.toLocal(stamp.sent_us);
+            stamp.recv_us       = Camera::FrameStamp::now();
+        }
+        frame_timings.recordReceived(stamp);
+
+        // hand off the pooled buffer itself (no copy), it is recycled once a newer frame replaces it
+        if(setLatestCamFrame(img_recv.buf, is_synced ? stamp : Camera::FrameStamp{}) != ReturnCodes::Success) {
+            cerr << save_frame_err << endl;
+        }
+    } catch (std::exception& err) {
+        cerr << save_frame_err << endl;
+        cerr << err.what() << endl;
+    }
+}
+
+void TcpClient::saveSrvData(const RecvRtn& srv_data_recv, const bool print_data) {
+    // if no issues, save the packet
+    constexpr auto save_srv_data_err {"Failed to update server data pkt from server"};
+    captureMsg(CaptureDir::Recv, Channel::SrvData, srv_data_recv.header, srv_data_recv.buf->data(), static_cast<std::uint32_t>(srv_data_recv.buf->size()));
+    try {
+        // decode the packet based on the encoding the server used (stored in the header)
+        const PktEncoding encoding  { static_cast<PktEncoding>(srv_data_recv.header.protocol) };
+        const char*       data      { reinterpret_cast<const char*>(srv_data_recv.buf->data()) };
+        const SrvDataPkt  pkt       { readSrvPkt(data, srv_data_recv.buf->size(), encoding) };
+
+        // print the buf to the terminal(if told to)
+        if (print_data) {
+            cout << "Recv Server Data: " + convertPktToJson(pkt).dump() << endl;
+        }
+
+        // actually update the saved most recent packet in memory
+        if(updatePkt(pkt) != ReturnCodes::Success) {
+            cerr << "Failed to update from server data pkt" << endl;
+        }
+
+    } catch (std::exception& err) {
+        cerr << save_srv_data_err << endl;
+        cerr << err.what() << endl;
+    }
+}
+
 
 } // end of Network namespace
 
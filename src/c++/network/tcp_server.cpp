@@ -1,5 +1,8 @@
 #include "tcp_server.h"
 
+#include <fcntl.h> // for non-blocking listen sockets
+#include <algorithm> // for std::find_if & std::stable_sort
+
 using std::cout;
 using std::cerr;
 using std::endl;
@@ -15,20 +18,35 @@ TcpServer::TcpServer(
     const int cam_send_port,
     const int srv_data_port_num,
     const bool should_init,
-    const bool verbosity
+    const bool verbosity,
+    const Transport transport
 )
-    : TcpBase{verbosity}
-    , close_conns{false}                    // set true if one socket gets closed, set back to false on restart
+    : TcpBase{verbosity, transport}
+    , peer_encoding{PktEncoding::Bson}      // until the client sends a control pkt, assume the self-describing format
+    , reactor{}                             // sockets are added once they are open
+    , sched_events{}
+    , public_ip{}                           // looked up when the server starts running
     , ctrl_listen_sock_fd{-1}               // init to invalid
-    , ctrl_data_sock_fd{-1}                 // init to invalid
+    , ctrl_conns{}                          // no clients yet
     , client_ip{}                           // empty string bc no client yet
     , ctrl_data_port{ctrl_data_port}        // wait to accept connections at this port for regular pkts
+    , ctrl_rx_pool{Constants::Network::MAX_CTRL_MSG_SIZE}
+    , udp_peers{}                           // no clients yet
+    , ctrl_latency{}                        // nothing received yet
     , cam_listen_sock_fd{-1}                // init to invalid
-    , cam_data_sock_fd{-1}                  // init to invalid
+    , cam_conns{}                           // no subscribers yet
+    , cam_ring{Constants::Network::BROADCAST_RING_SIZE}
     , cam_data_port{cam_send_port}          // port for the camera data connection
+    , cam_shm{}                             // created by initSock() if using Transport::Local
+    , video_rate{}                          // best quality until a subscriber falls behind
+    , rate_sampled{}
     , srv_data_listen_sock_fd{-1}           // init to invalid
-    , srv_data_sock_fd{-1}                  // init to invalid
+    , srv_conns{}                           // no subscribers yet
+    , srv_ring{Constants::Network::BROADCAST_RING_SIZE}
     , srv_data_port{srv_data_port_num}      // port to send server data to client
+    , latest_srv_msg{}                      // nothing to send yet
+    , srv_msg_sent{}
+    , srv_pkt_seq{0}
 {
     // first check if should not init
     if (!should_init) return;
@@ -51,6 +69,9 @@ TcpServer::~TcpServer() {
 
 /********************************************* Getters/Setters *********************************************/
 
+const LatencyHistogram& TcpServer::getCtrlLatency() const {
+    return ctrl_latency;
+}
 
 /********************************************* Server Functions ********************************************/
 
@@ -60,356 +81,859 @@ ReturnCodes TcpServer::acceptClient(
     const std::string& conn_desc,
     const int port
 ) {
-    // prepare the struct to store the client address
-    sockaddr_in client_addr;
+    // prepare the struct to store the client address (unix sockets if the client is on the same machine)
+    sockaddr_storage client_addr {};
     socklen_t client_addr_l = sizeof(client_addr);
 
-    // cannot cout normally "<<" due to threads' prints overlapping (save into single string to print at once)
-    cout << "Waiting to accept " + conn_desc + " data connection @" + formatIpAddr(GetPublicIp(), port) + "\n";
-
-    // wrap accept call in loop (due to timeout) to allow for program to be killed
-    // should stop looping when the connection has been made (i.e. data sock is positive)
-    while (!getExitCode() && data_sock_fd < 0) {
-        // call the accept API on the socket and forward connection to data socket
-        data_sock_fd = ::accept(listen_sock_fd, (struct sockaddr*) &client_addr, &client_addr_l);
-    }
-
-    // if should exit, do not continue
-    if (getExitCode()) {
-        return ReturnCodes::Error;
-    }
-
-    // if the data socket does not open successfully, close the listening socket
-    if(data_sock_fd < 0) {
-        cout << "ERROR: Failed to accept " << conn_desc << " connection" << endl;
-        listen_sock_fd = CloseOpenSock(listen_sock_fd);
+    // listen socket is non-blocking, so this only fails w/ EAGAIN if the client already gave up
+    const int new_sock_fd {::accept4(
+        listen_sock_fd, (struct sockaddr*) &client_addr, &client_addr_l, SOCK_NONBLOCK | SOCK_CLOEXEC
+    )};
+    if(new_sock_fd < 0) {
+        if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            cout << "ERROR: Failed to accept " << conn_desc << " connection" << endl;
+        }
         return ReturnCodes::Error;
     }
 
-    // set receive timeout so that runNetAgent loop can be stopped/killed
-    // without timeout recv/send might be blocking and loop might not end
-    struct timeval timeout;
-    timeout.tv_sec = Constants::Network::RX_TX_TIMEOUT;
-    timeout.tv_usec = 0;
-    setsockopt(data_sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(data_sock_fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+    data_sock_fd = new_sock_fd;
 
     // Print the client address (convert network address to char) 
     // -- print as single stream to prevent thread cout stream overlap
-    cout << "New " + conn_desc + " connection from " + formatIpAddr(inet_ntoa(client_addr.sin_addr), port) + "\n";
+    const std::string new_client_ip {client_addr.ss_family == AF_INET ?
+        inet_ntoa(reinterpret_cast<const sockaddr_in&>(client_addr).sin_addr) : "localhost"};
+    cout << "New " + conn_desc + " connection from " + formatIpAddr(new_client_ip, port) + "\n";
 
     // save the client IP in the m_ip string
-    client_ip = inet_ntoa(client_addr.sin_addr);
-
-    // tell sockets they can start
-    close_conns.store(false);
+    client_ip = new_client_ip;
     return ReturnCodes::Success;
 }
 
 ReturnCodes TcpServer::sendResetPkt() {
     // make sure client receives last cam frame before shutdown
-    // setting a new packet triggers video thread to send this new packet
-    return setLatestCamFrame(getLatestCamFrame());
+    // setting a new packet triggers the reactor to send this new packet
+    const CamFrameSnapshot last_frame {getLatestCamFrameSnapshot()};
+    return setLatestCamFrame(last_frame.frame, last_frame.stamp);
 }
 
-void TcpServer::ControlLoopFn(const bool print_data) {
-    // create a char buffer that hold the max allowed size
-    char buf[Constants::Network::MAX_DATA_SIZE];
-
-    // loop to keep trying to connect to new clients until told to stop
-    while(!getExitCode()) {
-
-        // wait for a client to connect
-        if(acceptClient(ctrl_listen_sock_fd, ctrl_data_sock_fd, "control", ctrl_data_port) == ReturnCodes::Success) {
+void TcpServer::launchNetThreads(const bool print_data) {
+    // the reactor handles every socket, so it is the only thread needed
+    startNetThread([this, print_data]() { ControlLoopFn(print_data); });
+}
 
-            // loop to receive data and send data with client
-            while(!getExitCode() && !close_conns.load()) {
+void TcpServer::ControlLoopFn(const bool print_data) {
+    // watch for new clients & new data to send (client connections are added once accepted)
+    // over udp, control & server data share the one datagram socket (there is nothing to accept)
+    // local clients read camera frames straight from shared memory (nothing to accept either)
+    // mux clients get every channel over their control connection (nothing else to accept)
+    const bool use_udp {getTransport() == Transport::Udp};
+    const bool use_shm {getTransport() == Transport::Local};
+    const bool use_mux {getTransport() == Transport::Mux};
+    if(!reactor.isValid()
+        || reactor.add(getDataEventFd(), EPOLLIN) != ReturnCodes::Success
+        || (!use_shm && !use_mux && reactor.add(cam_listen_sock_fd, EPOLLIN) != ReturnCodes::Success)
+        || (use_udp && reactor.add(udp_chan.getFd(), EPOLLIN) != ReturnCodes::Success)
+        || (!use_udp && reactor.add(ctrl_listen_sock_fd, EPOLLIN) != ReturnCodes::Success)
+        || (!use_udp && !use_mux && reactor.add(srv_data_listen_sock_fd, EPOLLIN) != ReturnCodes::Success)
+    ) {
+        cerr << "ERROR: Failed to setup server reactor" << endl;
+        return;
+    }
 
-                /********************************* Receiving From Server ********************************/
-                // call recvData and save result in str container to get size
-                const RecvRtn      ctrl_recv    { recvData(ctrl_data_sock_fd) };
-                const std::string& data         { std::string{ctrl_recv.buf.begin(), ctrl_recv.buf.end()} };
+    public_ip = use_shm ? "localhost" : GetPublicIp();
+    if (use_udp) {
+        cout << "Waiting for control datagrams @" + formatIpAddr(public_ip, ctrl_data_port) + " (udp)\n";
+    } else if (use_mux) {
+        cout << "Waiting to accept multiplexed connections @" + formatIpAddr(public_ip, ctrl_data_port) + "\n";
+    } else {
+        cout << "Waiting to accept control data connections @" + formatIpAddr(public_ip, ctrl_data_port) + "\n";
+    }
+    if (use_shm) {
+        cout << "Publishing camera frames to shared memory " + ShmFrameRing::makeName(cam_data_port) + "\n";
+    } else if (!use_mux) {
+        cout << "Waiting to accept camera data connections @" + formatIpAddr(public_ip, cam_data_port) + "\n";
+    }
+    if (!use_udp && !use_mux) {
+        cout << "Waiting to accept srv data data connections @" + formatIpAddr(public_ip, srv_data_port) + "\n";
+    }
 
-                // check if the data_size is smaller than 0
-                // (if so, print message bc might have been fluke)
-                if (ctrl_recv.RtnCode == RecvSendRtnCodes::Error) {
-                    cout << "Error - client control socket recv error" << endl;
-                    close_conns.store(true); // signal to camera socket to stop
-                    continue; // dont try to process badly recv pkt
-                }
+    // sleep until something is ready (setExitCode() wakes the reactor through the data eventfd)
+    // clients send control pkts as a heartbeat, so only wake up on a timer to check they are still alive
+    // (& to resend the latest server data to udp peers, which have no other way of recovering a lost datagram)
+    const auto ctrl_timeout {std::chrono::seconds(Constants::Network::RX_TX_TIMEOUT)};
+    while(!getExitCode()) {
+        const int wait_ms {
+            !udp_peers.empty()  ? Constants::Network::UDP_HEARTBEAT_MS :
+            !ctrl_conns.empty() ? static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(ctrl_timeout).count())
+                                : -1
+        };
+        for (const epoll_event& ready : scheduleEvents(reactor.wait(wait_ms))) {
+            const int fd {ready.data.fd};
+
+            if (fd == getDataEventFd()) {
+                // new data is picked up below (*_pkt_ready flags say what changed)
+                clearDataEvent();
+            }
+            else if (use_udp && fd == udp_chan.getFd()) {
+                handleCtrlDatagrams(print_data);
+            }
+            else if (fd == ctrl_listen_sock_fd || fd == cam_listen_sock_fd || fd == srv_data_listen_sock_fd) {
+                handleAccept(fd);
+            }
+            // remaining events might refer to closed (and possibly reused) fds -- epoll reports them again
+            else if (handleConnEvent(fd, ready.events, print_data)) {
+                break;
+            }
+        }
 
-                // check if the data_size is equal to 0 (time to exit bc client killed conn)
-                // break, but dont exit so server can wait for new client to connect
-                else if (ctrl_recv.RtnCode == RecvSendRtnCodes::ClosedConn) {
-                    cout << "Terminate - the client's control endpoint has closed the socket" << endl;
-                    close_conns.store(true); // signal to camera socket to stop
-                    break;
-                } 
-
-                // convert stringified json to json so it can be parsed into struct
-                try {
-                    // note: data is transmitted as bson so have to interpret & parse pkt first
-                    const json& recv_json = readCmnPkt(data.c_str(), data.size());
-
-                    // parse & print the buf to the terminal(if told to)
-                    if (print_data) {
-                        cout << "Recv Control Data: " + recv_json.dump() << endl;
-                    }
-
-                    // actually try to parse recv packet into the struct
-                    const CommonPkt pkt {readCmnPkt(recv_json)};
-
-                    // actually update the saved most recent packet in memory
-                    if(updatePkt(pkt) != ReturnCodes::Success) {
-                        cerr << "Error: Failed to update from control pkt" << endl;
-                    }
-
-                    // call receive callback if set
-                    if (recv_cb) {
-                        if (recv_cb(pkt) != ReturnCodes::Success) {
-                            cerr << "ERROR: Failed to process received packet from client" << endl;
-                        }
-                    }
-                } catch (std::exception& err) {
-                    cerr << "Error: Failed to update from control pkt: " << err.what() << endl;
+        // clients that went quiet (i.e. lost power) w/o closing their connections
+        const auto now {std::chrono::steady_clock::now()};
+        for (auto conn = ctrl_conns.begin(); conn != ctrl_conns.end();) {
+            const auto curr_conn {conn++};
+            if (now - curr_conn->last_rx > ctrl_timeout) {
+                cout << "Error - client control socket timed out" << endl;
+                closeConn(ctrl_conns, curr_conn, "control");
+            }
+        }
+        for (auto peer = udp_peers.begin(); peer != udp_peers.end();) {
+            const auto curr_peer {peer++};
+            if (now - curr_peer->last_rx > ctrl_timeout) {
+                const bool was_driver {curr_peer == udp_peers.begin()};
+                cout << "Error - client stopped sending control datagrams @"
+                        + formatIpAddr(inet_ntoa(curr_peer->addr.sin_addr), ntohs(curr_peer->addr.sin_port)) + "\n";
+                udp_peers.erase(curr_peer);
+                if(was_driver && !udp_peers.empty()) {
+                    cout << "Driver left, next oldest control peer is now driving" << endl;
                 }
-
-                // reset the buffer for a new read
-                memset(buf, 0, sizeof(buf));
             }
-
-            // at end of while, reset data socket to attempt to make new connection with same listener
-            ctrl_data_sock_fd = CloseOpenSock(ctrl_data_sock_fd);
-            if(isVerbose()) cout << "Closing Control Data Socket" << endl;
         }
+
+        // publish whatever is new & send it to every subscriber that is ready for it
+        // (server data first, so it is queued ahead of any camera frame going to the same client)
+        ServerDataHandler(print_data);
+        VideoStreamHandler();
+        updateVideoRate();
     }
 }
 
 void TcpServer::VideoStreamHandler() {
-    // server has to send the most up to date video frame to the client
-    // keep sending until told to stop
-
-    // loop to keep trying to connect to new clients until told to stop
-    while(!getExitCode()) {
-
-        // wait for a client to connect
-        if(acceptClient(cam_listen_sock_fd, cam_data_sock_fd, "camera", cam_data_port) == ReturnCodes::Success) {
-
-            // loop to receive data and send data with client
-            while(!getExitCode() && !close_conns.load()) {
-            
-                // wait until there is a new message (or first message)
-                // or until server is about to timeout
-                const int timeout_sec = Constants::Network::RX_TX_TIMEOUT-1;
-                std::unique_lock<std::mutex> data_lock(cam_data_pkt_mutex);
-                has_new_cam_data.wait_for(
-                    data_lock,
-                    timeout_sec > 0 ? std::chrono::seconds(timeout_sec) : std::chrono::milliseconds(500),
-                    [&](){return cam_pkt_ready.load();}
-                );
-
-                // bc of class scope of cv, need to manually unlock
-                // or else gets stuck when mutex needed in "getLatestCamFrame()"
-                data_lock.unlock();
-
-                // prevent predicate from being triggered in future iterations w/o being set by another thread
-                cam_pkt_ready.store(false);
-
-                /********************************* Sending Camera Data to Client ********************************/
-                const std::vector<unsigned char>& cam_frame {getLatestCamFrame()};
-                const SendRtn send_rtn {sendData(cam_data_sock_fd, cam_frame.data(), cam_frame.size())};
-
-                if(send_rtn.RtnCode != RecvSendRtnCodes::Success) {
-                    cout << "Error: Send camera data to client (suggests closed endpoint)" << endl;
-                    close_conns.store(true); // tell control socket to stop
-                    break; // try to wait for new connection (dont end program bc client may reconnect)
-                }
+    // frame's stamp goes along in the header, so the client can tell how long each hop took
+    const auto stampHeader {[](HeaderPkt_t& header, const Camera::FrameStamp& frame_stamp) {
+        if (!frame_stamp.isStamped()) return;
+        Camera::FrameStamp stamp {frame_stamp};
+        stamp.sent_us = Camera::FrameStamp::now();
+        header.setStamp(stamp);
+    }};
+
+    // local clients copy the newest frame out of shared memory themselves (no framing/checksum needed,
+    // the slot just carries the header w/ the stamp)
+    if (getTransport() == Transport::Local) {
+        if(cam_pkt_ready.exchange(false)) {
+            const CamFrameSnapshot snapshot {getLatestCamFrameSnapshot()};
+            const CamFrame& cam_frame {snapshot.frame};
+            const std::uint32_t frame_size {static_cast<std::uint32_t>(cam_frame->size())};
+            HeaderPkt_t header {};
+            if (isCapturing()) {
+                header = makeHeader(cam_frame->data(), frame_size, PktEncoding::Raw, Channel::Camera);
+            } else {
+                header.total_length = frame_size;
+                header.protocol     = static_cast<std::uint8_t>(PktEncoding::Raw);
+                header.flags_fo     = HeaderPkt_t::FLAG_NO_CHECKSUM;
+            }
+            stampHeader(header, snapshot.stamp);
 
+            if(cam_shm.publish(header, cam_frame->data(), frame_size) == 0) {
+                cerr << "Error: Camera frame too large for shared memory (" << frame_size << " bytes)" << endl;
+            } else if (isCapturing()) {
+                captureMsg(CaptureDir::Sent, Channel::Camera, header, cam_frame->data(), frame_size);
             }
+        }
+        return;
+    }
 
-            // at end of while, reset data socket to attempt to make new connection with same listener
-            cam_data_sock_fd = CloseOpenSock(cam_data_sock_fd);
-            if(isVerbose()) cout << "Closing Camera Data Socket" << endl;
+    // server has to send the most up to date video frame to every subscriber
+    if(cam_pkt_ready.exchange(false)) {
+        // hold a handle to the frame so it cannot be replaced/freed while any subscriber is sending it
+        // (checksum is computed once, no matter how many subscribers there are)
+        const CamFrameSnapshot snapshot {getLatestCamFrameSnapshot()};
+        const CamFrame& cam_frame {snapshot.frame};
+        const std::uint32_t frame_size {static_cast<std::uint32_t>(cam_frame->size())};
+        HeaderPkt_t header {makeHeader(cam_frame->data(), frame_size, PktEncoding::Raw, Channel::Camera)};
+        stampHeader(header, snapshot.stamp);
+        captureMsg(CaptureDir::Sent, Channel::Camera, header, cam_frame->data(), frame_size);
+        cam_ring.push(OutMsg{header, cam_frame->data(), frame_size, cam_frame});
+    }
+
+    /********************************* Sending Camera Data to Clients ********************************/
+    for (auto conn = cam_conns.begin(); conn != cam_conns.end();) {
+        const auto curr_conn {conn++};
+        if(pumpSubscriber(*curr_conn, cam_ring) != ReturnCodes::Success) {
+            cout << "Error: Send camera data to client (suggests closed endpoint)" << endl;
+            closeConn(cam_conns, curr_conn, "camera");
         }
     }
+    pumpMuxConns();
 }
 
 void TcpServer::ServerDataHandler(const bool print_data) {
-    // server has to send the most up to date pkt's regarding its collected data
-    // keep sending until told to stop
-
-    // loop to keep trying to connect to new clients until told to stop
-    while(!getExitCode()) {
-
-        // wait for a client to connect
-        if(acceptClient(srv_data_listen_sock_fd, srv_data_sock_fd, "srv data", srv_data_port) == ReturnCodes::Success) {
-
-            // loop to receive data and send data with client
-            while(!getExitCode() && !close_conns.load()) {
-            
-                // wait until there is a new message (or first message)
-                // or until server is about to timeout
-                const int timeout_sec = Constants::Network::RX_TX_TIMEOUT-1;
-                std::unique_lock<std::mutex> data_lock(srv_data_pkt_mutex);
-                has_new_srv_data.wait_for(
-                    data_lock,
-                    timeout_sec > 0 ? std::chrono::seconds(timeout_sec) : std::chrono::milliseconds(500),
-                    [&](){return srv_pkt_ready.load();}
-                );
-
-                // prevent predicate from being triggered in future iterations w/o being set by another thread
-                srv_pkt_ready.store(false);
-
-                // bc of class scope of cv, need to manually unlock
-                // or else gets stuck when mutex needed in "getCurrentSrvPkt()"
-                data_lock.unlock();
-
-                /********************************* Sending Server Data to Client ********************************/
-                const SrvDataPkt&   curr_pkt    {getCurrentSrvPkt()};
-                const json&         pkt_json    {convertPktToJson(curr_pkt)};
-                const std::string   bson_str    {writePkt(pkt_json)};
-                const char*         send_pkt    {bson_str.c_str()};
-                const std::size_t   pkt_size    {bson_str.size()};
-
-                // print the stringified json if told to
-                if (print_data) {
-                    cout << "Sending (" << pkt_size << "Bytes): " << pkt_json.dump() << endl;
-                }
-                
-                const SendRtn send_rtn {sendData(srv_data_sock_fd, send_pkt, pkt_size)};
+    // server has to send the most up to date pkt's regarding its collected data to every subscriber
+    if(srv_pkt_ready.exchange(false)) {
+        // encode once for all subscribers (clients decode w/ whatever encoding the header says)
+        const SrvDataPkt&   curr_pkt    {getCurrentSrvPkt()};
+        const PktEncoding   encoding    {peer_encoding.load()};
+        const auto          pkt_str     {std::make_shared<const std::string>(writePkt(curr_pkt, encoding))};
+        const std::uint32_t pkt_size    {static_cast<std::uint32_t>(pkt_str->size())};
+
+        // print the stringified json if told to
+        if (print_data) {
+            cout << "Sending (" << pkt_size << "Bytes): " << convertPktToJson(curr_pkt).dump() << endl;
+        }
 
-                if(send_rtn.RtnCode != RecvSendRtnCodes::Success) {
-                    cout << "Error: Send server data to client (suggests closed endpoint)" << endl;
-                    close_conns.store(true); // tell control socket to stop
-                    break; // try to wait for new connection (dont end program bc client may reconnect)
-                }
+        // numbered & stamped w/ when it was queued (on the server's clock) like the camera frames
+        HeaderPkt_t srv_header {makeHeader(pkt_str->data(), pkt_size, encoding, Channel::SrvData)};
+        srv_header.id = ++srv_pkt_seq;
+        srv_header.setOriginTime(ClockSync::now());
+
+        const OutMsg srv_msg {srv_header, pkt_str->data(), pkt_size, pkt_str};
+        captureMsg(CaptureDir::Sent, Channel::SrvData, srv_msg.header, pkt_str->data(), pkt_size);
+        if (getTransport() == Transport::Udp) {
+            latest_srv_msg = srv_msg;
+            sendSrvDatagrams(true);
+        } else {
+            srv_ring.push(srv_msg);
+        }
+    }
 
-            }
+    // nothing new -> udp peers still get the latest pkt resent every so often (in case it was lost)
+    sendSrvDatagrams(false);
 
-            // at end of while, reset data socket to attempt to make new connection with same listener
-            srv_data_sock_fd = CloseOpenSock(srv_data_sock_fd);
-            if(isVerbose()) cout << "Closing Server Data Socket" << endl;
+    /********************************* Sending Server Data to Clients ********************************/
+    for (auto conn = srv_conns.begin(); conn != srv_conns.end();) {
+        const auto curr_conn {conn++};
+        if(pumpSubscriber(*curr_conn, srv_ring) != ReturnCodes::Success) {
+            cout << "Error: Send server data to client (suggests closed endpoint)" << endl;
+            closeConn(srv_conns, curr_conn, "srv data");
         }
     }
+    pumpMuxConns();
 }
 
 ReturnCodes TcpServer::initSock() {
-    // open the listen socket of type SOCK_STREAM (TCP)
-    ctrl_listen_sock_fd = socket(AF_INET, SOCK_STREAM, 0);
-    cam_listen_sock_fd = socket(AF_INET, SOCK_STREAM, 0);
-    srv_data_listen_sock_fd = socket(AF_INET, SOCK_STREAM, 0);
-
-    // check if the socket creation was successful
-    if (ctrl_listen_sock_fd < 0){ 
-        cout << "ERROR: Opening control listen socket" << endl;
-        return ReturnCodes::Error;
+    // camera frames go over tcp, unless the client is on the same machine (then they go through shared memory)
+    // or every channel shares the control connection
+    if (getTransport() == Transport::Mux) {
+        ctrl_listen_sock_fd = openListenSock(ctrl_data_port, "mux");
+        return ctrl_listen_sock_fd < 0 ? ReturnCodes::Error : ReturnCodes::Success;
+    } else if (getTransport() == Transport::Local) {
+        if (cam_shm.create(ShmFrameRing::makeName(cam_data_port)) != ReturnCodes::Success) {
+            cout << "ERROR: Creating camera shared memory" << endl;
+            return ReturnCodes::Error;
+        }
+    } else {
+        cam_listen_sock_fd = openListenSock(cam_data_port, "camera");
+        if (cam_listen_sock_fd < 0) return ReturnCodes::Error;
     }
-    if (cam_listen_sock_fd < 0){ 
-        cout << "ERROR: Opening camera listen socket" << endl;
-        return ReturnCodes::Error;
+
+    // over udp, control & server data share a single non-blocking datagram socket on the control port
+    if (getTransport() == Transport::Udp) {
+        if (udp_chan.open(ctrl_data_port, true) != ReturnCodes::Success) {
+            cout << "ERROR: Opening control udp socket" << endl;
+            return ReturnCodes::Error;
+        }
+        tuneSock(udp_chan.getFd(), Channel::Control);
+        return ReturnCodes::Success;
     }
-    if (srv_data_listen_sock_fd < 0){ 
-        cout << "ERROR: Opening 'server data' listen socket" << endl;
-        return ReturnCodes::Error;
+
+    ctrl_listen_sock_fd = openListenSock(ctrl_data_port, "control");
+    if (ctrl_listen_sock_fd < 0) return ReturnCodes::Error;
+
+    srv_data_listen_sock_fd = openListenSock(srv_data_port, "'server data'");
+    if (srv_data_listen_sock_fd < 0) return ReturnCodes::Error;
+
+    return ReturnCodes::Success;
+}
+
+void TcpServer::quit() {
+    // set exit status to be true
+    setExitCode(true);
+
+    // dont bother continuing if not initialized
+    if (!getIsInit()) return;
+
+    // if sockets are still open, close them and set to -1
+    // how long the control pkts took to arrive (if any clients were synced)
+    if (ctrl_latency.getCount() > 0) {
+        cout << "Control pkt latency: mean " << ctrl_latency.getMeanUs() / 1000.0
+             << "ms, p99 " << ctrl_latency.getPercentileUs(0.99) / 1000.0
+             << "ms, max " << ctrl_latency.getMaxUs() / 1000.0 << "ms (" << ctrl_latency.getCount() << " pkts)" << endl;
+    }
+
+    cout << "Cleanup: closing control sockets" << endl;
+    ctrl_listen_sock_fd = CloseOpenSock(ctrl_listen_sock_fd);
+    for (NetConn& conn : ctrl_conns) conn.sock_fd = CloseOpenSock(conn.sock_fd);
+    ctrl_conns.clear();
+    udp_chan.close();
+    udp_peers.clear();
+
+    cout << "Cleanup: closing camera sockets" << endl;
+    cam_listen_sock_fd  = CloseOpenSock(cam_listen_sock_fd);
+    cam_shm.close();
+    for (NetConn& conn : cam_conns) conn.sock_fd = CloseOpenSock(conn.sock_fd);
+    cam_conns.clear();
+
+    cout << "Cleanup: closing server data sockets" << endl;
+    srv_data_listen_sock_fd = CloseOpenSock(srv_data_listen_sock_fd);
+    for (NetConn& conn : srv_conns) conn.sock_fd = CloseOpenSock(conn.sock_fd);
+    srv_conns.clear();
+}
+
+
+/********************************************* Helper Functions ********************************************/
+
+int TcpServer::openListenSock(const int port, const std::string& conn_desc) {
+    // open the listen socket of type SOCK_STREAM (TCP, or a unix socket for clients on the same machine)
+    const bool is_local {getTransport() == Transport::Local};
+    int listen_sock_fd {socket(is_local ? AF_UNIX : AF_INET, SOCK_STREAM, 0)};
+    if (listen_sock_fd < 0){ 
+        cout << "ERROR: Opening " << conn_desc << " listen socket" << endl;
+        return -1;
     }
 
     // set the options for the socket
     int option(1);
-    setsockopt(ctrl_listen_sock_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
-    setsockopt(cam_listen_sock_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
-    setsockopt(srv_data_listen_sock_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
-
-    // set receive timeout so that runNetAgent loop can be stopped/killed
-    // without timeout accept connection might be blocking until a connection forms
-    struct timeval timeout;
-    timeout.tv_sec = Constants::Network::ACPT_TIMEOUT;
-    timeout.tv_usec = 0;
-    setsockopt(ctrl_listen_sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(ctrl_listen_sock_fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(cam_listen_sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(cam_listen_sock_fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(srv_data_listen_sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    setsockopt(srv_data_listen_sock_fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt(listen_sock_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
+
+    // the reactor only accepts once a connection is pending, so accept must never block
+    // (a client that gives up in between would otherwise stall every other socket)
+    fcntl(listen_sock_fd, F_SETFL, fcntl(listen_sock_fd, F_GETFL) | O_NONBLOCK);
 
     // init struct for address to bind socket
-    sockaddr_in ctrl_addr  {};   // holds data on the control conn address
-    sockaddr_in cam_addr   {};   // holds data on the camera conn address
-    sockaddr_in srv_addr   {};   // holds data on the server data conn address
-    
-    // address family is AF_INET (IPV4)
-    ctrl_addr.sin_family        = AF_INET;
-    cam_addr.sin_family         = AF_INET;
-    srv_addr.sin_family         = AF_INET;
-    // convert ctrl_data_port to network number format
-    ctrl_addr.sin_port          = htons(ctrl_data_port);
-    cam_addr.sin_port           = htons(cam_data_port);
-    srv_addr.sin_port           = htons(srv_data_port);
-    // accept conn from all Network Interface Cards (NIC)
-    ctrl_addr.sin_addr.s_addr   = htonl(INADDR_ANY);
-    cam_addr.sin_addr.s_addr    = htonl(INADDR_ANY);
-    srv_addr.sin_addr.s_addr    = htonl(INADDR_ANY);
+    sockaddr_in addr        {};
+    addr.sin_family         = AF_INET;              // address family is AF_INET (IPV4)
+    addr.sin_port           = htons(port);          // convert port to network number format
+    addr.sin_addr.s_addr    = htonl(INADDR_ANY);    // accept conn from all Network Interface Cards (NIC)
+    sockaddr_un local_addr  {};
+    const socklen_t local_addr_l {makeLocalAddr(port, local_addr)};
 
     // bind the socket to the port
-    if (bind(ctrl_listen_sock_fd, (struct sockaddr*)&ctrl_addr, sizeof(ctrl_addr)) < 0) { 
-        cout << "ERROR: Failed to bind control socket" << endl;
-        ctrl_listen_sock_fd = CloseOpenSock(ctrl_listen_sock_fd);
-        return ReturnCodes::Error;
+    const int bind_rtn {is_local ?
+        bind(listen_sock_fd, (struct sockaddr*)&local_addr, local_addr_l) :
+        bind(listen_sock_fd, (struct sockaddr*)&addr, sizeof(addr))
+    };
+    if (bind_rtn < 0) { 
+        cout << "ERROR: Failed to bind " << conn_desc << " socket" << endl;
+        return CloseOpenSock(listen_sock_fd);
     }
-    if (bind(cam_listen_sock_fd, (struct sockaddr*)&cam_addr, sizeof(cam_addr)) < 0) { 
-        cout << "ERROR: Failed to bind camera socket" << endl;
-        cam_listen_sock_fd = CloseOpenSock(cam_listen_sock_fd);
-        return ReturnCodes::Error;
+
+    // several clients can connect at once (i.e. multiple operator stations), set the socket in a listening state
+    if (listen(listen_sock_fd, Constants::Network::MAX_SUBSCRIBERS) < 0) { 
+        cout << "ERROR: Failed to listen to " << conn_desc << " socket" << endl;
+        return CloseOpenSock(listen_sock_fd);
     }
-    if (bind(srv_data_listen_sock_fd, (struct sockaddr*)&srv_addr, sizeof(srv_addr)) < 0) { 
-        cout << "ERROR: Failed to bind server data socket" << endl;
-        srv_data_listen_sock_fd = CloseOpenSock(srv_data_listen_sock_fd);
-        return ReturnCodes::Error;
+
+    return listen_sock_fd;
+}
+
+void TcpServer::handleAccept(const int listen_sock_fd) {
+    const bool is_ctrl {listen_sock_fd == ctrl_listen_sock_fd};
+    const bool is_cam {listen_sock_fd == cam_listen_sock_fd};
+    std::list<NetConn>& conns {is_ctrl ? ctrl_conns : (is_cam ? cam_conns : srv_conns)};
+    const std::string conn_desc {is_ctrl ? "control" : (is_cam ? "camera" : "srv data")};
+    const int port {is_ctrl ? ctrl_data_port : (is_cam ? cam_data_port : srv_data_port)};
+
+    int listen_fd {listen_sock_fd};
+    int new_sock_fd {-1};
+    if(acceptClient(listen_fd, new_sock_fd, conn_desc, port) != ReturnCodes::Success) return;
+
+    // has to be accepted to be turned away (otherwise it stays pending & the reactor keeps waking up)
+    if(conns.size() >= static_cast<std::size_t>(Constants::Network::MAX_SUBSCRIBERS)) {
+        cout << "Refusing " + conn_desc + " connection (already serving the max number of clients)\n";
+        close(new_sock_fd);
+        return;
     }
 
-    // accept at most 1 client at a time, and set the socket in a listening state
-    constexpr int max_num_conns {1};
-    if (listen(ctrl_listen_sock_fd, max_num_conns) < 0) { 
-        cout << "ERROR: Failed to listen to control socket" << endl;
-        close(ctrl_listen_sock_fd);
-        return ReturnCodes::Error;
+    NetConn& conn {conns.emplace_back()};
+    conn.sock_fd = new_sock_fd;
+    conn.last_rx = std::chrono::steady_clock::now();
+    const bool has_lowat {tuneSock(conn.sock_fd, is_ctrl ? Channel::Control : (is_cam ? Channel::Camera : Channel::SrvData))};
+    // w/o the low water mark the mux connection would spin on EPOLLOUT while MuxWriter waits for the kernel
+    conn.mux_writer.setNotSentGate(has_lowat);
+
+    if (is_ctrl) {
+        reactor.add(conn.sock_fd, EPOLLIN | EPOLLRDHUP);
+        if (conns.size() > 1) {
+            cout << "Another client is driving, new control connection will only observe (unless it resumes a session)\n";
+        }
+
+        // mux clients subscribe to the camera & server data over this connection too
+        // (should get the current frame/pkt right away)
+        if (getTransport() == Transport::Mux) {
+            conn.send_cursor = cam_ring.subscribe();
+            conn.srv_cursor = srv_ring.subscribe();
+            if (cam_ring.empty()) cam_pkt_ready.store(true);
+            if (srv_ring.empty()) srv_pkt_ready.store(true);
+        }
+        return;
     }
-    if (listen(cam_listen_sock_fd, max_num_conns) < 0) { 
-        cout << "ERROR: Failed to listen to control socket" << endl;
-        close(cam_listen_sock_fd);
-        return ReturnCodes::Error;
+
+    // frames are large, so let the kernel send them straight from the frame buffers (if supported)
+    if(is_cam && enableZeroCopy(conn.sock_fd) != ReturnCodes::Success && isVerbose()) {
+        cout << "Zero copy sends unsupported, camera frames will be copied by the kernel" << endl;
+    }
+    reactor.add(conn.sock_fd, EPOLLIN | EPOLLRDHUP);
+
+    // new subscriber should get the current frame/pkt right away
+    BroadcastRing<OutMsg>& ring {is_cam ? cam_ring : srv_ring};
+    conn.send_cursor = ring.subscribe();
+    if (ring.empty()) {
+        (is_cam ? cam_pkt_ready : srv_pkt_ready).store(true);
     }
-    if (listen(srv_data_listen_sock_fd, srv_data_listen_sock_fd) < 0) { 
-        cout << "ERROR: Failed to listen to 'server data' socket" << endl;
-        close(srv_data_listen_sock_fd);
+}
+
+bool TcpServer::handleConnEvent(const int sock_fd, const std::uint32_t events, const bool print_data) {
+    const auto has_fd {[sock_fd](const NetConn& conn){ return conn.sock_fd == sock_fd; }};
+
+    // control connection -> read everything that arrived
+    const auto ctrl_conn {std::find_if(ctrl_conns.begin(), ctrl_conns.end(), has_fd)};
+    if (ctrl_conn != ctrl_conns.end()) {
+        // mux connections also carry the camera & server data, so continue sending once there is room
+        // (otherwise only clock pongs go back, continue sending those)
+        const bool use_mux {getTransport() == Transport::Mux};
+        if (handleCtrlRecv(*ctrl_conn, print_data) != ReturnCodes::Success
+            || (use_mux ? pumpMux(*ctrl_conn) : flushSend(*ctrl_conn)) != ReturnCodes::Success
+        ) {
+            closeConn(ctrl_conns, ctrl_conn, "control");
+            return true;
+        }
+        return resumeSession(ctrl_conns, ctrl_conn, "control");
+    }
+
+    // subscriber -> continue sending
+    const bool is_cam {std::any_of(cam_conns.begin(), cam_conns.end(), has_fd)};
+    std::list<NetConn>& conns {is_cam ? cam_conns : srv_conns};
+    BroadcastRing<OutMsg>& ring {is_cam ? cam_ring : srv_ring};
+    const auto conn {std::find_if(conns.begin(), conns.end(), has_fd)};
+    if (conn == conns.end()) return false;
+
+    // clients only send their session hello on these, so anything other than that/writable means the conn is done
+    // (EPOLLERR w/o a socket error is just zero copy completions, which flushSend() reaps)
+    const bool conn_done {
+        (events & (EPOLLHUP | EPOLLRDHUP)) || ((events & EPOLLERR) && hasSockError(sock_fd))
+    };
+    if (conn_done
+        || ((events & EPOLLIN) && handleSubscriberRecv(*conn) != ReturnCodes::Success)
+        || flushSend(*conn) != ReturnCodes::Success
+        || pumpSubscriber(*conn, ring) != ReturnCodes::Success
+    ) {
+        cout << "Terminate - a client's " << (is_cam ? "camera" : "srv data") << " endpoint has closed the socket"
+             << endl;
+        closeConn(conns, conn, is_cam ? "camera" : "srv data");
+        return true;
+    }
+    return resumeSession(conns, conn, is_cam ? "camera" : "srv data");
+}
+
+ReturnCodes TcpServer::handleSubscriberRecv(NetConn& conn) {
+    // drain whatever arrived, only session hellos mean anything (can reuse the control pool, they are tiny)
+    while (true) {
+        const RecvRtn sub_recv {conn.reader.readSome(conn.sock_fd, ctrl_rx_pool)};
+        switch (sub_recv.RtnCode) {
+            case RecvSendRtnCodes::Success:
+                if (sub_recv.header.isSessionHello()) conn.session = readSessionToken(sub_recv);
+                break;
+            case RecvSendRtnCodes::WouldBlock:
+                return ReturnCodes::Success;
+            case RecvSendRtnCodes::Error:
+                break; // too large -> already drained, the stream is still in sync
+            case RecvSendRtnCodes::ClosedConn:
+            default:
+                return ReturnCodes::Error;
+        }
+    }
+}
+
+bool TcpServer::resumeSession(std::list<NetConn>& conns, std::list<NetConn>::iterator conn, const std::string& conn_desc) {
+    if (conn->session == 0) return false;
+    const auto stale {std::find_if(conns.begin(), conns.end(), [&conn](const NetConn& other) {
+        return &other != &*conn && other.session == conn->session;
+    })};
+    if (stale == conns.end()) return false;
+
+    // client reconnected before its old connection timed out -> new one takes its place (i.e. keeps driving)
+    cout << "Client resumed its " + conn_desc + " session\n";
+    conns.splice(stale, conns, conn);
+    closeConn(conns, stale, conn_desc);
+    return true;
+}
+
+const std::vector<epoll_event>& TcpServer::scheduleEvents(const std::vector<epoll_event>& ready) {
+    // stable, so events of the same priority keep the order epoll reported them in
+    sched_events.assign(ready.begin(), ready.end());
+    std::stable_sort(sched_events.begin(), sched_events.end(), [this](const epoll_event& lhs, const epoll_event& rhs) {
+        return getFdPriority(lhs.data.fd) < getFdPriority(rhs.data.fd);
+    });
+    return sched_events;
+}
+
+std::uint8_t TcpServer::getFdPriority(const int fd) const {
+    const auto has_fd {[fd](const NetConn& conn){ return conn.sock_fd == fd; }};
+    if (std::any_of(cam_conns.begin(), cam_conns.end(), has_fd)) return channelPriority(Channel::Camera);
+    if (std::any_of(srv_conns.begin(), srv_conns.end(), has_fd)) return channelPriority(Channel::SrvData);
+    return channelPriority(Channel::Control);
+}
+
+ReturnCodes TcpServer::handleCtrlRecv(NetConn& conn, const bool print_data) {
+    // keep reading until the socket is drained (several pkts may have arrived at once)
+    while (true) {
+        /********************************* Receiving From Client ********************************/
+        // data is received straight into a reusable pooled buffer (can take several calls to arrive)
+        // mux clients only ever send control pkts, anything else is drained & dropped
+        const RecvRtn ctrl_recv {getTransport() == Transport::Mux ?
+            conn.mux_reader.readSome(conn.sock_fd, MuxPools{&ctrl_rx_pool, nullptr, nullptr}) :
+            conn.reader.readSome(conn.sock_fd, ctrl_rx_pool)
+        };
+
+        const std::uint64_t recv_us {ClockSync::now()};
+
+        switch (ctrl_recv.RtnCode) {
+            case RecvSendRtnCodes::Success:
+                conn.last_rx = std::chrono::steady_clock::now();
+
+                // session hello -> stop so the caller can check if it resumes an older connection (see resumeSession())
+                // before the pkts after it are read (the reactor reports the socket as readable again)
+                if (ctrl_recv.header.isSessionHello()) {
+                    conn.session = readSessionToken(ctrl_recv);
+                    return ReturnCodes::Success;
+                }
+
+                // corrupt pkts are dropped (the next heartbeat resends the state anyway)
+                if (!verifyChecksum(ctrl_recv, Channel::Control)) break;
+
+                // clock ping -> answered right away (from every client, they all time their frames)
+                if (ctrl_recv.header.isClockPing()) {
+                    if (answerClockPing(conn, ctrl_recv, recv_us) != ReturnCodes::Success) return ReturnCodes::Error;
+                    break;
+                }
+
+                // observers just keep their connection alive, only the driver controls the robot
+                recordCtrlLatency(ctrl_recv.header, recv_us);
+                if (&conn == &ctrl_conns.front()) {
+                    processCtrlPkt(ctrl_recv, print_data);
+                }
+                break;
+            case RecvSendRtnCodes::WouldBlock:
+                return ReturnCodes::Success;
+            case RecvSendRtnCodes::ClosedConn:
+                // client killed conn -- server keeps serving the other clients & waits for new ones
+                cout << "Terminate - a client's control endpoint has closed the socket" << endl;
+                return ReturnCodes::Error;
+            case RecvSendRtnCodes::Error:
+            default:
+                cout << "Error - client control socket recv error" << endl;
+                return ReturnCodes::Error;
+        }
+    }
+}
+
+void TcpServer::handleCtrlDatagrams(const bool print_data) {
+    // keep reading until the socket is drained (several datagrams may have arrived at once)
+    while (true) {
+        const DgramRtn dgram {recvDatagram(ctrl_rx_pool, Channel::Control)};
+        const std::uint64_t recv_us {ClockSync::now()};
+
+        // malformed/corrupt datagrams are already discarded, so anything else can wait until the reactor wakes again
+        if (dgram.msg.RtnCode != RecvSendRtnCodes::Success) return;
+
+        // there are no connections, so clients are told apart by where their datagrams come from
+        auto peer {std::find_if(udp_peers.begin(), udp_peers.end(), [&dgram](const UdpPeer& known) {
+            return isSameAddr(known.addr, dgram.from);
+        })};
+        if (peer == udp_peers.end()) {
+            if (udp_peers.size() >= static_cast<std::size_t>(Constants::Network::MAX_SUBSCRIBERS)) continue;
+
+            peer = udp_peers.emplace(udp_peers.end());
+            peer->addr = dgram.from;
+            cout << "New control peer @" + formatIpAddr(inet_ntoa(dgram.from.sin_addr), ntohs(dgram.from.sin_port))
+                    + " (udp)\n";
+            if (udp_peers.size() > 1) {
+                cout << "Another client is driving, new control peer will only observe\n";
+            }
+            client_ip = inet_ntoa(dgram.from.sin_addr);
+
+            // new peer should get the current server data right away
+            srv_pkt_ready.store(true);
+        }
+
+        // clock pings are answered right away (a late ping is still a good sample, so they skip the stale check)
+        if (dgram.msg.header.isClockPing()) {
+            const std::optional<OutMsg> pong {makeClockPong(dgram.msg, recv_us)};
+            if (pong && sendDatagram(dgram.from, *pong).RtnCode != RecvSendRtnCodes::Success) {
+                cout << "Error: Send clock pong datagram to client" << endl;
+            }
+            continue;
+        }
+
+        // only the newest state matters, so anything older than what was already used is thrown away
+        // (lost datagrams are never waited on, the next heartbeat resends the state anyway)
+        if (!peer->rx_seq.accept(dgram.stamp)) {
+            if (isVerbose()) {
+                cout << "Dropped stale control datagram #" << dgram.stamp.seq
+                     << " (newest is #" << peer->rx_seq.getLastSeq() << ")" << endl;
+            }
+            continue;
+        }
+        peer->last_rx = std::chrono::steady_clock::now();
+        recordCtrlLatency(dgram.msg.header, recv_us);
+
+        // observers just keep sending heartbeats, only the driver controls the robot
+        if (peer == udp_peers.begin()) {
+            processCtrlPkt(dgram.msg, print_data);
+        }
+    }
+}
+
+std::optional<OutMsg> TcpServer::makeClockPong(const RecvRtn& ping_recv, const std::uint64_t recv_us) const {
+    std::optional<ClockPing> pong {readClockMsg(ping_recv)};
+    if (!pong) return std::nullopt;
+
+    pong->server_recv = recv_us;
+    pong->server_send = ClockSync::now();
+    return makeClockMsg(*pong);
+}
+
+ReturnCodes TcpServer::answerClockPing(NetConn& conn, const RecvRtn& ping_recv, const std::uint64_t recv_us) {
+    // a pong that has to wait would come back w/ a useless rtt anyway
+    const bool use_mux {getTransport() == Transport::Mux};
+    if (use_mux ? conn.mux_writer.isBusy(Channel::Control) : conn.writer.isBusy()) return ReturnCodes::Success;
+
+    const std::optional<OutMsg> pong {makeClockPong(ping_recv, recv_us)};
+    if (!pong) return ReturnCodes::Success;
+    if (use_mux) {
+        if (conn.mux_writer.start(*pong) != ReturnCodes::Success) return ReturnCodes::Error;
+    } else {
+        conn.writer.start(*pong);
+    }
+    return flushSend(conn);
+}
+
+void TcpServer::recordCtrlLatency(const HeaderPkt_t& header, const std::uint64_t recv_us) {
+    // the client stamps its pkts on the server's clock once it is synced (0 until then)
+    const std::uint64_t sent_us {header.getOriginTime()};
+    if (sent_us == 0) return;
+    ctrl_latency.record(recv_us > sent_us ? recv_us - sent_us : 0);
+}
+
+void TcpServer::processCtrlPkt(const RecvRtn& ctrl_recv, const bool print_data) {
+    captureMsg(CaptureDir::Recv, Channel::Control, ctrl_recv.header, ctrl_recv.buf->data(), static_cast<std::uint32_t>(ctrl_recv.buf->size()));
+
+    // decode the packet based on the encoding the client used (stored in the header)
+    try {
+        const PktEncoding encoding  { static_cast<PktEncoding>(ctrl_recv.header.protocol) };
+        const char*       data      { reinterpret_cast<const char*>(ctrl_recv.buf->data()) };
+
+        // actually try to parse recv packet into the struct
+        const CommonPkt pkt {readCmnPkt(data, ctrl_recv.buf->size(), encoding)};
+
+        // answer with server data packets in whatever encoding the driver speaks
+        peer_encoding.store(encoding);
+
+        // print the buf to the terminal (if told to)
+        if (print_data) {
+            cout << "Recv Control Data: " + convertPktToJson(pkt).dump() << endl;
+        }
+
+        // actually update the saved most recent packet in memory
+        if(updatePkt(pkt) != ReturnCodes::Success) {
+            cerr << "Error: Failed to update from control pkt" << endl;
+        }
+
+        // call receive callback if set
+        if (recv_cb) {
+            if (recv_cb(pkt) != ReturnCodes::Success) {
+                cerr << "ERROR: Failed to process received packet from client" << endl;
+            }
+        }
+    } catch (std::exception& err) {
+        cerr << "Error: Failed to update from control pkt: " << err.what() << endl;
+    }
+}
+
+void TcpServer::sendSrvDatagrams(const bool force) {
+    if (getTransport() != Transport::Udp || udp_peers.empty() || !latest_srv_msg.keepalive) return;
+
+    // the latest pkt is resent every heartbeat (each resend gets a new seq, so the client takes it if it missed it)
+    const auto now {std::chrono::steady_clock::now()};
+    if (!force && now - srv_msg_sent < std::chrono::milliseconds(Constants::Network::UDP_HEARTBEAT_MS)) return;
+    srv_msg_sent = now;
+
+    for (const UdpPeer& peer : udp_peers) {
+        if(sendDatagram(peer.addr, latest_srv_msg).RtnCode != RecvSendRtnCodes::Success) {
+            cout << "Error: Send server data datagram to client" << endl;
+        }
+    }
+}
+
+ReturnCodes TcpServer::flushSend(NetConn& conn) {
+    // every connection is read from (mux: control pkts, subscribers: their session hello)
+    const bool use_mux {getTransport() == Transport::Mux};
+    const std::uint32_t base_events {EPOLLIN | EPOLLRDHUP};
+    const SendRtn send_rtn {use_mux ? continueSend(conn.sock_fd, conn.mux_writer) : continueSend(conn.sock_fd, conn.writer)};
+
+    // only wait for EPOLLOUT while the socket is full (otherwise it would wake the reactor constantly)
+    bool wait_writable {conn.wait_writable};
+    if (send_rtn.RtnCode == RecvSendRtnCodes::WouldBlock) {
+        wait_writable = true;
+    } else if (send_rtn.RtnCode == RecvSendRtnCodes::Success) {
+        wait_writable = false;
+    } else {
         return ReturnCodes::Error;
     }
 
+    if (wait_writable != conn.wait_writable) {
+        conn.wait_writable = wait_writable;
+        const std::uint32_t writable_event {wait_writable ? static_cast<std::uint32_t>(EPOLLOUT) : 0u};
+        return reactor.modify(conn.sock_fd, base_events | writable_event);
+    }
     return ReturnCodes::Success;
 }
 
-void TcpServer::quit() {
-    // set exit status to be true
-    setExitCode(true);
+ReturnCodes TcpServer::pumpSubscriber(NetConn& conn, BroadcastRing<OutMsg>& ring) {
+    // keep going until caught up or the socket is full (the rest goes out once it is writable)
+    const std::chrono::milliseconds target_latency {Constants::Camera::TARGET_LATENCY_MS};
+    while (!conn.writer.isBusy()) {
+        // frames already sent take too long to arrive -> wait (the next frame wakes the reactor again)
+        if (&ring == &cam_ring && conn.link.getQueueDelay(conn.sock_fd, 0) > target_latency) break;
 
-    // dont bother continuing if not initialized
-    if (!getIsInit()) return;
+        std::uint64_t skipped {0};
+        const OutMsg* msg {ring.next(conn.send_cursor, &skipped)};
+        if (msg == nullptr) break;
 
-    // if sockets are still open, close them and set to -1
-    cout << "Cleanup: closing control sockets" << endl;
-    ctrl_listen_sock_fd = CloseOpenSock(ctrl_listen_sock_fd);
-    ctrl_data_sock_fd   = CloseOpenSock(ctrl_data_sock_fd);
+        if (skipped > 0 && isVerbose()) {
+            cout << "Slow subscriber skipped " << skipped << " message(s)" << endl;
+        }
 
-    cout << "Cleanup: closing camera sockets" << endl;
-    cam_listen_sock_fd  = CloseOpenSock(cam_listen_sock_fd);
-    cam_data_sock_fd    = CloseOpenSock(cam_data_sock_fd);
+        conn.writer.start(*msg);
+        conn.link.addQueued(HeaderPkt_t::WIRE_SIZE + msg->size);
+        if (flushSend(conn) != ReturnCodes::Success) {
+            return ReturnCodes::Error;
+        }
+    }
+    return ReturnCodes::Success;
+}
 
-    cout << "Cleanup: closing server data sockets" << endl;
-    srv_data_listen_sock_fd = CloseOpenSock(srv_data_listen_sock_fd);
-    srv_data_sock_fd        = CloseOpenSock(srv_data_sock_fd);
+ReturnCodes TcpServer::pumpMux(NetConn& conn) {
+    const std::chrono::milliseconds target_latency {Constants::Camera::TARGET_LATENCY_MS};
+
+    // each channel holds a message at a time, so keep topping them up until caught up or the socket is full
+    // (the writer interleaves their fragments, most urgent channel first)
+    bool queued_msg {true};
+    while (queued_msg) {
+        queued_msg = false;
+        for (const Channel channel : {Channel::SrvData, Channel::Camera}) {
+            if (conn.mux_writer.isBusy(channel)) continue;
+
+            // frames already sent take too long to arrive -> wait (the next frame wakes the reactor again)
+            const bool is_cam {channel == Channel::Camera};
+            if (is_cam && conn.link.getQueueDelay(conn.sock_fd, conn.mux_writer.getUnsentSize()) > target_latency) {
+                continue;
+            }
+
+            std::uint64_t skipped {0};
+            const OutMsg* msg {(is_cam ? cam_ring : srv_ring).next(is_cam ? conn.send_cursor : conn.srv_cursor, &skipped)};
+            if (msg == nullptr) continue;
+
+            if (skipped > 0 && isVerbose()) {
+                cout << "Slow subscriber skipped " << skipped << " message(s)" << endl;
+            }
+
+            if (conn.mux_writer.start(*msg) != ReturnCodes::Success) {
+                cerr << "ERROR: Invalid mux channel " << static_cast<int>(msg->header.channel) << ", dropped msg" << endl;
+                continue;
+            }
+            conn.link.addQueued(MuxWriter::getWireSize(msg->size));
+            queued_msg = true;
+        }
+
+        if (flushSend(conn) != ReturnCodes::Success) {
+            return ReturnCodes::Error;
+        }
+        if (conn.wait_writable) break;
+    }
+    return ReturnCodes::Success;
 }
 
+void TcpServer::pumpMuxConns() {
+    if (getTransport() != Transport::Mux) return;
 
-/********************************************* Helper Functions ********************************************/
+    for (auto conn = ctrl_conns.begin(); conn != ctrl_conns.end();) {
+        const auto curr_conn {conn++};
+        if(pumpMux(*curr_conn) != ReturnCodes::Success) {
+            cout << "Error: Send to mux client (suggests closed endpoint)" << endl;
+            closeConn(ctrl_conns, curr_conn, "mux");
+        }
+    }
+}
+
+void TcpServer::updateVideoRate() {
+    const auto now {std::chrono::steady_clock::now()};
+    if (now - rate_sampled < std::chrono::milliseconds(Constants::Network::RATE_SAMPLE_MS)) return;
+    rate_sampled = now;
+
+    // no one to send frames over the network to (or they go through shared memory) -> best quality
+    // (every mux client subscribes to the camera)
+    const bool use_mux {getTransport() == Transport::Mux};
+    std::list<NetConn>& subscribers {use_mux ? ctrl_conns : cam_conns};
+    if (subscribers.empty()) {
+        video_rate.reset();
+        setVideoRung(video_rate.getRung());
+        return;
+    }
+
+    // frames are encoded once for everyone, so the slowest subscriber decides
+    std::chrono::milliseconds worst_delay {0};
+    for (NetConn& conn : subscribers) {
+        conn.link.sample(conn.sock_fd, use_mux ? conn.mux_writer.getUnsentSize() : conn.writer.getUnsentSize(), now);
+        worst_delay = std::max(worst_delay, conn.link.getQueueDelay());
+    }
+
+    const std::size_t prev_rung {getVideoRung()};
+    const std::size_t rung {video_rate.update(worst_delay, now)};
+    if (rung == prev_rung) return;
+    setVideoRung(rung);
+
+    if (isVerbose()) {
+        const Camera::VideoSettings& settings {Camera::getVideoSettings(rung)};
+        cout << "Video " + std::string(rung > prev_rung ? "down" : "up") + " to quality "
+                + std::to_string(settings.jpeg_quality) + " @" + std::to_string(settings.width) + "x"
+                + std::to_string(settings.height) + " " + std::to_string(settings.fps) + "fps (queue delay "
+                + std::to_string(worst_delay.count()) + "ms)\n";
+    }
+}
+
+void TcpServer::closeConn(
+    std::list<NetConn>& conns,
+    std::list<NetConn>::iterator conn,
+    const std::string& conn_desc
+) {
+    if (conn->sock_fd >= 0) {
+        reactor.remove(conn->sock_fd);
+    }
+    CloseOpenSock(conn->sock_fd);
+
+    // if the driver left, the next oldest control connection takes over
+    const bool was_driver {&conns == &ctrl_conns && conn == ctrl_conns.begin()};
+    conns.erase(conn);
+    if(isVerbose()) cout << "Closing " << conn_desc << " data socket" << endl;
+    if(was_driver && !ctrl_conns.empty()) {
+        cout << "Driver left, next oldest control connection is now driving" << endl;
+    }
+}
+
+bool TcpServer::hasSockError(const int sock_fd) const {
+    int sock_err {0};
+    socklen_t err_len {sizeof(sock_err)};
+    return getsockopt(sock_fd, SOL_SOCKET, SO_ERROR, &sock_err, &err_len) < 0 || sock_err != 0;
+}
 
 
 } // end of Network namespace
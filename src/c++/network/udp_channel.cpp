@@ -0,0 +1,272 @@
+#include "udp_channel.h"
+
+#include <unistd.h> // for close()
+#include <endian.h> // for htobe64/be64toh
+#include <cstring> // for memcpy
+#include <cerrno>
+#include <iostream>
+
+namespace RPI {
+namespace Network {
+
+/************************************************ Datagram Stamp ************************************************/
+
+DgramStamp::DgramStamp(const std::uint8_t* wire_buf) {
+    std::uint64_t wire_seq {0};
+    std::uint64_t wire_time {0};
+    std::memcpy(&wire_seq, wire_buf, sizeof(wire_seq));
+    std::memcpy(&wire_time, wire_buf+sizeof(wire_seq), sizeof(wire_time));
+    seq             = be64toh(wire_seq);
+    send_time_us    = be64toh(wire_time);
+}
+
+void DgramStamp::pack(std::uint8_t* wire_buf) const {
+    const std::uint64_t wire_seq {htobe64(seq)};
+    const std::uint64_t wire_time {htobe64(send_time_us)};
+    std::memcpy(wire_buf, &wire_seq, sizeof(wire_seq));
+    std::memcpy(wire_buf+sizeof(wire_seq), &wire_time, sizeof(wire_time));
+}
+
+/************************************************** Seq Filter **************************************************/
+
+bool SeqFilter::accept(const DgramStamp& stamp) {
+    const bool is_newer     {stamp.seq > last_seq};
+    const bool restarted    {stamp.seq < last_seq && stamp.send_time_us > last_send_time};
+    if (!is_newer && !restarted) {
+        ++num_stale;
+        return false;
+    }
+
+    last_seq        = stamp.seq;
+    last_send_time  = stamp.send_time_us;
+    return true;
+}
+
+std::uint64_t SeqFilter::getLastSeq() const {
+    return last_seq;
+}
+
+std::uint64_t SeqFilter::getNumStale() const {
+    return num_stale;
+}
+
+/************************************************* UDP Channel **************************************************/
+
+UdpChannel::UdpChannel()
+    : sock_fd{-1}                   // opened by open()
+    , next_seq{1}                   // 0 is never sent, so a fresh SeqFilter accepts the first datagram
+    , shim{}                        // no simulated loss by default
+    , shim_rng{shim.seed}
+    , held_dgram{}                  // nothing held back yet
+    , held_dest{}
+    , shim_dropped{0}
+{
+    // stub
+}
+
+UdpChannel::~UdpChannel() {
+    close();
+}
+
+int UdpChannel::getFd() const {
+    return sock_fd;
+}
+
+bool UdpChannel::isOpen() const {
+    return sock_fd >= 0;
+}
+
+void UdpChannel::setLossShim(const LossShim& new_shim) {
+    shim = new_shim;
+    shim_rng.seed(shim.seed);
+    held_dgram.clear();
+}
+
+std::uint64_t UdpChannel::getNumShimDropped() const {
+    return shim_dropped.load();
+}
+
+ReturnCodes UdpChannel::open(const int port, const bool non_blocking, const int recv_timeout_sec) {
+    close();
+    sock_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | (non_blocking ? SOCK_NONBLOCK : 0), 0);
+    if (sock_fd < 0) {
+        std::cerr << "ERROR: Opening udp socket" << std::endl;
+        return ReturnCodes::Error;
+    }
+
+    int option(1);
+    setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
+
+    // blocking sockets still need to return every so often so their thread can see it should exit
+    if (!non_blocking && recv_timeout_sec > 0) {
+        struct timeval timeout;
+        timeout.tv_sec = recv_timeout_sec;
+        timeout.tv_usec = 0;
+        setsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    }
+
+    sockaddr_in addr        {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(port);
+    addr.sin_addr.s_addr    = htonl(INADDR_ANY);
+    if (::bind(sock_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        std::cerr << "ERROR: Failed to bind udp socket to port " << port << std::endl;
+        close();
+        return ReturnCodes::Error;
+    }
+    return ReturnCodes::Success;
+}
+
+void UdpChannel::close() {
+    if (sock_fd >= 0) {
+        ::close(sock_fd);
+        sock_fd = -1;
+    }
+    held_dgram.clear();
+}
+
+SendRtn UdpChannel::sendTo(const sockaddr_in& dest, const OutMsg& msg) {
+    if (sock_fd < 0 || msg.size > Constants::Network::MAX_DGRAM_SIZE) {
+        return SendRtn{0, RecvSendRtnCodes::Error};
+    }
+
+    // stamp it so the receiver can throw away anything older than what it already has
+    DgramStamp stamp    {};
+    stamp.seq           = next_seq.fetch_add(1);
+    stamp.send_time_us  = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count());
+
+    std::uint8_t prefix_buf[DgramStamp::WIRE_SIZE + HeaderPkt_t::WIRE_SIZE];
+    stamp.pack(prefix_buf);
+    msg.header.pack(prefix_buf + DgramStamp::WIRE_SIZE);
+
+    // stamp, header & data go out as one datagram (w/o copying them together)
+    iovec iov[2];
+    iov[0].iov_base = prefix_buf;
+    iov[0].iov_len  = sizeof(prefix_buf);
+    iov[1].iov_base = const_cast<void*>(msg.data);
+    iov[1].iov_len  = msg.size;
+
+    if (!sendPacked(dest, iov, 2)) {
+        return SendRtn{0, RecvSendRtnCodes::Error};
+    }
+    return SendRtn{msg.size, RecvSendRtnCodes::Success};
+}
+
+DgramRtn UdpChannel::recvFrom(BufferPool& pool) {
+    DgramRtn rtn {RecvRtn{nullptr, RecvSendRtnCodes::Error, {}}, {}, {}};
+    if (sock_fd < 0) return rtn;
+
+    // data is received straight into a pooled buffer (trimmed to the real size afterwards)
+    PooledBuf data_buf {pool.acquire(Constants::Network::MAX_DGRAM_SIZE)};
+    if (!data_buf) return rtn;
+
+    std::uint8_t prefix_buf[DgramStamp::WIRE_SIZE + HeaderPkt_t::WIRE_SIZE];
+    iovec iov[2];
+    iov[0].iov_base = prefix_buf;
+    iov[0].iov_len  = sizeof(prefix_buf);
+    iov[1].iov_base = data_buf->data();
+    iov[1].iov_len  = data_buf->size();
+
+    msghdr msg          {};
+    msg.msg_name        = &rtn.from;
+    msg.msg_namelen     = sizeof(rtn.from);
+    msg.msg_iov         = iov;
+    msg.msg_iovlen      = 2;
+
+    ssize_t rx_size {-1};
+    do {
+        rx_size = ::recvmsg(sock_fd, &msg, 0);
+    } while (rx_size < 0 && errno == EINTR);
+
+    if (rx_size < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            rtn.msg.RtnCode = RecvSendRtnCodes::WouldBlock;
+        }
+        return rtn;
+    }
+
+    // datagrams arrive whole or not at all, so the header has to describe exactly what is left
+    if (static_cast<std::size_t>(rx_size) < sizeof(prefix_buf) || (msg.msg_flags & MSG_TRUNC)) {
+        std::cerr << "ERROR: RECV - malformed datagram (" << rx_size << " bytes), discarded it" << std::endl;
+        return rtn;
+    }
+    const std::size_t data_size {static_cast<std::size_t>(rx_size) - sizeof(prefix_buf)};
+    rtn.stamp       = DgramStamp{prefix_buf};
+    rtn.msg.header  = HeaderPkt_t{prefix_buf + DgramStamp::WIRE_SIZE};
+    if (rtn.msg.header.total_length != data_size) {
+        std::cerr << "ERROR: RECV - datagram size mismatch (" << data_size << "/"
+                  << rtn.msg.header.total_length << " bytes), discarded it" << std::endl;
+        return rtn;
+    }
+
+    data_buf->resize(data_size);
+    rtn.msg.buf     = std::move(data_buf);
+    rtn.msg.RtnCode = RecvSendRtnCodes::Success;
+    return rtn;
+}
+
+/*********************************************** Helper Functions ***********************************************/
+
+bool UdpChannel::sendPacked(const sockaddr_in& dest, const iovec* iov, const std::size_t iov_len) {
+    const auto send_once {[this](const sockaddr_in& to, const iovec* vecs, const std::size_t num_vecs) {
+        msghdr msg          {};
+        msg.msg_name        = const_cast<sockaddr_in*>(&to);
+        msg.msg_namelen     = sizeof(to);
+        msg.msg_iov         = const_cast<iovec*>(vecs);
+        msg.msg_iovlen      = num_vecs;
+
+        ssize_t sent {-1};
+        do {
+            sent = ::sendmsg(sock_fd, &msg, MSG_NOSIGNAL);
+        } while (sent < 0 && errno == EINTR);
+
+        // a full send buffer just loses the datagram (like the network would), the next one carries the state
+        return sent >= 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS;
+    }};
+
+    if (!shim.isActive()) {
+        return send_once(dest, iov, iov_len);
+    }
+
+    /*********************************************** loss shim ************************************************/
+    if (shimRoll(shim.drop_rate)) {
+        shim_dropped.fetch_add(1);
+        return true;
+    }
+
+    // hold this one back until the next datagram has gone out (only one is held at a time)
+    if (held_dgram.empty() && shimRoll(shim.reorder_rate)) {
+        for (std::size_t idx = 0; idx < iov_len; ++idx) {
+            const std::uint8_t* part {static_cast<const std::uint8_t*>(iov[idx].iov_base)};
+            held_dgram.insert(held_dgram.end(), part, part + iov[idx].iov_len);
+        }
+        held_dest = dest;
+        return true;
+    }
+
+    bool sent_ok {send_once(dest, iov, iov_len)};
+    if (shimRoll(shim.dup_rate)) {
+        sent_ok &= send_once(dest, iov, iov_len);
+    }
+    if (!held_dgram.empty()) {
+        const iovec held_iov {held_dgram.data(), held_dgram.size()};
+        sent_ok &= send_once(held_dest, &held_iov, 1);
+        held_dgram.clear();
+    }
+    return sent_ok;
+}
+
+bool UdpChannel::shimRoll(const double rate) {
+    if (rate <= 0) return false;
+    return std::uniform_real_distribution<double>{0.0, 1.0}(shim_rng) < rate;
+}
+
+bool isSameAddr(const sockaddr_in& lhs, const sockaddr_in& rhs) {
+    return lhs.sin_addr.s_addr == rhs.sin_addr.s_addr && lhs.sin_port == rhs.sin_port;
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
@@ -0,0 +1,473 @@
+#include "uring_engine.h"
+
+#include <chrono>
+#include <algorithm> // for std::min/max
+#include <cstring> // for memcpy/memset
+#include <cerrno>
+#include <cstdint>
+#include <unistd.h> // for close() & syscall()
+#include <fcntl.h> // for O_NONBLOCK
+#include <sys/mman.h> // for mmap()
+#include <sys/socket.h> // for SO_RCVTIMEO
+#include <sys/syscall.h> // for __NR_io_uring_*
+#include <sys/time.h> // for timeval
+#include <linux/io_uring.h>
+#include <linux/time_types.h> // for __kernel_timespec
+
+namespace RPI {
+namespace Network {
+
+namespace {
+
+constexpr std::uint64_t RECV_TAG        {1};    // user_data of the multishot recv
+constexpr std::uint64_t CANCEL_TAG      {2};    // user_data of the cancel sent when closing
+constexpr std::uint16_t BUF_GROUP       {0};    // the provided buffer group the recv picks from
+constexpr unsigned      RING_ENTRIES    {4};    // at most a recv & a cancel are ever in flight
+constexpr int           CANCEL_WAIT_MS  {100};  // longest to wait for the recv to be cancelled when closing
+
+int uringSetup(const unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(const int ring_fd, const unsigned to_submit, const unsigned min_complete, const unsigned flags,
+               const void* arg, const std::size_t arg_size) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+int uringRegister(const int ring_fd, const unsigned opcode, void* arg, const unsigned num_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, num_args));
+}
+
+// the ring heads/tails are shared w/ the kernel
+unsigned loadAcquire(const unsigned* ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(unsigned* ptr, const unsigned val) {
+    __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+}
+
+void* mapOrNull(const std::size_t size, const int fd, const off_t offset) {
+    void* const mapped {fd < 0 ?
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) :
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset)
+    };
+    return mapped == MAP_FAILED ? nullptr : mapped;
+}
+
+} // end of anonymous namespace
+
+/********************************************** Constructors **********************************************/
+
+UringEngine::UringEngine()
+    : ring_fd{-1}                   // setup by init()
+    , sock_fd{-1}
+    , timeout_ms{-1}
+    , sq_map{nullptr}
+    , sq_map_size{0}
+    , sq_head{nullptr}
+    , sq_tail{nullptr}
+    , sq_mask{nullptr}
+    , sq_array{nullptr}
+    , sqes{nullptr}
+    , sqes_size{0}
+    , cq_map{nullptr}
+    , cq_map_size{0}
+    , cq_head{nullptr}
+    , cq_tail{nullptr}
+    , cq_mask{nullptr}
+    , cqes{nullptr}
+    , buf_ring{nullptr}
+    , buf_ring_size{0}
+    , buf_mem{nullptr}
+    , buf_size{0}
+    , num_bufs{0}
+    , buf_tail{0}
+    , chunks{}
+    , num_to_submit{0}
+    , is_armed{false}
+    , is_closed{false}
+    , has_error{false}
+    , has_failed{false}
+    , got_data{false}
+    , header_buf{}
+    , header_rx{0}
+    , header{}
+    , data_buf{nullptr}
+    , data_rx{0}
+    , discarding{false}
+{
+    // stub
+}
+
+UringEngine::~UringEngine() {
+    close();
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+bool UringEngine::isSupported() {
+    static const bool is_supported {[]() {
+        io_uring_params params {};
+        const int probe_fd {uringSetup(RING_ENTRIES, &params)};
+        if (probe_fd < 0) return false; // no io_uring (pre 5.1 kernel, seccomp'd or disabled by sysctl)
+
+        // timed waits came in 5.11, provided buffer rings in 5.19 & multishot recv in 6.0
+        // (which has no feature flag, but the single issuer setup flag came w/ it)
+        io_uring_params version_params  {};
+        version_params.flags            = IORING_SETUP_SINGLE_ISSUER;
+        const int version_fd {uringSetup(RING_ENTRIES, &version_params)};
+        if (version_fd >= 0) ::close(version_fd);
+
+        bool has_all {(params.features & IORING_FEAT_EXT_ARG) != 0 && version_fd >= 0};
+        void* const probe_ring {mapOrNull(sizeof(io_uring_buf), -1, 0)};
+        if (has_all && probe_ring != nullptr) {
+            io_uring_buf_reg reg    {};
+            reg.ring_addr           = reinterpret_cast<std::uintptr_t>(probe_ring);
+            reg.ring_entries        = 1;
+            reg.bgid                = BUF_GROUP;
+            has_all = uringRegister(probe_fd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0;
+        }
+        ::close(probe_fd);
+        if (probe_ring != nullptr) ::munmap(probe_ring, sizeof(io_uring_buf));
+        return has_all && probe_ring != nullptr;
+    }()};
+    return is_supported;
+}
+
+bool UringEngine::hasFailed() const {
+    return has_failed;
+}
+
+int UringEngine::getRingFd() const {
+    return ring_fd;
+}
+
+/********************************************* Engine Functions ********************************************/
+
+ReturnCodes UringEngine::init(const int sock, const std::size_t new_buf_size, const unsigned new_num_bufs) {
+    close();
+    const bool is_pow_2 {new_num_bufs != 0 && (new_num_bufs & (new_num_bufs - 1)) == 0};
+    if (sock < 0 || !is_pow_2 || new_num_bufs > (1U << 15) || new_buf_size == 0 || !isSupported()) {
+        return ReturnCodes::Error;
+    }
+    sock_fd = sock;
+
+    // blocking sockets time out so their thread can see it should exit, waits here do the same
+    // (non-blocking sockets never wait, a reactor waits on the ring instead)
+    timeval rcv_timeout     {};
+    socklen_t timeout_len   {sizeof(rcv_timeout)};
+    timeout_ms = -1;
+    if (::fcntl(sock_fd, F_GETFL) & O_NONBLOCK) {
+        timeout_ms = 0;
+    } else if (::getsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO, &rcv_timeout, &timeout_len) == 0
+        && (rcv_timeout.tv_sec > 0 || rcv_timeout.tv_usec > 0)
+    ) {
+        timeout_ms = std::max(1, static_cast<int>(rcv_timeout.tv_sec * 1000 + rcv_timeout.tv_usec / 1000));
+    }
+
+    /************************************************ rings ***********************************************/
+    io_uring_params params {};
+    ring_fd = uringSetup(RING_ENTRIES, &params);
+    if (ring_fd < 0) {
+        close();
+        return ReturnCodes::Error;
+    }
+
+    sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_map {(params.features & IORING_FEAT_SINGLE_MMAP) != 0};
+    if (single_map) {
+        sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+    }
+    sq_map = mapOrNull(sq_map_size, ring_fd, IORING_OFF_SQ_RING);
+    cq_map = single_map ? sq_map : mapOrNull(cq_map_size, ring_fd, IORING_OFF_CQ_RING);
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mapOrNull(sqes_size, ring_fd, IORING_OFF_SQES));
+    if (sq_map == nullptr || cq_map == nullptr || sqes == nullptr) {
+        close();
+        return ReturnCodes::Error;
+    }
+
+    std::uint8_t* const sq_base {static_cast<std::uint8_t*>(sq_map)};
+    sq_head     = reinterpret_cast<unsigned*>(sq_base + params.sq_off.head);
+    sq_tail     = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+    sq_mask     = reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+    sq_array    = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+    std::uint8_t* const cq_base {static_cast<std::uint8_t*>(cq_map)};
+    cq_head     = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+    cq_tail     = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+    cq_mask     = reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+    cqes        = reinterpret_cast<io_uring_cqe*>(cq_base + params.cq_off.cqes);
+
+    /****************************************** provided buffers ******************************************/
+    buf_size        = new_buf_size;
+    num_bufs        = new_num_bufs;
+    buf_ring_size   = num_bufs * sizeof(io_uring_buf);
+    buf_ring        = static_cast<io_uring_buf*>(mapOrNull(buf_ring_size, -1, 0));
+    buf_mem         = static_cast<std::uint8_t*>(mapOrNull(buf_size * num_bufs, -1, 0));
+    if (buf_ring == nullptr || buf_mem == nullptr) {
+        close();
+        return ReturnCodes::Error;
+    }
+
+    io_uring_buf_reg reg    {};
+    reg.ring_addr           = reinterpret_cast<std::uintptr_t>(buf_ring);
+    reg.ring_entries        = num_bufs;
+    reg.bgid                = BUF_GROUP;
+    if (uringRegister(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        close();
+        return ReturnCodes::Error;
+    }
+    for (unsigned buf_id = 0; buf_id < num_bufs; ++buf_id) {
+        recycleBuf(static_cast<std::uint16_t>(buf_id));
+    }
+
+    // armed right away, so the ring is signaled as soon as anything arrives
+    armRecv();
+    const int submit_rtn {uringEnter(ring_fd, num_to_submit, 0, 0, nullptr, 0)};
+    if (submit_rtn < 0) {
+        close();
+        return ReturnCodes::Error;
+    }
+    num_to_submit -= std::min(num_to_submit, static_cast<unsigned>(submit_rtn));
+    return ReturnCodes::Success;
+}
+
+RecvRtn UringEngine::recvMsg(BufferPool& pool, std::uint64_t& num_syscalls) {
+    if (ring_fd < 0 || has_failed) {
+        return RecvRtn{nullptr, RecvSendRtnCodes::Error, {}};
+    }
+
+    const auto deadline {std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0))};
+    bool timed_out {false};
+    while (true) {
+        // whatever already arrived might hold the whole message
+        RecvRtn done {nullptr, RecvSendRtnCodes::Error, {}};
+        if (parseChunks(pool, done)) return done;
+
+        if (has_failed || has_error) return RecvRtn{nullptr, RecvSendRtnCodes::Error, header};
+        if (is_closed) return RecvRtn{nullptr, RecvSendRtnCodes::ClosedConn, header};
+
+        // multishot recv stops once every buffer is in use (parsing just gave them back) or on errors
+        if (!is_armed) armRecv();
+        if (reapCompletions() > 0) continue;
+        if (timed_out) return RecvRtn{nullptr, RecvSendRtnCodes::WouldBlock, header};
+
+        // non-blocking sockets only need the kernel to (re)arm the recv
+        const bool should_wait {timeout_ms != 0};
+        if (!should_wait && num_to_submit == 0) return RecvRtn{nullptr, RecvSendRtnCodes::WouldBlock, header};
+
+        // submit anything queued & sleep until the next chunk arrives, all in one call
+        __kernel_timespec wait_ts   {};
+        io_uring_getevents_arg wait_arg {};
+        unsigned flags              {should_wait ? IORING_ENTER_GETEVENTS : 0U};
+        const void* arg             {nullptr};
+        std::size_t arg_size        {0};
+        if (timeout_ms > 0) {
+            const auto ns_left {std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - std::chrono::steady_clock::now()
+            ).count())};
+            wait_ts.tv_sec  = ns_left / 1000000000;
+            wait_ts.tv_nsec = ns_left % 1000000000;
+            wait_arg.ts     = reinterpret_cast<std::uintptr_t>(&wait_ts);
+            flags          |= IORING_ENTER_EXT_ARG;
+            arg             = &wait_arg;
+            arg_size        = sizeof(wait_arg);
+        }
+
+        const int enter_rtn {uringEnter(ring_fd, num_to_submit, should_wait ? 1 : 0, flags, arg, arg_size)};
+        ++num_syscalls;
+        if (enter_rtn < 0 && errno != ETIME && errno != EINTR) {
+            has_error = true;
+            continue;
+        }
+        if (enter_rtn > 0) {
+            num_to_submit -= std::min(num_to_submit, static_cast<unsigned>(enter_rtn));
+        }
+        timed_out = timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline;
+    }
+}
+
+/********************************************* Helper Functions ********************************************/
+
+void UringEngine::close() {
+    // the kernel must be done w/ the buffers before they are unmapped
+    if (ring_fd >= 0 && sqes != nullptr && is_armed) {
+        const unsigned tail {*sq_tail};
+        const unsigned idx  {tail & *sq_mask};
+        io_uring_sqe* sqe   {&sqes[idx]};
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode         = IORING_OP_ASYNC_CANCEL;
+        sqe->fd             = -1;
+        sqe->addr           = RECV_TAG;
+        sqe->user_data      = CANCEL_TAG;
+        sq_array[idx]       = idx;
+        storeRelease(sq_tail, tail + 1);
+        ++num_to_submit;
+
+        const auto deadline {std::chrono::steady_clock::now() + std::chrono::milliseconds(CANCEL_WAIT_MS)};
+        while (is_armed && std::chrono::steady_clock::now() < deadline) {
+            __kernel_timespec wait_ts       {0, CANCEL_WAIT_MS * 1000000L};
+            io_uring_getevents_arg wait_arg {};
+            wait_arg.ts                     = reinterpret_cast<std::uintptr_t>(&wait_ts);
+            const int enter_rtn {uringEnter(
+                ring_fd, num_to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &wait_arg, sizeof(wait_arg)
+            )};
+            if (enter_rtn > 0) num_to_submit -= std::min(num_to_submit, static_cast<unsigned>(enter_rtn));
+            reapCompletions();
+        }
+    }
+
+    if (ring_fd >= 0) ::close(ring_fd);
+    if (sqes != nullptr) ::munmap(sqes, sqes_size);
+    if (cq_map != nullptr && cq_map != sq_map) ::munmap(cq_map, cq_map_size);
+    if (sq_map != nullptr) ::munmap(sq_map, sq_map_size);
+    if (buf_ring != nullptr) ::munmap(buf_ring, buf_ring_size);
+    if (buf_mem != nullptr) ::munmap(buf_mem, buf_size * num_bufs);
+
+    ring_fd     = -1;
+    sock_fd     = -1;
+    sq_map      = nullptr;
+    cq_map      = nullptr;
+    sqes        = nullptr;
+    buf_ring    = nullptr;
+    buf_mem     = nullptr;
+    buf_tail    = 0;
+    chunks.clear();
+    num_to_submit   = 0;
+    is_armed        = false;
+    is_closed       = false;
+    has_error       = false;
+    has_failed      = false;
+    got_data        = false;
+    header_rx       = 0;
+    data_buf        = nullptr;
+    data_rx         = 0;
+    discarding      = false;
+}
+
+void UringEngine::armRecv() {
+    // only this thread submits, so the tail can be read plainly
+    const unsigned tail {*sq_tail};
+    const unsigned idx  {tail & *sq_mask};
+    io_uring_sqe* sqe   {&sqes[idx]};
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode         = IORING_OP_RECV;
+    sqe->fd             = sock_fd;
+    sqe->ioprio         = IORING_RECV_MULTISHOT;  // keeps completing (a chunk per cqe) until stopped
+    sqe->flags          = IOSQE_BUFFER_SELECT;    // kernel picks a provided buffer per chunk
+    sqe->buf_group      = BUF_GROUP;
+    sqe->user_data      = RECV_TAG;
+    sq_array[idx]       = idx;
+    storeRelease(sq_tail, tail + 1);
+
+    ++num_to_submit;
+    is_armed = true;
+}
+
+void UringEngine::recycleBuf(const std::uint16_t buf_id) {
+    // indexed as a plain array: io_uring_buf_ring's flex array wrapper is laid out differently in c++
+    // leave `resv` alone, the first entry's is the ring's tail
+    io_uring_buf& entry {buf_ring[buf_tail & (num_bufs - 1)]};
+    entry.addr  = reinterpret_cast<std::uintptr_t>(buf_mem + static_cast<std::size_t>(buf_id) * buf_size);
+    entry.len   = static_cast<std::uint32_t>(buf_size);
+    entry.bid   = buf_id;
+    ++buf_tail;
+    __atomic_store_n(&buf_ring[0].resv, buf_tail, __ATOMIC_RELEASE);
+}
+
+unsigned UringEngine::reapCompletions() {
+    unsigned head       {*cq_head};
+    const unsigned tail {loadAcquire(cq_tail)};
+    unsigned num_reaped {0};
+    for (; head != tail; ++head, ++num_reaped) {
+        const io_uring_cqe& cqe {cqes[head & *cq_mask]};
+        if (cqe.user_data != RECV_TAG) continue;
+
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            const std::uint16_t buf_id {static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT)};
+            if (cqe.res > 0) {
+                chunks.push_back(Chunk{buf_id, 0, static_cast<std::uint32_t>(cqe.res)});
+                got_data = true;
+            } else {
+                recycleBuf(buf_id);
+            }
+        }
+
+        if (cqe.res == 0) {
+            is_closed = true;
+        } else if (cqe.res == -ENOBUFS || cqe.res == -ECANCELED) {
+            // out of buffers: re-armed once parsing frees some. cancelled: closing
+        } else if ((cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP) && !got_data) {
+            has_failed = true; // kernel predates multishot recv (6.0)
+        } else if (cqe.res < 0) {
+            has_error = true;
+        }
+
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            is_armed = false;
+        }
+    }
+    storeRelease(cq_head, head);
+    return num_reaped;
+}
+
+bool UringEngine::parseChunks(BufferPool& pool, RecvRtn& done) {
+    while (!chunks.empty()) {
+        Chunk& chunk {chunks.front()};
+        const std::uint8_t* src {buf_mem + static_cast<std::size_t>(chunk.buf_id) * buf_size + chunk.offset};
+        const std::size_t avail {chunk.size - chunk.offset};
+
+        std::size_t used {0};
+        if (header_rx < HeaderPkt_t::WIRE_SIZE) {
+            /*************************************** header ***************************************/
+            used = std::min(avail, HeaderPkt_t::WIRE_SIZE - header_rx);
+            std::memcpy(header_buf + header_rx, src, used);
+            header_rx += used;
+
+            // whole header arrived -> get a buffer for the data (drain it if too large)
+            if (header_rx == HeaderPkt_t::WIRE_SIZE) {
+                header      = HeaderPkt_t{header_buf};
+                data_buf    = pool.acquire(header.total_length);
+                data_rx     = 0;
+                discarding  = !data_buf;
+            }
+        } else {
+            /**************************************** data ****************************************/
+            used = std::min(avail, header.total_length - data_rx);
+            if (!discarding) std::memcpy(data_buf->data() + data_rx, src, used);
+            data_rx += used;
+        }
+
+        // fully parsed chunks go straight back to the kernel
+        chunk.offset += static_cast<std::uint32_t>(used);
+        if (chunk.offset == chunk.size) {
+            recycleBuf(chunk.buf_id);
+            chunks.pop_front();
+        }
+
+        if (header_rx < HeaderPkt_t::WIRE_SIZE || data_rx < header.total_length) continue;
+
+        // message complete -> hand it off & get ready for the next one
+        const bool was_discarded {discarding};
+        done.header     = header;
+        done.buf        = was_discarded ? nullptr : std::move(data_buf);
+        done.RtnCode    = was_discarded ? RecvSendRtnCodes::Error : RecvSendRtnCodes::Success;
+        header_rx       = 0;
+        data_buf        = nullptr;
+        data_rx         = 0;
+        discarding      = false;
+
+        if (was_discarded) {
+            std::cerr << "ERROR: RECV - message too large (" << done.header.total_length << "/"
+                      << pool.getMaxMsgSize() << " bytes), discarded it" << std::endl;
+        }
+        return true;
+    }
+    return false;
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace
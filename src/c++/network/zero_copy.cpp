@@ -0,0 +1,77 @@
+#include "zero_copy.h"
+
+namespace RPI {
+namespace Network {
+
+/********************************************** Constructors **********************************************/
+
+ZeroCopyTracker::ZeroCopyTracker()
+    : pending{}
+    , next_seq{0}           // kernel starts counting at 0 for each socket
+    , kernel_copied{false}
+{
+    // stub
+}
+
+ZeroCopyTracker::~ZeroCopyTracker() {
+    // stub
+}
+
+ReturnCodes ZeroCopyTracker::enable(const int sock_fd) {
+    const int option {1};
+    const int rtn {setsockopt(sock_fd, SOL_SOCKET, SO_ZEROCOPY, &option, sizeof(option))};
+    return rtn == 0 ? ReturnCodes::Success : ReturnCodes::Error;
+}
+
+/********************************************* Getters/Setters *********************************************/
+
+bool ZeroCopyTracker::shouldUse(const std::size_t size) const {
+    return !kernel_copied
+        && size >= Constants::Network::ZEROCOPY_MIN_SIZE
+        && pending.size() < Constants::Network::ZEROCOPY_MAX_PENDING;
+}
+
+std::size_t ZeroCopyTracker::getNumPending() const {
+    return pending.size();
+}
+
+/****************************************** Tracking Functions *****************************************/
+
+void ZeroCopyTracker::track(std::shared_ptr<const void> keepalive) {
+    pending.push_back(PendingSend{next_seq++, std::move(keepalive)});
+}
+
+void ZeroCopyTracker::reap(const int sock_fd) {
+    while (!pending.empty()) {
+        char        ctrl_buf[CMSG_SPACE(sizeof(sock_extended_err))];
+        msghdr      msg {};
+        msg.msg_control     = ctrl_buf;
+        msg.msg_controllen  = sizeof(ctrl_buf);
+
+        // nothing left on the error queue (or socket closed)
+        if (::recvmsg(sock_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            return;
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            const sock_extended_err* serr {reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg))};
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+            // kernel had to copy anyway (i.e. loopback), so zero copy only adds overhead on this socket
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                kernel_copied = true;
+            }
+
+            // [ee_info, ee_data] is the inclusive range of finished sends (wraps around at 2^32)
+            const std::uint32_t first {serr->ee_info};
+            const std::uint32_t last  {serr->ee_data};
+            while (!pending.empty() && pending.front().seq - first <= last - first) {
+                pending.pop_front();
+            }
+        }
+    }
+}
+
+} // end of Network namespace
+
+}; // end of RPI namespace